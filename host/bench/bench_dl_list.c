@@ -0,0 +1,56 @@
+/** @file bench_dl_list.c
+ *  @brief Host benchmark: doubly-linked list insert / remove
+ *
+ *  Moves entries between two lists the way the queue free pool and the
+ *  transmit queues do: remove from the head of one, insert at the end of
+ *  the other.
+ */
+
+#include <stdlib.h>
+
+#include "host_bench.h"
+
+#include "wlan_mac_dl_list.h"
+
+#define BENCH_DL_NUM_ENTRIES     1024
+#define BENCH_DL_ITERATIONS      10000000
+
+HOST_BENCH(dl_list){
+	dl_list   list_a;
+	dl_list   list_b;
+	dl_entry* entries;
+	dl_entry* entry;
+	u32       i;
+	u32       iterations = host_bench_iterations(BENCH_DL_ITERATIONS);
+	u64       start;
+
+	entries = calloc(BENCH_DL_NUM_ENTRIES, sizeof(dl_entry));
+	if (entries == NULL) {
+		return;
+	}
+
+	dl_list_init(&list_a);
+	dl_list_init(&list_b);
+
+	for (i = 0; i < BENCH_DL_NUM_ENTRIES; i++) {
+		dl_entry_insertEnd(&list_a, &entries[i]);
+	}
+
+	start = host_bench_now_ns();
+
+	for (i = 0; i < iterations; i++) {
+		if (list_a.length == 0) {
+			entry = list_b.first;
+			dl_entry_remove(&list_b, entry);
+			dl_entry_insertEnd(&list_a, entry);
+		} else {
+			entry = list_a.first;
+			dl_entry_remove(&list_a, entry);
+			dl_entry_insertEnd(&list_b, entry);
+		}
+	}
+
+	host_bench_report_ops("remove_first_insert_end", iterations, host_bench_now_ns() - start, NULL);
+
+	free(entries);
+}
@@ -0,0 +1,109 @@
+/** @file bench_entries.c
+ *  @brief Host benchmark: full vs compact TX / RX log entries
+ *
+ *  Logs received frames and their transmit / retransmit entries with full
+ *  and with compact entries until 1 MB of log is used, and reports the
+ *  entries per MB, the host time to create an entry and the host time to
+ *  decode an entry with log_decode_walk().
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "host_bench.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_802_11_defs.h"
+#include "wlan_mac_misc_util.h"
+#include "wlan_mac_entries.h"
+#include "wlan_mac_event_log.h"
+#include "log_decode.h"
+
+#define BENCH_ENTRIES_LOG_SIZE         (1024 * 1024)
+#define BENCH_ENTRIES_PAYLOAD_LEN      64                      // Bytes of each MAC payload to log
+
+static u32 bench_entries_rx_buf[(sizeof(rx_frame_info) + PHY_RX_PKT_BUF_MPDU_OFFSET + 2048) / 4];
+static u32 bench_entries_tx_buf[(sizeof(tx_frame_info) + PHY_TX_PKT_BUF_MPDU_OFFSET + 2048) / 4];
+
+static void bench_entries_callback(u16 entry_type, void* entry, u32 entry_length, void* arg){
+	(*(u32*)arg)++;
+}
+
+static void bench_entries_run(u8 compact){
+	rx_frame_info*          rx_mpdu = (rx_frame_info*)bench_entries_rx_buf;
+	tx_frame_info*          tx_mpdu = (tx_frame_info*)bench_entries_tx_buf;
+	wlan_mac_low_tx_details tx_low_details;
+	log_decode_stats        stats;
+	char                    label[64];
+	const char*             mode    = compact ? "compact" : "full";
+	u32                     i;
+	u32                     num_entries = 0;
+	u32                     num_decoded = 0;
+	u32                     log_size    = host_bench_iterations(BENCH_ENTRIES_LOG_SIZE * 100);
+	u32                     used;
+	u64                     start;
+	u64                     elapsed;
+
+	memset(bench_entries_rx_buf, 0, sizeof(bench_entries_rx_buf));
+	memset(bench_entries_tx_buf, 0, sizeof(bench_entries_tx_buf));
+	memset(&tx_low_details, 0, sizeof(tx_low_details));
+
+	((mac_header_80211*)((u8*)rx_mpdu + PHY_RX_PKT_BUF_MPDU_OFFSET))->frame_control_1 = MAC_FRAME_CTRL1_SUBTYPE_DATA;
+	((mac_header_80211*)((u8*)tx_mpdu + PHY_TX_PKT_BUF_MPDU_OFFSET))->frame_control_1 = MAC_FRAME_CTRL1_SUBTYPE_DATA;
+
+	rx_mpdu->state              = RX_MPDU_STATE_FCS_GOOD;
+	rx_mpdu->rx_power           = -50;
+	rx_mpdu->phy_details.length = 1500;
+	tx_mpdu->length             = 1500;
+	tx_mpdu->num_tx_attempts    = 1;
+	tx_low_details.tx_details_type = TX_DETAILS_MPDU;
+
+	// The log size is scaled by host_bench_iterations() so that --smoke logs 1 MB / 100
+	log_size = (log_size / 100) & ~0x3;
+
+	wlan_exp_log_set_entry_en_mask(ENTRY_EN_MASK_TXRX_CTRL | ENTRY_EN_MASK_TXRX_MPDU);
+	wlan_exp_log_reset_entry_policies();
+	wlan_exp_log_set_mac_payload_len(BENCH_ENTRIES_PAYLOAD_LEN);
+	event_log_init((char*)EVENT_LOG_BASE, log_size);
+	event_log_config_wrap(EVENT_LOG_WRAP_DISABLE);
+	wlan_exp_log_set_compact(compact);
+
+	start = host_bench_now_ns();
+
+	for (i = 0; event_log_get_num_failures() == 0; i++) {
+		rx_mpdu->timestamp        = 1000000 + (i * 200);
+		tx_mpdu->timestamp_create = 1000100 + (i * 200);
+		tx_mpdu->unique_seq       = i;
+
+		wlan_exp_log_create_rx_entry(rx_mpdu, 1, WLAN_MAC_MCS_18M);
+		wlan_exp_log_create_tx_entry(tx_mpdu, 1);
+		wlan_exp_log_create_tx_low_entry(tx_mpdu, &tx_low_details, 0, 0);
+		num_entries += 3;
+	}
+
+	elapsed = host_bench_now_ns() - start;
+
+	// Entries that did not fit in the log are not counted
+	//   NOTE:  A full log moves the next entry index back to 0, so the log
+	//     is walked using its total size.
+	num_entries -= event_log_get_num_failures();
+	used         = event_log_get_total_size();
+
+	snprintf(label, sizeof(label), "%s/entries_per_mb", mode);
+	host_bench_report_value(label, ((double)num_entries * 1024.0 * 1024.0) / used, "entries");
+
+	snprintf(label, sizeof(label), "%s/create_time_per_entry", mode);
+	host_bench_report_value(label, (double)elapsed / num_entries, "ns");
+
+	start = host_bench_now_ns();
+	log_decode_walk((u8*)EVENT_LOG_BASE, used, bench_entries_callback, &num_decoded, &stats);
+	elapsed = host_bench_now_ns() - start;
+
+	snprintf(label, sizeof(label), "%s/decode_time_per_entry", mode);
+	host_bench_report_value(label, (num_decoded > 0) ? ((double)elapsed / num_decoded) : 0.0, "ns");
+}
+
+HOST_BENCH(entries){
+	bench_entries_run(0);
+	bench_entries_run(1);
+}
@@ -0,0 +1,91 @@
+/** @file bench_event_log.c
+ *  @brief Host benchmark: event log allocation latency in wrap mode
+ *
+ *  Fills a wrapping event log once and then times each call to
+ *  event_log_get_next_empty_entry(); each entry is committed outside of the
+ *  timed call.  Every allocation in this state has to move the oldest entry
+ *  past the newly allocated bytes, so the latency tail shows the cost of
+ *  evicting old entries.  Two entry size mixes are
+ *  run: only small entries, and small entries with an occasional large one
+ *  that evicts a long run of small entries at once.
+ */
+
+#include <stdio.h>
+
+#include "host_bench.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_entries.h"
+#include "wlan_mac_event_log.h"
+
+#define BENCH_EVENT_LOG_ALLOCATIONS    1000000
+#define BENCH_EVENT_LOG_ENTRY_TYPE     ENTRY_TYPE_TEMPERATURE
+#define BENCH_EVENT_LOG_SMALL_SIZE     24
+#define BENCH_EVENT_LOG_LARGE_SIZE     2048
+
+static u16 bench_event_log_size(u32 i, u32 large_every){
+	if ((large_every != 0) && ((i % large_every) == 0)) {
+		return BENCH_EVENT_LOG_LARGE_SIZE;
+	}
+
+	return BENCH_EVENT_LOG_SMALL_SIZE + 4 * (i % 4);
+}
+
+static void bench_event_log_run(const char* mix, u32 log_size, u32 large_every){
+	host_bench_latency lat;
+	char               label[64];
+	u32                i;
+	u32                num_allocations = host_bench_iterations(BENCH_EVENT_LOG_ALLOCATIONS);
+	u32                num_wraps;
+	u64                elapsed = 0;
+	u64                start;
+	void*              entry;
+
+	event_log_init((char*)EVENT_LOG_BASE, log_size);
+	event_log_config_wrap(EVENT_LOG_WRAP_ENABLE);
+
+	// Fill the log so that every timed allocation has to evict old entries
+	for (i = 0; event_log_get_num_wraps() == 0; i++) {
+		entry = event_log_get_next_empty_entry(BENCH_EVENT_LOG_ENTRY_TYPE, bench_event_log_size(i, large_every));
+
+		if (entry != NULL) {
+			event_log_commit_entry(entry);
+		}
+	}
+
+	host_bench_latency_init(&lat, num_allocations);
+	num_wraps = event_log_get_num_wraps();
+
+	for (i = 0; i < num_allocations; i++) {
+		start = host_bench_now_ns();
+		entry = event_log_get_next_empty_entry(BENCH_EVENT_LOG_ENTRY_TYPE, bench_event_log_size(i, large_every));
+		start = host_bench_now_ns() - start;
+
+		if (entry == NULL) {
+			break;
+		}
+
+		event_log_commit_entry(entry);
+
+		elapsed += start;
+		host_bench_latency_add(&lat, start);
+	}
+
+	snprintf(label, sizeof(label), "%s/%ukB/allocate", mix, log_size / 1024);
+	host_bench_report_ops(label, i, elapsed, &lat);
+
+	snprintf(label, sizeof(label), "%s/%ukB/wraps", mix, log_size / 1024);
+	host_bench_report_value(label, event_log_get_num_wraps() - num_wraps, "wraps");
+
+	snprintf(label, sizeof(label), "%s/%ukB/failures", mix, log_size / 1024);
+	host_bench_report_value(label, event_log_get_num_failures(), "allocations");
+
+	host_bench_latency_free(&lat);
+}
+
+HOST_BENCH(event_log_wrap){
+	bench_event_log_run("small", 64 * 1024, 0);
+	bench_event_log_run("small", 4 * 1024 * 1024, 0);
+	bench_event_log_run("mixed", 64 * 1024, 50);
+	bench_event_log_run("mixed", 4 * 1024 * 1024, 50);
+}
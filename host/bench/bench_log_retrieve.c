@@ -0,0 +1,126 @@
+/** @file bench_log_retrieve.c
+ *  @brief Host benchmark: data movement of a full event log retrieval
+ *
+ *  Runs the node side of CMDID_LOG_GET_ENTRIES over a full log, one packet
+ *  of bytes_per_pkt bytes at a time, through the WLAN Exp transport and the
+ *  Xilnet stand-in.  Two data paths are compared:  copying each chunk in to
+ *  the response with event_log_get_data() and sending it with
+ *  transport_send(), and sending it from the log with
+ *  transport_send_w_data(), which has the central DMA copy it in to the send
+ *  buffer.
+ *
+ *  For each path the benchmark reports the packets per log and the bytes
+ *  copied by the processor and by the central DMA per byte of log.  The
+ *  shim's central DMA is a memmove and no frame is put on the wire, so the
+ *  host cannot report the retrieval rate of the node:  that needs a
+ *  measurement on hardware.
+ */
+
+#include <stdio.h>
+
+#include "host_bench.h"
+#include "host_shim.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_entries.h"
+#include "wlan_mac_event_log.h"
+#include "wlan_exp_common.h"
+#include "wlan_exp_transport.h"
+#include "xilnet_config.h"
+
+#define BENCH_LOG_RETRIEVE_LOG_SIZE    (16 * 1024 * 1024)
+#define BENCH_LOG_RETRIEVE_PASSES      4
+#define BENCH_LOG_RETRIEVE_ENTRY_TYPE  ENTRY_TYPE_TEMPERATURE
+
+// Message length of an event log response:  pad, response header and the 5 word buffer header
+#define BENCH_LOG_RETRIEVE_MSG_LENGTH  (PAYLOAD_PAD_NBYTES + sizeof(wn_respHdr) + 5*sizeof(u32))
+
+static void bench_log_retrieve_fill(u32 log_size){
+	u32   i;
+	void* entry;
+
+	event_log_init((char*)EVENT_LOG_BASE, log_size);
+	event_log_config_wrap(EVENT_LOG_WRAP_DISABLE);
+
+	for (i = 0; (entry = event_log_get_next_empty_entry(BENCH_LOG_RETRIEVE_ENTRY_TYPE, 24 + 4 * (i % 64))) != NULL; i++) {
+		event_log_commit_entry(entry);
+	}
+}
+
+static void bench_log_retrieve_run(const char* path, u32 bytes_per_pkt, u8 use_cdma){
+	char             label[64];
+	wn_host_message  msg;
+	pktSrcInfo       pkt_src    = {0};
+	u8*              buffer     = (u8*)eth_device[ETH_A_MAC].sendbuf;
+	u8*              msg_data   = buffer + PAYLOAD_OFFSET + sizeof(wn_transport_header) + BENCH_LOG_RETRIEVE_MSG_LENGTH - PAYLOAD_PAD_NBYTES;
+	u32              num_passes = (host_bench_iterations(BENCH_LOG_RETRIEVE_PASSES * 100) + 99) / 100;
+	u32              size       = event_log_get_total_size();
+	u32              pass;
+	u32              curr_index;
+	u32              transfer_size;
+	u32              num_bytes;
+	u32              log_address;
+	u32              num_sends;
+	u64              cpu_bytes  = 0;
+	u64              cdma_bytes;
+	u64              total      = 0;
+
+	host_shim_get_stats()->cdma_bytes = 0;
+	num_sends = host_shim_get_stats()->num_transport_send;
+
+	for (pass = 0; pass < num_passes; pass++) {
+		for (curr_index = 0; curr_index < size; curr_index += transfer_size) {
+			transfer_size = ((size - curr_index) < bytes_per_pkt) ? (size - curr_index) : bytes_per_pkt;
+
+			msg.buffer  = buffer;
+			msg.payload = buffer + PAYLOAD_OFFSET + sizeof(wn_transport_header);
+			msg.length  = BENCH_LOG_RETRIEVE_MSG_LENGTH;
+
+			if (use_cdma) {
+				num_bytes = event_log_get_data_address(curr_index, transfer_size, &log_address);
+				transport_send_w_data(0, &msg, (void*)log_address, num_bytes, &pkt_src, ETH_A_MAC);
+			} else {
+				num_bytes   = event_log_get_data(curr_index, transfer_size, (char*)msg_data);
+				cpu_bytes  += num_bytes;
+				msg.length += num_bytes;
+				transport_send(0, &msg, &pkt_src, ETH_A_MAC);
+			}
+
+			if (num_bytes != transfer_size) {
+				printf("%s: tried to get %u bytes, but only received %u @ 0x%x\n", path, transfer_size, num_bytes, curr_index);
+				return;
+			}
+
+			total += num_bytes;
+		}
+	}
+
+	num_sends  = host_shim_get_stats()->num_transport_send - num_sends;
+	cdma_bytes = host_shim_get_stats()->cdma_bytes;
+
+	// Data the central DMA cannot reach is copied by the transport with the processor
+	if (use_cdma) {
+		cpu_bytes = total - cdma_bytes;
+	}
+
+	snprintf(label, sizeof(label), "%s/%u_bytes_per_pkt/packets", path, bytes_per_pkt);
+	host_bench_report_value(label, (double)num_sends / num_passes, "pkts/log");
+
+	snprintf(label, sizeof(label), "%s/%u_bytes_per_pkt/cpu_copy", path, bytes_per_pkt);
+	host_bench_report_value(label, (total > 0) ? ((double)cpu_bytes / total) : 0.0, "bytes/log byte");
+
+	snprintf(label, sizeof(label), "%s/%u_bytes_per_pkt/cdma_copy", path, bytes_per_pkt);
+	host_bench_report_value(label, (total > 0) ? ((double)cdma_bytes / total) : 0.0, "bytes/log byte");
+}
+
+HOST_BENCH(log_retrieve){
+	// Largest packet that fits the transport's MTU (TRANSPORT_MTU)
+	u32 max_bytes_per_pkt = TRANSPORT_MAX_DATA_LENGTH(BENCH_LOG_RETRIEVE_MSG_LENGTH) & ~0x3;
+
+	bench_log_retrieve_fill(host_bench_iterations(BENCH_LOG_RETRIEVE_LOG_SIZE / 100) * 100);
+
+	bench_log_retrieve_run("copy", 1280,              0);
+	bench_log_retrieve_run("cdma", 1280,              1);
+	bench_log_retrieve_run("copy", max_bytes_per_pkt, 0);
+	bench_log_retrieve_run("cdma", max_bytes_per_pkt, 1);
+}
@@ -0,0 +1,121 @@
+/** @file bench_ltg.c
+ *  @brief Host benchmark: configured vs achieved LTG rates
+ *
+ *  Starts 1 to 500 periodic LTGs with intervals spread over 500 usec to
+ *  10 ms and runs them for one simulated second.  Reports the configured and
+ *  achieved aggregate event rates, the lowest ratio of achieved to configured
+ *  rate over the LTGs, and the host time spent per LTG event.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_bench.h"
+
+#include "wlan_mac_802_11_defs.h"
+#include "wlan_mac_high.h"
+#include "wlan_mac_schedule.h"
+#include "wlan_mac_packet_types.h"
+#include "wlan_mac_ltg.h"
+
+#define BENCH_LTG_DURATION_USEC        1000000
+#define BENCH_LTG_MIN_INTERVAL_USEC    500
+#define BENCH_LTG_MAX_INTERVAL_USEC    10000
+#define BENCH_LTG_MAX_NUM              500
+
+static u32  bench_ltg_first_id;
+static u32  bench_ltg_num_events[BENCH_LTG_MAX_NUM];
+
+static void bench_ltg_callback(u32 id, void* callback_arg){
+	u32 index = id - bench_ltg_first_id;
+
+	if (index < BENCH_LTG_MAX_NUM) {
+		bench_ltg_num_events[index]++;
+	}
+}
+
+static void bench_ltg_run(u32 num_ltgs){
+	ltg_sched_periodic_params params;
+	ltg_pyld_fixed*           payload;
+	char                      label[64];
+	u32                       i;
+	u32                       id;
+	u32                       interval[BENCH_LTG_MAX_NUM];
+	u32                       duration = BENCH_LTG_DURATION_USEC;
+	u64                       total_events = 0;
+	double                    configured   = 0.0;
+	double                    ratio;
+	double                    worst_ratio  = 1e9;
+	u64                       start;
+	u64                       elapsed;
+
+	// In --smoke mode run for 1/100th of the time
+	duration = host_bench_iterations(duration);
+
+	wlan_mac_schedule_init();
+	wlan_mac_schedule_setup_interrupt(host_shim_get_intc());
+	wlan_mac_ltg_sched_init();
+	wlan_mac_ltg_sched_set_callback((void*)bench_ltg_callback);
+
+	for (i = 0; i < num_ltgs; i++) {
+		interval[i] = BENCH_LTG_MIN_INTERVAL_USEC +
+		              ((i * 7919) % (BENCH_LTG_MAX_INTERVAL_USEC - BENCH_LTG_MIN_INTERVAL_USEC + 1));
+
+		params.interval_usec = interval[i];
+		params.duration_usec = LTG_DURATION_FOREVER;
+
+		payload = wlan_mac_high_calloc(sizeof(ltg_pyld_fixed));
+		payload->hdr.type = LTG_PYLD_TYPE_FIXED;
+		payload->length   = 1400;
+
+		id = ltg_sched_create(LTG_SCHED_TYPE_PERIODIC, &params, payload, NULL);
+
+		if (i == 0) {
+			bench_ltg_first_id = id;
+		}
+		bench_ltg_num_events[i] = 0;
+
+		configured += 1e6 / interval[i];
+	}
+
+	ltg_sched_start_all();
+
+	start = host_bench_now_ns();
+	host_shim_advance_usec(duration);
+	elapsed = host_bench_now_ns() - start;
+
+	ltg_sched_stop_all();
+
+	for (i = 0; i < num_ltgs; i++) {
+		total_events += bench_ltg_num_events[i];
+
+		// Only LTGs that should have run at least 10 times say anything about their rate
+		if ((duration / interval[i]) >= 10) {
+			ratio = ((double)bench_ltg_num_events[i] * interval[i]) / duration;
+			if (ratio < worst_ratio) {
+				worst_ratio = ratio;
+			}
+		}
+	}
+
+	snprintf(label, sizeof(label), "%u_ltgs/configured_rate", num_ltgs);
+	host_bench_report_value(label, configured, "events/s");
+
+	snprintf(label, sizeof(label), "%u_ltgs/achieved_rate", num_ltgs);
+	host_bench_report_value(label, ((double)total_events * 1e6) / duration, "events/s");
+
+	snprintf(label, sizeof(label), "%u_ltgs/worst_ltg_ratio", num_ltgs);
+	host_bench_report_value(label, (worst_ratio < 1e9) ? worst_ratio : 0.0, "");
+
+	snprintf(label, sizeof(label), "%u_ltgs/host_time_per_event", num_ltgs);
+	host_bench_report_value(label, (total_events > 0) ? ((double)elapsed / total_events) : 0.0, "ns");
+
+	ltg_sched_remove_all();
+}
+
+HOST_BENCH(ltg){
+	bench_ltg_run(1);
+	bench_ltg_run(10);
+	bench_ltg_run(100);
+	bench_ltg_run(500);
+}
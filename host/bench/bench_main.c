@@ -0,0 +1,146 @@
+/** @file bench_main.c
+ *  @brief Microbenchmark runner for the host build
+ *
+ *  Usage: wlan_mac_host_bench [--smoke] [name ...]
+ *
+ *  Runs every registered benchmark, or only the named ones.  Results are
+ *  printed one per line as
+ *
+ *      <bench>/<label>  <ops/sec>  p50 <ns>  p99 <ns>  p999 <ns>
+ *
+ *  or, for derived figures, as "<bench>/<label>  <value> <unit>".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_bench.h"
+
+static host_bench_case*  bench_list;
+static host_bench_case** bench_list_tail = &bench_list;
+static host_bench_case*  bench_current;
+static int               bench_smoke;
+
+void host_bench_register(host_bench_case* bench){
+	*bench_list_tail = bench;
+	bench_list_tail  = &(bench->next);
+}
+
+u64 host_bench_now_ns(void){
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((u64)ts.tv_sec * 1000000000ULL) + (u64)ts.tv_nsec;
+}
+
+u32 host_bench_iterations(u32 iterations){
+	if (bench_smoke) {
+		iterations = (iterations + 99) / 100;
+	}
+
+	return iterations;
+}
+
+void host_bench_latency_init(host_bench_latency* lat, u32 max_samples){
+	lat->samples     = malloc(max_samples * sizeof(u32));
+	lat->num_samples = 0;
+	lat->max_samples = (lat->samples != NULL) ? max_samples : 0;
+}
+
+void host_bench_latency_add(host_bench_latency* lat, u64 ns){
+	if (lat->num_samples < lat->max_samples) {
+		lat->samples[lat->num_samples++] = (ns > 0xFFFFFFFF) ? 0xFFFFFFFF : (u32)ns;
+	}
+}
+
+void host_bench_latency_free(host_bench_latency* lat){
+	free(lat->samples);
+	lat->samples     = NULL;
+	lat->num_samples = 0;
+	lat->max_samples = 0;
+}
+
+static int bench_compare_u32(const void* a, const void* b){
+	u32 x = *(const u32*)a;
+	u32 y = *(const u32*)b;
+
+	return (x > y) - (x < y);
+}
+
+static u32 bench_percentile(host_bench_latency* lat, u32 per_mille){
+	u32 index = (u32)(((u64)lat->num_samples * per_mille) / 1000);
+
+	if (index >= lat->num_samples) {
+		index = lat->num_samples - 1;
+	}
+
+	return lat->samples[index];
+}
+
+void host_bench_report_ops(const char* label, u64 num_ops, u64 elapsed_ns, host_bench_latency* lat){
+	double ops_per_sec = (elapsed_ns > 0) ? ((double)num_ops * 1e9) / (double)elapsed_ns : 0.0;
+
+	printf("%s/%-40s %12.0f ops/s", bench_current->name, label, ops_per_sec);
+
+	if ((lat != NULL) && (lat->num_samples > 0)) {
+		qsort(lat->samples, lat->num_samples, sizeof(u32), bench_compare_u32);
+		printf("  p50 %6u ns  p99 %6u ns  p999 %6u ns",
+		       bench_percentile(lat, 500), bench_percentile(lat, 990), bench_percentile(lat, 999));
+	}
+
+	printf("\n");
+}
+
+void host_bench_report_value(const char* label, double value, const char* unit){
+	printf("%s/%-40s %12.2f %s\n", bench_current->name, label, value, unit);
+}
+
+static int bench_selected(host_bench_case* bench, int argc, char** argv, int first_arg){
+	int i;
+
+	if (first_arg >= argc) {
+		return 1;
+	}
+
+	for (i = first_arg; i < argc; i++) {
+		if (strcmp(argv[i], bench->name) == 0) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int main(int argc, char** argv){
+	host_bench_case* bench;
+	int              first_arg = 1;
+	u32              num_run   = 0;
+
+	if ((argc > 1) && (strcmp(argv[1], "--smoke") == 0)) {
+		bench_smoke = 1;
+		first_arg   = 2;
+	}
+
+	for (bench = bench_list; bench != NULL; bench = bench->next) {
+		if (bench_selected(bench, argc, argv, first_arg) == 0) {
+			continue;
+		}
+
+		host_shim_init();
+		host_shim_set_verbose(getenv("HOST_SHIM_VERBOSE") != NULL);
+
+		bench_current = bench;
+		bench->fn();
+		num_run++;
+	}
+
+	if (num_run == 0) {
+		printf("No benchmarks selected\n");
+		return 1;
+	}
+
+	return 0;
+}
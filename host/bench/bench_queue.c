@@ -0,0 +1,173 @@
+/** @file bench_queue.c
+ *  @brief Host benchmark: Tx queue operations under an AP-shaped mix
+ *
+ *  Runs a mix of queue operations shaped like an AP serving many stations,
+ *  with 20, 200 and 2000 queues:
+ *
+ *   - Enqueue (checkout + enqueue_after_tail) and dequeue (dequeue_from_head
+ *     + checkin) in equal proportion, so the pool stays partly occupied
+ *   - 80% of the traffic goes to 20% of the queues
+ *   - 40% small frames (TCP ACKs, ARP), 60% full-size frames
+ *   - 1 in 1000 operations purges a queue, as when a station leaves
+ *
+ *  Each operation is timed separately, so the reported ops/sec of an
+ *  operation excludes the others; the "mix" line gives the throughput of
+ *  the whole mix.  Per-operation figures include the ~20 ns cost of reading
+ *  the host clock.
+ */
+
+#include <stdio.h>
+
+#include "host_bench.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_queue.h"
+
+#define BENCH_QUEUE_ITERATIONS         2000000
+#define BENCH_QUEUE_MAX_SAMPLES        1000000
+#define BENCH_QUEUE_PURGE_PER_MILLE    1
+
+enum {
+	BENCH_QUEUE_OP_CHECKOUT = 0,
+	BENCH_QUEUE_OP_ENQUEUE,
+	BENCH_QUEUE_OP_DEQUEUE,
+	BENCH_QUEUE_OP_CHECKIN,
+	BENCH_QUEUE_OP_PURGE,
+	BENCH_QUEUE_NUM_OPS
+};
+
+static const char* bench_queue_op_names[BENCH_QUEUE_NUM_OPS] = {
+	"checkout", "enqueue_after_tail", "dequeue_from_head", "checkin", "purge_queue"
+};
+
+typedef struct {
+	u64                  num_ops;
+	u64                  total_ns;
+	host_bench_latency   latency;
+} bench_queue_op_stats;
+
+static u32 bench_queue_rand_state;
+
+static u32 bench_queue_rand(){
+	// xorshift32
+	bench_queue_rand_state ^= bench_queue_rand_state << 13;
+	bench_queue_rand_state ^= bench_queue_rand_state >> 17;
+	bench_queue_rand_state ^= bench_queue_rand_state << 5;
+
+	return bench_queue_rand_state;
+}
+
+// Picks a queue so that 80% of the picks land on the first 20% of the queues
+static u16 bench_queue_pick(u32 num_queues){
+	u32 num_busy = (num_queues + 4) / 5;
+
+	if ((bench_queue_rand() % 10) < 8) {
+		return 1 + (bench_queue_rand() % num_busy);
+	}
+
+	return 1 + (bench_queue_rand() % num_queues);
+}
+
+static void bench_queue_time(bench_queue_op_stats* stats, u64 start){
+	u64 ns = host_bench_now_ns() - start;
+
+	stats->num_ops++;
+	stats->total_ns += ns;
+	host_bench_latency_add(&(stats->latency), ns);
+}
+
+static void bench_queue_run(u32 num_queues){
+	bench_queue_op_stats  op[BENCH_QUEUE_NUM_OPS];
+	tx_queue_element*     tqe;
+	tx_queue_buffer*      buffer;
+	char                  label[64];
+	u32                   i;
+	u32                   length;
+	u32                   iterations = host_bench_iterations(BENCH_QUEUE_ITERATIONS);
+	u32                   num_failed = 0;
+	u16                   queue_sel;
+	u64                   mix_start;
+	u64                   start;
+
+	queue_init(1);
+	bench_queue_rand_state = 0x2545F491;
+
+	for (i = 0; i < BENCH_QUEUE_NUM_OPS; i++) {
+		op[i].num_ops  = 0;
+		op[i].total_ns = 0;
+		host_bench_latency_init(&(op[i].latency), BENCH_QUEUE_MAX_SAMPLES);
+	}
+
+	// Create every queue before timing so that growing the queue arrays is not measured
+	for (i = 1; i <= num_queues; i++) {
+		tqe = queue_checkout();
+		enqueue_after_tail(i, tqe);
+		queue_checkin(dequeue_from_head(i));
+	}
+
+	mix_start = host_bench_now_ns();
+
+	for (i = 0; i < iterations; i++) {
+		queue_sel = bench_queue_pick(num_queues);
+
+		if ((bench_queue_rand() % 1000) < BENCH_QUEUE_PURGE_PER_MILLE) {
+			start = host_bench_now_ns();
+			purge_queue(queue_sel);
+			bench_queue_time(&op[BENCH_QUEUE_OP_PURGE], start);
+
+		} else if (bench_queue_rand() & 1) {
+			length = ((bench_queue_rand() % 10) < 4) ? 100 : 1500;
+
+			start = host_bench_now_ns();
+			tqe   = queue_checkout_sized(length);
+			bench_queue_time(&op[BENCH_QUEUE_OP_CHECKOUT], start);
+
+			if (tqe == NULL) {
+				num_failed++;
+				continue;
+			}
+
+			buffer = queue_element_buffer(tqe);
+			buffer->metadata.metadata_type = QUEUE_METADATA_TYPE_IGNORE;
+			buffer->metadata.ac            = QUEUE_AC_BE;
+			buffer->frame_info.length      = length;
+
+			start = host_bench_now_ns();
+			enqueue_after_tail(queue_sel, tqe);
+			bench_queue_time(&op[BENCH_QUEUE_OP_ENQUEUE], start);
+
+		} else {
+			start = host_bench_now_ns();
+			tqe   = dequeue_from_head(queue_sel);
+			bench_queue_time(&op[BENCH_QUEUE_OP_DEQUEUE], start);
+
+			if (tqe != NULL) {
+				start = host_bench_now_ns();
+				queue_checkin(tqe);
+				bench_queue_time(&op[BENCH_QUEUE_OP_CHECKIN], start);
+			}
+		}
+	}
+
+	snprintf(label, sizeof(label), "%u_queues/mix", num_queues);
+	host_bench_report_ops(label, iterations, host_bench_now_ns() - mix_start, NULL);
+
+	for (i = 0; i < BENCH_QUEUE_NUM_OPS; i++) {
+		snprintf(label, sizeof(label), "%u_queues/%s", num_queues, bench_queue_op_names[i]);
+		host_bench_report_ops(label, op[i].num_ops, op[i].total_ns, &(op[i].latency));
+		host_bench_latency_free(&(op[i].latency));
+	}
+
+	snprintf(label, sizeof(label), "%u_queues/checkout_failures", num_queues);
+	host_bench_report_value(label, (double)num_failed, "frames");
+
+	for (i = 1; i <= num_queues; i++) {
+		purge_queue(i);
+	}
+}
+
+HOST_BENCH(queue){
+	bench_queue_run(20);
+	bench_queue_run(200);
+	bench_queue_run(2000);
+}
@@ -0,0 +1,76 @@
+/** @file bench_schedule.c
+ *  @brief Host benchmark: scheduler timer interrupt cost vs number of events
+ *
+ *  Schedules N events on the fine scheduler, one of which is called every
+ *  10 ticks while the others stay pending, and advances the simulated clock
+ *  one tick at a time.  Each step runs exactly one timer interrupt, so the
+ *  reported latency is the time spent in the interrupt handler (plus the
+ *  shim's timer simulation) per tick.
+ */
+
+#include <stdio.h>
+
+#include "host_bench.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_schedule.h"
+
+#define BENCH_SCHEDULE_TICKS           200000
+#define BENCH_SCHEDULE_IDLE_DELAY      (1000 * 1000 * 1000)
+
+static u32 bench_schedule_num_calls;
+
+static void bench_schedule_callback(){
+	bench_schedule_num_calls++;
+}
+
+static void bench_schedule_run(u32 num_events){
+	host_bench_latency lat;
+	char               label[64];
+	u32                i;
+	u32                num_ticks = host_bench_iterations(BENCH_SCHEDULE_TICKS);
+	u32                num_interrupts;
+	u64                elapsed = 0;
+	u64                start;
+
+	wlan_mac_schedule_init();
+	wlan_mac_schedule_pool_config(num_events + 1);
+	wlan_mac_schedule_setup_interrupt(host_shim_get_intc());
+
+	bench_schedule_num_calls = 0;
+
+	for (i = 1; i < num_events; i++) {
+		wlan_mac_schedule_event_repeated(SCHEDULE_FINE, BENCH_SCHEDULE_IDLE_DELAY + (i * FAST_TIMER_DUR_US), 1, bench_schedule_callback);
+	}
+	wlan_mac_schedule_event_repeated(SCHEDULE_FINE, 10 * FAST_TIMER_DUR_US, SCHEDULE_REPEAT_FOREVER, bench_schedule_callback);
+
+	host_bench_latency_init(&lat, num_ticks);
+	num_interrupts = host_shim_get_stats()->num_interrupts;
+
+	for (i = 0; i < num_ticks; i++) {
+		start = host_bench_now_ns();
+		host_shim_advance_usec(FAST_TIMER_DUR_US);
+		start = host_bench_now_ns() - start;
+
+		elapsed += start;
+		host_bench_latency_add(&lat, start);
+	}
+
+	num_interrupts = host_shim_get_stats()->num_interrupts - num_interrupts;
+
+	snprintf(label, sizeof(label), "%u_events/fine_tick", num_events);
+	host_bench_report_ops(label, num_ticks, elapsed, &lat);
+
+	snprintf(label, sizeof(label), "%u_events/ns_per_interrupt", num_events);
+	host_bench_report_value(label, (num_interrupts > 0) ? ((double)elapsed / num_interrupts) : 0.0, "ns");
+
+	host_bench_latency_free(&lat);
+}
+
+HOST_BENCH(schedule){
+	bench_schedule_run(1);
+	bench_schedule_run(10);
+	bench_schedule_run(100);
+	bench_schedule_run(1000);
+	bench_schedule_run(10000);
+}
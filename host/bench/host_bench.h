@@ -0,0 +1,55 @@
+/** @file host_bench.h
+ *  @brief Minimal microbenchmark framework for the host build
+ *
+ *  Benchmarks are registered with HOST_BENCH(name) and run by bench_main.c.
+ *  Each benchmark starts from a freshly reset host shim and reports its
+ *  results with host_bench_report_*().  Timing uses the host monotonic
+ *  clock, so results can be compared against perf profiles of the runner.
+ *
+ *  host_bench_iterations() scales a benchmark's iteration count down when
+ *  the runner is invoked with --smoke, which ctest uses to check that every
+ *  benchmark still runs.
+ */
+
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include "xil_types.h"
+#include "host_shim.h"
+
+typedef void (*host_bench_fn)(void);
+
+typedef struct host_bench_case {
+	const char*              name;
+	host_bench_fn            fn;
+	struct host_bench_case*  next;
+} host_bench_case;
+
+typedef struct {
+	u32*   samples;                 ///< Latency of each sampled operation (ns)
+	u32    num_samples;
+	u32    max_samples;
+} host_bench_latency;
+
+void host_bench_register(host_bench_case* bench);
+
+#define HOST_BENCH(bench_name)                                                    \
+	static void bench_##bench_name(void);                                         \
+	static host_bench_case bench_case_##bench_name = {                            \
+		#bench_name, bench_##bench_name, NULL };                                  \
+	__attribute__((constructor)) static void register_##bench_name(void) {       \
+		host_bench_register(&bench_case_##bench_name);                            \
+	}                                                                             \
+	static void bench_##bench_name(void)
+
+u64  host_bench_now_ns(void);
+u32  host_bench_iterations(u32 iterations);
+
+void host_bench_latency_init(host_bench_latency* lat, u32 max_samples);
+void host_bench_latency_add(host_bench_latency* lat, u64 ns);
+void host_bench_latency_free(host_bench_latency* lat);
+
+void host_bench_report_ops(const char* label, u64 num_ops, u64 elapsed_ns, host_bench_latency* lat);
+void host_bench_report_value(const char* label, double value, const char* unit);
+
+#endif /* HOST_BENCH_H */
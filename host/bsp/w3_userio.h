@@ -0,0 +1,21 @@
+/** @file w3_userio.h
+ *  @brief Host BSP shim: WARP v3 User I/O
+ *
+ *  The User I/O registers are plain memory at XPAR_W3_USERIO_BASEADDR.
+ *  Only the LED accessors used by CPU Low are provided.
+ */
+
+#ifndef W3_USERIO_H
+#define W3_USERIO_H
+
+#include "xil_io.h"
+
+#define W3_USERIO_SLV_REG_LEDS_RED     0x04
+#define W3_USERIO_SLV_REG_LEDS_GREEN   0x08
+
+#define userio_write_leds_red(baseaddr, x)     Xil_Out32((baseaddr) + W3_USERIO_SLV_REG_LEDS_RED, (x))
+#define userio_write_leds_green(baseaddr, x)   Xil_Out32((baseaddr) + W3_USERIO_SLV_REG_LEDS_GREEN, (x))
+#define userio_read_leds_red(baseaddr)         Xil_In32((baseaddr) + W3_USERIO_SLV_REG_LEDS_RED)
+#define userio_read_leds_green(baseaddr)       Xil_In32((baseaddr) + W3_USERIO_SLV_REG_LEDS_GREEN)
+
+#endif /* W3_USERIO_H */
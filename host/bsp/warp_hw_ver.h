@@ -0,0 +1,13 @@
+/** @file warp_hw_ver.h
+ *  @brief Host BSP shim: WARP hardware version
+ *
+ *  The host build does not select a WARP hardware version, so no Ethernet
+ *  MAC driver is pulled in by the WLAN Exp headers.
+ */
+
+#ifndef WARP_HW_VER_H
+#define WARP_HW_VER_H
+
+#include "xparameters.h"
+
+#endif /* WARP_HW_VER_H */
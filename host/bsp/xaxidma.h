@@ -0,0 +1,122 @@
+/** @file xaxidma.h
+ *  @brief Host BSP shim: AXI DMA in scatter-gather mode
+ *
+ *  Buffer descriptor rings follow the driver:  BDs move from free to
+ *  pre-processing (XAxiDma_BdRingAlloc), to hardware (XAxiDma_BdRingToHw),
+ *  to post-processing (XAxiDma_BdRingFromHw) and back to free
+ *  (XAxiDma_BdRingFree), in ring order.
+ *
+ *  The simulated engine completes a Tx BD as soon as it is handed to
+ *  hardware.  Rx BDs are completed by host_shim_eth_rx(), which copies a
+ *  frame into the next Rx buffer and raises the S2MM interrupt
+ *  (XPAR_INTC_0_AXIDMA_0_S2MM_INTROUT_VEC_ID) when it is enabled.
+ *
+ *  Only the subset of the driver used by the WLAN MAC High Framework is
+ *  provided.
+ */
+
+#ifndef XAXIDMA_H
+#define XAXIDMA_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XAXIDMA_BD_NUM_WORDS           16
+#define XAXIDMA_BD_MINIMUM_ALIGNMENT   0x40
+
+#define XAXIDMA_BD_BUFA_OFFSET         0x08
+#define XAXIDMA_BD_CTRL_LEN_OFFSET     0x18
+#define XAXIDMA_BD_STS_OFFSET          0x1C
+#define XAXIDMA_BD_ID_OFFSET           0x34
+
+#define XAXIDMA_BD_CTRL_LENGTH_MASK    0x007FFFFF
+#define XAXIDMA_BD_CTRL_TXSOF_MASK     0x08000000
+#define XAXIDMA_BD_CTRL_TXEOF_MASK     0x04000000
+#define XAXIDMA_BD_CTRL_ALL_MASK       0x0C000000
+
+#define XAXIDMA_BD_STS_ACTUAL_LEN_MASK 0x007FFFFF
+#define XAXIDMA_BD_STS_COMPLETE_MASK   0x80000000
+
+#define XAXIDMA_IRQ_IOC_MASK           0x00001000
+#define XAXIDMA_IRQ_DELAY_MASK         0x00002000
+#define XAXIDMA_IRQ_ERROR_MASK         0x00004000
+#define XAXIDMA_IRQ_ALL_MASK           0x00007000
+
+#define XAXIDMA_ALL_BDS                0x0FFFFFFF
+
+#define XAXIDMA_CHANNEL_HALTED         0
+#define XAXIDMA_CHANNEL_RUNNING        1
+
+typedef u32 XAxiDma_Bd[XAXIDMA_BD_NUM_WORDS];
+
+typedef struct {
+	u32   DeviceId;
+	u32   BaseAddr;
+	int   SgLengthWidth;
+} XAxiDma_Config;
+
+typedef struct {
+	int   IsRxChannel;
+	int   RunState;
+	u32   MaxTransferLen;
+	u32   FirstBdAddr;
+	u32   LastBdAddr;
+	u32   Separation;
+	u32   FreeHead;
+	u32   PreHead;
+	u32   HwHead;
+	u32   HwTail;
+	u32   PostHead;
+	int   FreeCnt;
+	int   PreCnt;
+	int   HwCnt;
+	int   PostCnt;
+	int   AllCnt;
+	u32   IrqEnable;                ///< Host shim: interrupts enabled with XAxiDma_BdRingIntEnable()
+	u32   IrqStatus;                ///< Host shim: interrupts raised and not yet acknowledged
+} XAxiDma_BdRing;
+
+typedef struct {
+	u32              RegBase;
+	int              Initialized;
+	XAxiDma_BdRing   TxBdRing;
+	XAxiDma_BdRing   RxBdRing[1];
+} XAxiDma;
+
+#define XAxiDma_GetTxRing(InstancePtr)   (&((InstancePtr)->TxBdRing))
+#define XAxiDma_GetRxRing(InstancePtr)   (&((InstancePtr)->RxBdRing[0]))
+
+#define XAxiDma_BdRingGetFreeCnt(RingPtr)   ((RingPtr)->FreeCnt)
+
+#define XAxiDma_BdRingNext(RingPtr, BdPtr)                                      \
+	(((u32)(BdPtr) >= (RingPtr)->LastBdAddr) ?                                  \
+		(XAxiDma_Bd *)(uintptr_t)(RingPtr)->FirstBdAddr :                       \
+		(XAxiDma_Bd *)(uintptr_t)((u32)(BdPtr) + (RingPtr)->Separation))
+
+XAxiDma_Config * XAxiDma_LookupConfig(u32 DeviceId);
+int  XAxiDma_CfgInitialize(XAxiDma * InstancePtr, XAxiDma_Config * Config);
+
+int  XAxiDma_BdRingCreate(XAxiDma_BdRing * RingPtr, u32 PhysAddr, u32 VirtAddr, u32 Alignment, int BdCount);
+int  XAxiDma_BdRingClone(XAxiDma_BdRing * RingPtr, XAxiDma_Bd * SrcBdPtr);
+int  XAxiDma_BdRingStart(XAxiDma_BdRing * RingPtr);
+int  XAxiDma_BdRingSetCoalesce(XAxiDma_BdRing * RingPtr, u32 Counter, u32 Timer);
+int  XAxiDma_BdRingAlloc(XAxiDma_BdRing * RingPtr, int NumBd, XAxiDma_Bd ** BdSetPtr);
+int  XAxiDma_BdRingToHw(XAxiDma_BdRing * RingPtr, int NumBd, XAxiDma_Bd * BdSetPtr);
+int  XAxiDma_BdRingFromHw(XAxiDma_BdRing * RingPtr, int BdLimit, XAxiDma_Bd ** BdSetPtr);
+int  XAxiDma_BdRingFree(XAxiDma_BdRing * RingPtr, int NumBd, XAxiDma_Bd * BdSetPtr);
+
+void XAxiDma_BdRingIntEnable(XAxiDma_BdRing * RingPtr, u32 Mask);
+void XAxiDma_BdRingIntDisable(XAxiDma_BdRing * RingPtr, u32 Mask);
+u32  XAxiDma_BdRingGetIrq(XAxiDma_BdRing * RingPtr);
+void XAxiDma_BdRingAckIrq(XAxiDma_BdRing * RingPtr, u32 Mask);
+
+void XAxiDma_BdClear(XAxiDma_Bd * BdPtr);
+int  XAxiDma_BdSetBufAddr(XAxiDma_Bd * BdPtr, u32 Addr);
+u32  XAxiDma_BdGetBufAddr(XAxiDma_Bd * BdPtr);
+int  XAxiDma_BdSetLength(XAxiDma_Bd * BdPtr, u32 LenBytes, u32 LengthMask);
+u32  XAxiDma_BdGetActualLength(XAxiDma_Bd * BdPtr, u32 LengthMask);
+void XAxiDma_BdSetCtrl(XAxiDma_Bd * BdPtr, u32 Data);
+void XAxiDma_BdSetId(XAxiDma_Bd * BdPtr, u32 Id);
+u32  XAxiDma_BdGetId(XAxiDma_Bd * BdPtr);
+
+#endif /* XAXIDMA_H */
@@ -0,0 +1,49 @@
+/** @file xaxiethernet.h
+ *  @brief Host BSP shim: AXI Ethernet MAC
+ *
+ *  The MAC only records its options and speed; frames are moved by the
+ *  AXI DMA stand-in (see xaxidma.h).
+ */
+
+#ifndef XAXIETHERNET_H
+#define XAXIETHERNET_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XAE_PROMISC_OPTION             0x00000001
+#define XAE_JUMBO_OPTION               0x00000002
+#define XAE_VLAN_OPTION                0x00000004
+#define XAE_FLOW_CONTROL_OPTION        0x00000010
+#define XAE_FCS_STRIP_OPTION           0x00000020
+#define XAE_FCS_INSERT_OPTION          0x00000040
+#define XAE_LENTYPE_ERR_OPTION         0x00000080
+#define XAE_TRANSMITTER_ENABLE_OPTION  0x00000100
+#define XAE_RECEIVER_ENABLE_OPTION     0x00000200
+#define XAE_BROADCAST_OPTION           0x00000400
+#define XAE_MULTICAST_OPTION           0x00000800
+
+typedef struct {
+	u16   DeviceId;
+	u32   BaseAddress;
+	u32   AxiDevBaseAddress;
+} XAxiEthernet_Config;
+
+typedef struct {
+	XAxiEthernet_Config   Config;
+	u32                   IsReady;
+	u32                   IsStarted;
+	u32                   Options;
+	u16                   Speed;
+} XAxiEthernet;
+
+XAxiEthernet_Config * XAxiEthernet_LookupConfig(u16 DeviceId);
+int  XAxiEthernet_CfgInitialize(XAxiEthernet * InstancePtr, XAxiEthernet_Config * CfgPtr, u32 VirtualAddress);
+int  XAxiEthernet_SetOptions(XAxiEthernet * InstancePtr, u32 Options);
+int  XAxiEthernet_ClearOptions(XAxiEthernet * InstancePtr, u32 Options);
+int  XAxiEthernet_SetOperatingSpeed(XAxiEthernet * InstancePtr, u16 Speed);
+void XAxiEthernet_PhyWrite(XAxiEthernet * InstancePtr, u32 PhyAddress, u32 RegisterNum, u16 PhyData);
+void XAxiEthernet_PhyRead(XAxiEthernet * InstancePtr, u32 PhyAddress, u32 RegisterNum, u16 *PhyDataPtr);
+void XAxiEthernet_Start(XAxiEthernet * InstancePtr);
+
+#endif /* XAXIETHERNET_H */
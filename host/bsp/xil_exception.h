@@ -0,0 +1,19 @@
+/** @file xil_exception.h
+ *  @brief Host BSP shim: exception handling
+ */
+
+#ifndef XIL_EXCEPTION_H
+#define XIL_EXCEPTION_H
+
+#include "xil_types.h"
+
+typedef void (*XInterruptHandler)(void * InstancePtr);
+typedef void (*Xil_ExceptionHandler)(void * Data);
+
+void Xil_ExceptionEnable(void);
+void Xil_ExceptionDisable(void);
+
+#define Xil_AssertVoid(Expression)         do { if (!(Expression)) { return; } } while (0)
+#define Xil_AssertNonvoid(Expression)      do { if (!(Expression)) { return 0; } } while (0)
+
+#endif /* XIL_EXCEPTION_H */
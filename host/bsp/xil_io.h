@@ -0,0 +1,21 @@
+/** @file xil_io.h
+ *  @brief Host BSP shim: memory mapped I/O and byte order
+ */
+
+#ifndef XIL_IO_H
+#define XIL_IO_H
+
+#include "xil_types.h"
+
+#define Xil_In32(addr)             (*(volatile u32 *)(uintptr_t)(addr))
+#define Xil_Out32(addr, value)     (*(volatile u32 *)(uintptr_t)(addr) = (u32)(value))
+
+u16  Xil_EndianSwap16(u16 Data);
+u32  Xil_EndianSwap32(u32 Data);
+
+u16  Xil_Htons(u16 Data);
+u16  Xil_Ntohs(u16 Data);
+u32  Xil_Htonl(u32 Data);
+u32  Xil_Ntohl(u32 Data);
+
+#endif /* XIL_IO_H */
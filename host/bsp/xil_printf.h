@@ -0,0 +1,10 @@
+/** @file xil_printf.h
+ *  @brief Host BSP shim: lightweight printf
+ */
+
+#ifndef XIL_PRINTF_H
+#define XIL_PRINTF_H
+
+void xil_printf(const char * ctrl1, ...);
+
+#endif /* XIL_PRINTF_H */
@@ -0,0 +1,37 @@
+/** @file xil_types.h
+ *  @brief Host BSP shim: Xilinx basic types
+ *
+ *  Stand-in for the Xilinx standalone BSP header of the same name so that the
+ *  WLAN MAC High Framework can be built for the host (see host/README).
+ */
+
+#ifndef XIL_TYPES_H
+#define XIL_TYPES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t   u8;
+typedef uint16_t  u16;
+typedef uint32_t  u32;
+typedef uint64_t  u64;
+
+typedef int8_t    s8;
+typedef int16_t   s16;
+typedef int32_t   s32;
+typedef int64_t   s64;
+
+typedef char      char8;
+
+#ifndef TRUE
+#define TRUE      1
+#endif
+
+#ifndef FALSE
+#define FALSE     0
+#endif
+
+#define XIL_COMPONENT_IS_READY     0x11111111
+#define XIL_COMPONENT_IS_STARTED   0x22222222
+
+#endif /* XIL_TYPES_H */
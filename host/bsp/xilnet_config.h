@@ -0,0 +1,50 @@
+/** @file xilnet_config.h
+ *  @brief Host BSP shim: WARPxilnet configuration and socket API
+ *
+ *  Only the subset of Xilnet used by the WLAN Exp transport is provided.
+ *  Each Ethernet device has a send buffer of XILNET_SENDBUF_NBYTES in which
+ *  the transport builds its frames, as on hardware.  xilsock_sendto() does
+ *  not put a frame on the wire; it records the buffer and length of the
+ *  frame (see host_shim_get_xilnet_send()).
+ */
+
+#ifndef XILNET_CONFIG_H
+#define XILNET_CONFIG_H
+
+#include "xil_types.h"
+#include "xilnet_udp.h"
+
+#define XILNET_NUM_ETH_DEVICES     2
+
+#define ETH_A_MAC                  0
+#define ETH_B_MAC                  1
+
+// Send buffer:  an Ethernet header and a 9000 byte jumbo IP datagram
+#define XILNET_SENDBUF_NBYTES      (LINK_HDR_LEN + 9000)
+
+#define AF_INET                    2
+#define SOCK_DGRAM                 2
+#define INADDR_ANY                 0
+
+typedef struct {
+	unsigned int * sendbuf;
+	unsigned char  ip_addr[4];
+	unsigned char  hw_addr[6];
+} xilnet_eth_device;
+
+extern xilnet_eth_device eth_device[XILNET_NUM_ETH_DEVICES];
+
+int  xilnet_eth_device_init(unsigned int eth_dev_num, u32 dev_base_addr, unsigned char * ip_addr, unsigned char * hw_addr);
+void xilnet_eth_init_hw_addr_tbl(unsigned int eth_dev_num);
+int  xilnet_eth_device_start(unsigned int eth_dev_num);
+int  xilnet_eth_set_inf_hw_info(unsigned int eth_dev_num, unsigned char * ip_addr, unsigned char * hw_addr);
+int  xilnet_eth_get_inf_hw_addr(unsigned int eth_dev_num, unsigned char * hw_addr);
+int  xilnet_eth_get_inf_ip_addr(unsigned int eth_dev_num, unsigned char * ip_addr);
+int  xilnet_eth_recv_frame(unsigned int eth_dev_num);
+
+int  xilsock_socket(int domain, int type, int protocol, unsigned int eth_dev_num);
+int  xilsock_bind(int s, struct sockaddr * addr, int addrlen, void (*callback)(), unsigned int eth_dev_num);
+void xilsock_close(int s, unsigned int eth_dev_num);
+int  xilsock_sendto(int s, unsigned char * buf, int len, struct sockaddr * to, unsigned int eth_dev_num);
+
+#endif /* XILNET_CONFIG_H */
@@ -0,0 +1,39 @@
+/** @file xilnet_udp.h
+ *  @brief Host BSP shim: WARPxilnet UDP declarations
+ *
+ *  Only the declarations needed by the WLAN Exp transport header are provided
+ *  (see xilnet_config.h for the socket API).
+ */
+
+#ifndef XILNET_UDP_H
+#define XILNET_UDP_H
+
+#include "xil_types.h"
+
+#define LINK_HDR_LEN               14
+#define IP_HDR_LEN                 5
+#define UDP_HDR_LEN                8
+#define PAYLOAD_PAD_NBYTES         2
+
+struct sockaddr {
+	u16   sa_family;
+	u8    sa_data[14];
+};
+
+struct in_addr {
+	u32   s_addr;
+};
+
+struct sockaddr_in {
+	u16              sin_family;
+	u16              sin_port;
+	struct in_addr   sin_addr;
+	u8               sin_zero[8];
+};
+
+typedef struct {
+	u32   srcIPAddr;
+	u16   destPort;
+} pktSrcInfo;
+
+#endif /* XILNET_UDP_H */
@@ -0,0 +1,30 @@
+/** @file xintc.h
+ *  @brief Host BSP shim: interrupt controller
+ *
+ *  Handlers connected to the interrupt controller are called by the host
+ *  shim when a simulated peripheral raises its interrupt (see
+ *  host_shim_raise_interrupt()).
+ */
+
+#ifndef XINTC_H
+#define XINTC_H
+
+#include "xil_types.h"
+#include "xil_io.h"             // Included by the Xilinx driver through xintc_l.h
+#include "xstatus.h"
+#include "xil_exception.h"
+
+#define XINTC_MAX_NUM_INTR_INPUTS  32
+
+typedef struct {
+	u32   BaseAddress;
+	u32   IsReady;
+	u32   IsStarted;
+} XIntc;
+
+int  XIntc_Connect(XIntc * InstancePtr, u8 Id, XInterruptHandler Handler, void * CallBackRef);
+void XIntc_Disconnect(XIntc * InstancePtr, u8 Id);
+void XIntc_Enable(XIntc * InstancePtr, u8 Id);
+void XIntc_Disable(XIntc * InstancePtr, u8 Id);
+
+#endif /* XINTC_H */
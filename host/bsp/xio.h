@@ -0,0 +1,13 @@
+/** @file xio.h
+ *  @brief Host BSP shim: memory mapped I/O
+ */
+
+#ifndef XIO_H
+#define XIO_H
+
+#include "xil_io.h"
+
+#define XIo_In32(addr)             Xil_In32(addr)
+#define XIo_Out32(addr, value)     Xil_Out32(addr, value)
+
+#endif /* XIO_H */
@@ -0,0 +1,43 @@
+/** @file xmbox.h
+ *  @brief Host BSP shim: inter-processor mailbox
+ *
+ *  The host build runs a single CPU, so the mailbox is a loopback FIFO:
+ *  words written by XMbox_WriteBlocking() are returned by the reads.  A
+ *  blocking call that could never complete (write to a full FIFO, read
+ *  from an empty one) reports the error and exits.
+ *
+ *  Only the subset of the driver used by the WLAN MAC framework is
+ *  provided.
+ */
+
+#ifndef XMBOX_H
+#define XMBOX_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XMBOX_FIFO_DEPTH           1024          ///< Depth of the loopback FIFO, in words
+
+typedef struct {
+	u16   DeviceId;
+	u32   BaseAddress;
+	u8    UseFSL;
+	u8    SendID;
+	u8    RecvID;
+} XMbox_Config;
+
+typedef struct {
+	XMbox_Config   Config;
+	u32            IsReady;
+} XMbox;
+
+XMbox_Config* XMbox_LookupConfig(u16 DeviceId);
+int  XMbox_CfgInitialize(XMbox *InstancePtr, XMbox_Config *ConfigPtr, u32 EffectiveAddress);
+int  XMbox_Read(XMbox *InstancePtr, u32 *BufferPtr, u32 RequestedBytes, u32 *BytesRecvdPtr);
+void XMbox_ReadBlocking(XMbox *InstancePtr, u32 *BufferPtr, u32 RequestedBytes);
+int  XMbox_Write(XMbox *InstancePtr, u32 *BufferPtr, u32 RequestedBytes, u32 *BytesSentPtr);
+void XMbox_WriteBlocking(XMbox *InstancePtr, u32 *BufferPtr, u32 RequestedBytes);
+u32  XMbox_IsEmpty(XMbox *InstancePtr);
+void XMbox_Flush(XMbox *InstancePtr);
+
+#endif /* XMBOX_H */
@@ -0,0 +1,41 @@
+/** @file xmutex.h
+ *  @brief Host BSP shim: hardware mutex
+ *
+ *  Every lock is taken by the one host CPU (XMUTEX_HOST_CPU_ID).  As with
+ *  the hardware core, a locked mutex cannot be locked again and only its
+ *  owner can unlock it.
+ *
+ *  Only the subset of the driver used by the WLAN MAC framework is
+ *  provided.
+ */
+
+#ifndef XMUTEX_H
+#define XMUTEX_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XMUTEX_NUM_MUTEX           32
+#define XMUTEX_HOST_CPU_ID         0
+
+typedef struct {
+	u16   DeviceId;
+	u32   BaseAddress;
+	u32   NumMutex;
+	u8    UserReg;
+} XMutex_Config;
+
+typedef struct {
+	XMutex_Config   Config;
+	u32             IsReady;
+} XMutex;
+
+XMutex_Config* XMutex_LookupConfig(u16 DeviceId);
+int  XMutex_CfgInitialize(XMutex *InstancePtr, XMutex_Config *ConfigPtr, u32 EffectiveAddress);
+void XMutex_Lock(XMutex *InstancePtr, u8 MutexNumber);
+int  XMutex_Trylock(XMutex *InstancePtr, u8 MutexNumber);
+int  XMutex_Unlock(XMutex *InstancePtr, u8 MutexNumber);
+int  XMutex_IsLocked(XMutex *InstancePtr, u8 MutexNumber);
+void XMutex_GetStatus(XMutex *InstancePtr, u8 MutexNumber, u32 *Locked, u32 *Owner);
+
+#endif /* XMUTEX_H */
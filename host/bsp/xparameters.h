@@ -0,0 +1,81 @@
+/** @file xparameters.h
+ *  @brief Host BSP shim: hardware parameters
+ *
+ *  Only the parameters used by the host build are defined.  The DRAM and
+ *  aux. BRAM address ranges match the WARP v3 reference design; the host
+ *  shim maps memory at these addresses (see host_shim_init()).  The data
+ *  LMB is not mapped: it only bounds the addresses the ETH DMA rejects.
+ *
+ *  The CPU Low peripherals (packet buffers, MAC HW registers, User I/O) are
+ *  placed at host-chosen addresses that do not overlap the ranges above;
+ *  the shim maps them as plain memory.
+ */
+
+#ifndef XPARAMETERS_H
+#define XPARAMETERS_H
+
+#define XPAR_DDR3_SODIMM_S_AXI_BASEADDR              0xC0000000
+#define XPAR_DDR3_SODIMM_S_AXI_HIGHADDR              0xFFFFFFFF
+
+#define XPAR_MB_HIGH_AUX_BRAM_CTRL_S_AXI_BASEADDR    0xA0000000
+#define XPAR_MB_HIGH_AUX_BRAM_CTRL_S_AXI_HIGHADDR    0xA000FFFF
+
+#define XPAR_MB_HIGH_DLMB_BRAM_CNTLR_0_BASEADDR      0x00000000
+#define XPAR_MB_HIGH_DLMB_BRAM_CNTLR_0_HIGHADDR      0x0000FFFF
+#define XPAR_MB_HIGH_DLMB_BRAM_CNTLR_1_BASEADDR      0x00010000
+#define XPAR_MB_HIGH_DLMB_BRAM_CNTLR_1_HIGHADDR      0x0001FFFF
+
+#define XPAR_INTC_0_TMRCTR_0_VEC_ID                  0
+#define XPAR_INTC_0_AXIDMA_0_MM2S_INTROUT_VEC_ID     1
+#define XPAR_INTC_0_AXIDMA_0_S2MM_INTROUT_VEC_ID     2
+
+#define XPAR_MB_HIGH_ETH_DMA_DEVICE_ID               0
+#define XPAR_ETH_A_MAC_DEVICE_ID                     0
+#define XPAR_ETH_B_MAC_DEVICE_ID                     1
+
+#define XPAR_TMRCTR_0_DEVICE_ID                      0
+#define XPAR_TMRCTR_0_CLOCK_FREQ_HZ                  160000000
+
+#define XPAR_MBOX_0_DEVICE_ID                        0
+#define XPAR_MUTEX_0_DEVICE_ID                       0
+
+#define XPAR_PKT_BUFF_TX_BRAM_CTRL_S_AXI_BASEADDR    0x50000000
+#define XPAR_PKT_BUFF_TX_BRAM_CTRL_S_AXI_HIGHADDR    0x50007FFF
+#define XPAR_PKT_BUFF_RX_BRAM_CTRL_S_AXI_BASEADDR    0x50100000
+#define XPAR_PKT_BUFF_RX_BRAM_CTRL_S_AXI_HIGHADDR    0x50107FFF
+
+#define XPAR_W3_USERIO_BASEADDR                      0x60000000
+#define XPAR_W3_USERIO_HIGHADDR                      0x60000FFF
+
+#define XPAR_WLAN_MAC_HW_BASEADDR                    0x60100000
+#define XPAR_WLAN_MAC_HW_HIGHADDR                    0x60100FFF
+
+#define XPAR_WLAN_MAC_HW_MEMMAP_STATUS                     (XPAR_WLAN_MAC_HW_BASEADDR + 0x00)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TIMESTAMP_MSB              (XPAR_WLAN_MAC_HW_BASEADDR + 0x04)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TIMESTAMP_LSB              (XPAR_WLAN_MAC_HW_BASEADDR + 0x08)
+#define XPAR_WLAN_MAC_HW_MEMMAP_LATEST_RX_BYTE             (XPAR_WLAN_MAC_HW_BASEADDR + 0x0C)
+#define XPAR_WLAN_MAC_HW_MEMMAP_PHY_RX_PARAMS              (XPAR_WLAN_MAC_HW_BASEADDR + 0x10)
+#define XPAR_WLAN_MAC_HW_MEMMAP_BACKOFF_COUNTER            (XPAR_WLAN_MAC_HW_BASEADDR + 0x14)
+#define XPAR_WLAN_MAC_HW_MEMMAP_RX_START_TIMESTAMP_LSB     (XPAR_WLAN_MAC_HW_BASEADDR + 0x18)
+#define XPAR_WLAN_MAC_HW_MEMMAP_RX_START_TIMESTAMP_MSB     (XPAR_WLAN_MAC_HW_BASEADDR + 0x1C)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TX_START_TIMESTAMP_LSB     (XPAR_WLAN_MAC_HW_BASEADDR + 0x20)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TX_START_TIMESTAMP_MSB     (XPAR_WLAN_MAC_HW_BASEADDR + 0x24)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TX_START                   (XPAR_WLAN_MAC_HW_BASEADDR + 0x28)
+#define XPAR_WLAN_MAC_HW_MEMMAP_CALIB_TIMES                (XPAR_WLAN_MAC_HW_BASEADDR + 0x2C)
+#define XPAR_WLAN_MAC_HW_MEMMAP_IFS_INTERVALS1             (XPAR_WLAN_MAC_HW_BASEADDR + 0x30)
+#define XPAR_WLAN_MAC_HW_MEMMAP_IFS_INTERVALS2             (XPAR_WLAN_MAC_HW_BASEADDR + 0x34)
+#define XPAR_WLAN_MAC_HW_MEMMAP_CONTROL                    (XPAR_WLAN_MAC_HW_BASEADDR + 0x38)
+#define XPAR_WLAN_MAC_HW_MEMMAP_BACKOFF_CTRL               (XPAR_WLAN_MAC_HW_BASEADDR + 0x3C)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TIMESTAMP_SET_LSB          (XPAR_WLAN_MAC_HW_BASEADDR + 0x40)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TIMESTAMP_SET_MSB          (XPAR_WLAN_MAC_HW_BASEADDR + 0x44)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TIMESTAMP_INSERT_OFFSET    (XPAR_WLAN_MAC_HW_BASEADDR + 0x48)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TX_CTRL_A_PARAMS           (XPAR_WLAN_MAC_HW_BASEADDR + 0x4C)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TX_CTRL_A_GAINS            (XPAR_WLAN_MAC_HW_BASEADDR + 0x50)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TX_CTRL_B_PARAMS           (XPAR_WLAN_MAC_HW_BASEADDR + 0x54)
+#define XPAR_WLAN_MAC_HW_MEMMAP_TX_CTRL_B_GAINS            (XPAR_WLAN_MAC_HW_BASEADDR + 0x58)
+#define XPAR_WLAN_MAC_HW_MEMMAP_POST_TX_TIMERS             (XPAR_WLAN_MAC_HW_BASEADDR + 0x5C)
+#define XPAR_WLAN_MAC_HW_MEMMAP_POST_RX_TIMERS             (XPAR_WLAN_MAC_HW_BASEADDR + 0x60)
+#define XPAR_WLAN_MAC_HW_MEMMAP_NAV_MATCH_ADDR_1           (XPAR_WLAN_MAC_HW_BASEADDR + 0x64)
+#define XPAR_WLAN_MAC_HW_MEMMAP_NAV_MATCH_ADDR_2           (XPAR_WLAN_MAC_HW_BASEADDR + 0x68)
+
+#endif /* XPARAMETERS_H */
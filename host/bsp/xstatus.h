@@ -0,0 +1,16 @@
+/** @file xstatus.h
+ *  @brief Host BSP shim: Xilinx status codes
+ */
+
+#ifndef XSTATUS_H
+#define XSTATUS_H
+
+#define XST_SUCCESS                0L
+#define XST_FAILURE                1L
+#define XST_NO_DATA                13L
+#define XST_INVALID_PARAM          15L
+#define XST_DEVICE_BUSY            21L
+#define XST_FIFO_NO_ROOM           502L
+#define XST_DMA_SG_LIST_ERROR      525L
+
+#endif /* XSTATUS_H */
@@ -0,0 +1,64 @@
+/** @file xtmrctr.h
+ *  @brief Host BSP shim: AXI timer/counter
+ *
+ *  The timer/counter is simulated by the host shim.  Counters count the
+ *  simulated processor clock (XPAR_TMRCTR_0_CLOCK_FREQ_HZ), which is advanced
+ *  by host_shim_advance_usec().  When a counter expires its interrupt is
+ *  raised on XPAR_INTC_0_TMRCTR_0_VEC_ID.
+ *
+ *  Only the subset of the driver used by the WLAN MAC High Framework is
+ *  provided.  The register accessors work on the simulated Control/Status
+ *  register of each counter.
+ */
+
+#ifndef XTMRCTR_H
+#define XTMRCTR_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XTC_DEVICE_TIMER_COUNT     2
+
+#define XTC_TCSR_OFFSET            0
+#define XTC_TLR_OFFSET             4
+#define XTC_TCR_OFFSET             8
+
+#define XTC_CSR_DOWN_COUNT_MASK    0x00000002
+#define XTC_CSR_AUTO_RELOAD_MASK   0x00000010
+#define XTC_CSR_LOAD_MASK          0x00000020
+#define XTC_CSR_ENABLE_INT_MASK    0x00000040
+#define XTC_CSR_ENABLE_TMR_MASK    0x00000080
+#define XTC_CSR_INT_OCCURED_MASK   0x00000100
+
+#define XTC_INT_MODE_OPTION        0x00000100
+#define XTC_AUTO_RELOAD_OPTION     0x00000010
+#define XTC_DOWN_COUNT_OPTION      0x00000002
+
+typedef void (*XTmrCtr_Handler)(void * CallBackRef, u8 TmrCtrNumber);
+
+typedef struct {
+	u32   Interrupts;
+} XTmrCtrStats;
+
+typedef struct {
+	XTmrCtrStats      Stats;
+	u32               BaseAddress;
+	u32               IsReady;
+	XTmrCtr_Handler   Handler;
+	void            * CallBackRef;
+} XTmrCtr;
+
+int  XTmrCtr_Initialize(XTmrCtr * InstancePtr, u16 DeviceId);
+void XTmrCtr_SetHandler(XTmrCtr * InstancePtr, XTmrCtr_Handler FuncPtr, void * CallBackRef);
+void XTmrCtr_SetOptions(XTmrCtr * InstancePtr, u8 TmrCtrNumber, u32 Options);
+void XTmrCtr_SetResetValue(XTmrCtr * InstancePtr, u8 TmrCtrNumber, u32 ResetValue);
+void XTmrCtr_Start(XTmrCtr * InstancePtr, u8 TmrCtrNumber);
+void XTmrCtr_Stop(XTmrCtr * InstancePtr, u8 TmrCtrNumber);
+u32  XTmrCtr_GetValue(XTmrCtr * InstancePtr, u8 TmrCtrNumber);
+int  XTmrCtr_IsExpired(XTmrCtr * InstancePtr, u8 TmrCtrNumber);
+void XTmrCtr_InterruptHandler(void * InstancePtr);
+
+u32  XTmrCtr_ReadReg(u32 BaseAddress, u8 TmrCtrNumber, u32 RegOffset);
+void XTmrCtr_WriteReg(u32 BaseAddress, u8 TmrCtrNumber, u32 RegOffset, u32 ValueToWrite);
+
+#endif /* XTMRCTR_H */
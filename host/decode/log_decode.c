@@ -0,0 +1,255 @@
+/** @file log_decode.c
+ *  @brief Host decoder for event log data
+ *
+ *  See the ENTRY_TYPE_TXRX_COMPACT format in wlan_mac_entries.h.
+ */
+
+#include <string.h>
+
+#include "log_decode.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_802_11_defs.h"
+#include "wlan_mac_misc_util.h"
+#include "wlan_mac_entries.h"
+#include "wlan_mac_event_log.h"
+
+// Largest full entry a compact entry is expanded into
+#define LOG_DECODE_MAX_ENTRY_LENGTH    (sizeof(rx_ofdm_entry) + 0x10000)
+
+typedef struct {
+	const u8*  buf;
+	u32        len;
+	u32        pos;
+	int        error;
+} log_decode_reader;
+
+static u8 log_decode_u8(log_decode_reader* r){
+	if (r->pos >= r->len) {
+		r->error = 1;
+		return 0;
+	}
+
+	return r->buf[r->pos++];
+}
+
+static u64 log_decode_varint(log_decode_reader* r){
+	u64 value = 0;
+	u32 shift = 0;
+	u8  byte;
+
+	do {
+		byte   = log_decode_u8(r);
+		value |= ((u64)(byte & 0x7F)) << shift;
+		shift += 7;
+	} while ((byte & 0x80) && (shift < 64) && (r->error == 0));
+
+	return value;
+}
+
+static s64 log_decode_zigzag(u64 value){
+	return (s64)(value >> 1) ^ -(s64)(value & 1);
+}
+
+/**
+ * @brief Expands one compact entry into the full entry it replaces
+ *
+ * @param compact           Compact entry (after its entry_header)
+ * @param length            entry_length of the compact entry
+ * @param anchor            Timestamp of the preceding time anchor
+ * @param entry_type        Set to the full entry type
+ * @param entry             Buffer for the full entry
+ * @param max_entry_length  Size of entry
+ * @param entry_length      Set to the length of the full entry
+ * @return 0 on success, -1 if the compact entry is malformed or does not fit
+ */
+int log_decode_compact(const u8* compact, u32 length, u64 anchor, u16* entry_type, void* entry, u32 max_entry_length, u32* entry_length){
+	log_decode_reader r = { compact, length, 0, 0 };
+	u32               payload_offset;
+	u32               payload_len;
+	u32               fixed_len;
+	u32*              log_len;
+	u8*               payload;
+	u64               timestamp;
+	u8                byte;
+
+	*entry_type    = log_decode_u8(&r);
+	payload_offset = log_decode_u8(&r);
+	timestamp      = anchor + log_decode_zigzag(log_decode_varint(&r));
+
+	switch (*entry_type) {
+		case ENTRY_TYPE_RX_OFDM:
+		case ENTRY_TYPE_RX_OFDM_LTG:
+		case ENTRY_TYPE_RX_DSSS: {
+			rx_common_entry* rx = (rx_common_entry*)entry;
+
+			fixed_len = (*entry_type == ENTRY_TYPE_RX_DSSS) ? sizeof(rx_dsss_entry) : sizeof(rx_ofdm_entry);
+			if (fixed_len > max_entry_length) { return -1; }
+			memset(entry, 0, fixed_len);
+
+			byte           = log_decode_u8(&r);
+			rx->rate       = byte & 0x7F;
+			rx->fcs_status = byte >> 7;
+			rx->ant_mode   = log_decode_u8(&r);
+			rx->chan_num   = log_decode_u8(&r);
+			rx->power      = (s8)log_decode_u8(&r);
+			byte           = log_decode_u8(&r);
+			rx->rf_gain    = byte >> 6;
+			rx->bb_gain    = byte & 0x3F;
+			rx->pkt_type   = log_decode_u8(&r);
+			rx->flags      = log_decode_varint(&r);
+			rx->length     = log_decode_varint(&r);
+			rx->timestamp  = timestamp;
+
+			if (*entry_type == ENTRY_TYPE_RX_DSSS) {
+				log_len = &(((rx_dsss_entry*)entry)->mac_payload_log_len);
+				payload = (u8*)(((rx_dsss_entry*)entry)->mac_payload);
+			} else {
+				log_len = &(((rx_ofdm_entry*)entry)->mac_payload_log_len);
+				payload = (u8*)(((rx_ofdm_entry*)entry)->mac_payload);
+			}
+		}
+		break;
+
+		case ENTRY_TYPE_TX_HIGH:
+		case ENTRY_TYPE_TX_HIGH_LTG: {
+			tx_high_entry* tx = (tx_high_entry*)entry;
+
+			fixed_len = sizeof(tx_high_entry);
+			if (fixed_len > max_entry_length) { return -1; }
+			memset(entry, 0, fixed_len);
+
+			tx->timestamp_create  = timestamp;
+			tx->delay_accept      = log_decode_varint(&r);
+			tx->delay_done        = log_decode_varint(&r);
+			tx->unique_seq        = log_decode_varint(&r);
+			tx->rate              = log_decode_u8(&r);
+			tx->ant_mode          = log_decode_u8(&r);
+			tx->chan_num          = log_decode_u8(&r);
+			tx->power             = (s8)log_decode_u8(&r);
+			tx->num_tx            = log_decode_u8(&r);
+			tx->result            = log_decode_u8(&r);
+			tx->pkt_type          = log_decode_u8(&r);
+			tx->queue_id          = log_decode_u8(&r);
+			tx->high_retry_count  = log_decode_u8(&r);
+			tx->high_retry_status = log_decode_u8(&r);
+			tx->length            = log_decode_varint(&r);
+
+			log_len = &(tx->mac_payload_log_len);
+			payload = (u8*)(tx->mac_payload);
+		}
+		break;
+
+		case ENTRY_TYPE_TX_LOW:
+		case ENTRY_TYPE_TX_LOW_LTG: {
+			tx_low_entry* tx = (tx_low_entry*)entry;
+
+			fixed_len = sizeof(tx_low_entry);
+			if (fixed_len > max_entry_length) { return -1; }
+			memset(entry, 0, fixed_len);
+
+			tx->timestamp_send          = timestamp;
+			tx->unique_seq              = log_decode_varint(&r);
+			tx->phy_params.rate         = log_decode_u8(&r);
+			tx->phy_params.antenna_mode = log_decode_u8(&r);
+			tx->phy_params.power        = (s8)log_decode_u8(&r);
+			tx->phy_params.flags        = log_decode_u8(&r);
+			tx->transmission_count      = log_decode_u8(&r);
+			tx->chan_num                = log_decode_u8(&r);
+			tx->pkt_type                = log_decode_u8(&r);
+			tx->flags                   = log_decode_u8(&r);
+			tx->num_slots               = (s16)log_decode_zigzag(log_decode_varint(&r));
+			tx->cw                      = log_decode_varint(&r);
+			tx->length                  = log_decode_varint(&r);
+
+			log_len = &(tx->mac_payload_log_len);
+			payload = (u8*)(tx->mac_payload);
+		}
+		break;
+
+		default:
+			return -1;
+	}
+
+	payload_len = log_decode_varint(&r);
+
+	if ((r.error != 0) || (r.pos > payload_offset) || ((payload_offset + payload_len) > length)) {
+		return -1;
+	}
+
+	// Full entries hold at least MIN_MAC_PAYLOAD_LOG_LEN bytes of (zero padded) payload
+	*entry_length = fixed_len - MIN_MAC_PAYLOAD_LOG_LEN + ((payload_len > MIN_MAC_PAYLOAD_LOG_LEN) ? payload_len : MIN_MAC_PAYLOAD_LOG_LEN);
+
+	if (*entry_length > max_entry_length) {
+		return -1;
+	}
+
+	*log_len = payload_len;
+	memcpy(payload, &compact[payload_offset], payload_len);
+
+	return 0;
+}
+
+/**
+ * @brief Walks event log data and passes every entry to a callback
+ *
+ * @param data              Log data starting at an entry_header
+ * @param size              Number of bytes of log data
+ * @param callback          Called for each entry
+ * @param arg               Passed to callback
+ * @param stats             Filled in with decode statistics (may be NULL)
+ */
+void log_decode_walk(const u8* data, u32 size, log_decode_callback callback, void* arg, log_decode_stats* stats){
+	static u32        full[LOG_DECODE_MAX_ENTRY_LENGTH / 4];
+	log_decode_stats  local_stats;
+	entry_header*     header;
+	const u8*         entry;
+	u32               pos          = 0;
+	u32               full_length;
+	u16               full_type;
+	u64               anchor       = 0;
+	int               anchor_valid = 0;
+
+	if (stats == NULL) {
+		stats = &local_stats;
+	}
+	memset(stats, 0, sizeof(log_decode_stats));
+
+	while ((pos + sizeof(entry_header)) <= size) {
+		header = (entry_header*)&data[pos];
+		entry  = &data[pos + sizeof(entry_header)];
+
+		if (((header->entry_id & 0xFFFF0000) != EVENT_LOG_MAGIC_NUMBER) ||
+		    ((pos + sizeof(entry_header) + header->entry_length) > size)) {
+			break;
+		}
+
+		switch (header->entry_type) {
+			case ENTRY_TYPE_TIME_ANCHOR:
+				anchor       = ((time_anchor_entry*)entry)->timestamp;
+				anchor_valid = 1;
+				callback(header->entry_type, (void*)entry, header->entry_length, arg);
+				stats->num_entries++;
+			break;
+
+			case ENTRY_TYPE_TXRX_COMPACT:
+				if (anchor_valid == 0) {
+					stats->num_no_anchor++;
+				} else if (log_decode_compact(entry, header->entry_length, anchor, &full_type, full, sizeof(full), &full_length) != 0) {
+					stats->num_errors++;
+				} else {
+					callback(full_type, full, full_length, arg);
+					stats->num_compact++;
+					stats->num_entries++;
+				}
+			break;
+
+			default:
+				callback(header->entry_type, (void*)entry, header->entry_length, arg);
+				stats->num_entries++;
+			break;
+		}
+
+		pos += sizeof(entry_header) + header->entry_length;
+	}
+}
@@ -0,0 +1,30 @@
+/** @file log_decode.h
+ *  @brief Host decoder for event log data
+ *
+ *  Walks event log data as returned by LOG_GET_ENTRIES (entry_header
+ *  followed by the entry) and expands ENTRY_TYPE_TXRX_COMPACT entries back
+ *  into the full RX / TX high / TX low entry formats, so that compact and
+ *  full logs can be processed by the same code.
+ */
+
+#ifndef LOG_DECODE_H
+#define LOG_DECODE_H
+
+#include "xil_types.h"
+
+// Called for every decoded entry.  Compact entries are passed as the full entry type
+// they replace, with the full entry format; all other entries are passed unchanged.
+typedef void (*log_decode_callback)(u16 entry_type, void* entry, u32 entry_length, void* arg);
+
+typedef struct {
+	u32   num_entries;              ///< Number of entries passed to the callback
+	u32   num_compact;              ///< Number of compact entries expanded
+	u32   num_no_anchor;            ///< Compact entries skipped because their time anchor was not in the data
+	u32   num_errors;               ///< Malformed compact entries skipped
+} log_decode_stats;
+
+int log_decode_compact(const u8* compact, u32 length, u64 anchor, u16* entry_type, void* entry, u32 max_entry_length, u32* entry_length);
+
+void log_decode_walk(const u8* data, u32 size, log_decode_callback callback, void* arg, log_decode_stats* stats);
+
+#endif /* LOG_DECODE_H */
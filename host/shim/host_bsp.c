@@ -0,0 +1,1014 @@
+/** @file host_bsp.c
+ *  @brief Host shim: simulated BSP drivers
+ *
+ *  Implements the subset of the Xilinx standalone BSP used by the WLAN MAC
+ *  High Framework: xil_printf, byte order helpers, the interrupt controller,
+ *  the AXI timer/counter and the AXI DMA / Ethernet used for ETH A.  The
+ *  inter-processor mailbox and packet buffer mutex are provided for the
+ *  IPC code shared with CPU Low.
+ *
+ *  The timer/counter counts the simulated processor clock, which only moves
+ *  when host_shim_advance_cycles() is called.  Register writes follow the
+ *  hardware: the interrupt flag in TCSR is cleared by writing a 1 to it, and
+ *  the driver's read-modify-write of TCSR (e.g. in XTmrCtr_Stop) therefore
+ *  acknowledges a pending interrupt just as it does on the board.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xil_printf.h"
+#include "xintc.h"
+#include "xtmrctr.h"
+#include "xaxidma.h"
+#include "xaxiethernet.h"
+#include "xilnet_config.h"
+#include "xmbox.h"
+#include "xmutex.h"
+#include "xparameters.h"
+
+#include "host_shim.h"
+
+
+/*************************** Variable Definitions ****************************/
+
+typedef struct {
+	XInterruptHandler   handler;
+	void              * callback_ref;
+	u8                  enabled;
+	u8                  pending;
+} host_intc_input;
+
+typedef struct {
+	u32   tcsr;
+	u32   tlr;
+	u32   value;                    ///< Counter value at start_cycles
+	u64   start_cycles;             ///< Clock when the counter last started counting from value
+	u8    halted;                   ///< Counter reached its terminal count without auto-reload
+} host_tmrctr_counter;
+
+static host_intc_input          host_intc[XINTC_MAX_NUM_INTR_INPUTS];
+static host_tmrctr_counter      host_tmrctr[XTC_DEVICE_TIMER_COUNT];
+static u64                      host_clock_cycles;
+static int                      host_verbose;
+
+static XAxiDma_Config           host_dma_config;
+static XAxiDma_BdRing         * host_eth_rx_ring;
+static XAxiEthernet_Config      host_eth_mac_config;
+
+xilnet_eth_device               eth_device[XILNET_NUM_ETH_DEVICES];
+static u32                      host_xilnet_sendbuf[XILNET_NUM_ETH_DEVICES][(XILNET_SENDBUF_NBYTES + 3) / 4];
+static unsigned char          * host_xilnet_send_buf;
+static u32                      host_xilnet_send_length;
+static int                      host_xilnet_num_sockets;
+
+static XMbox_Config             host_mbox_config;
+static u32                      host_mbox_fifo[XMBOX_FIFO_DEPTH];
+static u32                      host_mbox_head;
+static u32                      host_mbox_count;
+
+static XMutex_Config            host_mutex_config;
+static u8                       host_mutex_locked[XMUTEX_NUM_MUTEX];
+
+extern void host_shim_deliver_interrupts(void);
+
+
+/*************************** Functions Prototypes ****************************/
+
+static u32  host_tmrctr_value(host_tmrctr_counter* counter);
+static int  host_tmrctr_next_expiry(u64* expiry, u8* counter_num);
+static void host_tmrctr_update_irq(void);
+static u32  host_dma_bd_read(XAxiDma_Bd* bd, u32 offset);
+static void host_dma_bd_write(XAxiDma_Bd* bd, u32 offset, u32 value);
+static u32  host_dma_ring_add(XAxiDma_BdRing* ring, u32 bd_addr, int num_bd);
+
+
+/******************************** Functions **********************************/
+
+void host_bsp_reset(){
+	u32 i;
+
+	memset(host_intc, 0, sizeof(host_intc));
+	memset(host_tmrctr, 0, sizeof(host_tmrctr));
+	host_clock_cycles = 0;
+	host_eth_rx_ring  = NULL;
+	host_mbox_head    = 0;
+	host_mbox_count   = 0;
+	memset(host_mutex_locked, 0, sizeof(host_mutex_locked));
+
+	for (i = 0; i < XILNET_NUM_ETH_DEVICES; i++) {
+		memset(&(eth_device[i]), 0, sizeof(xilnet_eth_device));
+		eth_device[i].sendbuf = host_xilnet_sendbuf[i];
+	}
+	host_xilnet_send_buf    = NULL;
+	host_xilnet_send_length = 0;
+	host_xilnet_num_sockets = 0;
+}
+
+void host_shim_set_verbose(int verbose){
+	host_verbose = verbose;
+}
+
+void xil_printf(const char * ctrl1, ...){
+	va_list args;
+
+	if (host_verbose == 0) {
+		return;
+	}
+
+	va_start(args, ctrl1);
+	vprintf(ctrl1, args);
+	va_end(args);
+}
+
+
+u16 Xil_EndianSwap16(u16 Data){ return (u16)((Data >> 8) | (Data << 8)); }
+u32 Xil_EndianSwap32(u32 Data){ return __builtin_bswap32(Data); }
+
+u16 Xil_Htons(u16 Data){ return Xil_EndianSwap16(Data); }
+u16 Xil_Ntohs(u16 Data){ return Xil_EndianSwap16(Data); }
+u32 Xil_Htonl(u32 Data){ return Xil_EndianSwap32(Data); }
+u32 Xil_Ntohl(u32 Data){ return Xil_EndianSwap32(Data); }
+
+void Xil_ExceptionEnable(void){ }
+void Xil_ExceptionDisable(void){ }
+
+
+
+/*****************************************************************************/
+/**
+ * Interrupt controller
+ *
+ * Interrupts raised with host_shim_raise_interrupt() stay pending until the
+ * input is enabled and the processor has interrupts enabled.
+ *
+ *****************************************************************************/
+int XIntc_Connect(XIntc * InstancePtr, u8 Id, XInterruptHandler Handler, void * CallBackRef){
+	if ((InstancePtr == NULL) || (Id >= XINTC_MAX_NUM_INTR_INPUTS)) {
+		return XST_INVALID_PARAM;
+	}
+
+	host_intc[Id].handler      = Handler;
+	host_intc[Id].callback_ref = CallBackRef;
+
+	return XST_SUCCESS;
+}
+
+void XIntc_Disconnect(XIntc * InstancePtr, u8 Id){
+	if (Id < XINTC_MAX_NUM_INTR_INPUTS) {
+		host_intc[Id].handler = NULL;
+		host_intc[Id].enabled = 0;
+	}
+}
+
+void XIntc_Enable(XIntc * InstancePtr, u8 Id){
+	if (Id < XINTC_MAX_NUM_INTR_INPUTS) {
+		host_intc[Id].enabled = 1;
+		host_shim_deliver_interrupts();
+	}
+}
+
+void XIntc_Disable(XIntc * InstancePtr, u8 Id){
+	if (Id < XINTC_MAX_NUM_INTR_INPUTS) {
+		host_intc[Id].enabled = 0;
+	}
+}
+
+void host_shim_raise_interrupt(u8 id){
+	if (id < XINTC_MAX_NUM_INTR_INPUTS) {
+		host_intc[id].pending = 1;
+		host_shim_deliver_interrupts();
+	}
+}
+
+/**
+ * Returns the handler of the next interrupt that can be delivered and clears
+ * its pending flag.  Used by host_shim_deliver_interrupts().
+ */
+int host_intc_take_pending(XInterruptHandler* handler, void** callback_ref){
+	u32 i;
+
+	for (i = 0; i < XINTC_MAX_NUM_INTR_INPUTS; i++) {
+		if (host_intc[i].pending && host_intc[i].enabled && (host_intc[i].handler != NULL)) {
+			host_intc[i].pending = 0;
+			*handler      = host_intc[i].handler;
+			*callback_ref = host_intc[i].callback_ref;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Simulated clock
+ *
+ *****************************************************************************/
+u64 host_shim_get_cycles(void){
+	return host_clock_cycles;
+}
+
+void host_shim_advance_cycles(u64 cycles){
+	u64 target = host_clock_cycles + cycles;
+	u64 expiry      = 0;
+	u8  counter_num = 0;
+	host_tmrctr_counter* counter;
+
+	while (host_tmrctr_next_expiry(&expiry, &counter_num) && (expiry <= target)) {
+		host_clock_cycles = expiry;
+		counter           = &host_tmrctr[counter_num];
+
+		counter->tcsr |= XTC_CSR_INT_OCCURED_MASK;
+
+		if (counter->tcsr & XTC_CSR_AUTO_RELOAD_MASK) {
+			counter->value        = counter->tlr;
+			counter->start_cycles = expiry;
+		} else {
+			// Without auto-reload the counter holds at its terminal count
+			counter->value        = 0;
+			counter->start_cycles = expiry;
+			counter->halted       = 1;
+		}
+
+		host_tmrctr_update_irq();
+
+		host_shim_main_loop_pass();
+	}
+
+	host_clock_cycles = target;
+}
+
+void host_shim_advance_usec(u64 usec){
+	host_shim_advance_cycles(usec * HOST_SHIM_CYCLES_PER_USEC);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * AXI timer/counter
+ *
+ * Only down counting in generate mode is simulated, which is how the
+ * scheduler uses the timer.
+ *
+ *****************************************************************************/
+static u32 host_tmrctr_value(host_tmrctr_counter* counter){
+	u64 elapsed;
+
+	if (((counter->tcsr & XTC_CSR_ENABLE_TMR_MASK) == 0) || counter->halted) {
+		return counter->value;
+	}
+
+	elapsed = host_clock_cycles - counter->start_cycles;
+
+	return (elapsed >= counter->value) ? 0 : (u32)(counter->value - elapsed);
+}
+
+static int host_tmrctr_next_expiry(u64* expiry, u8* counter_num){
+	u32 i;
+	u32 value;
+	int found = 0;
+
+	for (i = 0; i < XTC_DEVICE_TIMER_COUNT; i++) {
+		if ((host_tmrctr[i].tcsr & XTC_CSR_ENABLE_TMR_MASK) && (host_tmrctr[i].halted == 0)) {
+			// A counter loaded with 0 still takes a cycle to expire
+			value = (host_tmrctr[i].value == 0) ? 1 : host_tmrctr[i].value;
+
+			if ((found == 0) || ((host_tmrctr[i].start_cycles + value) < *expiry)) {
+				*expiry      = host_tmrctr[i].start_cycles + value;
+				*counter_num = i;
+				found        = 1;
+			}
+		}
+	}
+
+	return found;
+}
+
+static void host_tmrctr_update_irq(void){
+	u32 i;
+
+	for (i = 0; i < XTC_DEVICE_TIMER_COUNT; i++) {
+		if ((host_tmrctr[i].tcsr & XTC_CSR_ENABLE_INT_MASK) && (host_tmrctr[i].tcsr & XTC_CSR_INT_OCCURED_MASK)) {
+			host_shim_raise_interrupt(XPAR_INTC_0_TMRCTR_0_VEC_ID);
+			return;
+		}
+	}
+}
+
+u32 XTmrCtr_ReadReg(u32 BaseAddress, u8 TmrCtrNumber, u32 RegOffset){
+	host_tmrctr_counter* counter = &host_tmrctr[TmrCtrNumber % XTC_DEVICE_TIMER_COUNT];
+
+	switch (RegOffset) {
+		case XTC_TCSR_OFFSET:  return counter->tcsr;
+		case XTC_TLR_OFFSET:   return counter->tlr;
+		case XTC_TCR_OFFSET:   return host_tmrctr_value(counter);
+	}
+
+	return 0;
+}
+
+void XTmrCtr_WriteReg(u32 BaseAddress, u8 TmrCtrNumber, u32 RegOffset, u32 ValueToWrite){
+	host_tmrctr_counter* counter = &host_tmrctr[TmrCtrNumber % XTC_DEVICE_TIMER_COUNT];
+	u32 int_occured;
+
+	switch (RegOffset) {
+		case XTC_TCSR_OFFSET:
+			// Capture the count before the enable bit changes
+			counter->value        = host_tmrctr_value(counter);
+			counter->start_cycles = host_clock_cycles;
+
+			// The interrupt flag is cleared by writing a 1
+			int_occured = counter->tcsr & XTC_CSR_INT_OCCURED_MASK;
+			if (ValueToWrite & XTC_CSR_INT_OCCURED_MASK) {
+				int_occured = 0;
+			}
+
+			counter->tcsr = (ValueToWrite & ~XTC_CSR_INT_OCCURED_MASK) | int_occured;
+
+			if (ValueToWrite & XTC_CSR_LOAD_MASK) {
+				counter->value  = counter->tlr;
+				counter->halted = 0;
+			}
+		break;
+
+		case XTC_TLR_OFFSET:
+			counter->tlr = ValueToWrite;
+		break;
+	}
+}
+
+int XTmrCtr_Initialize(XTmrCtr * InstancePtr, u16 DeviceId){
+	u32 i;
+
+	if (InstancePtr == NULL) {
+		return XST_INVALID_PARAM;
+	}
+
+	memset(InstancePtr, 0, sizeof(XTmrCtr));
+
+	for (i = 0; i < XTC_DEVICE_TIMER_COUNT; i++) {
+		XTmrCtr_WriteReg(InstancePtr->BaseAddress, i, XTC_TCSR_OFFSET, XTC_CSR_INT_OCCURED_MASK);
+		XTmrCtr_WriteReg(InstancePtr->BaseAddress, i, XTC_TLR_OFFSET, 0);
+		XTmrCtr_WriteReg(InstancePtr->BaseAddress, i, XTC_TCSR_OFFSET, XTC_CSR_LOAD_MASK);
+		XTmrCtr_WriteReg(InstancePtr->BaseAddress, i, XTC_TCSR_OFFSET, 0);
+	}
+
+	InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+
+	return XST_SUCCESS;
+}
+
+void XTmrCtr_SetHandler(XTmrCtr * InstancePtr, XTmrCtr_Handler FuncPtr, void * CallBackRef){
+	InstancePtr->Handler     = FuncPtr;
+	InstancePtr->CallBackRef = CallBackRef;
+}
+
+void XTmrCtr_SetOptions(XTmrCtr * InstancePtr, u8 TmrCtrNumber, u32 Options){
+	u32 tcsr = 0;
+
+	if (Options & XTC_INT_MODE_OPTION)    { tcsr |= XTC_CSR_ENABLE_INT_MASK;  }
+	if (Options & XTC_AUTO_RELOAD_OPTION) { tcsr |= XTC_CSR_AUTO_RELOAD_MASK; }
+	if (Options & XTC_DOWN_COUNT_OPTION)  { tcsr |= XTC_CSR_DOWN_COUNT_MASK;  }
+
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET, tcsr);
+}
+
+void XTmrCtr_SetResetValue(XTmrCtr * InstancePtr, u8 TmrCtrNumber, u32 ResetValue){
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TLR_OFFSET, ResetValue);
+}
+
+void XTmrCtr_Start(XTmrCtr * InstancePtr, u8 TmrCtrNumber){
+	u32 tcsr = XTmrCtr_ReadReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET);
+
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET, XTC_CSR_LOAD_MASK);
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET, tcsr | XTC_CSR_ENABLE_TMR_MASK);
+}
+
+void XTmrCtr_Stop(XTmrCtr * InstancePtr, u8 TmrCtrNumber){
+	u32 tcsr = XTmrCtr_ReadReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET);
+
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET, tcsr & ~XTC_CSR_ENABLE_TMR_MASK);
+}
+
+u32 XTmrCtr_GetValue(XTmrCtr * InstancePtr, u8 TmrCtrNumber){
+	return XTmrCtr_ReadReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCR_OFFSET);
+}
+
+int XTmrCtr_IsExpired(XTmrCtr * InstancePtr, u8 TmrCtrNumber){
+	return ((XTmrCtr_ReadReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET) & XTC_CSR_INT_OCCURED_MASK) != 0);
+}
+
+void XTmrCtr_InterruptHandler(void * InstancePtr){
+	XTmrCtr * TmrCtrPtr = (XTmrCtr *) InstancePtr;
+	u32 tcsr;
+	u8  i;
+
+	for (i = 0; i < XTC_DEVICE_TIMER_COUNT; i++) {
+		tcsr = XTmrCtr_ReadReg(TmrCtrPtr->BaseAddress, i, XTC_TCSR_OFFSET);
+
+		if ((tcsr & XTC_CSR_ENABLE_INT_MASK) && (tcsr & XTC_CSR_INT_OCCURED_MASK)) {
+			TmrCtrPtr->Stats.Interrupts++;
+			TmrCtrPtr->Handler(TmrCtrPtr->CallBackRef, i);
+			tcsr = XTmrCtr_ReadReg(TmrCtrPtr->BaseAddress, i, XTC_TCSR_OFFSET);
+			XTmrCtr_WriteReg(TmrCtrPtr->BaseAddress, i, XTC_TCSR_OFFSET, tcsr | XTC_CSR_INT_OCCURED_MASK);
+		}
+	}
+}
+
+
+
+/*****************************************************************************/
+/**
+ * AXI DMA
+ *
+ * BDs live in the mapped aux. BRAM and are addressed by their 32-bit
+ * address, like the driver's ring pointers.
+ *
+ *****************************************************************************/
+static u32 host_dma_bd_read(XAxiDma_Bd* bd, u32 offset){
+	return *(u32*)((u8*)bd + offset);
+}
+
+static void host_dma_bd_write(XAxiDma_Bd* bd, u32 offset, u32 value){
+	*(u32*)((u8*)bd + offset) = value;
+}
+
+static u32 host_dma_ring_add(XAxiDma_BdRing* ring, u32 bd_addr, int num_bd){
+	u32 ring_bytes = ring->AllCnt * ring->Separation;
+
+	return ring->FirstBdAddr + ((bd_addr - ring->FirstBdAddr + (num_bd * ring->Separation)) % ring_bytes);
+}
+
+XAxiDma_Config * XAxiDma_LookupConfig(u32 DeviceId){
+	host_dma_config.DeviceId      = DeviceId;
+	host_dma_config.BaseAddr      = 0;
+	host_dma_config.SgLengthWidth = 23;
+
+	return &host_dma_config;
+}
+
+int XAxiDma_CfgInitialize(XAxiDma * InstancePtr, XAxiDma_Config * Config){
+	if ((InstancePtr == NULL) || (Config == NULL)) {
+		return XST_INVALID_PARAM;
+	}
+
+	memset(InstancePtr, 0, sizeof(XAxiDma));
+
+	InstancePtr->RegBase                    = Config->BaseAddr;
+	InstancePtr->TxBdRing.MaxTransferLen    = (1 << Config->SgLengthWidth) - 1;
+	InstancePtr->RxBdRing[0].MaxTransferLen = (1 << Config->SgLengthWidth) - 1;
+	InstancePtr->RxBdRing[0].IsRxChannel    = 1;
+	InstancePtr->Initialized                = 1;
+
+	// Frames passed to host_shim_eth_rx() arrive on the ETH A DMA
+	if (Config->DeviceId == XPAR_MB_HIGH_ETH_DMA_DEVICE_ID) {
+		host_eth_rx_ring = XAxiDma_GetRxRing(InstancePtr);
+	}
+
+	return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingCreate(XAxiDma_BdRing * RingPtr, u32 PhysAddr, u32 VirtAddr, u32 Alignment, int BdCount){
+	if ((BdCount <= 0) || (Alignment < XAXIDMA_BD_MINIMUM_ALIGNMENT) || (VirtAddr % Alignment)) {
+		return XST_INVALID_PARAM;
+	}
+
+	RingPtr->RunState    = XAXIDMA_CHANNEL_HALTED;
+	RingPtr->Separation  = (sizeof(XAxiDma_Bd) + (Alignment - 1)) & ~(Alignment - 1);
+	RingPtr->FirstBdAddr = VirtAddr;
+	RingPtr->LastBdAddr  = VirtAddr + ((BdCount - 1) * RingPtr->Separation);
+	RingPtr->AllCnt      = BdCount;
+	RingPtr->FreeCnt     = BdCount;
+	RingPtr->PreCnt      = 0;
+	RingPtr->HwCnt       = 0;
+	RingPtr->PostCnt     = 0;
+	RingPtr->FreeHead    = VirtAddr;
+	RingPtr->PreHead     = VirtAddr;
+	RingPtr->HwHead      = VirtAddr;
+	RingPtr->HwTail      = VirtAddr;
+	RingPtr->PostHead    = VirtAddr;
+
+	memset((void*)(uintptr_t)VirtAddr, 0, BdCount * RingPtr->Separation);
+
+	return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingClone(XAxiDma_BdRing * RingPtr, XAxiDma_Bd * SrcBdPtr){
+	int i;
+
+	if ((RingPtr->AllCnt == 0) || (RingPtr->FreeCnt != RingPtr->AllCnt) || (RingPtr->RunState == XAXIDMA_CHANNEL_RUNNING)) {
+		return XST_DMA_SG_LIST_ERROR;
+	}
+
+	for (i = 0; i < RingPtr->AllCnt; i++) {
+		memcpy((void*)(uintptr_t)(RingPtr->FirstBdAddr + (i * RingPtr->Separation)), SrcBdPtr, sizeof(XAxiDma_Bd));
+	}
+
+	return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingStart(XAxiDma_BdRing * RingPtr){
+	RingPtr->RunState = XAXIDMA_CHANNEL_RUNNING;
+	return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingSetCoalesce(XAxiDma_BdRing * RingPtr, u32 Counter, u32 Timer){
+	return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingAlloc(XAxiDma_BdRing * RingPtr, int NumBd, XAxiDma_Bd ** BdSetPtr){
+	if (NumBd <= 0) {
+		return XST_INVALID_PARAM;
+	}
+
+	if (RingPtr->FreeCnt < NumBd) {
+		return XST_FAILURE;
+	}
+
+	*BdSetPtr = (XAxiDma_Bd*)(uintptr_t)RingPtr->FreeHead;
+
+	RingPtr->FreeHead  = host_dma_ring_add(RingPtr, RingPtr->FreeHead, NumBd);
+	RingPtr->FreeCnt  -= NumBd;
+	RingPtr->PreCnt   += NumBd;
+
+	return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingToHw(XAxiDma_BdRing * RingPtr, int NumBd, XAxiDma_Bd * BdSetPtr){
+	XAxiDma_Bd* bd_ptr;
+	u32         length;
+	int         i;
+
+	if (NumBd == 0) {
+		return XST_SUCCESS;
+	}
+
+	if ((NumBd < 0) || (RingPtr->PreCnt < NumBd) || ((u32)BdSetPtr != RingPtr->PreHead)) {
+		return XST_DMA_SG_LIST_ERROR;
+	}
+
+	bd_ptr = BdSetPtr;
+
+	for (i = 0; i < NumBd; i++) {
+		host_dma_bd_write(bd_ptr, XAXIDMA_BD_STS_OFFSET, 0);
+
+		// The simulated MM2S engine sends a Tx frame as soon as it is handed over
+		if ((RingPtr->IsRxChannel == 0) && (RingPtr->RunState == XAXIDMA_CHANNEL_RUNNING)) {
+			length = host_dma_bd_read(bd_ptr, XAXIDMA_BD_CTRL_LEN_OFFSET) & XAXIDMA_BD_CTRL_LENGTH_MASK;
+
+			host_dma_bd_write(bd_ptr, XAXIDMA_BD_STS_OFFSET, XAXIDMA_BD_STS_COMPLETE_MASK | length);
+			host_shim_get_stats()->num_eth_tx++;
+			RingPtr->IrqStatus |= XAXIDMA_IRQ_IOC_MASK;
+		}
+
+		RingPtr->HwTail = (u32)bd_ptr;
+		bd_ptr          = XAxiDma_BdRingNext(RingPtr, bd_ptr);
+	}
+
+	RingPtr->PreHead  = host_dma_ring_add(RingPtr, RingPtr->PreHead, NumBd);
+	RingPtr->PreCnt  -= NumBd;
+	RingPtr->HwCnt   += NumBd;
+
+	return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingFromHw(XAxiDma_BdRing * RingPtr, int BdLimit, XAxiDma_Bd ** BdSetPtr){
+	XAxiDma_Bd* bd_ptr;
+	int         bd_count = 0;
+
+	bd_ptr = (XAxiDma_Bd*)(uintptr_t)RingPtr->HwHead;
+
+	// Completed BDs are returned in ring order, up to the first one still owned by the engine
+	while ((bd_count < RingPtr->HwCnt) && (bd_count < BdLimit) &&
+	       (host_dma_bd_read(bd_ptr, XAXIDMA_BD_STS_OFFSET) & XAXIDMA_BD_STS_COMPLETE_MASK)) {
+		bd_count++;
+		bd_ptr = XAxiDma_BdRingNext(RingPtr, bd_ptr);
+	}
+
+	if (bd_count == 0) {
+		*BdSetPtr = NULL;
+		return 0;
+	}
+
+	*BdSetPtr = (XAxiDma_Bd*)(uintptr_t)RingPtr->HwHead;
+
+	RingPtr->HwHead   = host_dma_ring_add(RingPtr, RingPtr->HwHead, bd_count);
+	RingPtr->HwCnt   -= bd_count;
+	RingPtr->PostCnt += bd_count;
+
+	return bd_count;
+}
+
+int XAxiDma_BdRingFree(XAxiDma_BdRing * RingPtr, int NumBd, XAxiDma_Bd * BdSetPtr){
+	if (NumBd == 0) {
+		return XST_SUCCESS;
+	}
+
+	if ((NumBd < 0) || (RingPtr->PostCnt < NumBd) || ((u32)BdSetPtr != RingPtr->PostHead)) {
+		return XST_DMA_SG_LIST_ERROR;
+	}
+
+	RingPtr->PostHead  = host_dma_ring_add(RingPtr, RingPtr->PostHead, NumBd);
+	RingPtr->PostCnt  -= NumBd;
+	RingPtr->FreeCnt  += NumBd;
+
+	return XST_SUCCESS;
+}
+
+void XAxiDma_BdRingIntEnable(XAxiDma_BdRing * RingPtr, u32 Mask){
+	RingPtr->IrqEnable |= (Mask & XAXIDMA_IRQ_ALL_MASK);
+}
+
+void XAxiDma_BdRingIntDisable(XAxiDma_BdRing * RingPtr, u32 Mask){
+	RingPtr->IrqEnable &= ~Mask;
+}
+
+u32 XAxiDma_BdRingGetIrq(XAxiDma_BdRing * RingPtr){
+	return (RingPtr->IrqStatus & XAXIDMA_IRQ_ALL_MASK);
+}
+
+void XAxiDma_BdRingAckIrq(XAxiDma_BdRing * RingPtr, u32 Mask){
+	RingPtr->IrqStatus &= ~Mask;
+}
+
+void XAxiDma_BdClear(XAxiDma_Bd * BdPtr){
+	memset(BdPtr, 0, sizeof(XAxiDma_Bd));
+}
+
+int XAxiDma_BdSetBufAddr(XAxiDma_Bd * BdPtr, u32 Addr){
+	host_dma_bd_write(BdPtr, XAXIDMA_BD_BUFA_OFFSET, Addr);
+	return XST_SUCCESS;
+}
+
+u32 XAxiDma_BdGetBufAddr(XAxiDma_Bd * BdPtr){
+	return host_dma_bd_read(BdPtr, XAXIDMA_BD_BUFA_OFFSET);
+}
+
+int XAxiDma_BdSetLength(XAxiDma_Bd * BdPtr, u32 LenBytes, u32 LengthMask){
+	u32 ctrl;
+
+	if ((LenBytes == 0) || (LenBytes > LengthMask)) {
+		return XST_INVALID_PARAM;
+	}
+
+	ctrl = host_dma_bd_read(BdPtr, XAXIDMA_BD_CTRL_LEN_OFFSET) & ~LengthMask;
+	host_dma_bd_write(BdPtr, XAXIDMA_BD_CTRL_LEN_OFFSET, ctrl | LenBytes);
+
+	return XST_SUCCESS;
+}
+
+u32 XAxiDma_BdGetActualLength(XAxiDma_Bd * BdPtr, u32 LengthMask){
+	return host_dma_bd_read(BdPtr, XAXIDMA_BD_STS_OFFSET) & XAXIDMA_BD_STS_ACTUAL_LEN_MASK & LengthMask;
+}
+
+void XAxiDma_BdSetCtrl(XAxiDma_Bd * BdPtr, u32 Data){
+	u32 ctrl = host_dma_bd_read(BdPtr, XAXIDMA_BD_CTRL_LEN_OFFSET) & ~XAXIDMA_BD_CTRL_ALL_MASK;
+
+	host_dma_bd_write(BdPtr, XAXIDMA_BD_CTRL_LEN_OFFSET, ctrl | (Data & XAXIDMA_BD_CTRL_ALL_MASK));
+}
+
+void XAxiDma_BdSetId(XAxiDma_Bd * BdPtr, u32 Id){
+	host_dma_bd_write(BdPtr, XAXIDMA_BD_ID_OFFSET, Id);
+}
+
+u32 XAxiDma_BdGetId(XAxiDma_Bd * BdPtr){
+	return host_dma_bd_read(BdPtr, XAXIDMA_BD_ID_OFFSET);
+}
+
+int host_shim_eth_rx(const u8* frame, u32 length){
+	XAxiDma_BdRing* ring = host_eth_rx_ring;
+	XAxiDma_Bd*     bd_ptr;
+	u32             bd_length;
+	int             i;
+
+	if ((ring == NULL) || (ring->RunState != XAXIDMA_CHANNEL_RUNNING)) {
+		return -1;
+	}
+
+	// Find the first BD owned by the engine that has not been filled
+	bd_ptr = (XAxiDma_Bd*)(uintptr_t)ring->HwHead;
+
+	for (i = 0; i < ring->HwCnt; i++) {
+		if ((host_dma_bd_read(bd_ptr, XAXIDMA_BD_STS_OFFSET) & XAXIDMA_BD_STS_COMPLETE_MASK) == 0) {
+			break;
+		}
+		bd_ptr = XAxiDma_BdRingNext(ring, bd_ptr);
+	}
+
+	if (i == ring->HwCnt) {
+		// No Rx buffer: the frame is dropped, as the hardware would
+		return -1;
+	}
+
+	bd_length = host_dma_bd_read(bd_ptr, XAXIDMA_BD_CTRL_LEN_OFFSET) & XAXIDMA_BD_CTRL_LENGTH_MASK;
+	if (length > bd_length) {
+		return -1;
+	}
+
+	memcpy((void*)(uintptr_t)XAxiDma_BdGetBufAddr(bd_ptr), frame, length);
+	host_dma_bd_write(bd_ptr, XAXIDMA_BD_STS_OFFSET, XAXIDMA_BD_STS_COMPLETE_MASK | length);
+
+	ring->IrqStatus |= XAXIDMA_IRQ_IOC_MASK;
+
+	if (ring->IrqEnable & XAXIDMA_IRQ_IOC_MASK) {
+		host_shim_raise_interrupt(XPAR_INTC_0_AXIDMA_0_S2MM_INTROUT_VEC_ID);
+	}
+
+	return 0;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * AXI Ethernet
+ *
+ *****************************************************************************/
+XAxiEthernet_Config * XAxiEthernet_LookupConfig(u16 DeviceId){
+	host_eth_mac_config.DeviceId          = DeviceId;
+	host_eth_mac_config.BaseAddress       = 0;
+	host_eth_mac_config.AxiDevBaseAddress = 0;
+
+	return &host_eth_mac_config;
+}
+
+int XAxiEthernet_CfgInitialize(XAxiEthernet * InstancePtr, XAxiEthernet_Config * CfgPtr, u32 VirtualAddress){
+	if ((InstancePtr == NULL) || (CfgPtr == NULL)) {
+		return XST_INVALID_PARAM;
+	}
+
+	memset(InstancePtr, 0, sizeof(XAxiEthernet));
+
+	InstancePtr->Config             = *CfgPtr;
+	InstancePtr->Config.BaseAddress = VirtualAddress;
+	InstancePtr->IsReady            = XIL_COMPONENT_IS_READY;
+
+	return XST_SUCCESS;
+}
+
+int XAxiEthernet_SetOptions(XAxiEthernet * InstancePtr, u32 Options){
+	InstancePtr->Options |= Options;
+	return XST_SUCCESS;
+}
+
+int XAxiEthernet_ClearOptions(XAxiEthernet * InstancePtr, u32 Options){
+	InstancePtr->Options &= ~Options;
+	return XST_SUCCESS;
+}
+
+int XAxiEthernet_SetOperatingSpeed(XAxiEthernet * InstancePtr, u16 Speed){
+	if ((Speed != 10) && (Speed != 100) && (Speed != 1000)) {
+		return XST_INVALID_PARAM;
+	}
+
+	InstancePtr->Speed = Speed;
+	return XST_SUCCESS;
+}
+
+void XAxiEthernet_PhyWrite(XAxiEthernet * InstancePtr, u32 PhyAddress, u32 RegisterNum, u16 PhyData){
+}
+
+void XAxiEthernet_PhyRead(XAxiEthernet * InstancePtr, u32 PhyAddress, u32 RegisterNum, u16 *PhyDataPtr){
+	*PhyDataPtr = 0;
+}
+
+void XAxiEthernet_Start(XAxiEthernet * InstancePtr){
+	InstancePtr->IsStarted = XIL_COMPONENT_IS_STARTED;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * WARPxilnet
+ *
+ * Frames are not put on the wire:  xilsock_sendto() counts the frame as a
+ * WLAN Exp packet and records its buffer and length.
+ *
+ *****************************************************************************/
+int xilnet_eth_device_init(unsigned int eth_dev_num, u32 dev_base_addr, unsigned char * ip_addr, unsigned char * hw_addr){
+	return xilnet_eth_set_inf_hw_info(eth_dev_num, ip_addr, hw_addr);
+}
+
+void xilnet_eth_init_hw_addr_tbl(unsigned int eth_dev_num){
+}
+
+int xilnet_eth_device_start(unsigned int eth_dev_num){
+	return 0;
+}
+
+int xilnet_eth_set_inf_hw_info(unsigned int eth_dev_num, unsigned char * ip_addr, unsigned char * hw_addr){
+	if (eth_dev_num >= XILNET_NUM_ETH_DEVICES) {
+		return -1;
+	}
+
+	memcpy(eth_device[eth_dev_num].ip_addr, ip_addr, 4);
+	memcpy(eth_device[eth_dev_num].hw_addr, hw_addr, 6);
+	return 0;
+}
+
+int xilnet_eth_get_inf_hw_addr(unsigned int eth_dev_num, unsigned char * hw_addr){
+	if (eth_dev_num >= XILNET_NUM_ETH_DEVICES) {
+		return -1;
+	}
+
+	memcpy(hw_addr, eth_device[eth_dev_num].hw_addr, 6);
+	return 0;
+}
+
+int xilnet_eth_get_inf_ip_addr(unsigned int eth_dev_num, unsigned char * ip_addr){
+	if (eth_dev_num >= XILNET_NUM_ETH_DEVICES) {
+		return -1;
+	}
+
+	memcpy(ip_addr, eth_device[eth_dev_num].ip_addr, 4);
+	return 0;
+}
+
+int xilnet_eth_recv_frame(unsigned int eth_dev_num){
+	return 0;
+}
+
+int xilsock_socket(int domain, int type, int protocol, unsigned int eth_dev_num){
+	return host_xilnet_num_sockets++;
+}
+
+int xilsock_bind(int s, struct sockaddr * addr, int addrlen, void (*callback)(), unsigned int eth_dev_num){
+	return 0;
+}
+
+void xilsock_close(int s, unsigned int eth_dev_num){
+}
+
+int xilsock_sendto(int s, unsigned char * buf, int len, struct sockaddr * to, unsigned int eth_dev_num){
+	host_xilnet_send_buf    = buf;
+	host_xilnet_send_length = len;
+
+	host_shim_get_stats()->num_transport_send++;
+
+	return len;
+}
+
+const u8* host_shim_get_xilnet_send(u32* length){
+	*length = host_xilnet_send_length;
+	return host_xilnet_send_buf;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Mailbox
+ *
+ * Transfers are whole words, as with the hardware FIFO.
+ *
+ *****************************************************************************/
+XMbox_Config* XMbox_LookupConfig(u16 DeviceId){
+	host_mbox_config.DeviceId    = DeviceId;
+	host_mbox_config.BaseAddress = 0;
+
+	return &host_mbox_config;
+}
+
+int XMbox_CfgInitialize(XMbox *InstancePtr, XMbox_Config *ConfigPtr, u32 EffectiveAddress){
+	if ((InstancePtr == NULL) || (ConfigPtr == NULL)) {
+		return XST_INVALID_PARAM;
+	}
+
+	InstancePtr->Config             = *ConfigPtr;
+	InstancePtr->Config.BaseAddress = EffectiveAddress;
+	InstancePtr->IsReady            = XIL_COMPONENT_IS_READY;
+
+	return XST_SUCCESS;
+}
+
+int XMbox_Read(XMbox *InstancePtr, u32 *BufferPtr, u32 RequestedBytes, u32 *BytesRecvdPtr){
+	u32 num_words = 0;
+
+	while ((num_words < (RequestedBytes / 4)) && (host_mbox_count > 0)) {
+		BufferPtr[num_words++] = host_mbox_fifo[host_mbox_head];
+		host_mbox_head         = (host_mbox_head + 1) % XMBOX_FIFO_DEPTH;
+		host_mbox_count--;
+	}
+
+	*BytesRecvdPtr = 4 * num_words;
+
+	return (num_words == 0) ? XST_NO_DATA : XST_SUCCESS;
+}
+
+void XMbox_ReadBlocking(XMbox *InstancePtr, u32 *BufferPtr, u32 RequestedBytes){
+	u32 bytes_read;
+
+	if ((RequestedBytes / 4) > host_mbox_count) {
+		fprintf(stderr, "host_shim: blocking mailbox read of %u bytes with %u words queued\n", RequestedBytes, host_mbox_count);
+		exit(1);
+	}
+
+	XMbox_Read(InstancePtr, BufferPtr, RequestedBytes, &bytes_read);
+}
+
+int XMbox_Write(XMbox *InstancePtr, u32 *BufferPtr, u32 RequestedBytes, u32 *BytesSentPtr){
+	u32 num_words = 0;
+
+	while ((num_words < (RequestedBytes / 4)) && (host_mbox_count < XMBOX_FIFO_DEPTH)) {
+		host_mbox_fifo[(host_mbox_head + host_mbox_count) % XMBOX_FIFO_DEPTH] = BufferPtr[num_words++];
+		host_mbox_count++;
+	}
+
+	*BytesSentPtr = 4 * num_words;
+
+	return (num_words == 0) ? XST_FIFO_NO_ROOM : XST_SUCCESS;
+}
+
+void XMbox_WriteBlocking(XMbox *InstancePtr, u32 *BufferPtr, u32 RequestedBytes){
+	u32 bytes_sent;
+
+	if ((RequestedBytes / 4) > (XMBOX_FIFO_DEPTH - host_mbox_count)) {
+		fprintf(stderr, "host_shim: blocking mailbox write of %u bytes with %u words queued\n", RequestedBytes, host_mbox_count);
+		exit(1);
+	}
+
+	XMbox_Write(InstancePtr, BufferPtr, RequestedBytes, &bytes_sent);
+}
+
+u32 XMbox_IsEmpty(XMbox *InstancePtr){
+	return (host_mbox_count == 0);
+}
+
+void XMbox_Flush(XMbox *InstancePtr){
+	host_mbox_head  = 0;
+	host_mbox_count = 0;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Mutex
+ *
+ *****************************************************************************/
+XMutex_Config* XMutex_LookupConfig(u16 DeviceId){
+	host_mutex_config.DeviceId    = DeviceId;
+	host_mutex_config.BaseAddress = 0;
+	host_mutex_config.NumMutex    = XMUTEX_NUM_MUTEX;
+	host_mutex_config.UserReg     = 0;
+
+	return &host_mutex_config;
+}
+
+int XMutex_CfgInitialize(XMutex *InstancePtr, XMutex_Config *ConfigPtr, u32 EffectiveAddress){
+	if ((InstancePtr == NULL) || (ConfigPtr == NULL)) {
+		return XST_INVALID_PARAM;
+	}
+
+	InstancePtr->Config             = *ConfigPtr;
+	InstancePtr->Config.BaseAddress = EffectiveAddress;
+	InstancePtr->IsReady            = XIL_COMPONENT_IS_READY;
+
+	return XST_SUCCESS;
+}
+
+void XMutex_Lock(XMutex *InstancePtr, u8 MutexNumber){
+	if (XMutex_Trylock(InstancePtr, MutexNumber) != XST_SUCCESS) {
+		fprintf(stderr, "host_shim: blocking lock of mutex %u, which is already locked\n", MutexNumber);
+		exit(1);
+	}
+}
+
+int XMutex_Trylock(XMutex *InstancePtr, u8 MutexNumber){
+	if ((MutexNumber >= InstancePtr->Config.NumMutex) || host_mutex_locked[MutexNumber]) {
+		return XST_DEVICE_BUSY;
+	}
+
+	host_mutex_locked[MutexNumber] = 1;
+
+	return XST_SUCCESS;
+}
+
+int XMutex_Unlock(XMutex *InstancePtr, u8 MutexNumber){
+	// Every lock is owned by the host CPU, so only an unlocked mutex fails
+	if ((MutexNumber >= InstancePtr->Config.NumMutex) || (host_mutex_locked[MutexNumber] == 0)) {
+		return XST_FAILURE;
+	}
+
+	host_mutex_locked[MutexNumber] = 0;
+
+	return XST_SUCCESS;
+}
+
+int XMutex_IsLocked(XMutex *InstancePtr, u8 MutexNumber){
+	return (MutexNumber < InstancePtr->Config.NumMutex) && host_mutex_locked[MutexNumber];
+}
+
+void XMutex_GetStatus(XMutex *InstancePtr, u8 MutexNumber, u32 *Locked, u32 *Owner){
+	*Locked = XMutex_IsLocked(InstancePtr, MutexNumber);
+	*Owner  = XMUTEX_HOST_CPU_ID;
+}
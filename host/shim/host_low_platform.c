@@ -0,0 +1,148 @@
+/** @file host_low_platform.c
+ *  @brief Host shim: low CPU platform
+ *
+ *  Stands in for the parts of the WLAN MAC Low Framework (wlan_mac_low.c,
+ *  wlan_phy_util.c) that the DCF calls.  Those files configure the radio
+ *  controller, clocks, AD converters and PHY cores, none of which exist on
+ *  the host; the MAC HW registers they share with the DCF are plain memory
+ *  at XPAR_WLAN_MAC_HW_BASEADDR (see host_shim_init()).
+ *
+ *  The contention window bounds and channel start at the values set by
+ *  wlan_mac_low_init() and can be changed with host_shim_low_set_cw_exp().
+ */
+
+#include <string.h>
+
+#include "xil_types.h"
+#include "xil_io.h"
+
+#include "wlan_mac_ipc_util.h"
+#include "wlan_mac_misc_util.h"
+#include "wlan_mac_low.h"
+#include "wlan_phy_util.h"
+
+#include "host_shim.h"
+
+
+/*************************** Variable Definitions ****************************/
+
+const u8 ones_in_chars[256] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8};
+
+static wlan_mac_hw_info        host_low_hw_info;
+static host_shim_low_stats     host_low_stats;
+static function_ptr_t          host_frame_tx_callback;
+static u32                     host_mac_param_chan;
+static u8                      host_cw_exp_min;
+static u8                      host_cw_exp_max;
+
+
+/******************************** Functions **********************************/
+
+void host_shim_low_reset(void){
+	memset((void*)XPAR_WLAN_MAC_HW_BASEADDR, 0, XPAR_WLAN_MAC_HW_HIGHADDR - XPAR_WLAN_MAC_HW_BASEADDR + 1);
+	memset((void*)XPAR_W3_USERIO_BASEADDR, 0, XPAR_W3_USERIO_HIGHADDR - XPAR_W3_USERIO_BASEADDR + 1);
+	memset((void*)XPAR_PKT_BUFF_TX_BRAM_CTRL_S_AXI_BASEADDR, 0, XPAR_PKT_BUFF_TX_BRAM_CTRL_S_AXI_HIGHADDR - XPAR_PKT_BUFF_TX_BRAM_CTRL_S_AXI_BASEADDR + 1);
+	memset((void*)XPAR_PKT_BUFF_RX_BRAM_CTRL_S_AXI_BASEADDR, 0, XPAR_PKT_BUFF_RX_BRAM_CTRL_S_AXI_HIGHADDR - XPAR_PKT_BUFF_RX_BRAM_CTRL_S_AXI_BASEADDR + 1);
+	memset(&host_low_hw_info, 0, sizeof(host_low_hw_info));
+	memset(&host_low_stats, 0, sizeof(host_low_stats));
+
+	host_frame_tx_callback = (function_ptr_t)nullCallback;
+	host_mac_param_chan    = 1;
+	host_cw_exp_min        = 4;
+	host_cw_exp_max        = 10;
+}
+
+host_shim_low_stats* host_shim_low_get_stats(void){
+	return &host_low_stats;
+}
+
+void host_shim_low_set_cw_exp(u8 cw_exp_min, u8 cw_exp_max){
+	host_cw_exp_min = cw_exp_min;
+	host_cw_exp_max = cw_exp_max;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * WLAN MAC Low Framework
+ *
+ *****************************************************************************/
+int wlan_mac_low_init(u32 type){
+	host_shim_low_reset();
+
+	host_low_hw_info.type = type;
+
+	wlan_lib_init();
+
+	return 0;
+}
+
+void wlan_mac_low_finish_init(){
+}
+
+u8 wlan_mac_low_get_cw_exp_min(){
+	return host_cw_exp_min;
+}
+
+u8 wlan_mac_low_get_cw_exp_max(){
+	return host_cw_exp_max;
+}
+
+wlan_mac_hw_info* wlan_mac_low_get_hw_info(){
+	return &host_low_hw_info;
+}
+
+u32 wlan_mac_low_get_active_channel(){
+	return host_mac_param_chan;
+}
+
+void wlan_mac_low_set_frame_tx_callback(function_ptr_t callback){
+	host_frame_tx_callback = callback;
+}
+
+void wlan_mac_low_poll_ipc_rx(){
+	host_low_stats.num_ipc_polls++;
+}
+
+void wlan_mac_low_send_exception(u32 reason){
+	host_low_stats.num_exceptions++;
+	host_low_stats.last_exception = reason;
+}
+
+u8 wlan_mac_low_dbm_to_gain_target(s8 power){
+	s8 power_railed;
+
+	if(power > TX_POWER_MAX_DBM){
+		power_railed = TX_POWER_MAX_DBM;
+	} else if( power < TX_POWER_MIN_DBM){
+		power_railed = TX_POWER_MIN_DBM;
+	} else {
+		power_railed = power;
+	}
+
+	return (u8)((power_railed << 1) + 20);
+}
+
+u64 get_tx_start_timestamp() {
+	u32 timestamp_high_u32;
+	u32 timestamp_low_u32;
+
+	timestamp_high_u32 = Xil_In32(WLAN_MAC_REG_TX_TIMESTAMP_MSB);
+	timestamp_low_u32  = Xil_In32(WLAN_MAC_REG_TX_TIMESTAMP_LSB);
+
+	return (((u64)timestamp_high_u32)<<32) + ((u64)timestamp_low_u32);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * WLAN PHY
+ *
+ *****************************************************************************/
+void wlan_phy_set_tx_signal(u8 pkt_buf, u8 rate, u16 length) {
+	Xil_Out32((TX_PKT_BUF_TO_ADDR(pkt_buf) + PHY_TX_PKT_BUF_PHY_HDR_OFFSET), WLAN_TX_SIGNAL_CALC(rate, length));
+
+	host_low_stats.num_tx_signal++;
+}
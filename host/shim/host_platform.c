@@ -0,0 +1,408 @@
+/** @file host_platform.c
+ *  @brief Host shim: high CPU platform
+ *
+ *  Stands in for the parts of wlan_mac_high.c, the WLAN Exp node
+ *  and the top-level application that the framework modules built for the
+ *  host depend on.
+ *
+ *  Memory:  DRAM and aux. BRAM are mapped at their hardware addresses, the
+ *           CPU Low packet buffers and registers at their xparameters.h
+ *           addresses.  The heap is kept on brk (no mmap'd chunks) so
+ *           that every allocation has a 32-bit address, like the
+ *           MicroBlaze heap.
+ *
+ *  Time:    get_usec_timestamp() returns the simulated clock (see host_bsp.c).
+ *
+ *  Interrupts:  wlan_mac_high_interrupt_stop() / _restore_state() keep the
+ *           processor interrupt enable.  Pending interrupts are delivered
+ *           when interrupts are re-enabled, with interrupts disabled for
+ *           the duration of the handler.
+ *
+ *  Main loop:  the main loop runs whenever the processor is not in an
+ *           interrupt handler.  After each timer expiry that is delivered,
+ *           host_shim_advance_cycles() makes one pass of the main loop
+ *           (wlan_mac_high_poll()) unless interrupts are stopped or the
+ *           test has turned the main loop off with host_shim_set_main_loop().
+ */
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "xil_types.h"
+#include "xintc.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_dl_list.h"
+#include "wlan_mac_packet_types.h"
+#include "wlan_mac_802_11_defs.h"
+#include "wlan_mac_ipc_util.h"
+#include "wlan_mac_eth_util.h"
+#include "wlan_mac_run_queue.h"
+#include "wlan_exp_common.h"
+#include "wlan_exp_node.h"
+#include "wlan_exp_transport.h"
+
+#include "host_shim.h"
+
+
+/*************************** Variable Definitions ****************************/
+
+// Application
+volatile function_ptr_t      tx_poll_callback;
+
+static dl_list               host_statistics;
+static dl_list               host_station_info_list;
+wlan_mac_hw_info             hw_info;
+
+// WLAN Exp node
+wn_node_info                 node_info;
+u32                          async_pkt_enable;
+u32                          async_eth_dev_num;
+pktSrcInfo                   async_pkt_dest;
+wn_transport_header          async_pkt_hdr;
+
+// Platform
+static XIntc                 host_intc_inst;
+static host_shim_stats       host_stats;
+static interrupt_state_t     host_interrupt_state;
+static u32                   host_malloc_limit;
+static u32                   host_tx_pkt_buf_locked;
+static int                   host_initialized;
+static int                   host_main_loop_enabled;
+static int                   host_main_loop_running;
+
+extern void host_bsp_reset(void);
+extern int  host_intc_take_pending(XInterruptHandler* handler, void** callback_ref);
+
+
+/******************************** Functions **********************************/
+
+static void host_map(u32 base, u32 size){
+	void* addr;
+
+	addr = mmap((void*)(uintptr_t)base, size, PROT_READ | PROT_WRITE,
+	            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE | MAP_NORESERVE, -1, 0);
+
+	if (addr != (void*)(uintptr_t)base) {
+		fprintf(stderr, "host_shim: unable to map 0x%08x bytes at 0x%08x\n", size, base);
+		exit(1);
+	}
+}
+
+void host_shim_init(void){
+	if (host_initialized == 0) {
+		host_map(DRAM_BASE, DRAM_SIZE);
+		host_map(AUX_BRAM_BASE, AUX_BRAM_SIZE);
+		host_map(XPAR_PKT_BUFF_TX_BRAM_CTRL_S_AXI_BASEADDR, XPAR_PKT_BUFF_TX_BRAM_CTRL_S_AXI_HIGHADDR - XPAR_PKT_BUFF_TX_BRAM_CTRL_S_AXI_BASEADDR + 1);
+		host_map(XPAR_PKT_BUFF_RX_BRAM_CTRL_S_AXI_BASEADDR, XPAR_PKT_BUFF_RX_BRAM_CTRL_S_AXI_HIGHADDR - XPAR_PKT_BUFF_RX_BRAM_CTRL_S_AXI_BASEADDR + 1);
+		host_map(XPAR_W3_USERIO_BASEADDR, XPAR_W3_USERIO_HIGHADDR - XPAR_W3_USERIO_BASEADDR + 1);
+		host_map(XPAR_WLAN_MAC_HW_BASEADDR, XPAR_WLAN_MAC_HW_HIGHADDR - XPAR_WLAN_MAC_HW_BASEADDR + 1);
+
+		// Keep every heap chunk on brk, which a non-PIE executable has below 4 GB
+		mallopt(M_MMAP_MAX, 0);
+
+		host_initialized = 1;
+	}
+
+	host_shim_reset();
+}
+
+void host_shim_reset(void){
+	host_bsp_reset();
+	host_shim_low_reset();
+
+	memset((void*)AUX_BRAM_BASE, 0, AUX_BRAM_SIZE);
+	memset(&host_stats, 0, sizeof(host_stats));
+
+	host_interrupt_state   = INTERRUPTS_ENABLED;
+	host_malloc_limit      = 0xFFFFFFFF;
+	host_tx_pkt_buf_locked = 0;
+
+	tx_poll_callback       = (function_ptr_t)nullCallback;
+
+	host_main_loop_enabled = 1;
+	host_main_loop_running = 0;
+	run_queue_init();
+
+	dl_list_init(&host_statistics);
+	dl_list_init(&host_station_info_list);
+
+	async_pkt_enable       = 0;
+}
+
+XIntc* host_shim_get_intc(void){
+	return &host_intc_inst;
+}
+
+host_shim_stats* host_shim_get_stats(void){
+	return &host_stats;
+}
+
+void host_shim_set_malloc_limit(u32 num_allocs){
+	host_malloc_limit = num_allocs;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Interrupts
+ *
+ *****************************************************************************/
+int host_shim_interrupts_enabled(void){
+	return (host_interrupt_state == INTERRUPTS_ENABLED);
+}
+
+void host_shim_deliver_interrupts(void){
+	XInterruptHandler handler;
+	void*             callback_ref;
+
+	while ((host_interrupt_state == INTERRUPTS_ENABLED) && host_intc_take_pending(&handler, &callback_ref)) {
+		host_interrupt_state = INTERRUPTS_DISABLED;
+		host_stats.num_interrupts++;
+
+		handler(callback_ref);
+
+		host_interrupt_state = INTERRUPTS_ENABLED;
+	}
+}
+
+interrupt_state_t wlan_mac_high_interrupt_stop(){
+	interrupt_state_t curr_state = host_interrupt_state;
+
+	host_interrupt_state = INTERRUPTS_DISABLED;
+
+	return curr_state;
+}
+
+int wlan_mac_high_interrupt_restore_state(interrupt_state_t new_interrupt_state){
+	host_interrupt_state = new_interrupt_state;
+
+	if (new_interrupt_state == INTERRUPTS_ENABLED) {
+		host_shim_deliver_interrupts();
+	}
+
+	return 0;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Heap
+ *
+ *****************************************************************************/
+static void* host_check_alloc(void* addr){
+	if ((uintptr_t)addr > 0xFFFFFFFFUL) {
+		fprintf(stderr, "host_shim: heap address %p does not fit in 32 bits\n", addr);
+		abort();
+	}
+
+	if (addr == NULL) {
+		host_stats.num_malloc_failures++;
+	}
+
+	return addr;
+}
+
+static int host_alloc_allowed(void){
+	if (host_malloc_limit == 0) {
+		host_stats.num_malloc_failures++;
+		return 0;
+	}
+
+	if (host_malloc_limit != 0xFFFFFFFF) {
+		host_malloc_limit--;
+	}
+
+	return 1;
+}
+
+void* wlan_mac_high_malloc(u32 size){
+	return host_alloc_allowed() ? host_check_alloc(malloc(size)) : NULL;
+}
+
+void* wlan_mac_high_calloc(u32 size){
+	return host_alloc_allowed() ? host_check_alloc(calloc(1, size)) : NULL;
+}
+
+void* wlan_mac_high_realloc(void* addr, u32 size){
+	return host_alloc_allowed() ? host_check_alloc(realloc(addr, size)) : NULL;
+}
+
+void wlan_mac_high_free(void* addr){
+	free(addr);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * CDMA
+ *
+ * Transfers complete immediately.  Addresses in the DLMB are reported as
+ * unreachable, as on hardware.
+ *
+ *****************************************************************************/
+int wlan_mac_high_cdma_addr_ok(void* addr){
+	// Both DLMB controllers are mapped from address 0 (see xparameters.h)
+	return ((u32)addr > XPAR_MB_HIGH_DLMB_BRAM_CNTLR_1_HIGHADDR);
+}
+
+int wlan_mac_high_cdma_start_transfer(void* dest, void* src, u32 size){
+	if (size > 0) {
+		memmove(dest, src, size);
+		host_stats.cdma_bytes += size;
+	}
+	return 0;
+}
+
+void wlan_mac_high_cdma_finish_transfer(){
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Main loop
+ *
+ * Same as the framework:  tests call wlan_mac_high_poll() in place of a
+ * pass of the MAC's main loop.  host_shim_main_loop_pass() is called by the
+ * simulated timer after each expiry.
+ *
+ *****************************************************************************/
+void wlan_mac_high_poll(){
+	run_queue_poll();
+}
+
+void host_shim_set_main_loop(int enabled){
+	host_main_loop_enabled = enabled;
+}
+
+void host_shim_main_loop_pass(void){
+	// The main loop cannot run while interrupts are stopped (the test is in a critical section) or
+	// from within itself (a callback advanced the clock)
+	if ((host_main_loop_enabled == 0) || (host_interrupt_state != INTERRUPTS_ENABLED) || host_main_loop_running) {
+		return;
+	}
+
+	host_main_loop_running = 1;
+	wlan_mac_high_poll();
+	host_main_loop_running = 0;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Packet buffers and transmission
+ *
+ * A single Tx packet buffer is available; wlan_mac_high_mpdu_transmit()
+ * hands it straight back, as CPU Low would once the MPDU was sent.
+ *
+ *****************************************************************************/
+int wlan_mac_high_lock_new_tx_packet_buffer(){
+	if (host_tx_pkt_buf_locked) {
+		return -1;
+	}
+
+	host_tx_pkt_buf_locked = 1;
+	return 0;
+}
+
+int wlan_mac_high_release_tx_packet_buffer(int pkt_buf){
+	host_tx_pkt_buf_locked = 0;
+	return 0;
+}
+
+void wlan_mac_high_mpdu_transmit(tx_queue_element* packet, int tx_pkt_buf){
+	host_stats.num_mpdu_transmit++;
+	host_tx_pkt_buf_locked = 0;
+}
+
+// Same classification as wlan_mac_high.c
+u8 wlan_mac_high_pkt_type(void* mpdu, u16 length){
+	mac_header_80211* hdr_80211 = (mac_header_80211*)mpdu;
+	llc_header*       llc_hdr;
+
+	if ((hdr_80211->frame_control_1 & 0xF) == MAC_FRAME_CTRL1_TYPE_MGMT) {
+		return PKT_TYPE_MGMT;
+	} else if (hdr_80211->frame_control_1 == MAC_FRAME_CTRL1_SUBTYPE_ACK) {
+		return PKT_TYPE_CONTROL_ACK;
+	} else if (hdr_80211->frame_control_1 == MAC_FRAME_CTRL1_SUBTYPE_CTS) {
+		return PKT_TYPE_CONTROL_CTS;
+	} else if (hdr_80211->frame_control_1 == MAC_FRAME_CTRL1_SUBTYPE_RTS) {
+		return PKT_TYPE_CONTROL_RTS;
+	} else if ((hdr_80211->frame_control_1 & 0xF) == MAC_FRAME_CTRL1_TYPE_DATA) {
+		if (hdr_80211->frame_control_2 & MAC_FRAME_CTRL2_FLAG_PROTECTED) {
+			return PKT_TYPE_DATA_PROTECTED;
+		}
+
+		if (length < (sizeof(mac_header_80211) + sizeof(llc_header) + WLAN_PHY_FCS_NBYTES)) {
+			return PKT_TYPE_DATA_OTHER;
+		}
+
+		llc_hdr = (llc_header*)((u8*)mpdu + sizeof(mac_header_80211));
+
+		switch (llc_hdr->type) {
+			case LLC_TYPE_ARP:
+			case LLC_TYPE_IP:         return PKT_TYPE_DATA_ENCAP_ETH;
+			case LLC_TYPE_WLAN_LTG:   return PKT_TYPE_DATA_ENCAP_LTG;
+			default:                  return PKT_TYPE_DATA_OTHER;
+		}
+	}
+
+	return 0;
+}
+
+wlan_mac_hw_info* wlan_mac_high_get_hw_info(){
+	return &hw_info;
+}
+
+void wlan_mac_high_set_node_error_status(u8 status){
+}
+
+void wlan_mac_high_blink_hex_display(u32 num_blinks, u32 blink_time){
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Application
+ *
+ *****************************************************************************/
+u64 get_usec_timestamp(){
+	return host_shim_get_cycles() / HOST_SHIM_CYCLES_PER_USEC;
+}
+
+dl_list* get_statistics(){
+	return &host_statistics;
+}
+
+dl_list* get_station_info_list(){
+	return &host_station_info_list;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * WLAN Exp node
+ *
+ * The transport is built for the host; it sends through the Xilnet sockets
+ * in host_bsp.c.
+ *
+ *****************************************************************************/
+int node_get_parameter_values(u32* buffer, unsigned int max_words){
+	return 0;
+}
+
+u32 wn_get_node_id(void)       { return 0; }
+u32 wn_get_serial_number(void) { return 0; }
+u32 wn_get_curr_temp(void)     { return 0; }
+u32 wn_get_min_temp(void)      { return 0; }
+u32 wn_get_max_temp(void)      { return 0; }
@@ -0,0 +1,76 @@
+/** @file host_shim.h
+ *  @brief Host shim for the WLAN MAC High Framework
+ *
+ *  Provides the platform that the framework expects from the MicroBlaze
+ *  BSP and the rest of the high CPU application, so that the framework
+ *  modules can be built and exercised on a development host:
+ *
+ *   - DRAM and aux. BRAM mapped at their hardware addresses
+ *   - A simulated processor clock and AXI timer/counter
+ *   - An AXI DMA for ETH A that sends Tx frames immediately and receives
+ *     the frames passed to host_shim_eth_rx()
+ *   - An interrupt controller that delivers the timer interrupt with
+ *     interrupts disabled, as the MicroBlaze does
+ *   - Heap, CDMA and packet buffer stand-ins
+ *   - The WARPxilnet sockets used by the WLAN Exp transport; frames are
+ *     built in the Xilnet send buffers and recorded, not sent
+ *   - A loopback IPC mailbox, the packet buffer mutex and the parts of the
+ *     WLAN MAC Low Framework used by the DCF (host_low_platform.c)
+ *
+ *  The framework casts pointers to u32, so the host build is non-PIE and
+ *  every address handed to the framework must be below 4 GB.
+ */
+
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+#include "xil_types.h"
+#include "xparameters.h"
+#include "xintc.h"
+
+#define HOST_SHIM_CYCLES_PER_USEC  (XPAR_TMRCTR_0_CLOCK_FREQ_HZ / 1000000)
+
+typedef struct {
+	u32   num_interrupts;           ///< Number of interrupts delivered
+	u32   num_mpdu_transmit;        ///< Number of calls to wlan_mac_high_mpdu_transmit()
+	u32   num_transport_send;       ///< Number of WLAN Exp packets sent
+	u32   num_eth_tx;               ///< Number of Ethernet frames sent by the ETH DMA
+	u64   cdma_bytes;               ///< Number of bytes moved by the CDMA
+	u32   num_malloc_failures;      ///< Number of failed heap allocations
+} host_shim_stats;
+
+typedef struct {
+	u32   num_tx_signal;            ///< Number of calls to wlan_phy_set_tx_signal()
+	u32   num_ipc_polls;            ///< Number of calls to wlan_mac_low_poll_ipc_rx()
+	u32   num_exceptions;           ///< Number of calls to wlan_mac_low_send_exception()
+	u32   last_exception;           ///< Reason passed to the last wlan_mac_low_send_exception()
+} host_shim_low_stats;
+
+
+void               host_shim_init(void);
+void               host_shim_reset(void);
+
+XIntc*             host_shim_get_intc(void);
+host_shim_stats*   host_shim_get_stats(void);
+void               host_shim_set_verbose(int verbose);
+
+u64                host_shim_get_cycles(void);
+void               host_shim_advance_cycles(u64 cycles);
+void               host_shim_advance_usec(u64 usec);
+
+void               host_shim_raise_interrupt(u8 id);
+int                host_shim_interrupts_enabled(void);
+
+void               host_shim_set_main_loop(int enabled);
+void               host_shim_main_loop_pass(void);
+
+int                host_shim_eth_rx(const u8* frame, u32 length);
+const u8*          host_shim_get_xilnet_send(u32* length);
+
+void               host_shim_set_malloc_limit(u32 num_allocs);
+
+void                 host_shim_low_reset(void);
+host_shim_low_stats* host_shim_low_get_stats(void);
+void                 host_shim_low_set_cw_exp(u8 cw_exp_min, u8 cw_exp_max);
+
+#endif /* HOST_SHIM_H */
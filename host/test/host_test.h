@@ -0,0 +1,50 @@
+/** @file host_test.h
+ *  @brief Minimal unit test framework for the host build
+ *
+ *  Tests are registered with HOST_TEST(suite, name) and run by test_main.c.
+ *  Each test starts from a freshly reset host shim (see host_shim_reset()).
+ *
+ *  HOST_CHECK() records a failure and carries on; HOST_ASSERT() records a
+ *  failure and returns from the test.
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include "xil_types.h"
+#include "host_shim.h"
+
+typedef void (*host_test_fn)(void);
+
+typedef struct host_test_case {
+	const char*             suite;
+	const char*             name;
+	host_test_fn            fn;
+	struct host_test_case*  next;
+} host_test_case;
+
+void host_test_register(host_test_case* test);
+void host_test_fail(const char* file, int line, const char* expr);
+
+#define HOST_TEST(suite_name, test_name)                                          \
+	static void test_##suite_name##_##test_name(void);                            \
+	static host_test_case test_case_##suite_name##_##test_name = {                \
+		#suite_name, #test_name, test_##suite_name##_##test_name, NULL };         \
+	__attribute__((constructor)) static void register_##suite_name##_##test_name(void) { \
+		host_test_register(&test_case_##suite_name##_##test_name);                \
+	}                                                                             \
+	static void test_##suite_name##_##test_name(void)
+
+#define HOST_CHECK(expr)                                                          \
+	do { if (!(expr)) { host_test_fail(__FILE__, __LINE__, #expr); } } while (0)
+
+#define HOST_ASSERT(expr)                                                         \
+	do { if (!(expr)) { host_test_fail(__FILE__, __LINE__, #expr); return; } } while (0)
+
+#define HOST_CHECK_EQ(a, b)                                                       \
+	do { long long _a = (long long)(a), _b = (long long)(b);                      \
+	     if (_a != _b) { host_test_fail_eq(__FILE__, __LINE__, #a, #b, _a, _b); } } while (0)
+
+void host_test_fail_eq(const char* file, int line, const char* a_expr, const char* b_expr, long long a, long long b);
+
+#endif /* HOST_TEST_H */
@@ -0,0 +1,195 @@
+/** @file test_dcf.c
+ *  @brief Host tests: DCF backoff, contention window and IPC primitives
+ *
+ *  The DCF is built with its main() renamed, and frame_transmit() runs
+ *  against the MAC HW registers mapped by the host shim: a test sets the
+ *  status register to the outcome it wants before the call.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+#include "xil_io.h"
+#include "wlan_mac_ipc_util.h"
+#include "wlan_mac_misc_util.h"
+#include "wlan_mac_802_11_defs.h"
+#include "wlan_mac_low.h"
+#include "wlan_phy_util.h"
+#include "wlan_mac_dcf.h"
+
+#define TEST_DCF_NUM_DRAWS    1000
+
+// Returns the largest of TEST_DCF_NUM_DRAWS backoff draws
+static u32 test_max_slots(u8 reason){
+	u32 max_slots = 0;
+	u32 n_slots;
+	u32 i;
+
+	for (i = 0; i < TEST_DCF_NUM_DRAWS; i++) {
+		n_slots = rand_num_slots(reason);
+		if (n_slots > max_slots) {
+			max_slots = n_slots;
+		}
+	}
+
+	return max_slots;
+}
+
+
+HOST_TEST(dcf, start_backoff){
+	wlan_mac_dcf_hw_start_backoff(37);
+
+	// The start bit is toggled, leaving only the number of slots
+	HOST_CHECK_EQ(Xil_In32(WLAN_MAC_REG_SW_BACKOFF_CTRL), 37);
+
+	wlan_mac_dcf_hw_start_backoff(0xFFFF);
+	HOST_CHECK_EQ(Xil_In32(WLAN_MAC_REG_SW_BACKOFF_CTRL), 0xFFFF);
+}
+
+HOST_TEST(dcf, contention_window){
+	u8  src = 0;
+	u32 max_slots;
+	u32 i;
+
+	srand(1);
+	host_shim_low_set_cw_exp(4, 6);
+	reset_ssrc();
+	reset_cw();
+
+	// CW = 2^4 - 1
+	max_slots = test_max_slots(RAND_SLOT_REASON_STANDARD_ACCESS);
+	HOST_CHECK(max_slots <= 15);
+	HOST_CHECK(max_slots >= 8);
+
+	// Each short retry doubles the window, up to 2^cw_exp_max - 1
+	increment_src_ssrc(&src);
+	max_slots = test_max_slots(RAND_SLOT_REASON_STANDARD_ACCESS);
+	HOST_CHECK(max_slots <= 31);
+	HOST_CHECK(max_slots >= 16);
+
+	for (i = 0; i < 5; i++) {
+		increment_src_ssrc(&src);
+	}
+	HOST_CHECK_EQ(src, 6);
+
+	max_slots = test_max_slots(RAND_SLOT_REASON_STANDARD_ACCESS);
+	HOST_CHECK(max_slots <= 63);
+	HOST_CHECK(max_slots >= 32);
+
+	// IBSS beacon backoffs are drawn from [0, 2*CWmin] whatever the current window
+	max_slots = test_max_slots(RAND_SLOT_REASON_IBSS_BEACON);
+	HOST_CHECK(max_slots <= 31);
+	HOST_CHECK(max_slots >= 16);
+
+	reset_cw();
+	max_slots = test_max_slots(RAND_SLOT_REASON_STANDARD_ACCESS);
+	HOST_CHECK(max_slots <= 15);
+}
+
+HOST_TEST(dcf, transmit_broadcast){
+	tx_frame_info*          mpdu_info = (tx_frame_info*)TX_PKT_BUF_TO_ADDR(2);
+	wlan_mac_low_tx_details low_tx_details[4];
+	u8                      gain;
+	u32                     tx_params;
+	int                     status;
+
+	memset(low_tx_details, 0, sizeof(low_tx_details));
+
+	mpdu_info->flags                   = 0;
+	mpdu_info->params.phy.rate         = WLAN_MAC_MCS_6M;
+	mpdu_info->params.phy.antenna_mode = TX_ANTMODE_SISO_ANTA;
+	mpdu_info->params.phy.power        = 15;
+
+	reset_cw();
+
+	// The MAC core reports the transmission done with no post-Tx wait
+	Xil_Out32(WLAN_MAC_REG_STATUS, WLAN_MAC_STATUS_MASK_TX_A_DONE | WLAN_MAC_STATUS_TX_A_RESULT_NONE);
+
+	status = frame_transmit(2, WLAN_MAC_MCS_6M, 100, low_tx_details);
+
+	HOST_CHECK_EQ(status, 0);
+	HOST_CHECK_EQ(mpdu_info->num_tx_attempts, 1);
+	HOST_CHECK_EQ(host_shim_low_get_stats()->num_tx_signal, 1);
+	HOST_CHECK_EQ(Xil_In32(TX_PKT_BUF_TO_ADDR(2) + PHY_TX_PKT_BUF_PHY_HDR_OFFSET), WLAN_TX_SIGNAL_CALC(WLAN_MAC_MCS_6M, 100));
+
+	// Tx state machine A: packet buffer 2, antenna A, no post-Tx timeout
+	tx_params = Xil_In32(WLAN_MAC_REG_TX_CTRL_A_PARAMS);
+	HOST_CHECK_EQ(tx_params & 0xF, 2);
+	HOST_CHECK_EQ((tx_params >> 4) & 0xF, 0x1);
+	HOST_CHECK_EQ((tx_params >> 26) & 0x1, 0);
+	HOST_CHECK_EQ(Xil_In32(WLAN_MAC_REG_TX_START) & 0x1, 0);
+
+	gain = wlan_mac_low_dbm_to_gain_target(15);
+	HOST_CHECK_EQ(Xil_In32(WLAN_MAC_REG_TX_CTRL_A_GAINS), gain | (gain << 6) | (gain << 12) | (gain << 18));
+
+	HOST_CHECK_EQ(low_tx_details[0].tx_details_type, TX_DETAILS_MPDU);
+	HOST_CHECK_EQ(low_tx_details[0].chan_num, wlan_mac_low_get_active_channel());
+	HOST_CHECK_EQ(low_tx_details[0].cw, 15);
+
+	// A post-Tx backoff is started from the minimum window
+	HOST_CHECK(Xil_In32(WLAN_MAC_REG_SW_BACKOFF_CTRL) <= 15);
+}
+
+HOST_TEST(dcf, ipc_mailbox){
+	wlan_ipc_msg msg;
+	wlan_ipc_msg rx_msg;
+	u32          payload[3]    = { 0x11111111, 0x22222222, 0x33333333 };
+	u32          rx_payload[3] = { 0 };
+
+	wlan_lib_init();
+	HOST_CHECK(ipc_mailbox_read_isempty());
+
+	msg.msg_id            = IPC_MBOX_MSG_ID(IPC_MBOX_TX_MPDU_DONE);
+	msg.num_payload_words = 3;
+	msg.arg0              = 5;
+	msg.payload_ptr       = payload;
+
+	HOST_CHECK_EQ(ipc_mailbox_write_msg(&msg), IPC_MBOX_SUCCESS);
+	HOST_CHECK(!ipc_mailbox_read_isempty());
+
+	rx_msg.payload_ptr = rx_payload;
+	HOST_CHECK_EQ(ipc_mailbox_read_msg(&rx_msg), IPC_MBOX_SUCCESS);
+	HOST_CHECK_EQ(IPC_MBOX_MSG_ID_TO_MSG(rx_msg.msg_id), IPC_MBOX_TX_MPDU_DONE);
+	HOST_CHECK_EQ(rx_msg.num_payload_words, 3);
+	HOST_CHECK_EQ(rx_msg.arg0, 5);
+	HOST_CHECK(memcmp(rx_payload, payload, sizeof(payload)) == 0);
+	HOST_CHECK(ipc_mailbox_read_isempty());
+
+	// Messages without the delimiter, or too long, are not sent
+	msg.msg_id = IPC_MBOX_TX_MPDU_DONE;
+	HOST_CHECK_EQ(ipc_mailbox_write_msg(&msg), IPC_MBOX_INVALID_MSG);
+
+	msg.msg_id            = IPC_MBOX_MSG_ID(IPC_MBOX_TX_MPDU_DONE);
+	msg.num_payload_words = IPC_BUFFER_MAX_NUM_WORDS + 1;
+	HOST_CHECK_EQ(ipc_mailbox_write_msg(&msg), IPC_MBOX_INVALID_MSG);
+	HOST_CHECK(ipc_mailbox_read_isempty());
+	HOST_CHECK_EQ(ipc_mailbox_read_msg(&rx_msg), IPC_MBOX_INVALID_MSG);
+}
+
+HOST_TEST(dcf, pkt_buf_mutex){
+	u32 locked;
+	u32 owner;
+
+	wlan_lib_init();
+
+	HOST_CHECK_EQ(lock_pkt_buf_tx(TX_PKT_BUF_ACK_CTS), PKT_BUF_MUTEX_SUCCESS);
+	HOST_CHECK_EQ(lock_pkt_buf_tx(TX_PKT_BUF_ACK_CTS), PKT_BUF_MUTEX_FAIL_ALREADY_LOCKED);
+
+	HOST_CHECK_EQ(status_pkt_buf_tx(TX_PKT_BUF_ACK_CTS, &locked, &owner), PKT_BUF_MUTEX_SUCCESS);
+	HOST_CHECK_EQ(locked, 1);
+
+	// Tx and Rx buffers with the same index use different mutexes
+	HOST_CHECK_EQ(lock_pkt_buf_rx(TX_PKT_BUF_ACK_CTS), PKT_BUF_MUTEX_SUCCESS);
+	HOST_CHECK_EQ(unlock_pkt_buf_rx(TX_PKT_BUF_ACK_CTS), PKT_BUF_MUTEX_SUCCESS);
+
+	HOST_CHECK_EQ(unlock_pkt_buf_tx(TX_PKT_BUF_ACK_CTS), PKT_BUF_MUTEX_SUCCESS);
+	HOST_CHECK_EQ(unlock_pkt_buf_tx(TX_PKT_BUF_ACK_CTS), PKT_BUF_MUTEX_FAIL_NOT_LOCK_OWNER);
+
+	HOST_CHECK_EQ(status_pkt_buf_tx(TX_PKT_BUF_ACK_CTS, &locked, &owner), PKT_BUF_MUTEX_SUCCESS);
+	HOST_CHECK_EQ(locked, 0);
+
+	HOST_CHECK_EQ(lock_pkt_buf_tx(NUM_TX_PKT_BUFS), PKT_BUF_MUTEX_FAIL_INVALID_BUF);
+	HOST_CHECK_EQ(lock_pkt_buf_rx(NUM_RX_PKT_BUFS), PKT_BUF_MUTEX_FAIL_INVALID_BUF);
+}
@@ -0,0 +1,94 @@
+/** @file test_dl_list.c
+ *  @brief Host tests: doubly-linked list
+ */
+
+#include "host_test.h"
+
+#include "wlan_mac_dl_list.h"
+
+#define TEST_NUM_ENTRIES  8
+
+static dl_entry  entries[TEST_NUM_ENTRIES];
+
+// Checks that list holds exactly the entries whose indices are given, in order, linked both ways
+static int list_matches(dl_list* list, const u32* expected, u32 num_expected){
+	dl_entry* curr;
+	dl_entry* prev = NULL;
+	u32       i    = 0;
+
+	if (list->length != num_expected) {
+		return 0;
+	}
+
+	for (curr = list->first; curr != NULL; curr = dl_entry_next(curr)) {
+		if ((i >= num_expected) || (curr != &entries[expected[i]]) || (dl_entry_prev(curr) != prev)) {
+			return 0;
+		}
+		prev = curr;
+		i++;
+	}
+
+	return (i == num_expected) && (list->last == prev);
+}
+
+HOST_TEST(dl_list, init_is_empty){
+	dl_list list;
+
+	list.first  = &entries[0];
+	list.length = 3;
+
+	dl_list_init(&list);
+
+	HOST_CHECK(list.first == NULL);
+	HOST_CHECK(list.last == NULL);
+	HOST_CHECK_EQ(list.length, 0);
+}
+
+HOST_TEST(dl_list, insert_end_and_beginning){
+	dl_list list;
+	const u32 expected[] = {2, 0, 1};
+
+	dl_list_init(&list);
+	dl_entry_insertEnd(&list, &entries[0]);
+	dl_entry_insertEnd(&list, &entries[1]);
+	dl_entry_insertBeginning(&list, &entries[2]);
+
+	HOST_CHECK(list_matches(&list, expected, 3));
+}
+
+HOST_TEST(dl_list, insert_after_and_before){
+	dl_list list;
+	const u32 expected[] = {0, 3, 1, 2};
+
+	dl_list_init(&list);
+	dl_entry_insertEnd(&list, &entries[0]);
+	dl_entry_insertAfter(&list, &entries[0], &entries[1]);
+	dl_entry_insertAfter(&list, &entries[1], &entries[2]);
+	dl_entry_insertBefore(&list, &entries[1], &entries[3]);
+
+	HOST_CHECK(list_matches(&list, expected, 4));
+}
+
+HOST_TEST(dl_list, remove_first_middle_last){
+	dl_list list;
+	u32 i;
+	const u32 expected_mid[]  = {0, 1, 3, 4};
+	const u32 expected_ends[] = {1, 3};
+
+	dl_list_init(&list);
+	for (i = 0; i < 5; i++) {
+		dl_entry_insertEnd(&list, &entries[i]);
+	}
+
+	dl_entry_remove(&list, &entries[2]);
+	HOST_CHECK(list_matches(&list, expected_mid, 4));
+
+	dl_entry_remove(&list, &entries[0]);
+	dl_entry_remove(&list, &entries[4]);
+	HOST_CHECK(list_matches(&list, expected_ends, 2));
+
+	dl_entry_remove(&list, &entries[1]);
+	dl_entry_remove(&list, &entries[3]);
+	HOST_CHECK(list_matches(&list, NULL, 0));
+	HOST_CHECK(list.first == NULL);
+}
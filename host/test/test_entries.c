@@ -0,0 +1,148 @@
+/** @file test_entries.c
+ *  @brief Host tests: log entries
+ */
+
+#include <string.h>
+
+#include "host_test.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_802_11_defs.h"
+#include "wlan_mac_packet_types.h"
+#include "wlan_mac_misc_util.h"
+#include "wlan_mac_entries.h"
+#include "wlan_mac_event_log.h"
+
+#define TEST_LOG_SIZE        (1024 * 1024)
+
+static u32 test_rx_buf[(sizeof(rx_frame_info) + PHY_RX_PKT_BUF_MPDU_OFFSET + 2048) / 4];
+
+static void test_entries_setup(void){
+	wlan_exp_log_set_entry_en_mask(ENTRY_EN_MASK_TXRX_CTRL | ENTRY_EN_MASK_TXRX_MPDU);
+	wlan_exp_log_set_compact(0);
+	wlan_exp_log_reset_entry_policies();
+
+	event_log_init((char*)EVENT_LOG_BASE, TEST_LOG_SIZE);
+}
+
+// Builds a received data frame from addr_2 in the Rx packet buffer
+static rx_frame_info* test_rx_frame(u16 length, u8 addr_2_last){
+	rx_frame_info*    rx_mpdu = (rx_frame_info*)test_rx_buf;
+	mac_header_80211* hdr     = (mac_header_80211*)((u8*)test_rx_buf + PHY_RX_PKT_BUF_MPDU_OFFSET);
+	u32               i;
+
+	memset(test_rx_buf, 0, sizeof(test_rx_buf));
+
+	rx_mpdu->state               = RX_MPDU_STATE_FCS_GOOD;
+	rx_mpdu->rx_power            = -40;
+	rx_mpdu->phy_details.length  = length;
+	rx_mpdu->phy_details.mcs     = WLAN_MAC_MCS_18M;
+	rx_mpdu->timestamp           = 123456;
+
+	hdr->frame_control_1 = MAC_FRAME_CTRL1_SUBTYPE_DATA;
+	hdr->address_2[5]    = addr_2_last;
+
+	for (i = sizeof(mac_header_80211); i < length; i++) {
+		((u8*)hdr)[i] = (u8)i;
+	}
+
+	return rx_mpdu;
+}
+
+HOST_TEST(entries, rx_entry_fields){
+	rx_common_entry* entry;
+	rx_frame_info*   rx_mpdu;
+	entry_header*    header;
+
+	test_entries_setup();
+
+	rx_mpdu = test_rx_frame(200, 1);
+	entry   = wlan_exp_log_create_rx_entry(rx_mpdu, 6, WLAN_MAC_MCS_18M);
+
+	HOST_ASSERT(entry != NULL);
+
+	header = (entry_header*)((u8*)entry - sizeof(entry_header));
+
+	HOST_CHECK_EQ(header->entry_type, ENTRY_TYPE_RX_OFDM);
+	HOST_CHECK_EQ(entry->timestamp, 123456);
+	HOST_CHECK_EQ(entry->length, 200);
+	HOST_CHECK_EQ(entry->rate, WLAN_MAC_MCS_18M);
+	HOST_CHECK_EQ(entry->power, -40);
+	HOST_CHECK_EQ(entry->chan_num, 6);
+	HOST_CHECK_EQ(entry->fcs_status, RX_ENTRY_FCS_GOOD);
+
+	// The start of the MAC payload is copied into the entry
+	HOST_CHECK(memcmp(((rx_ofdm_entry*)entry)->mac_payload, (u8*)rx_mpdu + PHY_RX_PKT_BUF_MPDU_OFFSET, sizeof(mac_header_80211)) == 0);
+}
+
+HOST_TEST(entries, policy_never){
+	test_entries_setup();
+
+	HOST_ASSERT(wlan_exp_log_set_entry_policy(ENTRY_TYPE_RX_OFDM, ENTRY_POLICY_NEVER, 0, NULL, NULL) == 0);
+
+	HOST_CHECK(wlan_exp_log_create_rx_entry(test_rx_frame(200, 1), 6, WLAN_MAC_MCS_18M) == NULL);
+	HOST_CHECK_EQ(event_log_get_next_entry_index(), EVENT_LOG_WRAP_INDEX);
+}
+
+HOST_TEST(entries, policy_sample_one_in_n){
+	u32 i;
+	u32 num_created = 0;
+	entry_policy policy;
+
+	test_entries_setup();
+
+	HOST_ASSERT(wlan_exp_log_set_entry_policy(ENTRY_TYPE_RX_OFDM, ENTRY_POLICY_SAMPLE, 4, NULL, NULL) == 0);
+
+	for (i = 0; i < 100; i++) {
+		if (wlan_exp_log_create_rx_entry(test_rx_frame(200, 1), 6, WLAN_MAC_MCS_18M) != NULL) {
+			num_created++;
+		}
+	}
+
+	HOST_CHECK_EQ(num_created, 25);
+
+	wlan_exp_log_get_entry_policy(ENTRY_TYPE_RX_OFDM, &policy);
+	HOST_CHECK_EQ(policy.num_filtered, 75);
+}
+
+HOST_TEST(entries, policy_addr_filter){
+	u8 addr[6]      = {0, 0, 0, 0, 0, 2};
+	u8 addr_mask[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+	test_entries_setup();
+
+	HOST_ASSERT(wlan_exp_log_set_entry_policy(ENTRY_TYPE_RX_OFDM, ENTRY_POLICY_ADDR, 0, addr, addr_mask) == 0);
+
+	HOST_CHECK(wlan_exp_log_create_rx_entry(test_rx_frame(200, 1), 6, WLAN_MAC_MCS_18M) == NULL);
+	HOST_CHECK(wlan_exp_log_create_rx_entry(test_rx_frame(200, 2), 6, WLAN_MAC_MCS_18M) != NULL);
+}
+
+HOST_TEST(entries, rx_flags_in_full_and_compact_entries){
+	rx_common_entry* entry;
+	entry_header*    header;
+	u8*              compact;
+
+	test_entries_setup();
+
+	entry = wlan_exp_log_create_rx_entry_with_flags(test_rx_frame(200, 1), 6, WLAN_MAC_MCS_18M, RX_ENTRY_FLAGS_IS_DUPLICATE);
+	HOST_ASSERT(entry != NULL);
+	HOST_CHECK_EQ(entry->flags, RX_ENTRY_FLAGS_IS_DUPLICATE);
+
+	// Compact logging: a time anchor, then the compact entry
+	test_entries_setup();
+	wlan_exp_log_set_compact(1);
+
+	HOST_CHECK(wlan_exp_log_create_rx_entry_with_flags(test_rx_frame(200, 1), 6, WLAN_MAC_MCS_18M, RX_ENTRY_FLAGS_IS_DUPLICATE) == NULL);
+
+	header = (entry_header*)(EVENT_LOG_BASE + EVENT_LOG_WRAP_INDEX);
+	HOST_ASSERT(header->entry_type == ENTRY_TYPE_TIME_ANCHOR);
+
+	header  = (entry_header*)((u8*)header + sizeof(entry_header) + header->entry_length);
+	compact = (u8*)header + sizeof(entry_header);
+	HOST_ASSERT(header->entry_type == ENTRY_TYPE_TXRX_COMPACT);
+
+	// entry_type, payload_offset, 1 byte timestamp delta, 6 bytes of fields, then the flags varint
+	HOST_CHECK_EQ(compact[0], ENTRY_TYPE_RX_OFDM);
+	HOST_CHECK_EQ(compact[2], 0);
+	HOST_CHECK_EQ(compact[3 + 6], RX_ENTRY_FLAGS_IS_DUPLICATE);
+}
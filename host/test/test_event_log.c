@@ -0,0 +1,507 @@
+/** @file test_event_log.c
+ *  @brief Host tests: event log
+ *
+ *  The tests use a small log at EVENT_LOG_BASE so that it wraps quickly.
+ */
+
+#include "host_test.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_entries.h"
+#include "wlan_mac_event_log.h"
+
+#define TEST_LOG_SIZE        (256 * 1024)
+#define TEST_ENTRY_TYPE      ENTRY_TYPE_TXRX_STATS
+#define TEST_ENTRY_SIZE      100
+
+// The test log is small enough for skip index blocks of the minimum size
+#define TEST_SKIP_SHIFT      EVENT_LOG_SKIP_MIN_SHIFT
+#define TEST_SKIP_BLOCK_SIZE (1 << TEST_SKIP_SHIFT)
+#define TEST_SKIP_INDEX      ((u16*)EVENT_LOG_SKIP_BASE)
+
+// Log entry streaming state (defined by the host shim and the WLAN Exp transport)
+extern u32 async_pkt_enable;
+extern int sock_async;
+
+static void test_event_log_setup(void){
+	event_log_init((char*)EVENT_LOG_BASE, TEST_LOG_SIZE);
+}
+
+// Allocates and commits an entry, as a producer does once it has filled in the payload
+static void* test_event_log_add(u16 entry_size){
+	void* entry = event_log_get_next_empty_entry(TEST_ENTRY_TYPE, entry_size);
+
+	if (entry != NULL) {
+		event_log_commit_entry(entry);
+	}
+
+	return entry;
+}
+
+// Checks that the entries from start_index to end_index are contiguous, with consecutive entry ids
+static int test_event_log_walk(u32 start_index, u32 end_index, u32* num_entries){
+	entry_header* header;
+	u32           index = start_index;
+	u32           count = 0;
+	u32           prev_id = 0;
+
+	*num_entries = 0;
+
+	while (index < end_index) {
+		header = (entry_header*)(EVENT_LOG_BASE + index);
+
+		if ((header->entry_id & 0xFFFF0000) != EVENT_LOG_MAGIC_NUMBER) {
+			return 0;
+		}
+
+		if ((count > 0) && ((header->entry_id & 0xFFFF) != ((prev_id + 1) & 0xFFFF))) {
+			return 0;
+		}
+
+		prev_id = header->entry_id & 0xFFFF;
+		index  += sizeof(entry_header) + header->entry_length;
+		count++;
+	}
+
+	*num_entries = count;
+
+	return (index == end_index);
+}
+
+// Reference for the oldest entry index once the log has allocated an entry that ends at end_index:
+//   walks every entry from the oldest entry, as the log did before it had a skip index.  The log
+//   must have wrapped and the allocation must not wrap it again.
+static u32 test_event_log_ref_oldest(u32 end_index){
+	u32 oldest   = event_log_get_oldest_entry_index();
+	u32 soft_end = oldest + event_log_get_size(oldest);
+
+	if (end_index <= oldest) {
+		return oldest;
+	}
+
+	while (oldest <= end_index) {
+		oldest += sizeof(entry_header) + ((entry_header*)(EVENT_LOG_BASE + oldest))->entry_length;
+
+		if (oldest >= soft_end) {
+			return EVENT_LOG_WRAP_INDEX;
+		}
+	}
+
+	return oldest;
+}
+
+// Adds an entry and, if the log has wrapped, checks the oldest entry against the reference walk
+static int test_event_log_add_checked(u16 entry_size, u32* num_checked){
+	u32 oldest   = event_log_get_oldest_entry_index();
+	u32 next     = event_log_get_next_entry_index();
+	u32 end      = next + sizeof(entry_header) + entry_size;
+	u32 expected = 0;
+	int check    = (next < oldest) && (end < (oldest + event_log_get_size(oldest)));
+
+	// The reference walk reads the headers the allocation overwrites
+	if (check) {
+		expected = test_event_log_ref_oldest(end);
+	}
+
+	if (test_event_log_add(entry_size) == NULL) {
+		return 0;
+	}
+
+	if (check) {
+		(*num_checked)++;
+		return (event_log_get_oldest_entry_index() == expected);
+	}
+
+	return 1;
+}
+
+HOST_TEST(event_log, init_holds_node_info){
+	entry_header* header;
+
+	test_event_log_setup();
+
+	header = (entry_header*)EVENT_LOG_BASE;
+
+	HOST_CHECK_EQ(header->entry_type, ENTRY_TYPE_NODE_INFO);
+	HOST_CHECK_EQ(event_log_get_oldest_entry_index(), 0);
+	HOST_CHECK_EQ(event_log_get_next_entry_index(), EVENT_LOG_WRAP_INDEX);
+	HOST_CHECK_EQ(event_log_get_capacity(), TEST_LOG_SIZE);
+}
+
+HOST_TEST(event_log, entries_are_contiguous){
+	u32   i;
+	u32   num_entries = 0;
+	void* entry;
+
+	test_event_log_setup();
+
+	for (i = 0; i < 100; i++) {
+		entry = test_event_log_add(TEST_ENTRY_SIZE + (i % 4));
+		HOST_ASSERT(entry != NULL);
+		HOST_CHECK_EQ(((u32)(uintptr_t)entry) % 4, 0);
+	}
+
+	HOST_CHECK(test_event_log_walk(0, event_log_get_next_entry_index(), &num_entries));
+	HOST_CHECK_EQ(num_entries, 101);
+}
+
+HOST_TEST(event_log, full_without_wrap){
+	u32 num_allocated = 0;
+
+	test_event_log_setup();
+	event_log_config_wrap(EVENT_LOG_WRAP_DISABLE);
+
+	while (test_event_log_add(TEST_ENTRY_SIZE) != NULL) {
+		num_allocated++;
+	}
+
+	HOST_CHECK(num_allocated > (TEST_LOG_SIZE / (TEST_ENTRY_SIZE + sizeof(entry_header))) - 2);
+	HOST_CHECK_EQ(event_log_get_num_failures(), 1);
+}
+
+HOST_TEST(event_log, wrap_keeps_oldest_entry_valid){
+	u32 i;
+	u32 num_entries = 0;
+	u32 oldest;
+	u32 next;
+
+	test_event_log_setup();
+	event_log_config_wrap(EVENT_LOG_WRAP_ENABLE);
+
+	for (i = 0; i < 3 * (TEST_LOG_SIZE / (TEST_ENTRY_SIZE + sizeof(entry_header))); i++) {
+		HOST_ASSERT(test_event_log_add(TEST_ENTRY_SIZE + 4 * (i % 7)) != NULL);
+
+		oldest = event_log_get_oldest_entry_index();
+		HOST_ASSERT(((entry_header*)(EVENT_LOG_BASE + oldest))->entry_id >= EVENT_LOG_MAGIC_NUMBER);
+	}
+
+	HOST_CHECK(event_log_get_num_wraps() >= 2);
+	HOST_CHECK_EQ(event_log_get_num_failures(), 0);
+
+	oldest = event_log_get_oldest_entry_index();
+	next   = event_log_get_next_entry_index();
+
+	// The entries after the node info entry run up to the next entry, then from the oldest entry to the end
+	HOST_CHECK(next < oldest);
+	HOST_CHECK(test_event_log_walk(EVENT_LOG_WRAP_INDEX, next, &num_entries));
+	HOST_CHECK(test_event_log_walk(oldest, oldest + event_log_get_size(oldest), &num_entries));
+}
+
+HOST_TEST(event_log, time_range_covers_window){
+	u32 i;
+	u32 start_index;
+	u32 size;
+	u32 num_entries = 0;
+	u32 window_first = 0;
+	u32 window_last  = 0;
+	u32 index;
+
+	test_event_log_setup();
+
+	// One entry every 100 usec
+	for (i = 0; i < 2000; i++) {
+		index = event_log_get_next_entry_index();
+
+		if (i == 500)  { window_first = index; }
+		if (i == 1000) { window_last  = index; }
+
+		test_event_log_add(TEST_ENTRY_SIZE);
+		host_shim_advance_usec(100);
+	}
+
+	HOST_ASSERT(event_log_get_time_range(500 * 100, 1000 * 100, &start_index, &size) == 0);
+
+	HOST_CHECK(start_index <= window_first);
+	HOST_CHECK((start_index + size) > window_last);
+	HOST_CHECK(test_event_log_walk(start_index, start_index + size, &num_entries));
+}
+
+HOST_TEST(event_log, reset_restarts_indexes){
+	u32 i;
+	u32 num_entries = 0;
+	u32 start_index;
+	u32 size;
+	u32 oldest;
+	u32 window_first = 0;
+	u64 window_time  = 0;
+	u32 num_per_pass = TEST_LOG_SIZE / (TEST_ENTRY_SIZE + sizeof(entry_header));
+
+	test_event_log_setup();
+	event_log_config_wrap(EVENT_LOG_WRAP_ENABLE);
+
+	// Leave checkpoints and block offsets all over the log
+	for (i = 0; i < 3 * num_per_pass; i++) {
+		test_event_log_add(TEST_ENTRY_SIZE + 4 * (i % 7));
+		host_shim_advance_usec(10);
+	}
+
+	event_log_reset();
+
+	HOST_CHECK_EQ(event_log_get_oldest_entry_index(), 0);
+	HOST_CHECK_EQ(event_log_get_next_entry_index(), EVENT_LOG_WRAP_INDEX);
+
+	for (i = 0; i < 200; i++) {
+		if (i == 100) {
+			window_first = event_log_get_next_entry_index();
+			window_time  = get_usec_timestamp();
+		}
+
+		test_event_log_add(TEST_ENTRY_SIZE);
+		host_shim_advance_usec(100);
+	}
+
+	// Stale checkpoints past the next entry are not used
+	HOST_ASSERT(event_log_get_time_range(window_time, get_usec_timestamp(), &start_index, &size) == 0);
+	HOST_CHECK(start_index <= window_first);
+	HOST_CHECK_EQ(start_index + size, event_log_get_next_entry_index());
+	HOST_CHECK(test_event_log_walk(start_index, start_index + size, &num_entries));
+
+	// Stale block offsets are not used when the log wraps again
+	for (i = 0; i < 3 * num_per_pass; i++) {
+		HOST_ASSERT(test_event_log_add(TEST_ENTRY_SIZE + 4 * (i % 5)) != NULL);
+
+		oldest = event_log_get_oldest_entry_index();
+		HOST_ASSERT(((entry_header*)(EVENT_LOG_BASE + oldest))->entry_id >= EVENT_LOG_MAGIC_NUMBER);
+	}
+
+	HOST_CHECK(event_log_get_num_wraps() >= 2);
+	HOST_CHECK(test_event_log_walk(EVENT_LOG_WRAP_INDEX, event_log_get_next_entry_index(), &num_entries));
+	HOST_CHECK(test_event_log_walk(event_log_get_oldest_entry_index(),
+	                               event_log_get_oldest_entry_index() + event_log_get_size(event_log_get_oldest_entry_index()), &num_entries));
+}
+
+HOST_TEST(event_log, uncommitted_entry_hides_later_entries){
+	u32   i;
+	u32   num_entries = 0;
+	u32   hidden_index;
+	u32   next_index;
+	u32   start_index;
+	u32   size;
+	u32   address;
+	void* hidden;
+	void* entry = NULL;
+
+	test_event_log_setup();
+
+	for (i = 0; i < 10; i++) {
+		HOST_ASSERT(test_event_log_add(TEST_ENTRY_SIZE) != NULL);
+		host_shim_advance_usec(100);
+	}
+
+	// A producer is interrupted while it fills in an entry; the interrupt logs more entries
+	hidden       = event_log_get_next_empty_entry(TEST_ENTRY_TYPE, TEST_ENTRY_SIZE);
+	HOST_ASSERT(hidden != NULL);
+	hidden_index = (u32)(uintptr_t)hidden - sizeof(entry_header) - EVENT_LOG_BASE;
+
+	for (i = 0; i < 10; i++) {
+		entry = test_event_log_add(TEST_ENTRY_SIZE);
+		HOST_ASSERT(entry != NULL);
+		host_shim_advance_usec(100);
+	}
+
+	next_index = (u32)(uintptr_t)entry + TEST_ENTRY_SIZE - EVENT_LOG_BASE;
+
+	// Readers stop at the entry that is not committed
+	HOST_CHECK_EQ(event_log_get_next_entry_index(), hidden_index);
+	HOST_CHECK_EQ(event_log_get_size(0), hidden_index);
+	HOST_CHECK_EQ(event_log_get_total_size(), hidden_index);
+	HOST_CHECK_EQ(event_log_get_data_address(0, TEST_LOG_SIZE, &address), hidden_index);
+	HOST_CHECK_EQ(event_log_get_data_address(hidden_index - 4, 8, &address), 4);
+
+	HOST_ASSERT(event_log_get_time_range(0, get_usec_timestamp(), &start_index, &size) == 0);
+	HOST_CHECK_EQ(start_index + size, hidden_index);
+
+	// Committing it exposes the entries logged after it
+	event_log_commit_entry(hidden);
+
+	HOST_CHECK_EQ(event_log_get_next_entry_index(), next_index);
+	HOST_CHECK_EQ(event_log_get_total_size(), next_index);
+	HOST_CHECK(test_event_log_walk(0, next_index, &num_entries));
+	HOST_CHECK_EQ(num_entries, 22);
+}
+
+HOST_TEST(event_log, uncommitted_entry_at_wrap){
+	u32   num_entries = 0;
+	u32   pending_index;
+	u32   wrapped_index;
+	u32   oldest;
+	u32   address;
+	void* pending;
+	void* entry;
+
+	test_event_log_setup();
+	event_log_config_wrap(EVENT_LOG_WRAP_ENABLE);
+
+	// Keep the last entry before the wrap uncommitted while the first entry after it is committed
+	pending = event_log_get_next_empty_entry(TEST_ENTRY_TYPE, TEST_ENTRY_SIZE);
+	HOST_ASSERT(pending != NULL);
+
+	while (1) {
+		entry = event_log_get_next_empty_entry(TEST_ENTRY_TYPE, TEST_ENTRY_SIZE);
+		HOST_ASSERT(entry != NULL);
+
+		if (event_log_get_num_wraps() != 0) { break; }
+
+		event_log_commit_entry(pending);
+		pending = entry;
+	}
+
+	event_log_commit_entry(entry);
+
+	pending_index = (u32)(uintptr_t)pending - sizeof(entry_header) - EVENT_LOG_BASE;
+	wrapped_index = (u32)(uintptr_t)entry + TEST_ENTRY_SIZE - EVENT_LOG_BASE;
+	oldest        = event_log_get_oldest_entry_index();
+
+	HOST_ASSERT(((u32)(uintptr_t)entry - sizeof(entry_header) - EVENT_LOG_BASE) == EVENT_LOG_WRAP_INDEX);
+
+	// The log reads as if it had not wrapped, up to the pending entry
+	HOST_CHECK_EQ(event_log_get_next_entry_index(), pending_index);
+	HOST_CHECK_EQ(event_log_get_total_size(), pending_index - oldest);
+	HOST_CHECK_EQ(event_log_get_data_address(oldest, TEST_LOG_SIZE, &address), pending_index - oldest);
+	HOST_CHECK(test_event_log_walk(oldest, pending_index, &num_entries));
+
+	// Once it is committed, the log continues after the wrap
+	event_log_commit_entry(pending);
+
+	HOST_CHECK_EQ(event_log_get_next_entry_index(), wrapped_index);
+	HOST_CHECK_EQ(event_log_get_size(oldest), pending_index + sizeof(entry_header) + TEST_ENTRY_SIZE - oldest);
+	HOST_CHECK(test_event_log_walk(EVENT_LOG_WRAP_INDEX, wrapped_index, &num_entries));
+	HOST_CHECK_EQ(num_entries, 1);
+}
+
+HOST_TEST(event_log, uncommitted_entry_not_streamed){
+	void* entry;
+
+	test_event_log_setup();
+	async_pkt_enable = 1;
+	sock_async       = 0;
+
+	entry = event_log_get_next_empty_entry(TEST_ENTRY_TYPE, TEST_ENTRY_SIZE);
+	HOST_ASSERT(entry != NULL);
+
+	wn_transmit_log_entry(entry);
+	HOST_CHECK_EQ(host_shim_get_stats()->num_transport_send, 0);
+
+	event_log_commit_entry(entry);
+
+	wn_transmit_log_entry(entry);
+	HOST_CHECK_EQ(host_shim_get_stats()->num_transport_send, 1);
+
+	async_pkt_enable = 0;
+	sock_async       = -1;
+}
+
+HOST_TEST(event_log, skip_index_matches_walk){
+	u32 i;
+	u32 num_checked = 0;
+	u32 num_entries = 0;
+	u16 entry_size;
+
+	test_event_log_setup();
+	event_log_config_wrap(EVENT_LOG_WRAP_ENABLE);
+
+	// Small entries mixed with entries larger than a skip index block, so that allocations end
+	//   in blocks where no entry starts
+	for (i = 0; i < 2000; i++) {
+		entry_size = ((i % 7) == 0) ? (TEST_SKIP_BLOCK_SIZE + 4 * (i % 300)) : (20 + 4 * (i % 23));
+
+		HOST_ASSERT(test_event_log_add_checked(entry_size, &num_checked));
+	}
+
+	HOST_CHECK(event_log_get_num_wraps() >= 3);
+	HOST_CHECK(num_checked > 1000);
+	HOST_CHECK(test_event_log_walk(EVENT_LOG_WRAP_INDEX, event_log_get_next_entry_index(), &num_entries));
+}
+
+HOST_TEST(event_log, long_entry_clears_skip_blocks){
+	u32 i;
+	u32 num_checked  = 0;
+	u32 num_entries  = 0;
+	u32 long_index;
+	u32 long_end;
+	u32 block;
+	u32 passed_long  = 0;
+	u16 long_size    = 4 * TEST_SKIP_BLOCK_SIZE;
+
+	test_event_log_setup();
+	event_log_config_wrap(EVENT_LOG_WRAP_ENABLE);
+
+	// Record an entry in every block, then stop half way through the next pass
+	while ((event_log_get_num_wraps() == 0) || (event_log_get_next_entry_index() < (TEST_LOG_SIZE / 2))) {
+		HOST_ASSERT(test_event_log_add_checked(TEST_ENTRY_SIZE, &num_checked));
+	}
+
+	// The payload of the long entry is not written:  it still holds the headers of the previous pass
+	long_index = event_log_get_next_entry_index();
+	long_end   = long_index + sizeof(entry_header) + long_size;
+
+	HOST_ASSERT(test_event_log_add_checked(long_size, &num_checked));
+	HOST_ASSERT(test_event_log_add_checked(TEST_ENTRY_SIZE, &num_checked));
+
+	// Once the entry after it is allocated, no entry starts in the blocks the long entry covers
+	for (block = (long_index >> TEST_SKIP_SHIFT) + 1; block < (long_end >> TEST_SKIP_SHIFT); block++) {
+		HOST_CHECK_EQ(TEST_SKIP_INDEX[block], EVENT_LOG_SKIP_NONE);
+	}
+
+	// On the next pass, the oldest entry moves from the long entry to the entry after it
+	for (i = 0; i < 3 * (TEST_LOG_SIZE / (TEST_ENTRY_SIZE + sizeof(entry_header))); i++) {
+		HOST_ASSERT(test_event_log_add_checked(TEST_ENTRY_SIZE, &num_checked));
+
+		if (event_log_get_oldest_entry_index() == long_end) {
+			passed_long = 1;
+		}
+	}
+
+	HOST_CHECK(passed_long);
+	HOST_CHECK_EQ(event_log_get_num_failures(), 0);
+	HOST_CHECK(test_event_log_walk(EVENT_LOG_WRAP_INDEX, event_log_get_next_entry_index(), &num_entries));
+}
+
+HOST_TEST(event_log, stale_skip_offset_falls_back_to_walk){
+	u32 num_checked = 0;
+	u32 num_wraps;
+	u32 oldest;
+	u32 next;
+	u32 end;
+	u32 block;
+	u32 stale_index;
+	u32 expected;
+
+	test_event_log_setup();
+	event_log_config_wrap(EVENT_LOG_WRAP_ENABLE);
+
+	while ((event_log_get_num_wraps() == 0) || (event_log_get_next_entry_index() < (TEST_LOG_SIZE / 2))) {
+		HOST_ASSERT(test_event_log_add_checked(TEST_ENTRY_SIZE, &num_checked));
+	}
+
+	// Find an allocation whose end falls in a block with an entry after the oldest entry
+	while (1) {
+		oldest = event_log_get_oldest_entry_index();
+		next   = event_log_get_next_entry_index();
+		end    = next + sizeof(entry_header) + TEST_ENTRY_SIZE;
+		block  = end >> TEST_SKIP_SHIFT;
+
+		if ((TEST_SKIP_INDEX[block] != EVENT_LOG_SKIP_NONE) &&
+		    (((block << TEST_SKIP_SHIFT) + TEST_SKIP_INDEX[block]) > oldest) &&
+		    ((TEST_SKIP_INDEX[block] + sizeof(entry_header) + sizeof(u32)) <= TEST_SKIP_BLOCK_SIZE)) {
+			break;
+		}
+
+		HOST_ASSERT(test_event_log_add_checked(TEST_ENTRY_SIZE, &num_checked));
+	}
+
+	// Point the block at a payload word of its first entry, which is not an entry header
+	stale_index = (block << TEST_SKIP_SHIFT) + TEST_SKIP_INDEX[block] + sizeof(entry_header);
+	*(u32*)(EVENT_LOG_BASE + stale_index) = 0;
+	TEST_SKIP_INDEX[block] = stale_index & (TEST_SKIP_BLOCK_SIZE - 1);
+
+	expected  = test_event_log_ref_oldest(end);
+	num_wraps = event_log_get_num_wraps();
+
+	HOST_ASSERT(test_event_log_add(TEST_ENTRY_SIZE) != NULL);
+
+	// The oldest entry is found by walking the entries, without a log reset
+	HOST_CHECK(expected > oldest);
+	HOST_CHECK_EQ(event_log_get_oldest_entry_index(), expected);
+	HOST_CHECK_EQ(event_log_get_num_wraps(), num_wraps);
+}
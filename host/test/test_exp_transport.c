@@ -0,0 +1,137 @@
+/** @file test_exp_transport.c
+ *  @brief Host tests: WLAN Exp transport frame size and data segment
+ *
+ *  Frames are sent with transport_send_w_data() through the Xilnet stand-in
+ *  (see xilnet_config.h), which records the buffer and length of each frame.
+ */
+
+#include <string.h>
+
+#include "host_test.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_exp_common.h"
+#include "wlan_exp_transport.h"
+#include "xilnet_config.h"
+
+// Message length of an event log response:  pad, response header and the 5 word buffer header
+#define TEST_LOG_MSG_LENGTH   (PAYLOAD_PAD_NBYTES + sizeof(wn_respHdr) + 5*sizeof(u32))
+
+// Data segment, in DRAM where the central DMA can reach it
+#define TEST_DATA             ((u8*)DRAM_BASE)
+
+static wn_host_message test_msg;
+static pktSrcInfo      test_pkt_src;
+
+// Builds a message of msg_length bytes in the send buffer of ETH A, as node responses are
+static void test_msg_init(u32 msg_length){
+	u8*                  buffer = (u8*)eth_device[ETH_A_MAC].sendbuf;
+	wn_transport_header* header = (wn_transport_header*)(buffer + PAYLOAD_OFFSET);
+
+	memset(header, 0, sizeof(wn_transport_header));
+	header->seqNum = 0x1234;
+
+	test_msg.buffer  = buffer;
+	test_msg.payload = (u8*)header + sizeof(wn_transport_header);
+	test_msg.length  = msg_length;
+}
+
+// Length of the Ethernet frame built in the Xilnet send buffer for the last send
+static u32 test_frame_length(void){
+	u32 udp_payload_length;
+
+	host_shim_get_xilnet_send(&udp_payload_length);
+
+	return LINK_HDR_LEN + IP_HDR_LEN*4 + UDP_HDR_LEN + udp_payload_length;
+}
+
+static void test_data_fill(u32 length){
+	u32 i;
+
+	for (i = 0; i < length; i++) {
+		TEST_DATA[i] = (u8)(i * 7 + 1);
+	}
+}
+
+
+HOST_TEST(exp_transport, mtu_follows_jumbo_frames_setting){
+	HOST_CHECK_EQ(TRANSPORT_MTU, WLAN_EXP_JUMBO_FRAMES ? 9000 : 1500);
+	HOST_CHECK_EQ(TRANSPORT_MAX_UDP_PAYLOAD, TRANSPORT_MTU - 28);
+
+	// The stand-in send buffer must hold the largest frame
+	HOST_CHECK(LINK_HDR_LEN + TRANSPORT_MTU <= XILNET_SENDBUF_NBYTES);
+}
+
+HOST_TEST(exp_transport, data_copied_behind_message){
+	u32       data_length = 256;
+	u32       frame_length;
+	const u8* frame;
+	u8*       frame_data;
+
+	test_msg_init(TEST_LOG_MSG_LENGTH);
+	test_data_fill(data_length);
+
+	transport_send_w_data(0, &test_msg, TEST_DATA, data_length, &test_pkt_src, ETH_A_MAC);
+
+	HOST_CHECK_EQ(host_shim_get_stats()->num_transport_send, 1);
+
+	frame = host_shim_get_xilnet_send(&frame_length);
+	HOST_CHECK(frame == test_msg.buffer);
+	HOST_CHECK_EQ(frame_length, sizeof(wn_transport_header) + TEST_LOG_MSG_LENGTH + data_length);
+
+	// The data follows the message in the send buffer, moved by the central DMA
+	frame_data = (u8*)test_msg.buffer + PAYLOAD_OFFSET + sizeof(wn_transport_header) + TEST_LOG_MSG_LENGTH - PAYLOAD_PAD_NBYTES;
+	HOST_CHECK(memcmp(frame_data, TEST_DATA, data_length) == 0);
+	HOST_CHECK_EQ(host_shim_get_stats()->cdma_bytes, data_length);
+
+	// The transport header is restored after the send
+	HOST_CHECK_EQ(((wn_transport_header*)((u8*)test_msg.buffer + PAYLOAD_OFFSET))->seqNum, 0x1234);
+}
+
+HOST_TEST(exp_transport, message_without_data){
+	u32 frame_length;
+
+	test_msg_init(TEST_LOG_MSG_LENGTH);
+
+	transport_send(0, &test_msg, &test_pkt_src, ETH_A_MAC);
+
+	HOST_CHECK_EQ(host_shim_get_stats()->num_transport_send, 1);
+	host_shim_get_xilnet_send(&frame_length);
+	HOST_CHECK_EQ(frame_length, sizeof(wn_transport_header) + TEST_LOG_MSG_LENGTH);
+	HOST_CHECK_EQ(host_shim_get_stats()->cdma_bytes, 0);
+}
+
+HOST_TEST(exp_transport, data_exactly_at_mtu){
+	u32 data_length = TRANSPORT_MAX_DATA_LENGTH(TEST_LOG_MSG_LENGTH);
+
+	test_data_fill(data_length + 1);
+
+	// The largest data segment fills the send buffer exactly:  an IP datagram of TRANSPORT_MTU bytes
+	test_msg_init(TEST_LOG_MSG_LENGTH);
+	transport_send_w_data(0, &test_msg, TEST_DATA, data_length, &test_pkt_src, ETH_A_MAC);
+
+	HOST_CHECK_EQ(host_shim_get_stats()->num_transport_send, 1);
+	HOST_CHECK_EQ(test_frame_length(), LINK_HDR_LEN + TRANSPORT_MTU);
+
+	// One more byte is not sent
+	test_msg_init(TEST_LOG_MSG_LENGTH);
+	transport_send_w_data(0, &test_msg, TEST_DATA, data_length + 1, &test_pkt_src, ETH_A_MAC);
+
+	HOST_CHECK_EQ(host_shim_get_stats()->num_transport_send, 1);
+	HOST_CHECK_EQ(host_shim_get_stats()->cdma_bytes, data_length);
+}
+
+HOST_TEST(exp_transport, message_larger_than_mtu){
+	// A message that fills the frame leaves no room for data
+	test_msg_init(TRANSPORT_MAX_DATA_LENGTH(0));
+	transport_send_w_data(0, &test_msg, TEST_DATA, 1, &test_pkt_src, ETH_A_MAC);
+
+	HOST_CHECK_EQ(host_shim_get_stats()->num_transport_send, 0);
+
+	// The data length bound is unsigned:  a longer message must not wrap it
+	test_msg_init(TRANSPORT_MAX_DATA_LENGTH(0) + 1);
+	transport_send_w_data(0, &test_msg, TEST_DATA, 1, &test_pkt_src, ETH_A_MAC);
+
+	HOST_CHECK_EQ(host_shim_get_stats()->num_transport_send, 0);
+	HOST_CHECK_EQ(host_shim_get_stats()->cdma_bytes, 0);
+}
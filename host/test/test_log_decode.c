@@ -0,0 +1,223 @@
+/** @file test_log_decode.c
+ *  @brief Host tests: compact log entry decoder
+ *
+ *  Logs the same frames with full and with compact entries and checks that
+ *  the decoded compact log matches the full log field for field.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "host_test.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_802_11_defs.h"
+#include "wlan_mac_packet_types.h"
+#include "wlan_mac_misc_util.h"
+#include "wlan_mac_entries.h"
+#include "wlan_mac_event_log.h"
+#include "log_decode.h"
+
+#define TEST_LOG_SIZE          (1024 * 1024)
+#define TEST_NUM_FRAMES        200
+#define TEST_MAX_ENTRIES       (4 * TEST_NUM_FRAMES)
+#define TEST_MAX_ENTRY_LEN     2048
+
+typedef struct {
+	u16   entry_type;
+	u32   entry_length;
+	u32   entry[TEST_MAX_ENTRY_LEN / 4];
+} test_entry;
+
+typedef struct {
+	u32          num_entries;
+	test_entry   entries[TEST_MAX_ENTRIES];
+} test_log;
+
+static test_log test_full;
+static test_log test_compact;
+
+static u32 test_rx_buf[(sizeof(rx_frame_info) + PHY_RX_PKT_BUF_MPDU_OFFSET + 2048) / 4];
+static u32 test_tx_buf[(sizeof(tx_frame_info) + PHY_TX_PKT_BUF_MPDU_OFFSET + 2048) / 4];
+
+static void test_log_callback(u16 entry_type, void* entry, u32 entry_length, void* arg){
+	test_log*   log = (test_log*)arg;
+	test_entry* e;
+
+	// Only the entries both encodings have in common are compared
+	if ((entry_type == ENTRY_TYPE_NODE_INFO) || (entry_type == ENTRY_TYPE_TIME_ANCHOR) || (log->num_entries >= TEST_MAX_ENTRIES)) {
+		return;
+	}
+
+	e               = &(log->entries[log->num_entries++]);
+	e->entry_type   = entry_type;
+	e->entry_length = (entry_length < TEST_MAX_ENTRY_LEN) ? entry_length : TEST_MAX_ENTRY_LEN;
+	memcpy(e->entry, entry, e->entry_length);
+}
+
+// Logs a mix of received, transmitted and retransmitted frames; i selects the variant
+static void test_log_frame(u32 i){
+	rx_frame_info*          rx_mpdu = (rx_frame_info*)test_rx_buf;
+	tx_frame_info*          tx_mpdu = (tx_frame_info*)test_tx_buf;
+	mac_header_80211*       hdr;
+	wlan_mac_low_tx_details tx_low_details;
+	u16                     length  = 40 + (i * 37) % 1400;
+	u32                     j;
+
+	memset(test_rx_buf, 0, sizeof(test_rx_buf));
+	memset(test_tx_buf, 0, sizeof(test_tx_buf));
+
+	// Receive
+	hdr = (mac_header_80211*)((u8*)test_rx_buf + PHY_RX_PKT_BUF_MPDU_OFFSET);
+	hdr->frame_control_1 = MAC_FRAME_CTRL1_SUBTYPE_DATA;
+	hdr->address_2[5]    = i;
+	for (j = sizeof(mac_header_80211); j < length; j++) {
+		((u8*)hdr)[j] = (u8)(i + j);
+	}
+
+	rx_mpdu->state              = (i % 5) ? RX_MPDU_STATE_FCS_GOOD : RX_MPDU_STATE_FCS_BAD;
+	rx_mpdu->ant_mode           = i % 4;
+	rx_mpdu->rx_power           = -30 - (i % 60);
+	rx_mpdu->rf_gain            = i % 3;
+	rx_mpdu->bb_gain            = i % 32;
+	rx_mpdu->phy_details.mcs    = 1 + (i % 7);
+	rx_mpdu->phy_details.length = length;
+	rx_mpdu->timestamp          = 1000000 + (i * 1234);
+
+	wlan_exp_log_create_rx_entry_with_flags(rx_mpdu, 1 + (i % 11), (i % 9) ? WLAN_MAC_MCS_18M : WLAN_MAC_MCS_1M,
+	                                        (i % 3) ? 0 : RX_ENTRY_FLAGS_IS_DUPLICATE);
+
+	// Transmit
+	hdr = (mac_header_80211*)((u8*)test_tx_buf + PHY_TX_PKT_BUF_MPDU_OFFSET);
+	hdr->frame_control_1 = MAC_FRAME_CTRL1_SUBTYPE_DATA;
+	hdr->address_1[5]    = i;
+	for (j = sizeof(mac_header_80211); j < length; j++) {
+		((u8*)hdr)[j] = (u8)(i * j);
+	}
+
+	tx_mpdu->timestamp_create         = 1000500 + (i * 1234);
+	tx_mpdu->delay_accept             = 10 + i;
+	tx_mpdu->delay_done               = 300 + (i * 3);
+	tx_mpdu->unique_seq               = 0x100000000ULL + i;
+	tx_mpdu->high_retry_count         = i % 2;
+	tx_mpdu->tx_result                = (i % 4) ? TX_MPDU_RESULT_SUCCESS : TX_MPDU_RESULT_FAILURE;
+	tx_mpdu->QID                      = i % 8;
+	tx_mpdu->short_retry_count        = 1 + (i % 2);
+	tx_mpdu->num_tx_attempts          = 1 + (i % 2);
+	tx_mpdu->high_retry_status        = i % 4;
+	tx_mpdu->length                   = length;
+	tx_mpdu->params.phy.rate          = 1 + (i % 7);
+	tx_mpdu->params.phy.antenna_mode  = i % 4;
+	tx_mpdu->params.phy.power         = 15 - (i % 20);
+
+	wlan_exp_log_create_tx_entry(tx_mpdu, 1 + (i % 11));
+
+	for (j = 0; j < tx_mpdu->num_tx_attempts; j++) {
+		memset(&tx_low_details, 0, sizeof(tx_low_details));
+		tx_low_details.tx_details_type               = TX_DETAILS_MPDU;
+		tx_low_details.tx_start_delta                = 20 + (j * 100);
+		tx_low_details.mpdu_phy_params.rate          = 1 + ((i + j) % 7);
+		tx_low_details.mpdu_phy_params.antenna_mode  = j;
+		tx_low_details.mpdu_phy_params.power         = 10 - j;
+		tx_low_details.mpdu_phy_params.flags         = j;
+		tx_low_details.num_slots                     = (i % 7) - 1;
+		tx_low_details.cw                            = 15 << j;
+		tx_low_details.chan_num                      = 1 + (i % 11);
+
+		wlan_exp_log_create_tx_low_entry(tx_mpdu, &tx_low_details, 0, j);
+	}
+}
+
+static void test_log_run(u8 compact, test_log* log){
+	u32 i;
+
+	wlan_exp_log_set_entry_en_mask(ENTRY_EN_MASK_TXRX_CTRL | ENTRY_EN_MASK_TXRX_MPDU);
+	wlan_exp_log_reset_entry_policies();
+	wlan_exp_log_set_mac_payload_len(MIN_MAC_PAYLOAD_LOG_LEN + 100);
+	event_log_init((char*)EVENT_LOG_BASE, TEST_LOG_SIZE);
+	wlan_exp_log_set_compact(compact);
+
+	for (i = 0; i < TEST_NUM_FRAMES; i++) {
+		test_log_frame(i);
+	}
+
+	log->num_entries = 0;
+	log_decode_walk((u8*)EVENT_LOG_BASE, event_log_get_next_entry_index(), test_log_callback, log, NULL);
+}
+
+// Offset of the MAC payload in a full entry, or 0 if the entry type has none
+static u32 test_payload_offset(u16 entry_type){
+	switch (entry_type) {
+		case ENTRY_TYPE_RX_OFDM:
+		case ENTRY_TYPE_RX_OFDM_LTG:   return offsetof(rx_ofdm_entry, mac_payload);
+		case ENTRY_TYPE_RX_DSSS:       return offsetof(rx_dsss_entry, mac_payload);
+		case ENTRY_TYPE_TX_HIGH:
+		case ENTRY_TYPE_TX_HIGH_LTG:   return offsetof(tx_high_entry, mac_payload);
+		case ENTRY_TYPE_TX_LOW:
+		case ENTRY_TYPE_TX_LOW_LTG:    return offsetof(tx_low_entry, mac_payload);
+	}
+
+	return 0;
+}
+
+HOST_TEST(log_decode, compact_matches_full){
+	u32         i;
+	u32         offset;
+	u32         log_len_full;
+	u32         log_len_compact;
+	test_entry* full;
+	test_entry* compact;
+
+	test_log_run(0, &test_full);
+	test_log_run(1, &test_compact);
+
+	HOST_ASSERT(test_full.num_entries > TEST_NUM_FRAMES);
+	HOST_ASSERT(test_compact.num_entries == test_full.num_entries);
+
+	for (i = 0; i < test_full.num_entries; i++) {
+		full    = &test_full.entries[i];
+		compact = &test_compact.entries[i];
+		offset  = test_payload_offset(full->entry_type);
+
+		HOST_ASSERT(compact->entry_type == full->entry_type);
+		HOST_ASSERT(offset != 0);
+
+		// Compact entries have no channel estimates; tx_low_entry.reserved is never written
+		if ((full->entry_type == ENTRY_TYPE_RX_OFDM) || (full->entry_type == ENTRY_TYPE_RX_OFDM_LTG)) {
+			memset(((rx_ofdm_entry*)full->entry)->channel_est, 0, sizeof(((rx_ofdm_entry*)full->entry)->channel_est));
+		}
+		if ((full->entry_type == ENTRY_TYPE_TX_LOW) || (full->entry_type == ENTRY_TYPE_TX_LOW_LTG)) {
+			memset(((tx_low_entry*)full->entry)->reserved, 0, sizeof(((tx_low_entry*)full->entry)->reserved));
+		}
+
+		// Every field before mac_payload_log_len is the same
+		HOST_CHECK(memcmp(full->entry, compact->entry, offset - sizeof(u32)) == 0);
+
+		// Full entries zero pad the payload; compact entries only keep the logged bytes
+		log_len_full    = *(u32*)((u8*)full->entry + offset - sizeof(u32));
+		log_len_compact = *(u32*)((u8*)compact->entry + offset - sizeof(u32));
+
+		HOST_CHECK(log_len_compact <= log_len_full);
+		HOST_CHECK(memcmp((u8*)full->entry + offset, (u8*)compact->entry + offset, log_len_compact) == 0);
+	}
+}
+
+HOST_TEST(log_decode, compact_without_anchor_is_skipped){
+	log_decode_stats stats;
+	u32              first_compact;
+	entry_header*    header;
+
+	test_log_run(1, &test_compact);
+
+	// Start the walk at the first compact entry, after its time anchor
+	header = (entry_header*)(EVENT_LOG_BASE + EVENT_LOG_WRAP_INDEX);
+	HOST_ASSERT(header->entry_type == ENTRY_TYPE_TIME_ANCHOR);
+	first_compact = EVENT_LOG_WRAP_INDEX + sizeof(entry_header) + header->entry_length;
+
+	log_decode_walk((u8*)(EVENT_LOG_BASE + first_compact), event_log_get_next_entry_index() - first_compact,
+	                test_log_callback, &test_compact, &stats);
+
+	HOST_CHECK_EQ(stats.num_no_anchor, COMPACT_ANCHOR_INTERVAL);
+	HOST_CHECK_EQ(stats.num_errors, 0);
+	HOST_CHECK(stats.num_compact > 0);
+}
@@ -0,0 +1,416 @@
+/** @file test_ltg.c
+ *  @brief Host tests: local traffic generator
+ */
+
+#include <string.h>
+
+#include "host_test.h"
+
+#include "wlan_mac_802_11_defs.h"
+#include "wlan_mac_high.h"
+#include "wlan_mac_schedule.h"
+#include "wlan_mac_packet_types.h"
+#include "wlan_mac_ltg.h"
+
+static u32 test_num_events;
+static u32 test_last_id;
+static u16 test_trace_lengths[16];
+
+static void test_ltg_callback(u32 id, void* callback_arg){
+	u32   type;
+	void* state;
+
+	// Trace LTGs take the length of each event from its record
+	if ((ltg_sched_get_state(id, &type, &state) == 0) && (type == LTG_SCHED_TYPE_TRACE) &&
+	    (test_num_events < (sizeof(test_trace_lengths) / sizeof(test_trace_lengths[0])))) {
+		test_trace_lengths[test_num_events] = ((ltg_sched_trace_state*)state)->length;
+	}
+
+	test_num_events++;
+	test_last_id = id;
+}
+
+static void test_ltg_setup(void){
+	test_num_events = 0;
+
+	wlan_mac_schedule_init();
+	wlan_mac_schedule_setup_interrupt(host_shim_get_intc());
+	wlan_mac_ltg_sched_init();
+	wlan_mac_ltg_sched_set_callback((void*)test_ltg_callback);
+}
+
+static u32 test_ltg_create_periodic(u32 interval_usec, u64 duration_usec){
+	ltg_sched_periodic_params params;
+	ltg_pyld_fixed*           payload;
+
+	params.interval_usec = interval_usec;
+	params.duration_usec = duration_usec;
+
+	payload = wlan_mac_high_calloc(sizeof(ltg_pyld_fixed));
+	payload->hdr.type = LTG_PYLD_TYPE_FIXED;
+	payload->length   = 100;
+
+	return ltg_sched_create(LTG_SCHED_TYPE_PERIODIC, &params, payload, NULL);
+}
+
+HOST_TEST(ltg, periodic_event_rate){
+	u32 id;
+
+	test_ltg_setup();
+
+	id = test_ltg_create_periodic(1000, LTG_DURATION_FOREVER);
+	HOST_ASSERT(id != LTG_ID_INVALID);
+	HOST_ASSERT(ltg_sched_start(id) == 0);
+
+	host_shim_advance_usec(100000);
+
+	// One event per interval, give or take the first and the one in progress
+	HOST_CHECK(test_num_events >= 99);
+	HOST_CHECK(test_num_events <= 101);
+	HOST_CHECK_EQ(test_last_id, id);
+}
+
+HOST_TEST(ltg, poisson_mean_interval){
+	ltg_sched_poisson_params params;
+	ltg_pyld_fixed*          payload;
+	u32 id;
+
+	test_ltg_setup();
+
+	params.mean_interval_usec = 1000;
+	params.duration_usec      = LTG_DURATION_FOREVER;
+
+	payload = wlan_mac_high_calloc(sizeof(ltg_pyld_fixed));
+	payload->hdr.type = LTG_PYLD_TYPE_FIXED;
+	payload->length   = 100;
+
+	id = ltg_sched_create(LTG_SCHED_TYPE_POISSON, &params, payload, NULL);
+	HOST_ASSERT(id != LTG_ID_INVALID);
+	HOST_ASSERT(ltg_sched_start(id) == 0);
+
+	host_shim_advance_usec(4000000);
+
+	// 4000 events expected; the standard deviation of the count is ~63
+	HOST_CHECK(test_num_events >= 3700);
+	HOST_CHECK(test_num_events <= 4300);
+}
+
+HOST_TEST(ltg, pareto_on_off_mean_periods){
+	ltg_sched_pareto_on_off_params params;
+	ltg_pyld_fixed*                payload;
+	u32   id;
+	u32   type;
+	void* state;
+	u32   num_bursts;
+
+	test_ltg_setup();
+
+	// Shape 3.0: the on and off periods have a finite variance (standard deviation ~0.58 of the mean)
+	params.interval_usec = 100;
+	params.mean_on_usec  = 10000;
+	params.mean_off_usec = 10000;
+	params.shape         = 300;
+	params.duration_usec = LTG_DURATION_FOREVER;
+
+	payload = wlan_mac_high_calloc(sizeof(ltg_pyld_fixed));
+	payload->hdr.type = LTG_PYLD_TYPE_FIXED;
+	payload->length   = 100;
+
+	id = ltg_sched_create(LTG_SCHED_TYPE_PARETO_ON_OFF, &params, payload, NULL);
+	HOST_ASSERT(id != LTG_ID_INVALID);
+	HOST_ASSERT(ltg_sched_start(id) == 0);
+
+	host_shim_advance_usec(5000000);
+
+	HOST_ASSERT(ltg_sched_get_state(id, &type, &state) == 0);
+	num_bursts = ((ltg_sched_pareto_on_off_state*)state)->num_bursts;
+
+	// One burst per 20 ms on/off cycle, with events every 100 usec during the on half
+	HOST_CHECK(num_bursts >= 225);
+	HOST_CHECK(num_bursts <= 275);
+	HOST_CHECK(test_num_events >= 22500);
+	HOST_CHECK(test_num_events <= 27500);
+}
+
+HOST_TEST(ltg, trace_ends_after_num_loops){
+	ltg_trace_record       records[3];
+	ltg_sched_trace_params params;
+	ltg_pyld_trace*        payload;
+	u32   id;
+	u32   i;
+	u32   type;
+	void* state;
+
+	test_ltg_setup();
+
+	memset(records, 0, sizeof(records));
+	for (i = 0; i < 3; i++) {
+		records[i].delta_usec = 1000;
+		records[i].length     = 100 * (i + 1);
+	}
+	HOST_ASSERT(ltg_trace_write(10, 3, records) == 0);
+
+	params.start_index   = 10;
+	params.num_records   = 3;
+	params.num_loops     = 2;
+	params.duration_usec = LTG_DURATION_FOREVER;
+
+	payload = wlan_mac_high_calloc(sizeof(ltg_pyld_trace));
+	payload->hdr.type = LTG_PYLD_TYPE_TRACE;
+
+	id = ltg_sched_create(LTG_SCHED_TYPE_TRACE, &params, payload, NULL);
+	HOST_ASSERT(id != LTG_ID_INVALID);
+	HOST_ASSERT(ltg_sched_start(id) == 0);
+
+	host_shim_advance_usec(100000);
+
+	// Each record is replayed twice, in order, and then the LTG stops itself
+	HOST_CHECK_EQ(test_num_events, 6);
+	for (i = 0; i < 6; i++) {
+		HOST_CHECK_EQ(test_trace_lengths[i], 100 * ((i % 3) + 1));
+	}
+
+	HOST_ASSERT(ltg_sched_get_state(id, &type, &state) == 0);
+	HOST_CHECK_EQ(((ltg_sched_trace_state*)state)->hdr.enabled, 0);
+	HOST_CHECK_EQ(((ltg_sched_trace_state*)state)->num_loops, 2);
+}
+
+HOST_TEST(ltg, stop_halts_events){
+	u32 id;
+	u32 num_events;
+
+	test_ltg_setup();
+
+	id = test_ltg_create_periodic(500, LTG_DURATION_FOREVER);
+	ltg_sched_start(id);
+	host_shim_advance_usec(10000);
+
+	HOST_ASSERT(ltg_sched_stop(id) == 0);
+	num_events = test_num_events;
+	host_shim_advance_usec(10000);
+
+	HOST_CHECK(num_events > 0);
+	HOST_CHECK_EQ(test_num_events, num_events);
+}
+
+static u32 test_stop_id;
+static u32 test_num_stopped_events;
+
+static void test_ltg_stop_callback(u32 id, void* callback_arg){
+	if (id == test_stop_id) {
+		test_num_stopped_events++;
+	} else if (test_num_events == 0) {
+		// The first event of the other LTG stops this one
+		ltg_sched_stop(test_stop_id);
+	}
+
+	test_ltg_callback(id, callback_arg);
+}
+
+HOST_TEST(ltg, callback_stops_ltg_in_same_slot){
+	u32 id_0;
+	u32 id_1;
+
+	test_ltg_setup();
+	wlan_mac_ltg_sched_set_callback((void*)test_ltg_stop_callback);
+	test_num_stopped_events = 0;
+
+	// Equal intervals started together share each wheel slot, id_0 first
+	id_0 = test_ltg_create_periodic(1000, LTG_DURATION_FOREVER);
+	id_1 = test_ltg_create_periodic(1000, LTG_DURATION_FOREVER);
+	test_stop_id = id_1;
+
+	HOST_ASSERT(ltg_sched_start(id_0) == 0);
+	HOST_ASSERT(ltg_sched_start(id_1) == 0);
+	host_shim_advance_usec(10000);
+
+	HOST_CHECK_EQ(test_num_stopped_events, 0);
+	HOST_CHECK(test_num_events >= 9);
+	HOST_CHECK_EQ(test_last_id, id_0);
+}
+
+HOST_TEST(ltg, duration_limits_events){
+	u32 id;
+
+	test_ltg_setup();
+
+	id = test_ltg_create_periodic(1000, 20000);
+	ltg_sched_start(id);
+	host_shim_advance_usec(100000);
+
+	HOST_CHECK(test_num_events >= 19);
+	HOST_CHECK(test_num_events <= 21);
+}
+
+HOST_TEST(ltg, frame_carries_ltg_id){
+	u8  addr_1[6] = {0x02, 0x11, 0x22, 0x33, 0x44, 0x55};
+	u8  addr_2[6] = {0x02, 0x66, 0x77, 0x88, 0x99, 0xAA};
+	u8  frame[256];
+	int length;
+	mac_header_80211_common common;
+	ltg_packet_id* pkt_id;
+
+	test_ltg_setup();
+
+	memset(&common, 0, sizeof(common));
+	common.address_1 = addr_1;
+	common.address_2 = addr_2;
+	common.address_3 = addr_2;
+
+	length = wlan_create_ltg_frame(frame, &common, 0, 7);
+	pkt_id = (ltg_packet_id*)(frame + sizeof(mac_header_80211));
+
+	// The returned length includes the FCS
+	HOST_CHECK_EQ(length, sizeof(mac_header_80211) + sizeof(ltg_packet_id) + WLAN_PHY_FCS_NBYTES);
+	HOST_CHECK_EQ(pkt_id->ltg_id, 7);
+	HOST_CHECK_EQ(wlan_mac_high_pkt_type(frame, length), PKT_TYPE_DATA_ENCAP_LTG);
+}
+
+HOST_TEST(ltg, rx_requires_packet_id_magic){
+	u8  addr_1[6] = {0x02, 0x11, 0x22, 0x33, 0x44, 0x55};
+	u8  addr_2[6] = {0x02, 0x66, 0x77, 0x88, 0x99, 0xAA};
+	u32 rx_buf[(PHY_RX_PKT_BUF_MPDU_OFFSET + 256) / 4];
+	rx_frame_info*  rx_mpdu = (rx_frame_info*)rx_buf;
+	u8*             frame   = (u8*)rx_buf + PHY_RX_PKT_BUF_MPDU_OFFSET;
+	ltg_packet_id*  pkt_id  = (ltg_packet_id*)(frame + sizeof(mac_header_80211));
+	mac_header_80211_common common;
+
+	test_ltg_setup();
+	ltg_rx_stats_set_enable(1);
+	ltg_rx_stats_reset();
+
+	memset(rx_buf, 0, sizeof(rx_buf));
+	memset(&common, 0, sizeof(common));
+	common.address_1 = addr_1;
+	common.address_2 = addr_2;
+	common.address_3 = addr_2;
+
+	rx_mpdu->state              = RX_MPDU_STATE_FCS_GOOD;
+	rx_mpdu->phy_details.length = wlan_create_ltg_frame(frame, &common, 0, 3);
+
+	HOST_CHECK_EQ(pkt_id->magic, LTG_PACKET_ID_MAGIC);
+
+	// A frame from an older node has payload bytes in place of magic, ltg_seq and timestamp
+	pkt_id->magic = 0;
+	ltg_rx_process(rx_buf);
+	HOST_CHECK_EQ(ltg_rx_stats_num_flows(), 0);
+
+	pkt_id->magic = LTG_PACKET_ID_MAGIC;
+	ltg_rx_process(rx_buf);
+	HOST_CHECK_EQ(ltg_rx_stats_num_flows(), 1);
+}
+
+// Builds a received LTG frame of the given LTG in rx_buf
+static ltg_packet_id* test_ltg_rx_frame(u32* rx_buf, u32 rx_buf_size, u32 ltg_id){
+	u8  addr_1[6] = {0x02, 0x11, 0x22, 0x33, 0x44, 0x55};
+	u8  addr_2[6] = {0x02, 0x66, 0x77, 0x88, 0x99, 0xAA};
+	rx_frame_info*  rx_mpdu = (rx_frame_info*)rx_buf;
+	u8*             frame   = (u8*)rx_buf + PHY_RX_PKT_BUF_MPDU_OFFSET;
+	mac_header_80211_common common;
+
+	memset(rx_buf, 0, rx_buf_size);
+	memset(&common, 0, sizeof(common));
+	common.address_1 = addr_1;
+	common.address_2 = addr_2;
+	common.address_3 = addr_2;
+
+	rx_mpdu->state              = RX_MPDU_STATE_FCS_GOOD;
+	rx_mpdu->phy_details.length = wlan_create_ltg_frame(frame, &common, 0, ltg_id);
+
+	return (ltg_packet_id*)(frame + sizeof(mac_header_80211));
+}
+
+// Receives the frame built by test_ltg_rx_frame() with the given ltg_seq, delay_usec after it was sent
+static void test_ltg_rx(u32* rx_buf, ltg_packet_id* pkt_id, u32 ltg_seq, u32 delay_usec){
+	pkt_id->ltg_seq   = ltg_seq;
+	pkt_id->timestamp = get_usec_timestamp() - delay_usec;
+
+	ltg_rx_process(rx_buf);
+}
+
+HOST_TEST(ltg, rx_counts_loss_duplicates_and_reordering){
+	u32 rx_buf[(PHY_RX_PKT_BUF_MPDU_OFFSET + 256) / 4];
+	u32 seq[] = {0, 1, 2, 4, 3, 3, 7, 5, 5};
+	u32 i;
+	u32 ltg_id;
+	u8  addr_src[6];
+	ltg_packet_id*    pkt_id;
+	ltg_rx_flow_stats stats;
+
+	test_ltg_setup();
+	ltg_rx_stats_set_enable(1);
+	ltg_rx_stats_reset();
+	host_shim_advance_usec(1000000);
+
+	pkt_id = test_ltg_rx_frame(rx_buf, sizeof(rx_buf), 5);
+
+	// 3 arrives late and fills its gap, 3 and 5 are repeated, 6 is never received
+	for (i = 0; i < (sizeof(seq) / sizeof(seq[0])); i++) {
+		test_ltg_rx(rx_buf, pkt_id, seq[i], 100);
+	}
+
+	HOST_ASSERT(ltg_rx_stats_get(0, addr_src, &ltg_id, &stats) == 0);
+	HOST_CHECK_EQ(ltg_id, 5);
+	HOST_CHECK_EQ(stats.num_rx, 9);
+	HOST_CHECK_EQ(stats.num_dup, 2);
+	HOST_CHECK_EQ(stats.num_reorder, 2);
+	HOST_CHECK_EQ(stats.num_lost, 1);
+
+	// 8 to 99 are missing; 10 is then too far behind the window to fill its gap
+	test_ltg_rx(rx_buf, pkt_id, 100, 100);
+	test_ltg_rx(rx_buf, pkt_id, 10, 100);
+
+	HOST_ASSERT(ltg_rx_stats_get(0, addr_src, &ltg_id, &stats) == 0);
+	HOST_CHECK_EQ(stats.num_lost, 93);
+	HOST_CHECK_EQ(stats.num_reorder, 3);
+	HOST_CHECK_EQ(stats.num_dup, 2);
+
+	// Flows are per LTG
+	pkt_id = test_ltg_rx_frame(rx_buf, sizeof(rx_buf), 6);
+	test_ltg_rx(rx_buf, pkt_id, 50, 100);
+
+	HOST_CHECK_EQ(ltg_rx_stats_num_flows(), 2);
+	HOST_ASSERT(ltg_rx_stats_get(1, addr_src, &ltg_id, &stats) == 0);
+	HOST_CHECK_EQ(ltg_id, 6);
+	HOST_CHECK_EQ(stats.num_rx, 1);
+	HOST_CHECK_EQ(stats.num_lost, 0);
+}
+
+HOST_TEST(ltg, rx_delay_percentiles){
+	u32 rx_buf[(PHY_RX_PKT_BUF_MPDU_OFFSET + 256) / 4];
+	u32 i;
+	u32 ltg_id;
+	u8  addr_src[6];
+	ltg_packet_id*    pkt_id;
+	ltg_rx_flow_stats stats;
+
+	test_ltg_setup();
+	ltg_rx_stats_set_enable(1);
+	ltg_rx_stats_reset();
+	host_shim_advance_usec(1000000);
+
+	pkt_id = test_ltg_rx_frame(rx_buf, sizeof(rx_buf), 5);
+
+	// Delays of 100, 200, ... 10000 usec, received with each pair of frames swapped
+	for (i = 0; i < 100; i++) {
+		test_ltg_rx(rx_buf, pkt_id, i ^ 1, 100 * (1 + (i ^ 1)));
+	}
+
+	// A duplicate is not a new delay sample
+	test_ltg_rx(rx_buf, pkt_id, 99, 500000);
+
+	HOST_ASSERT(ltg_rx_stats_get(0, addr_src, &ltg_id, &stats) == 0);
+	HOST_CHECK_EQ(stats.num_rx, 101);
+	HOST_CHECK_EQ(stats.num_dup, 1);
+	HOST_CHECK_EQ(stats.num_reorder, 50);
+	HOST_CHECK_EQ(stats.num_lost, 0);
+	HOST_CHECK_EQ(stats.delay_min, 100);
+	HOST_CHECK_EQ(stats.delay_max, 10000);
+	HOST_CHECK_EQ(stats.delay_avg, 5050);
+
+	// Percentiles are within 1/8 of the true value (see LTG_RX_DELAY_SUB_BINS_LOG2)
+	HOST_CHECK((stats.delay_p50 >= (5000 - 5000 / 8)) && (stats.delay_p50 <= (5000 + 5000 / 8)));
+	HOST_CHECK((stats.delay_p90 >= (9000 - 9000 / 8)) && (stats.delay_p90 <= (9000 + 9000 / 8)));
+	HOST_CHECK((stats.delay_p99 >= (9900 - 9900 / 8)) && (stats.delay_p99 <= (9900 + 9900 / 8)));
+	HOST_CHECK(stats.delay_p50 < stats.delay_p90);
+}
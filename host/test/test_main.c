@@ -0,0 +1,94 @@
+/** @file test_main.c
+ *  @brief Unit test runner for the host build
+ *
+ *  Usage: wlan_mac_host_tests [suite[.test]]
+ *
+ *  Runs every registered test, or only those of the given suite / test.
+ *  Returns non-zero if any test failed.  Set HOST_SHIM_VERBOSE to see the
+ *  framework's xil_printf output.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+static host_test_case*  test_list;
+static host_test_case** test_list_tail = &test_list;
+static u32              test_num_failures;
+
+void host_test_register(host_test_case* test){
+	// Keep tests in the order they appear in each file
+	*test_list_tail = test;
+	test_list_tail  = &(test->next);
+}
+
+void host_test_fail(const char* file, int line, const char* expr){
+	printf("    %s:%d: check failed: %s\n", file, line, expr);
+	test_num_failures++;
+}
+
+void host_test_fail_eq(const char* file, int line, const char* a_expr, const char* b_expr, long long a, long long b){
+	printf("    %s:%d: check failed: %s == %s (%lld != %lld)\n", file, line, a_expr, b_expr, a, b);
+	test_num_failures++;
+}
+
+static int test_selected(host_test_case* test, const char* filter){
+	char   full_name[256];
+	size_t len;
+
+	if (filter == NULL) {
+		return 1;
+	}
+
+	snprintf(full_name, sizeof(full_name), "%s.%s", test->suite, test->name);
+
+	if (strcmp(filter, full_name) == 0) {
+		return 1;
+	}
+
+	len = strlen(test->suite);
+
+	return (strlen(filter) == len) && (strncmp(filter, test->suite, len) == 0);
+}
+
+int main(int argc, char** argv){
+	host_test_case* test;
+	const char*     filter     = (argc > 1) ? argv[1] : NULL;
+	u32             num_run    = 0;
+	u32             num_failed = 0;
+	u32             failures_before;
+
+	for (test = test_list; test != NULL; test = test->next) {
+		if (test_selected(test, filter) == 0) {
+			continue;
+		}
+
+		host_shim_init();
+		host_shim_set_verbose(getenv("HOST_SHIM_VERBOSE") != NULL);
+
+		failures_before = test_num_failures;
+
+		printf("[ RUN  ] %s.%s\n", test->suite, test->name);
+		test->fn();
+
+		if (test_num_failures != failures_before) {
+			printf("[ FAIL ] %s.%s\n", test->suite, test->name);
+			num_failed++;
+		} else {
+			printf("[  OK  ] %s.%s\n", test->suite, test->name);
+		}
+
+		num_run++;
+	}
+
+	printf("%u tests run, %u failed\n", num_run, num_failed);
+
+	if (num_run == 0) {
+		printf("No tests match '%s'\n", filter ? filter : "");
+		return 1;
+	}
+
+	return (num_failed != 0);
+}
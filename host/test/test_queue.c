@@ -0,0 +1,594 @@
+/** @file test_queue.c
+ *  @brief Host tests: Tx queue
+ */
+
+#include <string.h>
+
+#include "host_test.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_queue.h"
+#include "wlan_mac_802_11_defs.h"
+#include "wlan_mac_eth_util.h"
+
+// Checks out an entry for a frame of the given length, tagged with id in its first frame byte
+static tx_queue_element* test_packet(u32 length, u8 ac, u8 id){
+	tx_queue_element* tqe = queue_checkout_sized(length);
+	tx_queue_buffer*  buffer;
+
+	if (tqe != NULL) {
+		buffer = queue_element_buffer(tqe);
+		buffer->metadata.metadata_type = QUEUE_METADATA_TYPE_IGNORE;
+		buffer->metadata.ac            = ac;
+		buffer->frame_info.length      = length;
+		buffer->frame[0]               = id;
+	}
+
+	return tqe;
+}
+
+static u8 test_packet_id(tx_queue_element* tqe){
+	return queue_element_buffer(tqe)->frame[0];
+}
+
+HOST_TEST(queue, init_all_free){
+	queue_init(1);
+
+	HOST_CHECK(queue_total_size() > 0);
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size());
+	HOST_CHECK_EQ(queue_num_active(), 0);
+}
+
+HOST_TEST(queue, fifo_per_queue){
+	u32 i;
+	tx_queue_element* tqe;
+
+	queue_init(1);
+
+	for (i = 0; i < 10; i++) {
+		HOST_ASSERT(enqueue_after_tail(1 + (i % 2), test_packet(100, QUEUE_AC_BE, i)) == 0);
+	}
+
+	HOST_CHECK_EQ(queue_num_queued(1), 5);
+	HOST_CHECK_EQ(queue_num_queued(2), 5);
+	HOST_CHECK_EQ(queue_num_active(), 2);
+
+	for (i = 0; i < 10; i += 2) {
+		tqe = dequeue_from_head(1);
+		HOST_ASSERT(tqe != NULL);
+		HOST_CHECK_EQ(test_packet_id(tqe), i);
+		queue_checkin(tqe);
+	}
+
+	HOST_CHECK(dequeue_from_head(1) == NULL);
+	HOST_CHECK_EQ(queue_num_active(), 1);
+	HOST_CHECK(dequeue_from_head(100) == NULL);
+}
+
+HOST_TEST(queue, strict_ac_priority){
+	tx_queue_element* tqe;
+
+	queue_init(1);
+
+	enqueue_after_tail(1, test_packet(100, QUEUE_AC_BK, 1));
+	enqueue_after_tail(1, test_packet(100, QUEUE_AC_BE, 2));
+	enqueue_after_tail(1, test_packet(100, QUEUE_AC_VO, 3));
+	enqueue_after_tail(1, test_packet(100, QUEUE_AC_VI, 4));
+
+	tqe = dequeue_from_head(1); HOST_CHECK_EQ(test_packet_id(tqe), 3); queue_checkin(tqe);
+	tqe = dequeue_from_head(1); HOST_CHECK_EQ(test_packet_id(tqe), 4); queue_checkin(tqe);
+	tqe = dequeue_from_head(1); HOST_CHECK_EQ(test_packet_id(tqe), 2); queue_checkin(tqe);
+	tqe = dequeue_from_head(1); HOST_CHECK_EQ(test_packet_id(tqe), 1); queue_checkin(tqe);
+}
+
+HOST_TEST(queue, sized_checkout_uses_small_buffers){
+	tx_queue_element* small;
+	tx_queue_element* large;
+
+	queue_init(1);
+
+	small = queue_checkout_sized(64);
+	large = queue_checkout_sized(1500);
+
+	HOST_ASSERT((small != NULL) && (large != NULL));
+	HOST_CHECK(queue_frame_capacity(small) >= 64);
+	HOST_CHECK(queue_frame_capacity(small) < queue_frame_capacity(large));
+	HOST_CHECK(queue_frame_capacity(large) >= 1500);
+
+	queue_checkin(small);
+	queue_checkin(large);
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size());
+}
+
+HOST_TEST(queue, element_data_is_element_buffer){
+	tx_queue_element* small;
+	tx_queue_element* large;
+
+	queue_init(1);
+
+	small = queue_checkout_sized(64);
+	large = queue_checkout_sized(1500);
+	HOST_ASSERT((small != NULL) && (large != NULL));
+
+	// Replaces tqe->data of the dl_entry based element
+	HOST_CHECK(queue_element_data(small) == (void*)queue_element_buffer(small));
+	HOST_CHECK(queue_element_data(large) == (void*)queue_element_buffer(large));
+	HOST_CHECK(((tx_queue_buffer*)queue_element_data(large))->frame == queue_element_buffer(large)->frame);
+
+	queue_checkin(small);
+	queue_checkin(large);
+}
+
+HOST_TEST(queue, unsized_checkout_keeps_full_size_capacity){
+	tx_queue_list list;
+	u32           num_checkout;
+
+	queue_init(1);
+
+	// queue_checkout() callers get as many full size buffers as before there were size classes
+	HOST_CHECK_EQ(queue_num_free(), QUEUE_BUFFER_NUM_LARGE);
+	HOST_CHECK(queue_num_free_sized(0) > QUEUE_BUFFER_NUM_LARGE);
+
+	queue_list_init(&list);
+	num_checkout = queue_checkout_list(&list, QUEUE_BUFFER_NUM_LARGE + 1);
+
+	HOST_CHECK_EQ(num_checkout, QUEUE_BUFFER_NUM_LARGE);
+	HOST_CHECK_EQ(queue_num_free(), 0);
+	HOST_CHECK(queue_checkout() == NULL);
+
+	// Smaller frames still fit the other size classes
+	HOST_CHECK(queue_checkout_sized(64) != NULL);
+	HOST_CHECK(queue_checkout_sized(1500) != NULL);
+}
+
+HOST_TEST(queue, purge_returns_entries){
+	u32 i;
+
+	queue_init(1);
+
+	for (i = 0; i < 20; i++) {
+		enqueue_after_tail(7, test_packet((i % 2) ? 1500 : 64, QUEUE_AC_BE, i));
+	}
+
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size() - 20);
+
+	purge_queue(7);
+
+	HOST_CHECK_EQ(queue_num_queued(7), 0);
+	HOST_CHECK_EQ(queue_num_active(), 0);
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size());
+}
+
+HOST_TEST(queue, transmit_checkin){
+	queue_init(1);
+
+	enqueue_after_tail(3, test_packet(200, QUEUE_AC_BE, 0));
+	enqueue_after_tail(3, test_packet(200, QUEUE_AC_BE, 1));
+
+	HOST_CHECK(dequeue_transmit_checkin(3) != 0);
+	HOST_CHECK_EQ(host_shim_get_stats()->num_mpdu_transmit, 1);
+	HOST_CHECK_EQ(queue_num_queued(3), 1);
+}
+
+HOST_TEST(queue, enqueue_before_head_is_next){
+	tx_queue_element* tqe;
+
+	queue_init(1);
+
+	enqueue_after_tail(4, test_packet(100, QUEUE_AC_BE, 1));
+	enqueue_after_tail(4, test_packet(100, QUEUE_AC_BE, 2));
+	HOST_ASSERT(enqueue_before_head(4, test_packet(100, QUEUE_AC_BE, 3)) == 0);
+
+	HOST_CHECK_EQ(queue_num_queued(4), 3);
+
+	tqe = dequeue_from_head(4); HOST_CHECK_EQ(test_packet_id(tqe), 3); queue_checkin(tqe);
+	tqe = dequeue_from_head(4); HOST_CHECK_EQ(test_packet_id(tqe), 1); queue_checkin(tqe);
+	tqe = dequeue_from_head(4); HOST_CHECK_EQ(test_packet_id(tqe), 2); queue_checkin(tqe);
+
+	// Returning a packet to an empty queue makes the queue active again
+	HOST_CHECK_EQ(queue_num_active(), 0);
+	HOST_ASSERT(enqueue_before_head(9, test_packet(100, QUEUE_AC_VO, 4)) == 0);
+	HOST_CHECK_EQ(queue_num_active(), 1);
+	HOST_CHECK_EQ(queue_num_queued_ac(9, QUEUE_AC_VO), 1);
+}
+
+// Transmits the head of queue_sel and reports the given result for it, as CPU Low would
+//  Returns the high_retry_status written by queue_tx_done(), or 0xFF if nothing was transmitted
+static u8 test_tx_done(u16 queue_sel, u8 tx_result){
+	tx_frame_info tx_mpdu;
+
+	if (dequeue_transmit_checkin(queue_sel) != 1) {
+		return 0xFF;
+	}
+
+	memset(&tx_mpdu, 0, sizeof(tx_mpdu));
+	tx_mpdu.tx_result = tx_result;
+	queue_tx_done(0, &tx_mpdu);
+
+	return tx_mpdu.high_retry_status;
+}
+
+HOST_TEST(queue, tx_done_disabled_frees_entry){
+	tx_frame_info tx_mpdu;
+
+	queue_init(1);
+
+	HOST_CHECK_EQ(queue_retry_get_max(), QUEUE_RETRY_MAX_DISABLED);
+
+	enqueue_after_tail(3, test_packet(200, QUEUE_AC_BE, 0));
+	HOST_ASSERT(dequeue_transmit_checkin(3) == 1);
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size());
+
+	// Nothing is pending, so a failure is not retried
+	memset(&tx_mpdu, 0xFF, sizeof(tx_mpdu));
+	tx_mpdu.tx_result = TX_MPDU_RESULT_FAILURE;
+	queue_tx_done(0, &tx_mpdu);
+
+	HOST_CHECK_EQ(tx_mpdu.high_retry_status, TX_HIGH_RETRY_NONE);
+	HOST_CHECK_EQ(queue_num_queued(3), 0);
+}
+
+HOST_TEST(queue, tx_done_success_frees_entry){
+	tx_frame_info tx_mpdu;
+
+	queue_init(1);
+	HOST_ASSERT(queue_retry_config(2, QUEUE_RETRY_AGE_LIMIT_DEFAULT) == 0);
+
+	enqueue_after_tail(3, test_packet(200, QUEUE_AC_BE, 0));
+
+	// The entry is held until CPU Low reports the transmission done
+	HOST_ASSERT(dequeue_transmit_checkin(3) == 1);
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size() - 1);
+	HOST_CHECK_EQ(queue_num_active(), 0);
+
+	memset(&tx_mpdu, 0xFF, sizeof(tx_mpdu));
+	tx_mpdu.tx_result = TX_MPDU_RESULT_SUCCESS;
+	queue_tx_done(0, &tx_mpdu);
+
+	HOST_CHECK_EQ(tx_mpdu.high_retry_status, TX_HIGH_RETRY_NONE);
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size());
+}
+
+HOST_TEST(queue, tx_done_requeues_until_exhausted){
+	tx_queue_element* tqe;
+	tx_queue_buffer*  buffer;
+
+	queue_init(1);
+	HOST_CHECK_EQ(queue_retry_config(0x100, QUEUE_RETRY_AGE_LIMIT_DEFAULT), -1);
+	HOST_ASSERT(queue_retry_config(2, QUEUE_RETRY_AGE_LIMIT_DEFAULT) == 0);
+
+	tqe    = test_packet(200, QUEUE_AC_BE, 1);
+	buffer = queue_element_buffer(tqe);
+	buffer->frame_info.timestamp_create = get_usec_timestamp();
+
+	enqueue_after_tail(3, tqe);
+	enqueue_after_tail(3, test_packet(200, QUEUE_AC_BE, 2));
+
+	// Each failure returns the packet to the head of its queue until its retry budget is used
+	HOST_CHECK_EQ(test_tx_done(3, TX_MPDU_RESULT_FAILURE), TX_HIGH_RETRY_REQUEUED);
+	HOST_CHECK_EQ(queue_num_queued(3), 2);
+	HOST_CHECK_EQ(buffer->frame_info.high_retry_count, 1);
+
+	HOST_CHECK_EQ(test_tx_done(3, TX_MPDU_RESULT_FAILURE), TX_HIGH_RETRY_REQUEUED);
+	HOST_CHECK_EQ(queue_num_queued(3), 2);
+	HOST_CHECK_EQ(buffer->frame_info.high_retry_count, 2);
+
+	HOST_CHECK_EQ(test_tx_done(3, TX_MPDU_RESULT_FAILURE), TX_HIGH_RETRY_EXHAUSTED);
+	HOST_CHECK_EQ(queue_num_queued(3), 1);
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size() - 1);
+
+	// The next packet starts with a full budget
+	tqe = dequeue_from_head(3);
+	HOST_ASSERT(tqe != NULL);
+	HOST_CHECK_EQ(test_packet_id(tqe), 2);
+	queue_checkin(tqe);
+}
+
+HOST_TEST(queue, tx_done_drops_expired){
+	tx_queue_element* tqe;
+
+	queue_init(1);
+	HOST_ASSERT(queue_retry_config(5, 1000) == 0);
+	HOST_CHECK_EQ(queue_retry_get_age_limit(), 1000);
+
+	tqe = test_packet(200, QUEUE_AC_BE, 1);
+	queue_element_buffer(tqe)->frame_info.timestamp_create = get_usec_timestamp();
+	enqueue_after_tail(3, tqe);
+
+	host_shim_advance_usec(500);
+	HOST_CHECK_EQ(test_tx_done(3, TX_MPDU_RESULT_FAILURE), TX_HIGH_RETRY_REQUEUED);
+	HOST_CHECK_EQ(queue_num_queued(3), 1);
+
+	// Older than the age limit: dropped although retries remain
+	host_shim_advance_usec(600);
+	HOST_CHECK_EQ(test_tx_done(3, TX_MPDU_RESULT_FAILURE), TX_HIGH_RETRY_EXPIRED);
+	HOST_CHECK_EQ(queue_num_queued(3), 0);
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size());
+}
+
+HOST_TEST(queue, tx_done_drops_purged){
+	tx_frame_info tx_mpdu;
+
+	queue_init(1);
+	HOST_ASSERT(queue_retry_config(5, QUEUE_RETRY_AGE_LIMIT_DEFAULT) == 0);
+
+	enqueue_after_tail(3, test_packet(200, QUEUE_AC_BE, 1));
+	HOST_ASSERT(dequeue_transmit_checkin(3) == 1);
+
+	// The queue is purged while its packet is with CPU Low
+	purge_queue(3);
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size());
+
+	// The failed packet cannot be re-enqueued and is reported as dropped
+	memset(&tx_mpdu, 0, sizeof(tx_mpdu));
+	tx_mpdu.tx_result = TX_MPDU_RESULT_FAILURE;
+	queue_tx_done(0, &tx_mpdu);
+
+	HOST_CHECK_EQ(tx_mpdu.high_retry_status, TX_HIGH_RETRY_DROPPED);
+	HOST_CHECK_EQ(queue_num_queued(3), 0);
+	HOST_CHECK_EQ(queue_num_active(), 0);
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size());
+
+	// The next packet through the same buffer is handled normally
+	enqueue_after_tail(3, test_packet(200, QUEUE_AC_BE, 2));
+	HOST_CHECK_EQ(test_tx_done(3, TX_MPDU_RESULT_SUCCESS), TX_HIGH_RETRY_NONE);
+	HOST_CHECK_EQ(queue_num_free_sized(0), queue_total_size());
+}
+
+HOST_TEST(queue, share_disabled_by_default){
+	tx_queue_element* tqe;
+	tx_queue_stats    stats;
+
+	queue_init(1);
+
+	HOST_CHECK_EQ(queue_share_get_alpha(), QUEUE_SHARE_ALPHA_DISABLED);
+
+	// A single backlogged queue may use the whole pool
+	while ((tqe = test_packet(64, QUEUE_AC_BE, 0)) != NULL) {
+		HOST_ASSERT(enqueue_after_tail(1, tqe) == 0);
+	}
+
+	HOST_CHECK_EQ(queue_num_free_sized(0), 0);
+	HOST_CHECK_EQ(queue_num_queued(1), queue_total_size());
+
+	HOST_ASSERT(queue_get_stats(1, &stats) == 0);
+	HOST_CHECK_EQ(stats.num_share_drops, 0);
+}
+
+HOST_TEST(queue, share_drop_keeps_drr_deficit){
+	u32 i;
+	u32 num_turn;
+
+	queue_init(1);
+	queue_set_drr_quantum(1, 3000);
+	queue_set_drr_quantum(2, 3000);
+
+	for (i = 0; i < 6; i++) {
+		HOST_ASSERT(enqueue_after_tail(1, test_packet(1000, QUEUE_AC_BE, i)) == 0);
+	}
+	HOST_ASSERT(enqueue_after_tail(2, test_packet(1000, QUEUE_AC_BE, 100)) == 0);
+
+	// Queue 1 takes the turn with 3000 bytes of deficit and sends one packet
+	HOST_ASSERT(queue_drr_select() == 1);
+	queue_checkin(dequeue_from_head(1));
+
+	// The share policy head-drops one of queue 1's packets to admit a packet to queue 2
+	HOST_ASSERT(queue_share_config(64, queue_total_size()) == 0);
+	HOST_ASSERT(enqueue_after_tail(2, test_packet(1000, QUEUE_AC_BE, 101)) == 0);
+	HOST_ASSERT(queue_share_config(QUEUE_SHARE_ALPHA_DISABLED, 0) == 0);
+	HOST_CHECK_EQ(queue_num_queued(1), 4);
+
+	// The dropped packet was not sent, so queue 1 keeps the turn for the rest of its deficit
+	for (num_turn = 0; queue_drr_select() == 1; num_turn++) {
+		queue_checkin(dequeue_from_head(1));
+	}
+
+	HOST_CHECK_EQ(num_turn, 2);
+}
+
+HOST_TEST(queue, share_drops_from_longest_queue){
+	u32 i;
+	u32 num_free;
+	tx_queue_stats stats_1;
+	tx_queue_stats stats_2;
+
+	queue_init(1);
+
+	// Queues 1 and 2 are equally long; queue 2 stays idle while queue 3 receives packets
+	for (i = 0; i < 20; i++) {
+		HOST_ASSERT(enqueue_after_tail(1, test_packet(64, QUEUE_AC_BE, 1)) == 0);
+		HOST_ASSERT(enqueue_after_tail(2, test_packet(64, QUEUE_AC_BE, 2)) == 0);
+	}
+
+	num_free = queue_num_free_sized(0);
+	HOST_ASSERT(queue_share_config(64, num_free) == 0);
+
+	// Every arrival to queue 3 is below the reserve, so a longest queue gives up an entry for it
+	for (i = 0; i < 10; i++) {
+		HOST_ASSERT(enqueue_after_tail(3, test_packet(64, QUEUE_AC_BE, 3)) == 0);
+
+		// Head drops follow the longest queue, not only the one found when the pool ran low
+		HOST_CHECK(queue_num_queued(1) <= queue_num_queued(2) + 1);
+		HOST_CHECK(queue_num_queued(2) <= queue_num_queued(1) + 1);
+	}
+
+	HOST_CHECK_EQ(queue_num_queued(1) + queue_num_queued(2), 30);
+	HOST_CHECK_EQ(queue_num_queued(3), 10);
+
+	HOST_ASSERT(queue_get_stats(1, &stats_1) == 0);
+	HOST_ASSERT(queue_get_stats(2, &stats_2) == 0);
+	HOST_CHECK_EQ(stats_1.num_share_drops + stats_2.num_share_drops, 10);
+
+	// Once queue 3 would be the longest, its own arrivals are refused
+	for (i = 0; i < 10; i++) {
+		enqueue_after_tail(3, test_packet(64, QUEUE_AC_BE, 3));
+	}
+	HOST_CHECK(queue_num_queued(3) <= queue_num_queued(1) + 1);
+	HOST_CHECK(queue_num_queued(3) <= queue_num_queued(2) + 1);
+
+	HOST_ASSERT(queue_share_config(QUEUE_SHARE_ALPHA_DISABLED, 0) == 0);
+}
+
+#define TEST_DRR_NUM_SELECTS  400
+
+HOST_TEST(queue, drr_byte_fair_across_packet_sizes){
+	u32 i;
+	u32 queue_sel;
+	u32 length;
+	u32 num_bytes[3] = { 0 };
+	u32 num_pkts[3]  = { 0 };
+	u32 pkt_len[3]   = { 0, 1500, 100 };
+
+	queue_init(1);
+
+	// Queue 1 sends full-size packets and queue 2 small ones; both keep a backlog of 4 packets
+	for (i = 0; i < 4; i++) {
+		HOST_ASSERT(enqueue_after_tail(1, test_packet(pkt_len[1], QUEUE_AC_BE, 1)) == 0);
+		HOST_ASSERT(enqueue_after_tail(2, test_packet(pkt_len[2], QUEUE_AC_BE, 2)) == 0);
+	}
+
+	for (i = 0; i < TEST_DRR_NUM_SELECTS; i++) {
+		queue_sel = queue_drr_select();
+		HOST_ASSERT((queue_sel == 1) || (queue_sel == 2));
+
+		length = pkt_len[queue_sel];
+		queue_checkin(dequeue_from_head(queue_sel));
+		num_bytes[queue_sel] += length;
+		num_pkts[queue_sel]++;
+
+		HOST_ASSERT(enqueue_after_tail(queue_sel, test_packet(length, QUEUE_AC_BE, queue_sel)) == 0);
+	}
+
+	// Equal quanta give each queue the same bytes, to within one quantum and one packet
+	HOST_CHECK(num_bytes[1] + QUEUE_DRR_QUANTUM_DEFAULT + pkt_len[1] >= num_bytes[2]);
+	HOST_CHECK(num_bytes[2] + QUEUE_DRR_QUANTUM_DEFAULT + pkt_len[1] >= num_bytes[1]);
+
+	// ... so the queue of small packets sends many more of them
+	HOST_CHECK(num_pkts[2] > 10 * num_pkts[1]);
+}
+
+HOST_TEST(queue, active_bitmap_tracks_non_empty_queues){
+	tx_queue_element* tqe;
+
+	queue_init(1);
+	HOST_CHECK_EQ(queue_drr_select(), QUEUE_SEL_NONE);
+
+	// Queues in different bitmap words
+	HOST_ASSERT(enqueue_after_tail(3, test_packet(100, QUEUE_AC_BE, 3)) == 0);
+	HOST_ASSERT(enqueue_after_tail(40, test_packet(100, QUEUE_AC_BE, 40)) == 0);
+	HOST_ASSERT(enqueue_after_tail(40, test_packet(100, QUEUE_AC_BE, 41)) == 0);
+	HOST_CHECK_EQ(queue_num_active(), 2);
+
+	// Selection wraps around the bitmap and skips the empty queues in between
+	HOST_CHECK_EQ(queue_drr_select(), 3);
+	queue_checkin(dequeue_from_head(3));
+	HOST_CHECK_EQ(queue_num_active(), 1);
+	HOST_CHECK_EQ(queue_drr_select(), 40);
+	HOST_CHECK_EQ(queue_drr_select(), 40);
+
+	// Entries placed at the head of an empty queue set its bit again
+	tqe = test_packet(100, QUEUE_AC_BE, 4);
+	HOST_ASSERT(enqueue_before_head(3, tqe) == 0);
+	HOST_CHECK_EQ(queue_num_active(), 2);
+
+	// Purging a queue clears its bit
+	purge_queue(40);
+	HOST_CHECK_EQ(queue_num_active(), 1);
+	HOST_CHECK_EQ(queue_drr_select(), 3);
+
+	queue_checkin(dequeue_from_head(3));
+	HOST_CHECK_EQ(queue_num_active(), 0);
+	HOST_CHECK_EQ(queue_drr_select(), QUEUE_SEL_NONE);
+}
+
+// Builds an ECN capable IPv4 QoS data frame, whose MAC header is 2 bytes longer than mac_header_80211
+static tx_queue_element* test_qos_ipv4_packet(u32 length){
+	tx_queue_element* tqe = test_packet(length, QUEUE_AC_BE, 0);
+	tx_queue_buffer*  buffer;
+	llc_header*       llc_hdr;
+	ipv4_header*      ip_hdr;
+
+	if (tqe != NULL) {
+		buffer  = queue_element_buffer(tqe);
+		memset(buffer->frame, 0, sizeof(mac_header_80211) + 2 + sizeof(llc_header) + sizeof(ipv4_header));
+
+		llc_hdr = (llc_header*)(buffer->frame + sizeof(mac_header_80211) + 2);
+		ip_hdr  = (ipv4_header*)(buffer->frame + sizeof(mac_header_80211) + 2 + sizeof(llc_header));
+
+		buffer->frame[0]                    = MAC_FRAME_CTRL1_SUBTYPE_QOSDATA;
+		buffer->frame_info.timestamp_create = get_usec_timestamp();
+		llc_hdr->type                       = LLC_TYPE_IP;
+		ip_hdr->ver_ihl                     = 0x45;
+		ip_hdr->tos                         = 0x02;             // ECT(0)
+	}
+
+	return tqe;
+}
+
+HOST_TEST(queue, aqm_marks_qos_data_frames){
+	tx_queue_element* tqe[4];
+	ipv4_header*      ip_hdr;
+	tx_queue_stats    stats;
+	u32               i;
+
+	queue_init(1);
+	HOST_ASSERT(queue_aqm_config(QUEUE_AQM_MODE_MARK, 5000, 100000) == 0);
+
+	for (i = 0; i < 4; i++) {
+		tqe[i] = test_qos_ipv4_packet(1500);
+		HOST_ASSERT(tqe[i] != NULL);
+		HOST_ASSERT(enqueue_after_tail(1, tqe[i]) == 0);
+	}
+
+	ip_hdr = (ipv4_header*)(queue_element_buffer(tqe[1])->frame + sizeof(mac_header_80211) + 2 + sizeof(llc_header));
+
+	// The delay goes above target, then stays there for an interval
+	host_shim_advance_usec(10000);
+	HOST_CHECK_EQ(dequeue_transmit_checkin(1), 1);
+	host_shim_advance_usec(100000);
+	HOST_CHECK_EQ(dequeue_transmit_checkin(1), 1);
+
+	HOST_ASSERT(queue_get_stats(1, &stats) == 0);
+	HOST_CHECK_EQ(stats.num_aqm_marks, 1);
+	HOST_CHECK_EQ(stats.num_aqm_drops, 0);
+	HOST_CHECK_EQ(ip_hdr->tos & IPV4_ECN_MASK, IPV4_ECN_CE);
+
+	HOST_ASSERT(queue_aqm_config(QUEUE_AQM_MODE_DISABLED, 5000, 100000) == 0);
+}
+
+HOST_TEST(queue, aqm_drops_not_counted_as_dequeued){
+	tx_queue_element* tqe;
+	tx_queue_stats    stats;
+	u64               now;
+	u32               i;
+
+	queue_init(1);
+	HOST_ASSERT(queue_aqm_config(QUEUE_AQM_MODE_DROP, 5000, 100000) == 0);
+
+	host_shim_advance_usec(50000);
+	now = get_usec_timestamp();
+
+	// The second packet has waited longest, so it is the one AQM drops
+	for (i = 0; i < 5; i++) {
+		tqe = test_packet(1500, QUEUE_AC_BE, i);
+		HOST_ASSERT(tqe != NULL);
+		queue_element_buffer(tqe)->frame_info.timestamp_create = (i == 1) ? (now - 50000) : now;
+		HOST_ASSERT(enqueue_after_tail(1, tqe) == 0);
+	}
+
+	host_shim_advance_usec(10000);
+	HOST_CHECK_EQ(dequeue_transmit_checkin(1), 1);
+	host_shim_advance_usec(100000);
+	HOST_CHECK_EQ(dequeue_transmit_checkin(1), 1);
+
+	HOST_ASSERT(queue_get_stats(1, &stats) == 0);
+	HOST_CHECK_EQ(stats.num_aqm_drops, 1);
+	HOST_CHECK_EQ(stats.num_dequeued, 2);
+	HOST_CHECK_EQ(stats.num_queued, 2);
+
+	// The dropped packet's sojourn time is not reported as a transmitted one
+	HOST_CHECK_EQ(stats.sojourn_last, 110000);
+	HOST_CHECK_EQ(stats.sojourn_max, 110000);
+
+	HOST_ASSERT(queue_aqm_config(QUEUE_AQM_MODE_DISABLED, 5000, 100000) == 0);
+}
@@ -0,0 +1,83 @@
+/** @file test_run_queue.c
+ *  @brief Host tests: run queue
+ *
+ *  Tasks are called from wlan_mac_high_poll(), as they are from the main loop of
+ *  the firmware.
+ */
+
+#include "host_test.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_run_queue.h"
+
+#define TEST_NUM_TASKS  3
+
+static u32 test_task_id[TEST_NUM_TASKS];
+static u32 test_num_calls[TEST_NUM_TASKS];
+static u32 test_remove_index;
+
+static void test_task(u32 index){
+	test_num_calls[index]++;
+
+	// The first task removes the task given by test_remove_index
+	if ((index == 0) && (test_remove_index < TEST_NUM_TASKS)) {
+		run_queue_task_remove(test_task_id[test_remove_index]);
+		test_remove_index = TEST_NUM_TASKS;
+	}
+}
+
+static void test_run_queue_setup(u32 remove_index){
+	u32 i;
+
+	run_queue_init();
+
+	for (i = 0; i < TEST_NUM_TASKS; i++) {
+		test_num_calls[i] = 0;
+		test_task_id[i]   = run_queue_task_register(RUN_QUEUE_PRIORITY_NORMAL, 100, (function_ptr_t)test_task, i);
+	}
+
+	test_remove_index = remove_index;
+}
+
+HOST_TEST(run_queue, task_removes_next_task){
+	run_queue_stats stats;
+
+	test_run_queue_setup(1);
+
+	wlan_mac_high_poll();
+	wlan_mac_high_poll();
+
+	HOST_CHECK_EQ(test_num_calls[0], 2);
+	HOST_CHECK_EQ(test_num_calls[1], 0);
+	HOST_CHECK_EQ(test_num_calls[2], 2);
+	HOST_CHECK_EQ(run_queue_get_task_stats(test_task_id[1], &stats), -1);
+}
+
+HOST_TEST(run_queue, task_removes_itself){
+	run_queue_stats stats;
+
+	test_run_queue_setup(0);
+
+	wlan_mac_high_poll();
+	wlan_mac_high_poll();
+
+	HOST_CHECK_EQ(test_num_calls[0], 1);
+	HOST_CHECK_EQ(test_num_calls[1], 2);
+	HOST_CHECK_EQ(test_num_calls[2], 2);
+	HOST_CHECK_EQ(run_queue_get_task_stats(test_task_id[0], &stats), -1);
+	HOST_CHECK_EQ(run_queue_get_task_stats(test_task_id[2], &stats), 0);
+	HOST_CHECK_EQ(stats.num_runs, 2);
+}
+
+HOST_TEST(run_queue, remove_outside_poll_frees_task){
+	run_queue_stats stats;
+
+	test_run_queue_setup(TEST_NUM_TASKS);
+
+	run_queue_task_remove(test_task_id[2]);
+	wlan_mac_high_poll();
+
+	HOST_CHECK_EQ(test_num_calls[0], 1);
+	HOST_CHECK_EQ(test_num_calls[2], 0);
+	HOST_CHECK_EQ(run_queue_get_task_stats(test_task_id[2], &stats), -1);
+}
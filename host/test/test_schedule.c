@@ -0,0 +1,388 @@
+/** @file test_schedule.c
+ *  @brief Host tests: scheduler
+ *
+ *  The scheduler runs on the simulated timer. As the tests advance the
+ *  simulated clock, the timer interrupt queues the calls of expired events and
+ *  the main loop pass the shim makes after each expiry calls them.
+ */
+
+#include "host_test.h"
+
+#include "wlan_mac_high.h"
+#include "wlan_mac_schedule.h"
+#include "wlan_mac_run_queue.h"
+
+#define TEST_MAX_CALLS  16
+
+static u32 test_num_calls;
+static u64 test_call_time[TEST_MAX_CALLS];
+static u32 test_last_id;
+static int test_last_interrupts_enabled;
+
+static void test_callback(u32 id){
+	if (test_num_calls < TEST_MAX_CALLS) {
+		test_call_time[test_num_calls] = get_usec_timestamp();
+	}
+	test_num_calls++;
+	test_last_id = id;
+	test_last_interrupts_enabled = host_shim_interrupts_enabled();
+}
+
+static void test_schedule_setup(void){
+	test_num_calls = 0;
+
+	wlan_mac_schedule_init();
+	wlan_mac_schedule_setup_interrupt(host_shim_get_intc());
+}
+
+HOST_TEST(schedule, repeated_event_called_num_calls_times){
+	u32 id;
+
+	test_schedule_setup();
+
+	id = wlan_mac_schedule_event_repeated(SCHEDULE_FINE, 640, 3, (void*)test_callback);
+	HOST_ASSERT(id != SCHEDULE_FAILURE);
+
+	host_shim_advance_usec(100000);
+
+	HOST_CHECK_EQ(test_num_calls, 3);
+	HOST_CHECK_EQ(test_last_id, id);
+	HOST_CHECK(find_schedule(SCHEDULE_FINE, id) == NULL);
+}
+
+HOST_TEST(schedule, fire_times_follow_delay){
+	u32 i;
+
+	test_schedule_setup();
+
+	wlan_mac_schedule_event_repeated(SCHEDULE_FINE, 640, 4, (void*)test_callback);
+	host_shim_advance_usec(10000);
+
+	HOST_ASSERT(test_num_calls == 4);
+
+	for (i = 0; i < 4; i++) {
+		// Called at the tick the delay expires on: within one tick of (i + 1) * delay
+		HOST_CHECK(test_call_time[i] >= ((i + 1) * 640) - FAST_TIMER_DUR_US);
+		HOST_CHECK(test_call_time[i] <= ((i + 1) * 640) + FAST_TIMER_DUR_US);
+	}
+}
+
+HOST_TEST(schedule, removed_event_not_called){
+	u32 id;
+
+	test_schedule_setup();
+
+	id = wlan_mac_schedule_event_repeated(SCHEDULE_COARSE, 2*SLOW_TIMER_DUR_US, SCHEDULE_REPEAT_FOREVER, (void*)test_callback);
+	host_shim_advance_usec(5*SLOW_TIMER_DUR_US);
+
+	HOST_CHECK(test_num_calls >= 2);
+
+	wlan_mac_remove_schedule(SCHEDULE_COARSE, id);
+	test_num_calls = 0;
+	host_shim_advance_usec(10*SLOW_TIMER_DUR_US);
+
+	HOST_CHECK_EQ(test_num_calls, 0);
+}
+
+HOST_TEST(schedule, periodic_event_not_called_early){
+	u32 i;
+
+	test_schedule_setup();
+
+	wlan_mac_schedule_event_periodic(SCHEDULE_FINE, 1000, 1000, 5, (void*)test_callback);
+	host_shim_advance_usec(10000);
+
+	HOST_ASSERT(test_num_calls == 5);
+
+	for (i = 0; i < 5; i++) {
+		HOST_CHECK(test_call_time[i] >= 1000 * (i + 1));
+		HOST_CHECK(test_call_time[i] <  1000 * (i + 1) + FAST_TIMER_DUR_US);
+	}
+}
+
+// Runs five calls of a 10 ms event in the given mode, with call times relative to the start; returns the number of fine timer interrupts taken
+static u32 test_schedule_run_mode(u8 tickless){
+	wlan_sched_timer_stats stats;
+	u32                    i;
+	u64                    start;
+
+	test_schedule_setup();
+	start = get_usec_timestamp();
+	wlan_mac_schedule_set_tickless(SCHEDULE_FINE, tickless);
+
+	wlan_mac_schedule_event_repeated(SCHEDULE_FINE, 10000, 5, (void*)test_callback);
+	host_shim_advance_usec(100000);
+
+	for (i = 0; (i < test_num_calls) && (i < TEST_MAX_CALLS); i++) {
+		test_call_time[i] -= start;
+	}
+
+	wlan_mac_schedule_get_timer_stats(SCHEDULE_FINE, &stats);
+
+	return stats.num_interrupts;
+}
+
+HOST_TEST(schedule, tickless_fire_times_match_periodic){
+	u32 i;
+	u64 periodic_call_time[5];
+
+	HOST_ASSERT(test_schedule_run_mode(0) > 0);
+	HOST_ASSERT(test_num_calls == 5);
+
+	for (i = 0; i < 5; i++) {
+		periodic_call_time[i] = test_call_time[i];
+	}
+
+	test_schedule_run_mode(1);
+	HOST_ASSERT(test_num_calls == 5);
+
+	for (i = 0; i < 5; i++) {
+		HOST_CHECK(test_call_time[i] + FAST_TIMER_DUR_US >= periodic_call_time[i]);
+		HOST_CHECK(test_call_time[i] <= periodic_call_time[i] + FAST_TIMER_DUR_US);
+	}
+}
+
+HOST_TEST(schedule, tickless_takes_fewer_interrupts){
+	u32 num_periodic;
+	u32 num_tickless;
+
+	num_periodic = test_schedule_run_mode(0);
+	num_tickless = test_schedule_run_mode(1);
+
+	// Periodic mode interrupts every tick while the event is scheduled; tickless only when it is due
+	HOST_CHECK(num_periodic >= ((5 * 10000) / FAST_TIMER_DUR_US) - 1);
+	HOST_CHECK(num_tickless <= 5 + 1);
+}
+
+// Calls test_callback() and schedules itself again with no delay
+static void test_reschedule_callback(u32 id){
+	test_callback(id);
+
+	if (test_num_calls < 100) {
+		wlan_mac_schedule_event(SCHEDULE_FINE, 0, (void*)test_reschedule_callback);
+	}
+}
+
+HOST_TEST(schedule, event_scheduled_by_callback_waits_for_next_tick){
+	u8  tickless;
+	u32 i;
+
+	for (tickless = 0; tickless < 2; tickless++) {
+		test_schedule_setup();
+		wlan_mac_schedule_set_tickless(SCHEDULE_FINE, tickless);
+
+		wlan_mac_schedule_event(SCHEDULE_FINE, 0, (void*)test_reschedule_callback);
+		host_shim_advance_usec(10 * FAST_TIMER_DUR_US);
+
+		// One call per tick, not a loop in the first timer interrupt
+		HOST_CHECK(test_num_calls >= 8);
+		HOST_CHECK(test_num_calls <= 11);
+
+		for (i = 1; (i < test_num_calls) && (i < TEST_MAX_CALLS); i++) {
+			HOST_CHECK(test_call_time[i] - test_call_time[i - 1] >= FAST_TIMER_DUR_US / 2);
+		}
+	}
+}
+
+HOST_TEST(schedule, tickless_event_added_while_armed){
+	test_schedule_setup();
+	wlan_mac_schedule_set_tickless(SCHEDULE_FINE, 1);
+
+	// Arm the timer for a distant event, then add an earlier one part way through
+	wlan_mac_schedule_event(SCHEDULE_FINE, 50000, (void*)test_callback);
+	host_shim_advance_usec(1000);
+	wlan_mac_schedule_event(SCHEDULE_FINE, 2000, (void*)test_callback);
+
+	host_shim_advance_usec(10000);
+	HOST_ASSERT(test_num_calls == 1);
+	HOST_CHECK(test_call_time[0] >= 3000 - FAST_TIMER_DUR_US);
+	HOST_CHECK(test_call_time[0] <= 3000 + FAST_TIMER_DUR_US);
+
+	host_shim_advance_usec(50000);
+	HOST_ASSERT(test_num_calls == 2);
+	HOST_CHECK(test_call_time[1] >= 50000 - FAST_TIMER_DUR_US);
+	HOST_CHECK(test_call_time[1] <= 50000 + FAST_TIMER_DUR_US);
+}
+
+HOST_TEST(schedule, tickless_event_removed_while_interrupt_pending){
+	u32               id;
+	interrupt_state_t prev_interrupt_state;
+
+	test_schedule_setup();
+	wlan_mac_schedule_set_tickless(SCHEDULE_FINE, 1);
+
+	id = wlan_mac_schedule_event(SCHEDULE_FINE, 1000, (void*)test_callback);
+	wlan_mac_schedule_event(SCHEDULE_FINE, 1000, (void*)test_callback);
+
+	// Let the one-shot expire while interrupts are stopped, then remove one of the due events
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+	host_shim_advance_usec(2000);
+	wlan_mac_remove_schedule(SCHEDULE_FINE, id);
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	// The pending interrupt queues the other event as soon as interrupts are restored
+	wlan_mac_high_poll();
+
+	HOST_ASSERT(test_num_calls == 1);
+	HOST_CHECK_EQ(test_call_time[0], 2000);
+	HOST_CHECK(test_last_id != id);
+}
+
+HOST_TEST(schedule, deferred_callback_called_from_poll){
+	u32 id;
+
+	test_schedule_setup();
+	host_shim_set_main_loop(0);
+
+	id = wlan_mac_schedule_event_repeated(SCHEDULE_FINE, 1000, 1, (void*)test_callback);
+	HOST_ASSERT(id != SCHEDULE_FAILURE);
+
+	// The timer interrupt only queues the callback
+	host_shim_advance_usec(2000);
+	HOST_CHECK_EQ(test_num_calls, 0);
+
+	wlan_mac_high_poll();
+
+	HOST_ASSERT(test_num_calls == 1);
+	HOST_CHECK_EQ(test_last_id, id);
+	HOST_CHECK(test_last_interrupts_enabled);
+
+	// Called once only
+	wlan_mac_high_poll();
+	HOST_CHECK_EQ(test_num_calls, 1);
+}
+
+HOST_TEST(schedule, deferred_call_of_removed_event_dropped){
+	u32                    id;
+	wlan_sched_timer_stats timer_stats;
+	wlan_sched_pool_stats  pool_stats;
+
+	test_schedule_setup();
+	host_shim_set_main_loop(0);
+
+	id = wlan_mac_schedule_event_repeated(SCHEDULE_FINE, 1000, SCHEDULE_REPEAT_FOREVER, (void*)test_callback);
+
+	// Removed after the timer interrupt queued its call, before the main loop made it
+	host_shim_advance_usec(1000 + FAST_TIMER_DUR_US);
+	wlan_mac_remove_schedule(SCHEDULE_FINE, id);
+
+	// The record is held for the queued call
+	wlan_mac_schedule_pool_get_stats(&pool_stats);
+	HOST_CHECK_EQ(pool_stats.num_used, 1);
+
+	wlan_mac_high_poll();
+	HOST_CHECK_EQ(test_num_calls, 0);
+
+	wlan_mac_schedule_get_timer_stats(SCHEDULE_FINE, &timer_stats);
+	HOST_CHECK_EQ(timer_stats.num_deferred_dropped, 1);
+
+	wlan_mac_schedule_pool_get_stats(&pool_stats);
+	HOST_CHECK_EQ(pool_stats.num_used, 0);
+}
+
+HOST_TEST(schedule, deferred_call_queue_overflow_counted){
+	u32                    i;
+	wlan_sched_timer_stats stats;
+
+	test_schedule_setup();
+	host_shim_set_main_loop(0);
+
+	for (i = 0; i < SCHEDULE_DEFERRED_QUEUE_SIZE + 8; i++) {
+		HOST_ASSERT(wlan_mac_schedule_event(SCHEDULE_FINE, 1000, (void*)test_callback) != SCHEDULE_FAILURE);
+	}
+
+	// The calls that do not fit are dropped, not made from the interrupt handler
+	host_shim_advance_usec(2000);
+	HOST_CHECK_EQ(test_num_calls, 0);
+
+	wlan_mac_schedule_get_timer_stats(SCHEDULE_FINE, &stats);
+	HOST_CHECK_EQ(stats.num_deferred_overflows, 8);
+
+	wlan_mac_high_poll();
+	HOST_CHECK_EQ(test_num_calls, SCHEDULE_DEFERRED_QUEUE_SIZE);
+	HOST_CHECK(test_last_interrupts_enabled);
+}
+
+HOST_TEST(schedule, pool_grows_from_run_queue){
+	u32 i;
+	wlan_sched_pool_stats stats;
+
+	test_schedule_setup();
+	run_queue_init();
+
+	wlan_mac_schedule_pool_get_stats(&stats);
+	HOST_ASSERT(stats.capacity == SCHEDULE_POOL_SIZE_DEFAULT);
+
+	for (i = 0; i < (SCHEDULE_POOL_SIZE_DEFAULT - SCHEDULE_POOL_LOW_WATER + 1); i++) {
+		HOST_ASSERT(wlan_mac_schedule_event_repeated(SCHEDULE_COARSE, 1000000, 1, (void*)test_callback) != SCHEDULE_FAILURE);
+	}
+
+	// The pool is not grown from the caller's context while it has free events
+	wlan_mac_schedule_pool_get_stats(&stats);
+	HOST_CHECK_EQ(stats.capacity, SCHEDULE_POOL_SIZE_DEFAULT);
+
+	// The work item queued when the pool ran low doubles it in the main loop
+	wlan_mac_high_poll();
+
+	wlan_mac_schedule_pool_get_stats(&stats);
+	HOST_CHECK_EQ(stats.capacity, 2 * SCHEDULE_POOL_SIZE_DEFAULT);
+	HOST_CHECK_EQ(stats.num_failures, 0);
+}
+
+HOST_TEST(schedule, pool_exhausted_fails_until_poll){
+	u32 i;
+	wlan_sched_pool_stats stats;
+
+	test_schedule_setup();
+	run_queue_init();
+
+	for (i = 0; i < SCHEDULE_POOL_SIZE_DEFAULT; i++) {
+		HOST_ASSERT(wlan_mac_schedule_event_repeated(SCHEDULE_COARSE, 1000000 + (i * SLOW_TIMER_DUR_US), 1, (void*)test_callback) != SCHEDULE_FAILURE);
+	}
+
+	// An empty pool is never grown by the scheduling call, which may be made from interrupt context:
+	// with allocations refused, no allocation is attempted
+	host_shim_set_malloc_limit(0);
+	HOST_CHECK_EQ(wlan_mac_schedule_event_repeated(SCHEDULE_COARSE, 1000000, 1, (void*)test_callback), SCHEDULE_FAILURE);
+	HOST_CHECK_EQ(host_shim_get_stats()->num_malloc_failures, 0);
+	host_shim_set_malloc_limit(0xFFFFFFFF);
+
+	wlan_mac_schedule_pool_get_stats(&stats);
+	HOST_CHECK_EQ(stats.capacity, SCHEDULE_POOL_SIZE_DEFAULT);
+	HOST_CHECK_EQ(stats.num_failures, 1);
+
+	// The main loop grows it
+	wlan_mac_high_poll();
+	HOST_CHECK(wlan_mac_schedule_event_repeated(SCHEDULE_COARSE, 1000000, 1, (void*)test_callback) != SCHEDULE_FAILURE);
+
+	wlan_mac_schedule_pool_get_stats(&stats);
+	HOST_CHECK_EQ(stats.capacity, 2 * SCHEDULE_POOL_SIZE_DEFAULT);
+	HOST_CHECK_EQ(stats.num_used, SCHEDULE_POOL_SIZE_DEFAULT + 1);
+	HOST_CHECK_EQ(stats.num_failures, 1);
+
+	// Events scheduled before the heaps were moved still expire
+	host_shim_advance_usec(1000000 + ((SCHEDULE_POOL_SIZE_DEFAULT + 1) * SLOW_TIMER_DUR_US));
+	HOST_CHECK_EQ(test_num_calls, SCHEDULE_POOL_SIZE_DEFAULT + 1);
+}
+
+HOST_TEST(schedule, pool_failure_counted){
+	u32 i;
+	wlan_sched_pool_stats stats;
+
+	test_schedule_setup();
+	run_queue_init();
+
+	for (i = 0; i < SCHEDULE_POOL_SIZE_DEFAULT; i++) {
+		HOST_ASSERT(wlan_mac_schedule_event_repeated(SCHEDULE_COARSE, 1000000, 1, (void*)test_callback) != SCHEDULE_FAILURE);
+	}
+
+	// The main loop cannot grow the pool either
+	host_shim_set_malloc_limit(0);
+	wlan_mac_high_poll();
+	HOST_CHECK_EQ(wlan_mac_schedule_event_repeated(SCHEDULE_COARSE, 1000000, 1, (void*)test_callback), SCHEDULE_FAILURE);
+	host_shim_set_malloc_limit(0xFFFFFFFF);
+
+	wlan_mac_schedule_pool_get_stats(&stats);
+	HOST_CHECK_EQ(stats.capacity, SCHEDULE_POOL_SIZE_DEFAULT);
+	HOST_CHECK_EQ(stats.num_failures, 1);
+}
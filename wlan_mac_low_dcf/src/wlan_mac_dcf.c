@@ -464,7 +464,12 @@ int frame_transmit(u8 mpdu_pkt_buf, u8 mpdu_rate, u16 mpdu_length, wlan_mac_low_
 
 			wlan_phy_set_tx_signal(mac_cfg_pkt_buf, mac_cfg_rate, mac_cfg_length); // Write SIGNAL for RTS
 
-
+#else
+			//RTS/CTS is not built: send the long MPDU directly and wait for its ACK
+			tx_wait_state = TX_WAIT_ACK;
+			mac_cfg_rate = mpdu_rate;
+			mac_cfg_length = mpdu_length;
+			mac_cfg_pkt_buf = mpdu_pkt_buf;
 #endif
 
 		} else if( (tx_mode == TX_MODE_SHORT) && (req_timeout == 1) ) {
@@ -41,6 +41,11 @@
 //   - Disabled by default
 #define WLAN_EXP_WAIT_FOR_ETH          0
 
+// Send WARPNet frames of up to a 9000 byte jumbo MTU (see TRANSPORT_MTU)
+//   - Disabled by default
+//   - Only enable if the Xilnet BSP is built with send buffers for jumbo frames
+#define WLAN_EXP_JUMBO_FRAMES          0
+
 
 
 // **********************************************************************
@@ -58,8 +63,15 @@
 
 // Version info (MAJOR.MINOR.REV, all must be ints)
 //     MAJOR and MINOR are both u8, while REV is u16
+//
+//     1.4.0 - TxRx statistics entries are 112 bytes:  each frame_statistics_txrx
+//             gained tx_num_packets_requeued and tx_num_packets_retry_dropped.
+//             TX high entries carry high_retry_count / high_retry_status in
+//             place of their padding.
+//     1.5.0 - ltg_packet_id (LTG frames and the payload of LTG Tx / Rx entries)
+//             is 36 bytes:  magic, ltg_seq and timestamp follow ltg_id.
 #define WLAN_EXP_VER_MAJOR        1
-#define WLAN_EXP_VER_MINOR        3
+#define WLAN_EXP_VER_MINOR        5
 #define WLAN_EXP_VER_REV          0
 
 #define REQ_WLAN_EXP_HW_VER       (WLAN_EXP_VER_MAJOR<<24)|(WLAN_EXP_VER_MINOR<<16)|(WLAN_EXP_VER_REV)
@@ -121,14 +121,14 @@ typedef struct{
 	u32 delay_accept;							///< Time in microseconds between timestamp_create and packet acceptance by CPU Low
 	u32 delay_done;								///< Time in microseconds between acceptance and transmit completion
 	u64	unique_seq;								///< Unique sequence number for this packet (12 LSB used as 802.11 MAC sequence number)
-	u8 padding0;
+	u8 high_retry_count;						///< Number of times CPU High has re-enqueued this packet after a failed transmission
 	u8 tx_result;								///< Result of transmission attempt - TX_MPDU_RESULT_SUCCESS or TX_MPDU_RESULT_FAILURE
 	u8 QID;										///< Queue ID from which this packet was taken
 	u8 short_retry_count;
 	u8 long_retry_count;
 	u8 num_tx_attempts;
 	u8 flags;									///< Bit flags en/disabling certain operations by the lower-level MAC
-	u8 padding1;
+	u8 high_retry_status;						///< Outcome of a failed transmission in CPU High - TX_HIGH_RETRY_*
 	u16 length;									///< Number of bytes in MAC packet, including MAC header and FCS
 	u16 AID;									///< Association ID of the node to which this packet is addressed
 	u8 padding2[4];
@@ -141,6 +141,12 @@ typedef struct{
 #define TX_MPDU_RESULT_SUCCESS	0
 #define TX_MPDU_RESULT_FAILURE	1
 
+#define TX_HIGH_RETRY_NONE		0			///< Transmission succeeded or high-level retry is disabled
+#define TX_HIGH_RETRY_REQUEUED	1			///< Packet was re-enqueued at the head of its queue
+#define TX_HIGH_RETRY_EXHAUSTED	2			///< Packet was dropped; its retry budget was used up
+#define TX_HIGH_RETRY_EXPIRED	3			///< Packet was dropped; it was older than the retry age limit
+#define TX_HIGH_RETRY_DROPPED	4			///< Packet was dropped; its queue no longer exists or refused it
+
 #define TX_MPDU_FLAGS_REQ_TO				0x01
 #define TX_MPDU_FLAGS_FILL_TIMESTAMP		0x02
 #define TX_MPDU_FLAGS_FILL_DURATION			0x04
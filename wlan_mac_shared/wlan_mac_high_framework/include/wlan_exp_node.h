@@ -65,6 +65,7 @@
 #define CMDID_NODE_RANDOM_SEED                             0x001017
 #define CMDID_NODE_WLAN_MAC_ADDR                           0x001018
 #define CMDID_NODE_LOW_PARAM				               0x001020
+#define CMDID_NODE_SCHEDULE_STATS                          0x001021
 
 #define CMD_PARAM_WRITE_VAL                                0x00000000
 #define CMD_PARAM_READ_VAL                                 0x00000001
@@ -104,6 +105,8 @@
 #define CMD_PARAM_RANDOM_SEED_VALID                        0x00000001
 #define CMD_PARAM_RANDOM_SEED_RSVD                         0xFFFFFFFF
 
+#define CMD_PARAM_NODE_SCHEDULE_STATS_FLAG_RESET           0x00000001
+
 
 //-----------------------------------------------
 // LTG Commands
@@ -113,11 +116,15 @@
 #define CMDID_LTG_STOP                                     0x002002
 #define CMDID_LTG_REMOVE                                   0x002003
 #define CMDID_LTG_STATUS                                   0x002004
+#define CMDID_LTG_TRACE_WRITE                              0x002005
+#define CMDID_LTG_RX_STATS                                 0x002006
 
 #define CMD_PARAM_LTG_ERROR                                0x000001
 
 #define CMD_PARAM_LTG_CONFIG_FLAG_AUTOSTART                0x00000001
 
+#define CMD_PARAM_LTG_RX_STATS_FLAG_RESET                  0x00000001
+
 #define CMD_PARAM_LTG_ALL_LTGS                             LTG_ID_INVALID
 
 #define CMD_PARAM_LTG_RUNNING                              0x00000001
@@ -135,6 +142,7 @@
 #define CMDID_LOG_ADD_STATS_TXRX                           0x003005
 #define CMDID_LOG_ENABLE_ENTRY                             0x003006
 #define CMDID_LOG_STREAM_ENTRIES                           0x003007
+#define CMDID_LOG_GET_ENTRIES_BY_TIME                      0x003008
 
 #define CMD_PARAM_LOG_GET_ALL_ENTRIES                      0xFFFFFFFF
 
@@ -144,6 +152,7 @@
 #define CMD_PARAM_LOG_CONFIG_FLAG_WN_CMDS                  0x00000008
 #define CMD_PARAM_LOG_CONFIG_FLAG_TXRX_MPDU                0x00000010
 #define CMD_PARAM_LOG_CONFIG_FLAG_TXRX_CTRL                0x00000020
+#define CMD_PARAM_LOG_CONFIG_FLAG_COMPACT                  0x00000040
 
 
 //-----------------------------------------------
@@ -160,6 +169,14 @@
 // Queue Commands
 //
 #define CMDID_QUEUE_TX_DATA_PURGE_ALL                      0x005000
+#define CMDID_QUEUE_AQM_CONFIG                             0x005001
+#define CMDID_QUEUE_GET_STATS                              0x005002
+#define CMDID_QUEUE_SHARE_CONFIG                           0x005003
+#define CMDID_QUEUE_RETRY_CONFIG                           0x005004
+
+#define CMD_PARAM_QUEUE_ERROR                              0x000001
+
+#define CMD_PARAM_QUEUE_AQM_CONFIG_FLAG_RESET_STATS        0x00000001
 
 
 //-----------------------------------------------
@@ -204,6 +221,9 @@
 #define WLAN_EXP_AID_ME                                    0xFFFFFFFE
 #define WLAN_EXP_AID_DEFAULT                               0x00000001
 
+// Time (in microseconds) the transport poll run queue task should use per call
+#define WLAN_EXP_TRANSPORT_POLL_BUDGET                     500
+
 
 // ****************************************************************************
 // Define Node Hardware Parameters
@@ -78,6 +78,22 @@
 
 #define TRANSPORT_ROBUST_MASK       0x1
 
+// Largest UDP payload the transport will send:  the MTU less the IP and UDP headers
+//   NOTE:  Every frame is built in the Xilnet send buffer (eth_device[].sendbuf), which holds LINK_HDR_LEN
+//          bytes more than the MTU.  The buffer holds a standard 1500 byte MTU frame unless the Xilnet BSP
+//          is built for jumbo frames; only then set WLAN_EXP_JUMBO_FRAMES (wlan_exp.h) to allow 9000 byte
+//          frames.  The host determines the payload size its network supports with TRANS_PAYLOADSIZETEST_CMDID.
+#if WLAN_EXP_JUMBO_FRAMES
+#define TRANSPORT_MTU               9000
+#else
+#define TRANSPORT_MTU               1500
+#endif
+#define TRANSPORT_MAX_UDP_PAYLOAD   (TRANSPORT_MTU - IP_HDR_LEN*4 - UDP_HDR_LEN)
+
+// Largest data segment transport_send_w_data() will copy behind a message of msg_length bytes
+//   (the wn_host_message length, which includes the PAYLOAD_PAD_NBYTES pad but not the transport header)
+#define TRANSPORT_MAX_DATA_LENGTH(msg_length)    (TRANSPORT_MAX_UDP_PAYLOAD - sizeof(wn_transport_header) - (msg_length))
+
 #define ETHPHYREG_17_0_LINKUP       0x0400
 
 #define WAITDURATION_SEC            2
@@ -176,6 +192,7 @@ void transport_receiveCallback    ( unsigned char* buff, unsigned int len, void*
 int  transport_setReceiveCallback ( void(*handler) );
 void transport_poll               ( unsigned int eth_dev_num);
 void transport_send               ( int socket, wn_host_message* currMsg, pktSrcInfo* pktSrc, unsigned int eth_dev_num);
+void transport_send_w_data        ( int socket, wn_host_message* currMsg, void* data, unsigned int data_length, pktSrcInfo* pktSrc, unsigned int eth_dev_num);
 void transport_close              ( unsigned int eth_dev_num);
 
 int  transport_set_hw_info        ( unsigned int eth_dev_num, unsigned char* ip_addr, unsigned char* hw_addr);
@@ -47,6 +47,30 @@
 #define ENTRY_EN_MASK_TXRX_CTRL					  0x01
 #define ENTRY_EN_MASK_TXRX_MPDU					  0x02
 
+//-----------------------------------------------
+// Entry Policies
+//
+//     Each entry type has a policy that is checked before any space is
+//     requested from the event log (and before any payload is copied):
+//         ENTRY_POLICY_ALWAYS  - Always create the entry (default)
+//         ENTRY_POLICY_NEVER   - Never create the entry
+//         ENTRY_POLICY_SAMPLE  - Create one of every sample_n entries
+//         ENTRY_POLICY_ADDR    - Create the entry only if its address matches
+//                                (addr & addr_mask) == (policy addr & addr_mask)
+//
+//     For TX entries the address is the receiver (address 1); for RX entries
+//     the address is the transmitter (address 2).  Entries that do not carry
+//     an address are always created under ENTRY_POLICY_ADDR.
+//
+//     Entry types >= ENTRY_POLICY_NUM_TYPES are always created.
+
+#define ENTRY_POLICY_NUM_TYPES                   32
+
+#define ENTRY_POLICY_ALWAYS                      0
+#define ENTRY_POLICY_NEVER                       1
+#define ENTRY_POLICY_SAMPLE                      2
+#define ENTRY_POLICY_ADDR                        3
+
 //------------------------------------------------------------------------
 // Entry Types
 
@@ -83,6 +107,21 @@
 
 #define ENTRY_TYPE_TXRX_STATS          30
 
+//-----------------------------------------------
+// Compact Entries
+//
+//     When compact logging is enabled, RX, TX high and TX low MPDU entries are
+//     logged as ENTRY_TYPE_TXRX_COMPACT entries.  Their timestamps are deltas
+//     against the preceding ENTRY_TYPE_TIME_ANCHOR entry in the log.
+
+#define ENTRY_TYPE_TIME_ANCHOR         40
+#define ENTRY_TYPE_TXRX_COMPACT        41
+
+// Maximum number of compact entries between time anchors.  This bounds the
+// number of compact entries that cannot be decoded when the log wraps over
+// their time anchor.
+#define COMPACT_ANCHOR_INTERVAL        64
+
 
 
 
@@ -249,10 +288,30 @@ typedef struct{
 //   NOTE:  To add TxRx Statistics to the log, please use one of the methods provided
 //     in wlan_mac_event_log.*
 //
+//   Entry format (112 bytes since WLAN Exp 1.4.0; 96 bytes before):
+//       u64        timestamp
+//       u8[6]      addr
+//       u8         is_associated
+//       u8         padding
+//       data:      frame_statistics_txrx (48 bytes)
+//       mgmt:      frame_statistics_txrx (48 bytes)
+//
+//     frame_statistics_txrx:
+//       u64        rx_num_bytes
+//       u64        tx_num_bytes_success
+//       u64        tx_num_bytes_total
+//       u32        rx_num_packets
+//       u32        tx_num_packets_success
+//       u32        tx_num_packets_total
+//       u32        tx_num_packets_low
+//       u32        tx_num_packets_requeued        (1.4.0)
+//       u32        tx_num_packets_retry_dropped   (1.4.0)
+//
 typedef struct{
     u64                      timestamp;          // Timestamp of the log entry
     statistics_txrx_base     stats;              // Framework's statistics struct
 } txrx_stats_entry;
+CASSERT(sizeof(txrx_stats_entry) == 112, txrx_stats_entry_alignment_check);
 
 
 //-----------------------------------------------
@@ -342,7 +401,8 @@ typedef struct{
 	u8                  pkt_type;                // Type of packet
 	u8	                ant_mode;                // Antenna mode used for transmission
 	u8					queue_id;				 // Queue ID this packet was sent from
-	u8	                padding[2];              // Padding for alignment
+	u8                  high_retry_count;        // Number of times the packet had been re-enqueued before this transmission
+	u8                  high_retry_status;       // Outcome of a failed transmission (TX_HIGH_RETRY_*)
 	u32                 mac_payload_log_len;     // Number of payload bytes actually recorded in log entry
 	u32                 mac_payload[MIN_MAC_PAYLOAD_LOG_LEN/4];
 } tx_high_entry;
@@ -378,6 +438,63 @@ typedef struct{
 #define TX_LOW_FLAGS_WAS_ACKED 0x01
 
 
+//-----------------------------------------------
+// Time Anchor Entry
+//
+//     Full timestamp for the compact entries that follow it in the log
+//
+typedef struct{
+	u64                 timestamp;               // Timestamp that compact entry deltas are relative to
+} time_anchor_entry;
+
+
+//-----------------------------------------------
+// Compact Transmit / Receive Entry
+//
+//     Variable length entry:
+//         u8     entry_type                     // Full entry type (ENTRY_TYPE_RX_*, ENTRY_TYPE_TX_*)
+//         u8     payload_offset                 // Offset of mac_payload from the start of the entry
+//         varint timestamp delta                // Zigzag encoded delta from the time anchor (usec)
+//         ...    fields                         // Depends on entry_type (see below)
+//         u8     mac_payload[]                  // Starts at payload_offset (4-byte aligned)
+//
+//     Varints are little endian base 128 (7 bits per byte, MSB set on all but the
+//     last byte).  The fields are:
+//
+//     RX:       u8 rate | (fcs_status << 7), u8 ant_mode, u8 chan_num, s8 power,
+//               u8 (rf_gain << 6) | bb_gain, u8 pkt_type, varint flags,
+//               varint length, varint mac_payload_log_len
+//
+//     TX high:  varint delay_accept, varint delay_done, varint unique_seq,
+//               u8 rate, u8 ant_mode, u8 chan_num, s8 power, u8 num_tx, u8 result,
+//               u8 pkt_type, u8 queue_id, u8 high_retry_count, u8 high_retry_status,
+//               varint length, varint mac_payload_log_len
+//
+//     TX low:   varint unique_seq, u8 phy rate, u8 phy antenna_mode, s8 phy power,
+//               u8 phy flags, u8 transmission_count, u8 chan_num, u8 pkt_type,
+//               u8 flags, varint zigzag num_slots, varint cw, varint length,
+//               varint mac_payload_log_len
+//
+//     Compact RX entries do not contain channel estimates.  The MAC payload is
+//     not zero padded to the minimum payload length.
+//
+#define COMPACT_ENTRY_MAX_FIELDS_LEN             48
+
+
+// **********************************************************************
+// Entry Policy
+//
+typedef struct{
+	u8                  mode;                    // ENTRY_POLICY_*
+	u8                  addr[6];                 // Address for ENTRY_POLICY_ADDR
+	u8                  addr_mask[6];            // Mask applied to both addresses before comparison
+	u8                  reserved[3];
+	u32                 sample_n;                // Create one of every sample_n entries for ENTRY_POLICY_SAMPLE
+	u32                 sample_count;            // Entries left to skip before the next sample
+	u32                 num_filtered;            // Number of entries not created because of the policy
+} entry_policy;
+
+
 /*************************** Function Prototypes *****************************/
 
 extern u32 mac_payload_log_len;
@@ -388,6 +505,18 @@ extern u32 mac_payload_log_len;
 u8 wlan_exp_log_get_entry_en_mask();
 void wlan_exp_log_set_entry_en_mask(u8 mask);
 
+u8       wlan_exp_log_get_compact();
+void     wlan_exp_log_set_compact(u8 enable);
+void     wlan_exp_log_reset_compact();
+
+//-----------------------------------------------
+// Methods to configure the per entry type policy
+//
+int      wlan_exp_log_set_entry_policy(u16 entry_type_id, u8 mode, u32 sample_n, u8* addr, u8* addr_mask);
+int      wlan_exp_log_get_entry_policy(u16 entry_type_id, entry_policy* policy);
+void     wlan_exp_log_reset_entry_policies();
+u32      wlan_exp_log_entry_policy_check(u16 entry_type_id, u8* addr);
+
 //-----------------------------------------------
 // Method to set the global variable mac_payload_log_len
 //
@@ -407,6 +536,7 @@ tx_high_entry   * wlan_exp_log_create_tx_entry(tx_frame_info* tx_mpdu, u8 channe
 tx_low_entry    * wlan_exp_log_create_tx_low_entry(tx_frame_info* tx_mpdu, wlan_mac_low_tx_details* tx_low_details, u64 timestamp_offset, u32 tx_low_count);
 
 rx_common_entry * wlan_exp_log_create_rx_entry(rx_frame_info* rx_mpdu, u8 channel_num, u8 rate);
+rx_common_entry * wlan_exp_log_create_rx_entry_with_flags(rx_frame_info* rx_mpdu, u8 channel_num, u8 rate, u16 flags);
 
 
 
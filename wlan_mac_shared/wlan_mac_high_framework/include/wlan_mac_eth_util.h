@@ -27,6 +27,14 @@ typedef struct{
 	u16 type;
 } ethernet_header;
 
+typedef struct{
+	u8  address_destination[6];
+	u8  address_source[6];
+	u16 tpid;
+	u16 tci;
+	u16 type;
+} ethernet_vlan_header;
+
 typedef struct{
 	u8  ver_ihl;
 	u8  tos;
@@ -99,11 +107,24 @@ typedef struct{
 
 #define IPV4_PROT_UDP                                      0x11
 
+#define IPV4_ECN_MASK                                      0x03                // ECN field in the low bits of ipv4_header.tos (RFC 3168)
+#define IPV4_ECN_NOT_ECT                                   0x00
+#define IPV4_ECN_CE                                        0x03
+
+#define IPV4_DSCP(tos)                                     ((tos) >> 2)
+#define IPV4_DSCP_EF                                       46                  // Expedited forwarding (RFC 3246)
+#define IPV4_DSCP_VA                                       44                  // Voice admit (RFC 5865)
+
 #define UDP_SRC_PORT_BOOTPC                                68
 #define UDP_SRC_PORT_BOOTPS                                67
 
 #define ETH_TYPE_ARP                                       0x0608
 #define ETH_TYPE_IP                                        0x0008
+#define ETH_TYPE_VLAN                                      0x0081              // 802.1Q tag protocol ID
+
+#define ETH_VLAN_TAG_LEN                                   4
+#define ETH_VLAN_PCP(tci)                                  ((tci) >> 13)       // 802.1p priority code point (host order TCI)
+#define ETH_VLAN_PCP_NONE                                  0xFF
 
 #define LLC_SNAP                                           0xAA
 #define LLC_CNTRL_UNNUMBERED                               0x03
@@ -120,6 +141,16 @@ typedef struct{
 // Memory space allocated per Ethernet packet
 #define ETH_A_PKT_BUF_SIZE                                 0x800               // 2KB
 
+// Largest Ethernet reception accepted by the Rx DMA (jumbo frames are disabled; 1518 bytes plus an 802.1Q tag)
+#define ETH_RX_MAX_LEN                                     1522
+
+// Offset of the Ethernet header within a Tx queue entry's frame buffer. The Rx DMA writes each
+// reception at this offset so that its payload is already in its post-encapsulation location.
+#define ETH_RX_BUF_OFFSET                                  (sizeof(mac_header_80211) + sizeof(llc_header) - sizeof(ethernet_header))
+
+// Time (in microseconds) the Ethernet Rx run queue task should use per call
+#define ETH_RX_TASK_BUDGET                                 200
+
 int  wlan_eth_init();
 int  wlan_eth_dma_init();
 
@@ -133,9 +164,10 @@ inline int eth_get_num_rx_bd();
 
 int  wlan_mpdu_eth_send(void* mpdu, u16 length, u8 pre_llc_offset);
 
-int  wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_ptr, u32 eth_rx_len);
+int  wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_ptr, u32 eth_rx_len, u8* ac);
 
 inline void wlan_poll_eth_rx();
+void wlan_eth_rx_task(u32 arg);
 
 int  wlan_eth_setup_interrupt(XIntc* intc);
 void eth_rx_interrupt_handler(void *callbarck_arg);
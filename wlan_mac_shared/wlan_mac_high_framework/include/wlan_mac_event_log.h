@@ -71,12 +71,41 @@
 #define EVENT_LOG_MAGIC_NUMBER         0xACED0000
 
 
+// Define number that marks an entry as reserved but not yet committed
+//   - The header of a new entry is written with this number in place of the
+//     magic number.  event_log_commit_entry() replaces it with the magic number
+//     once the entry payload is written.
+//
+#define EVENT_LOG_RESERVED_NUMBER      0xACE00000
+
+
 // Define constants for function flags
 //   NOTE:  the transmit flag is defined in wlan_exp_common.h since it is used in multiple places
 #define EVENT_LOG_NO_STATS             0
 #define EVENT_LOG_STATS                1
 
 
+// Define time index parameters
+//   The time index is a sparse set of checkpoints (log time to log index) kept
+//   alongside the log.  The log is divided in to intervals of (1 << shift) bytes
+//   and the first entry allocated in each interval is recorded as a checkpoint.
+//   The shift starts at EVENT_LOG_INDEX_MIN_SHIFT (64 kB) and is increased at
+//   initialization until the checkpoints fit in EVENT_LOG_INDEX_SIZE.
+//
+#define EVENT_LOG_INDEX_MIN_SHIFT      16
+#define EVENT_LOG_INDEX_INVALID        0xFFFFFFFF
+
+
+// Define skip index parameters
+//   The skip index holds the offset of the first entry that starts in each block
+//   of (1 << shift) bytes of the log.  The shift starts at EVENT_LOG_SKIP_MIN_SHIFT
+//   (4 kB) and is increased at initialization until the offsets fit in
+//   EVENT_LOG_SKIP_SIZE.  The shift may not exceed 16 (offsets are u16).
+//
+#define EVENT_LOG_SKIP_MIN_SHIFT       12
+#define EVENT_LOG_SKIP_NONE            0xFFFF
+
+
 /*********************** Global Structure Definitions ************************/
 
 //-----------------------------------------------
@@ -90,6 +119,22 @@ typedef struct{
 } entry_header;
 
 
+// Index of the first entry after the log wraps (the node info entry at the
+//   beginning of the log is never overwritten; requires wlan_mac_entries.h)
+#define EVENT_LOG_WRAP_INDEX           ( sizeof(entry_header) + sizeof(node_info_entry) )
+
+
+//-----------------------------------------------
+// Log Time Index Checkpoint
+//   - Log time is the time the entry was allocated (see get_usec_timestamp())
+//
+typedef struct{
+	u64 timestamp;                     // Time the entry was allocated
+	u32 index;                         // Index of the entry header (EVENT_LOG_INDEX_INVALID if none)
+	u32 reserved;
+} event_log_checkpoint;
+
+
 
 /*************************** Function Prototypes *****************************/
 
@@ -101,14 +146,18 @@ int       event_log_config_wrap( u32 enable );
 int       event_log_config_logging( u32 enable );
 
 u32       event_log_get_data( u32 start_address, u32 size, char * buffer );
+u32       event_log_get_data_address( u32 start_index, u32 size, u32 * address );
 u32       event_log_get_size( u32 start_index );
 u32       event_log_get_total_size( void );
 u32       event_log_get_capacity( void );
 u32       event_log_get_next_entry_index( void );
 u32       event_log_get_oldest_entry_index( void );
 u32       event_log_get_num_wraps( void );
+u32       event_log_get_num_failures( void );
 u32       event_log_get_flags( void );
+int       event_log_get_time_range( u64 start_time, u64 end_time, u32 * start_index, u32 * size );
 void *    event_log_get_next_empty_entry( u16 entry_type, u16 entry_size );
+void      event_log_commit_entry( void * entry_ptr );
 
 int       event_log_update_type( void * entry_ptr, u16 entry_type );
 
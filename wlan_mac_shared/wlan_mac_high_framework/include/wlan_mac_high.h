@@ -49,7 +49,7 @@
 //     Aux. BRAM     |          DRAM
 //--------------------------------------------
 //
-// Tx Queue DL_ENTRY -> Tx Queue Buffer
+// Tx Queue Elements -> Tx Queue Buffer
 //
 //-------------------|
 //                   |
@@ -63,6 +63,8 @@
 //                   | User Scratch Space
 //-------------------|
 //                   |------------------------
+//                   | LTG Trace Buffer
+//                   |------------------------
 //                   |
 //                   |
 //                   | Event Log
@@ -75,23 +77,25 @@
 
 
 /* The Tx Queue consists of two pieces:
- *  (1) dl_entry structs that live in the aux. BRAM and
+ *  (1) tx_queue_element descriptors that live in the aux. BRAM and
  *  (2) data buffers for the packets themselves than live in DRAM
  *
  *	The below definitions carve out the sizes of memory for these two pieces.
- *	The default value of 40 kB do the dl_entry memory space was chosen. Because
- *	each dl_entry has a size of 12 bytes, this space allows for a potential
- *	of 3413 dl_entry structs describing Tx queue elements.
+ *	The default value of 40 kB do the descriptor memory space was chosen. Because
+ *	each tx_queue_element is a 4 byte pair of 16-bit list indices, this space allows
+ *	for a potential of 10240 Tx queue elements.
  *
- *	As far as the actual payload space in DRAM, 14000 kB was chosen because this
- *	is enough to store each of the 3413 Tx queue elements. Each queue element points
- *	to a unique 4KB-sized buffer.
+ *	As far as the actual payload space in DRAM, 18096 kB was chosen. This space is
+ *	divided between buffer size classes (see wlan_mac_queue.h): ~13.3 MB holds the
+ *	3413 4KB-sized buffers of the large class, and the rest holds the smaller classes.
+ *	Each queue element describes a unique buffer whose address is computed from the
+ *	element's index.
  */
 #define TX_QUEUE_DL_ENTRY_MEM_BASE		(AUX_BRAM_BASE)
 #define TX_QUEUE_DL_ENTRY_MEM_SIZE		(40*1024)
 #define TX_QUEUE_DL_ENTRY_MEM_HIGH		high_addr_calc(TX_QUEUE_DL_ENTRY_MEM_BASE, TX_QUEUE_DL_ENTRY_MEM_SIZE)
 #define TX_QUEUE_BUFFER_BASE            (DRAM_BASE)
-#define TX_QUEUE_BUFFER_SIZE            (14000*1024)
+#define TX_QUEUE_BUFFER_SIZE            (18096*1024)
 #define TX_QUEUE_BUFFER_HIGH            high_addr_calc(TX_QUEUE_BUFFER_BASE, TX_QUEUE_BUFFER_SIZE)
 
 /* Like the Tx Queue, BSS Info consists of two pieces:
@@ -138,12 +142,37 @@
 #define USER_SCRATCH_HIGH				high_addr_calc(USER_SCRATCH_BASE, USER_SCRATCH_SIZE)
 
 
+/* The LTG trace buffer holds the records replayed by LTG_SCHED_TYPE_TRACE schedules. Records are
+ * written by WLAN_EXP (see wlan_mac_ltg.h). Each record is 12 bytes, so 4 MB holds 349525 records.
+ */
+#define LTG_TRACE_BUFFER_BASE			(USER_SCRATCH_BASE + USER_SCRATCH_SIZE)
+#define LTG_TRACE_BUFFER_SIZE			(4096*1024)
+#define LTG_TRACE_BUFFER_HIGH			high_addr_calc(LTG_TRACE_BUFFER_BASE, LTG_TRACE_BUFFER_SIZE)
+
+
+/* The event log time index holds the checkpoints used to find entries by time (see wlan_mac_event_log.h).
+ * Each checkpoint is 16 bytes, so 256 kB holds one checkpoint per 64 kB of a 1 GB event log.
+ */
+#define EVENT_LOG_INDEX_BASE			(LTG_TRACE_BUFFER_BASE + LTG_TRACE_BUFFER_SIZE)
+#define EVENT_LOG_INDEX_SIZE			(256*1024)
+#define EVENT_LOG_INDEX_HIGH			high_addr_calc(EVENT_LOG_INDEX_BASE, EVENT_LOG_INDEX_SIZE)
+
+
+/* The event log skip index holds the offset of the first entry in each block of the event log, which
+ * lets the oldest entry move past an allocation without walking every entry (see wlan_mac_event_log.h).
+ * Each block offset is 2 bytes, so 512 kB holds one offset per 4 kB of a 1 GB event log.
+ */
+#define EVENT_LOG_SKIP_BASE				(EVENT_LOG_INDEX_BASE + EVENT_LOG_INDEX_SIZE)
+#define EVENT_LOG_SKIP_SIZE				(512*1024)
+#define EVENT_LOG_SKIP_HIGH				high_addr_calc(EVENT_LOG_SKIP_BASE, EVENT_LOG_SKIP_SIZE)
+
+
 /* Finally, the remaining space in DRAM is used for the WLAN_EXP event log. The above sections in DRAM
  * are much smaller than the space set aside for the event log. In the current implementation, the
- * event log is ~996 MB.
+ * event log is ~987 MB.
  */
-#define EVENT_LOG_BASE					(USER_SCRATCH_BASE + USER_SCRATCH_SIZE)
-#define EVENT_LOG_SIZE					(DRAM_SIZE - (TX_QUEUE_BUFFER_SIZE + BSS_INFO_BUFFER_SIZE + USER_SCRATCH_SIZE))
+#define EVENT_LOG_BASE					(EVENT_LOG_SKIP_BASE + EVENT_LOG_SKIP_SIZE)
+#define EVENT_LOG_SIZE					(DRAM_SIZE - (TX_QUEUE_BUFFER_SIZE + BSS_INFO_BUFFER_SIZE + USER_SCRATCH_SIZE + LTG_TRACE_BUFFER_SIZE + EVENT_LOG_INDEX_SIZE + EVENT_LOG_SKIP_SIZE))
 #define EVENT_LOG_HIGH					high_addr_calc(EVENT_LOG_BASE, EVENT_LOG_SIZE)
 
 // End Aux. BRAM and DRAM Memory Map
@@ -215,6 +244,8 @@ typedef struct{
 	u32		tx_num_packets_success;		///< # of successfully transmitted packets (high-level MPDUs)
 	u32		tx_num_packets_total;		///< Total # of transmitted packets (high-level MPDUs)
 	u32		tx_num_packets_low;			///< # of low-level transmitted frames (including retransmissions)
+	u32		tx_num_packets_requeued;	///< # of failed high-level MPDUs re-enqueued for another attempt
+	u32		tx_num_packets_retry_dropped;	///< # of failed high-level MPDUs dropped by the retry budget or age limit
 } frame_statistics_txrx;
 
 
@@ -237,7 +268,7 @@ typedef struct{
 	MY_STATISTICS_TXRX_COMMON_FIELDS
 	u64     latest_txrx_timestamp;                              ///< Timestamp of the last frame reception
 } statistics_txrx;
-CASSERT(sizeof(statistics_txrx) == 96, statistics_txrx_alignment_check);
+CASSERT(sizeof(statistics_txrx) == 112, statistics_txrx_alignment_check);
 
 
 /**
@@ -331,6 +362,8 @@ extern const  u8 bcast_addr[6];
 //////////// Initialization Functions ////////////
 void               wlan_mac_high_init();
 void               wlan_mac_high_heap_init();
+void               wlan_mac_high_poll();
+void               wlan_mac_high_main_loop();
 
 int                         wlan_mac_high_interrupt_init();
 inline int                  wlan_mac_high_interrupt_restore_state(interrupt_state_t new_interrupt_state);
@@ -372,6 +405,7 @@ void               wlan_mac_high_blink_hex_display(u32 num_blinks, u32 blink_tim
 int                wlan_mac_high_memory_test();
 int                wlan_mac_high_right_shift_test();
 
+int                wlan_mac_high_cdma_addr_ok(void* addr);
 int                wlan_mac_high_cdma_start_transfer(void* dest, void* src, u32 size);
 void               wlan_mac_high_cdma_finish_transfer();
 
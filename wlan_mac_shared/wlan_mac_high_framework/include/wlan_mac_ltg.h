@@ -24,6 +24,9 @@
 //LTG Schedules define the times when LTG event callbacks are called.
 #define LTG_SCHED_TYPE_PERIODIC			1
 #define LTG_SCHED_TYPE_UNIFORM_RAND	 	2
+#define LTG_SCHED_TYPE_POISSON	 		3
+#define LTG_SCHED_TYPE_PARETO_ON_OFF	4
+#define LTG_SCHED_TYPE_TRACE	 		5
 
 //LTG Payloads define how payloads are constructed once the LTG event callbacks
 //are called. For example, the LTG_SCHED_TYPE_PERIODIC schedule that employs the
@@ -32,6 +35,7 @@
 #define LTG_PYLD_TYPE_FIXED				1
 #define LTG_PYLD_TYPE_UNIFORM_RAND		2
 #define LTG_PYLD_TYPE_ALL_ASSOC_FIXED	3
+#define LTG_PYLD_TYPE_TRACE				4
 
 
 #define LTG_REMOVE_ALL                  0xFFFFFFFF
@@ -49,12 +53,18 @@ typedef struct tg_schedule tg_schedule;
 struct tg_schedule{
 	u32 id;
 	u32 type;
-	u64 target;
+	u64 target;                                      ///< LTG check at which the next event is due
 	u64	stop_target;
 	void* params;
 	void* callback_arg;
 	function_ptr_t cleanup_callback;
 	void* state;
+	u64 target_usec;                                 ///< Time of the next event (usec of LTG checks); keeps the fraction of a check
+	u64 wheel_target;                                ///< LTG check at which the LTG is next visited (next event or stop)
+	dl_entry wheel_entry;                            ///< Entry in the timing wheel slot of wheel_target
+	u8 in_wheel;
+	u8 reserved[3];
+	u32 tx_seq;                                      ///< ltg_seq of the next frame created for the LTG
 };
 
 //LTG Schedules
@@ -69,8 +79,8 @@ typedef struct {
 } ltg_sched_state_hdr;
 
 typedef struct {
-	u32 interval_count;
-	u64 duration_count;
+	u32 interval_usec;
+	u64 duration_usec;
 } ltg_sched_periodic_params;
 
 typedef struct {
@@ -79,9 +89,9 @@ typedef struct {
 } ltg_sched_periodic_state;
 
 typedef struct {
-	u32 min_interval_count;
-	u32 max_interval_count;
-	u64 duration_count;
+	u32 min_interval_usec;
+	u32 max_interval_usec;
+	u64 duration_usec;
 } ltg_sched_uniform_rand_params;
 
 typedef struct {
@@ -89,6 +99,62 @@ typedef struct {
 	u32 time_to_next_count;
 } ltg_sched_uniform_rand_state;
 
+//Exponentially distributed intervals (Poisson arrivals)
+typedef struct {
+	u32 mean_interval_usec;
+	u64 duration_usec;
+} ltg_sched_poisson_params;
+
+typedef struct {
+	ltg_sched_state_hdr hdr;
+	u32 time_to_next_count;
+} ltg_sched_poisson_state;
+
+//Bursts of periodic events separated by idle periods. The lengths of the on (burst) and off (idle)
+//periods are Pareto distributed with the given means and shape. The shape is in 1/100 units and must
+//be greater than 100; shapes close to 100 give the heaviest tails.
+typedef struct {
+	u32 interval_usec;
+	u32 mean_on_usec;
+	u32 mean_off_usec;
+	u32 shape;
+	u64 duration_usec;
+} ltg_sched_pareto_on_off_params;
+
+typedef struct {
+	ltg_sched_state_hdr hdr;
+	u32 time_to_next_count;
+	u32 num_bursts;
+	u64 on_end_usec;                                 ///< End of the current on period (usec of LTG checks)
+} ltg_sched_pareto_on_off_state;
+
+//Replay of records from the LTG trace buffer. Each record gives the time since the previous event,
+//and the length and destination to use for its event. Records are written with ltg_trace_write().
+typedef struct {
+	u32 delta_usec;
+	u16 length;
+	u8  addr_da[6];
+} ltg_trace_record;
+
+#define LTG_TRACE_MAX_NUM_RECORDS      (LTG_TRACE_BUFFER_SIZE / sizeof(ltg_trace_record))
+#define LTG_TRACE_LOOP_FOREVER         0
+
+typedef struct {
+	u32 start_index;                                 ///< Index of the first record in the trace buffer
+	u32 num_records;
+	u32 num_loops;                                   ///< Number of times to replay the records, or LTG_TRACE_LOOP_FOREVER
+	u64 duration_usec;
+} ltg_sched_trace_params;
+
+typedef struct {
+	ltg_sched_state_hdr hdr;
+	u32 time_to_next_count;
+	u32 index;                                       ///< Record of the next event, relative to start_index
+	u32 num_loops;                                   ///< Number of completed replays
+	u16 length;                                      ///< Length of the current event, from its record
+	u8  addr_da[6];                                  ///< Destination of the current event, from its record
+} ltg_sched_trace_state;
+
 //LTG Payload Profiles
 
 typedef struct {
@@ -115,20 +181,92 @@ typedef struct {
 	u16 padding;
 } ltg_pyld_uniform_rand;
 
+//The length and destination of each event are taken from the current record of an
+//LTG_SCHED_TYPE_TRACE schedule (see ltg_sched_trace_state)
+typedef struct {
+	ltg_pyld_hdr hdr;
+} ltg_pyld_trace;
+
 
 //LTG Payload Contents
+//
+//Frames from nodes older than WLAN Exp 1.5.0 end the ltg_packet_id after ltg_id. The fields after it
+//are only valid if magic is LTG_PACKET_ID_MAGIC; its low byte is the version of those fields.
+#define LTG_PACKET_ID_MAGIC            0x4C544701  // "LTG" + version 1 (ltg_seq, timestamp)
 
 typedef struct {
 	llc_header  llc_hdr;
 	u64         unique_seq;
 	u32         ltg_id;
+	u32         magic;                               ///< LTG_PACKET_ID_MAGIC
+	u32         ltg_seq;                             ///< Sequence number of the frame among the frames of the LTG
+	u64         timestamp;                           ///< System time (usec) at which the frame was created
 } ltg_packet_id;
 
 
+//LTG Receive Statistics
+//
+//Receptions of LTG frames are tracked per flow, where a flow is the frames of one LTG of one source
+//(address_2, ltg_id). Loss, duplicates and reordering are found from ltg_seq. One-way delay and
+//jitter are found from the timestamp of the frame, so they are only meaningful when the times of the
+//nodes are synchronized. Losses are counted per LTG, so frames of an LTG sent to other destinations
+//(e.g. LTG_PYLD_TYPE_ALL_ASSOC_FIXED) are counted as lost.
+#define LTG_RX_FLOW_TABLE_SIZE         64          // Hash buckets, must be a power of 2
+#define LTG_RX_MAX_NUM_FLOWS           64
+#define LTG_RX_SEQ_WINDOW              64          // Sequence numbers behind the highest in which duplicates are found
+
+//One-way delays are kept in a histogram with 2^LTG_RX_DELAY_SUB_BINS_LOG2 bins per power of 2 usec,
+//so delay percentiles are within 1/2^(LTG_RX_DELAY_SUB_BINS_LOG2 + 1) of the true value. The last bin
+//holds all delays over ~33 seconds.
+#define LTG_RX_DELAY_SUB_BINS_LOG2     2
+#define LTG_RX_DELAY_NUM_BINS          96
+
+#define LTG_RX_STATS_ENABLE_DEFAULT    1
+
+typedef struct {
+	u32 num_rx;                                      ///< Frames received, including duplicates
+	u32 num_lost;                                    ///< Gaps in ltg_seq that have not been filled by reordered frames
+	u32 num_dup;                                     ///< Frames whose ltg_seq had already been received
+	u32 num_reorder;                                 ///< Frames received after a frame with a higher ltg_seq
+	u32 jitter;                                      ///< Interarrival jitter (RFC 3550) (usec)
+	u32 delay_min;                                   ///< One-way delay (usec)
+	u32 delay_avg;
+	u32 delay_max;
+	u32 delay_p50;
+	u32 delay_p90;
+	u32 delay_p99;
+	u32 num_delay_negative;                          ///< Frames received before their timestamp (delay counted as 0)
+} ltg_rx_flow_stats;
+
+typedef struct {
+	dl_entry entry;                                  ///< Entry in the list of all flows
+	dl_entry bucket_entry;                           ///< Entry in the hash bucket of the flow
+	u8  addr_src[6];
+	u16 reserved;
+	u32 ltg_id;
+	u32 seq_max;                                     ///< Highest ltg_seq received
+	u64 seq_window;                                  ///< Bit i is set if seq_max - i has been received
+	s64 transit_last;                                ///< Rx time minus timestamp of the last frame (usec)
+	u64 delay_total;
+	u32 jitter_q4;                                   ///< Interarrival jitter in 1/16 usec
+	ltg_rx_flow_stats stats;                         ///< Percentiles and averages are filled in by ltg_rx_stats_get()
+	u32 delay_hist[LTG_RX_DELAY_NUM_BINS];
+} ltg_rx_flow;
+
+
 //Note: This definition simply reflects the use of the fast timer for LTG polling. To increase LTG
 //polling rate at the cost of more overhead in checking LTGs, increase the speed of the fast timer.
 #define LTG_POLL_INTERVAL              FAST_TIMER_DUR_US
 
+//Running LTGs are kept in a timing wheel with one slot per LTG check. Each check only visits the
+//LTGs in its slot; LTGs due more than a revolution in the future are skipped until their check.
+#define LTG_WHEEL_NUM_SLOTS            256         // Must be a power of 2
+
+//Schedule intervals are kept in microseconds, so an LTG whose interval is shorter than LTG_POLL_INTERVAL
+//has several events in one check. This limits the events per LTG per check; the rest are made up in
+//later checks.
+#define LTG_MAX_EVENTS_PER_CHECK       16
+
 #define LTG_ID_INVALID	               0xFFFFFFFF
 
 //External function to LTG -- user code interacts with the LTG via these functions
@@ -147,6 +285,13 @@ int ltg_sched_get_state(u32 id, u32* type, void** state);
 int ltg_sched_get_params(u32 id, void** params);
 int ltg_sched_get_callback_arg(u32 id, void** callback_arg);
 int wlan_create_ltg_frame(void* pkt_buf, mac_header_80211_common* common, u8 tx_flags, u32 ltg_id);
+int ltg_trace_write(u32 index, u32 num_records, ltg_trace_record* records);
+
+void ltg_rx_process(void* pkt_buf_addr);
+void ltg_rx_stats_set_enable(u8 enable);
+u32  ltg_rx_stats_num_flows();
+int  ltg_rx_stats_get(u32 index, u8* addr_src, u32* ltg_id, ltg_rx_flow_stats* stats);
+void ltg_rx_stats_reset();
 
 // WLAN Exp function to LTG -- users may call these directly or modify if needed
 void * ltg_sched_deserialize(u32 * src, u32 * ret_type, u32 * ret_size);
@@ -21,11 +21,142 @@
 
 #define QUEUE_BUFFER_SIZE	0x1000 	//4KB
 
-typedef dl_entry tx_queue_element;
+//Tx queue buffers are carved out of TX_QUEUE_BUFFER_BASE in several size classes so that small
+//packets (TCP ACKs, ARP, management frames) do not each occupy a full QUEUE_BUFFER_SIZE slot.
+//Size classes are ordered from smallest to largest. Every buffer size includes the queue metadata,
+//tx_frame_info and PHY header padding that precede the frame (see QUEUE_BUFFER_HDR_SIZE).
+#define QUEUE_NUM_SIZE_CLASSES      3
+
+#define QUEUE_SIZE_CLASS_SMALL      0
+#define QUEUE_SIZE_CLASS_MEDIUM     1
+#define QUEUE_SIZE_CLASS_LARGE      2
+
+#define QUEUE_BUFFER_SIZE_SMALL     0x100      //256B  - TCP ACKs, ARP and most management frames
+#define QUEUE_BUFFER_SIZE_MEDIUM    0x680      //1664B - Encapsulated Ethernet frame up to 1522 bytes (802.1Q tagged)
+#define QUEUE_BUFFER_SIZE_LARGE     QUEUE_BUFFER_SIZE
+
+//queue_checkout() and queue_checkout_list() do not know the length of the frame the caller will build,
+//so they always return large buffers. The large class is sized first and holds QUEUE_BUFFER_NUM_LARGE
+//buffers, the number of QUEUE_BUFFER_SIZE buffers the Tx queue held before it was divided into size
+//classes, so those callers keep their capacity. The rest of TX_QUEUE_BUFFER_SIZE is shared between
+//the small and medium classes.
+#define QUEUE_BUFFER_NUM_LARGE      3413
+
+//Percentage of the space left after the large class given to each size class
+#define QUEUE_BUFFER_SHARE_SMALL    20
+#define QUEUE_BUFFER_SHARE_MEDIUM   80
+#define QUEUE_BUFFER_SHARE_LARGE    0
+
+//Tx queue elements are compact descriptors kept in aux. BRAM. Lists of elements are linked by
+//16-bit element indices rather than pointers, and the DRAM buffer described by an element is
+//computed from its index (see queue_element_buffer()) rather than stored in it.
+//
+//Code written for the dl_entry based element, which accessed the buffer as tqe->data, should use
+//queue_element_data(tqe). Code that cannot be changed yet may define QUEUE_ELEMENT_DATA_FIELD to
+//restore the data field; this doubles the size of each element and halves the number of elements
+//that fit in TX_QUEUE_DL_ENTRY_MEM_SIZE.
+#define QUEUE_INDEX_NONE                0xFFFF
+
+typedef struct{
+	u16   next;                                    // Index of next element in the list, QUEUE_INDEX_NONE if last
+	u16   prev;                                    // Index of previous element in the list, QUEUE_INDEX_NONE if first
+#ifdef QUEUE_ELEMENT_DATA_FIELD
+	void* data;                                    // Same as queue_element_buffer(); set by queue_init()
+#endif
+} tx_queue_element;
+
+#define queue_element_data(tqe)         ((void*)queue_element_buffer(tqe))
+
+typedef struct{
+	u16   first;                                   // Index of first element, QUEUE_INDEX_NONE if empty
+	u16   last;                                    // Index of last element, QUEUE_INDEX_NONE if empty
+	u32   length;
+} tx_queue_list;
+
+#define QUEUE_SEL_NONE                  0xFFFFFFFF
+
+#define QUEUE_DRR_QUANTUM_DEFAULT       1600       // Bytes credited per DRR round; covers a full-size MPDU
+#define QUEUE_DRR_QUANTUM_MIN           64
+
+#define QUEUE_BITMAP_NUM_WORDS(x)       (((x) + 31) >> 5)
+
+#define QUEUE_AQM_MODE_DISABLED         0
+#define QUEUE_AQM_MODE_DROP             1          // Head-drop packets chosen by the control law
+#define QUEUE_AQM_MODE_MARK             2          // Set ECN CE on ECN capable IPv4 packets, head-drop all others
+
+#define QUEUE_AQM_TARGET_DEFAULT        5000       // usec
+#define QUEUE_AQM_INTERVAL_DEFAULT      100000     // usec
+#define QUEUE_AQM_MTU                   1500       // Queues holding no more than this many bytes are never dropped from
+
+//Each queue is split into one sub-queue per 802.11e access category (AC). AC values follow the
+//EDCA ACI encoding, so a queue entry whose metadata has not been classified defaults to best effort.
+#define QUEUE_NUM_AC                    4
+
+#define QUEUE_AC_BE                     0          // Best effort
+#define QUEUE_AC_BK                     1          // Background
+#define QUEUE_AC_VI                     2          // Video
+#define QUEUE_AC_VO                     3          // Voice
+
+#define QUEUE_AC_SCHED_STRICT           0          // Always serve the highest priority non-empty AC
+#define QUEUE_AC_SCHED_WEIGHTED         1          // Serve non-empty ACs in proportion to their weights (packets per round)
+
+#define QUEUE_AC_WEIGHT_BE_DEFAULT      4
+#define QUEUE_AC_WEIGHT_BK_DEFAULT      1
+#define QUEUE_AC_WEIGHT_VI_DEFAULT      8
+#define QUEUE_AC_WEIGHT_VO_DEFAULT      16
+
+//Free pool sharing uses a dynamic threshold (A. K. Choudhury and E. L. Hahne, "Dynamic Queue Length
+//Thresholds for Shared-Memory Packet Switches"): a queue may hold at most alpha times the number of
+//free entries. Alpha is expressed in 1/8 units. Sharing is disabled by default, so that a single
+//backlogged queue can use the whole pool; an alpha of 16 (2 x free entries) limits it to 2/3 of the pool.
+#define QUEUE_SHARE_ALPHA_DISABLED      0
+#define QUEUE_SHARE_ALPHA_DEFAULT       QUEUE_SHARE_ALPHA_DISABLED
+#define QUEUE_SHARE_RESERVE_DEFAULT     64         // Free entries below which the longest queue is head-dropped
+#define QUEUE_SHARE_MIN_ENTRIES         2          // Every queue may hold at least this many entries
+
+//Packets that CPU Low fails to deliver can be re-enqueued at the head of their queue. The queue entry is
+//held until CPU Low reports the result, so it is not returned to the free pool at transmission.
+#define QUEUE_RETRY_MAX_DISABLED        0
+#define QUEUE_RETRY_AGE_LIMIT_DEFAULT   100000     // usec since tx_frame_info.timestamp_create
+
+typedef struct{
+	u32   deficit;                                 // DRR deficit counter (bytes)
+	u32   quantum;                                 // DRR quantum (bytes per round)
+	u32   num_bytes;                               // Bytes currently in the queue
+	u8    ac_credit[QUEUE_NUM_AC];                 // Packets each AC may still send this round (QUEUE_AC_SCHED_WEIGHTED)
+
+	u8    aqm_dropping;                            // AQM is in the dropping state
+	u8    reserved[3];
+	u32   aqm_count;                               // Drops since entering the dropping state
+	u32   aqm_lastcount;                           // aqm_count when the dropping state was last entered
+	u64   aqm_first_above_time;                    // Time at which the sojourn time will have been above target for an interval
+	u64   aqm_drop_next;                           // Time of the next scheduled drop
+
+	u32   num_dequeued;                            // Packets dequeued for transmission
+	u32   num_aqm_drops;                           // Packets dropped by AQM
+	u32   num_aqm_marks;                           // Packets marked by AQM
+	u32   num_share_drops;                         // Packets refused or head-dropped to enforce the free pool share
+	u32   sojourn_last;                            // Sojourn time of the last packet dequeued for transmission (usec)
+	u32   sojourn_avg;                             // Moving average (1/8 weight) of the sojourn time of packets dequeued for transmission (usec)
+	u32   sojourn_max;                             // Maximum sojourn time of packets dequeued for transmission (usec)
+} tx_queue_info;
+
+typedef struct{
+	u32   num_queued;
+	u32   num_bytes;
+	u32   num_dequeued;
+	u32   num_aqm_drops;
+	u32   num_aqm_marks;
+	u32   num_share_drops;
+	u32   sojourn_last;
+	u32   sojourn_avg;
+	u32   sojourn_max;
+} tx_queue_stats;
 
 typedef struct{
 	u8	  metadata_type;
-	u8	  reserved[3];
+	u8	  ac;                                      // Access category (QUEUE_AC_*) selecting the sub-queue at enqueue
+	u8	  reserved[2];
 	u32   metadata_ptr;
 } tx_queue_metadata;
 
@@ -34,6 +165,10 @@ typedef struct{
 #define QUEUE_METADATA_TYPE_TX_PARAMS   	0x02
 
 
+//The frame array is declared for a QUEUE_BUFFER_SIZE buffer, but only buffers of the large size class
+//are that long. A small or medium buffer holds QUEUE_BUFFER_FRAME_SIZE(QUEUE_BUFFER_SIZE_SMALL) or
+//QUEUE_BUFFER_FRAME_SIZE(QUEUE_BUFFER_SIZE_MEDIUM) frame bytes, so sizeof(frame) must not be used as
+//the length of a buffer's frame; use queue_frame_capacity() instead.
 typedef struct{
 	tx_queue_metadata metadata;
 	tx_frame_info frame_info;
@@ -41,21 +176,65 @@ typedef struct{
 	u8 frame[QUEUE_BUFFER_SIZE - PHY_TX_PKT_BUF_PHY_HDR_SIZE - sizeof(tx_frame_info) - sizeof(tx_queue_metadata)];
 } tx_queue_buffer;
 
+#define QUEUE_BUFFER_HDR_SIZE             (sizeof(tx_queue_metadata) + sizeof(tx_frame_info) + PHY_TX_PKT_BUF_PHY_HDR_SIZE)
+#define QUEUE_BUFFER_FRAME_SIZE(x)        ((x) - QUEUE_BUFFER_HDR_SIZE)
+
 void queue_init(u8 dram_present);
 
 tx_queue_element* queue_checkout();
+tx_queue_element* queue_checkout_sized(u32 length);
 void queue_checkin(tx_queue_element* tqe);
 
-void enqueue_after_tail(u16 queue_sel, tx_queue_element* tqe);
+tx_queue_buffer* queue_element_buffer(tx_queue_element* tqe);
+tx_queue_element* queue_element_next(tx_queue_element* tqe);
+
+void queue_list_init(tx_queue_list* list);
+tx_queue_element* queue_list_first(tx_queue_list* list);
+
+u32 queue_frame_capacity(tx_queue_element* tqe);
+tx_queue_element* queue_downsize(tx_queue_element* tqe, u32 length);
+
+int enqueue_after_tail(u16 queue_sel, tx_queue_element* tqe);
+int enqueue_before_head(u16 queue_sel, tx_queue_element* tqe);
 tx_queue_element* dequeue_from_head(u16 queue_sel);
 
-int queue_checkout_list(dl_list* new_list, u16 num_tqe);
+int queue_checkout_list(tx_queue_list* new_list, u16 num_tqe);
+int queue_checkout_list_sized(tx_queue_list* new_list, u16 num_tqe, u32 length);
 inline u32 queue_num_free();
+u32 queue_num_free_sized(u32 length);
 inline u32 queue_num_queued(u16 queue_sel);
+u32 queue_num_queued_ac(u16 queue_sel, u8 ac);
+u32 queue_num_active();
+
+void queue_set_drr_quantum(u16 queue_sel, u32 quantum);
+u32 queue_drr_select();
+
+int queue_ac_sched_config(u32 mode, u8* weights);
+u32 queue_ac_sched_get_mode();
+
+int queue_share_config(u32 alpha, u32 reserve);
+u32 queue_share_get_alpha();
+u32 queue_share_get_reserve();
+u32 queue_share_get_cap();
+
+int queue_retry_config(u32 max_retries, u32 age_limit);
+u32 queue_retry_get_max();
+u32 queue_retry_get_age_limit();
+void queue_tx_done(int tx_pkt_buf, tx_frame_info* tx_mpdu);
+
+int queue_aqm_config(u32 mode, u32 target, u32 interval);
+u32 queue_aqm_get_mode();
+u32 queue_aqm_get_target();
+u32 queue_aqm_get_interval();
+
+u32 queue_num_queues();
+int queue_get_stats(u16 queue_sel, tx_queue_stats* stats);
+void queue_reset_stats();
 
 int queue_total_size();
 void purge_queue(u16 queue_sel);
 
 inline int dequeue_transmit_checkin(u16 queue_sel);
+int dequeue_transmit_checkin_drr();
 
 #endif /* WLAN_MAC_QUEUE_H_ */
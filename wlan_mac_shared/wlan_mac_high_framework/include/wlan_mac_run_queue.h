@@ -0,0 +1,103 @@
+/** @file wlan_mac_run_queue.h
+ *  @brief Run Queue
+ *
+ *  This contains code for deferring work from interrupt context to the
+ *  main loop of CPU High.
+ *
+ *  @copyright Copyright 2014-2015, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *				See LICENSE.txt included in the design archive or
+ *				at http://mangocomm.com/802.11/license
+ *
+ *  @author Chris Hunter (chunter [at] mangocomm.com)
+ *  @author Patrick Murphy (murphpo [at] mangocomm.com)
+ *  @author Erik Welsh (welsh [at] mangocomm.com)
+ */
+
+/***************************** Include Files *********************************/
+
+
+/*************************** Constant Definitions ****************************/
+#ifndef WLAN_MAC_RUN_QUEUE_H_
+#define WLAN_MAC_RUN_QUEUE_H_
+
+#include "wlan_mac_dl_list.h"
+#include "wlan_mac_misc_util.h"
+
+
+//Work is run in priority order. Within a priority, queued work items run before registered tasks.
+#define RUN_QUEUE_NUM_PRIORITIES                 3
+
+#define RUN_QUEUE_PRIORITY_HIGH                  0
+#define RUN_QUEUE_PRIORITY_NORMAL                1
+#define RUN_QUEUE_PRIORITY_LOW                   2
+
+//Number of work items that can be queued at each priority (must be a power of 2)
+#define RUN_QUEUE_WORK_SIZE                      32
+
+//Time (in microseconds) that queued work items of each priority may use in one pass of run_queue_poll()
+#define RUN_QUEUE_BUDGET_HIGH_DEFAULT            1000
+#define RUN_QUEUE_BUDGET_NORMAL_DEFAULT          500
+#define RUN_QUEUE_BUDGET_LOW_DEFAULT             250
+
+#define RUN_QUEUE_TASK_ID_INVALID                0xFFFFFFFF
+
+
+/*********************** Global Structure Definitions ************************/
+
+// **********************************************************************
+// Run Queue Statistics
+//
+//     Used for both registered tasks and the queued work items of a priority
+//
+typedef struct {
+
+	u32   num_runs;                          ///< Number of times the task was run
+	u32   num_overruns;                      ///< Number of runs that took longer than the budget
+	u32   run_time_last;                     ///< Run time of the last run (usec)
+	u32   run_time_max;                      ///< Maximum run time (usec)
+	u64   run_time_total;                    ///< Total run time (usec)
+
+} run_queue_stats;
+
+
+// **********************************************************************
+// Run Queue Task
+//
+//     A task is a function called once per pass of run_queue_poll(), such as
+//     wlan_eth_rx_task() or transport_poll(). The task is passed its argument
+//     and should return once its budget has been used.
+//
+typedef struct {
+
+	u32              id;
+	u8               priority;
+	u8               removed;                ///< Removed during run_queue_poll(); freed when the pass over the tasks ends
+	u8               reserved[2];
+	u32              budget;                 ///< Time (in microseconds) the task should use per call
+	function_ptr_t   function;
+	u32              arg;
+	run_queue_stats  stats;
+
+} run_queue_task;
+
+
+
+/*************************** Function Prototypes *****************************/
+
+void  run_queue_init();
+
+int   run_queue_enqueue(u8 priority, function_ptr_t function, u32 arg);
+void  run_queue_poll();
+
+u32   run_queue_task_register(u8 priority, u32 budget, function_ptr_t function, u32 arg);
+void  run_queue_task_remove(u32 id);
+
+int   run_queue_set_budget(u8 priority, u32 budget);
+
+int   run_queue_get_task_stats(u32 id, run_queue_stats* stats);
+int   run_queue_get_work_stats(u8 priority, run_queue_stats* stats);
+void  run_queue_print_stats();
+
+
+#endif /* WLAN_MAC_RUN_QUEUE_H_ */
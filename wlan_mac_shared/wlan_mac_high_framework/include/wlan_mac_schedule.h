@@ -34,8 +34,49 @@ typedef struct {
 	u32 num_calls;
 	u64 target;
 	function_ptr_t callback;
+	u32 heap_index;                                  ///< Position of the event in its scheduler's heap
+	u32 period;                                      ///< Interval between deadlines (usec); 0 for events scheduled in ticks
+	u64 deadline;                                    ///< Next deadline (usec) if period is non-zero
+	u32 generation;                                  ///< Changed when the event is removed or its record re-used; deferred calls of an older generation are dropped
+	u32 num_deferred;                                ///< Number of deferred calls of the event not yet made; the record returns to the pool once there are none
 } wlan_sched;
 
+//Events are allocated from a fixed pool. Each pool record holds the dl_entry
+//and the wlan_sched it points to.
+typedef struct {
+	dl_entry   entry;
+	wlan_sched sched;
+} wlan_sched_event;
+
+typedef struct {
+	u32 capacity;                                    ///< Number of events in the pool
+	u32 num_used;                                    ///< Number of events currently scheduled
+	u32 high_water;                                  ///< Maximum of num_used since boot
+	u32 num_failures;                                ///< Number of events not scheduled because the pool was empty
+} wlan_sched_pool_stats;
+
+typedef struct {
+	u8  tickless;                                    ///< Timer is programmed for the earliest event only
+	u8  reserved[3];
+	u32 num_interrupts;                              ///< Number of timer interrupts taken
+	u64 num_checks;                                  ///< Number of scheduler ticks elapsed
+	u32 num_deferred_overflows;                      ///< Number of deferred calls dropped because the deferred call queue was full
+	u32 num_deferred_dropped;                        ///< Number of deferred calls dropped because their event was removed before the call
+} wlan_sched_timer_stats;
+
+//Lateness of calls to events scheduled with wlan_mac_schedule_event_periodic(). Bin 0 of the
+//histogram counts calls made within the deadline's microsecond; bin N counts calls that were
+//[2^(N-1), 2^N) usec late. The last bin also counts all later calls.
+#define SCHEDULE_LATENESS_NUM_BINS               20
+
+typedef struct {
+	u32 num_calls;                                   ///< Number of calls
+	u32 num_missed;                                  ///< Number of deadlines skipped because they had already passed
+	u32 lateness_max;                                ///< Maximum lateness (usec)
+	u32 lateness_avg;                                ///< Moving average (1/8 weight) of the lateness (usec)
+	u32 hist[SCHEDULE_LATENESS_NUM_BINS];            ///< Lateness histogram
+} wlan_sched_lateness_stats;
+
 //Special value for num_calls parameter of wlan_sched
 #define SCHEDULE_REPEAT_FOREVER 0xFFFFFFFF
 
@@ -52,6 +93,28 @@ typedef struct {
 #define	SLOW_TIMER_DUR_US 102400
 
 
+// Number of hash buckets used to find events by ID (must be a power of 2)
+#define SCHEDULE_ID_TABLE_SIZE                   32
+
+// Schedulers start in periodic mode; see wlan_mac_schedule_set_tickless()
+#define SCHEDULE_TICKLESS_DEFAULT                0
+
+// Scheduler callbacks are deferred to the run queue and called from the main loop rather than
+// from the timer interrupt handler; see wlan_mac_schedule_set_deferred()
+#define SCHEDULE_DEFERRED_DEFAULT                1
+
+// Number of deferred calls each scheduler can hold until the main loop makes them (must be a power of 2)
+#define SCHEDULE_DEFERRED_QUEUE_SIZE             32
+
+// Number of events that may be scheduled at once before the event pool grows
+#define SCHEDULE_POOL_SIZE_DEFAULT               64
+
+// When an allocation leaves fewer free events than this, the pool is doubled by a run queue
+// work item so that the heap is not used from interrupt context. If the pool runs out before
+// the main loop has run the work item, events cannot be scheduled until it has.
+#define SCHEDULE_POOL_LOW_WATER                  8
+
+
 // Reserved Schedule ID range
 #define SCHEDULE_ID_RESERVED_MIN                 0xFFFFFF00
 #define SCHEDULE_ID_RESERVED_MAX                 0xFFFFFFFF
@@ -68,9 +131,21 @@ int wlan_mac_schedule_setup_interrupt(XIntc* intc);
 #define CALL_FOREVER 0xFFFFFF
 #define wlan_mac_schedule_event(scheduler_sel,delay,callback) wlan_mac_schedule_event_repeated(scheduler_sel,delay,1,callback)
 u32 wlan_mac_schedule_event_repeated(u8 scheduler_sel, u32 delay, u32 num_calls, void(*callback)());
+u32 wlan_mac_schedule_event_periodic(u8 scheduler_sel, u64 first_deadline, u32 period, u32 num_calls, void(*callback)());
 void wlan_mac_remove_schedule(u8 scheduler_sel, u32 id);
 
 dl_entry* find_schedule(u8 scheduler_sel, u32 id);
+
+int  wlan_mac_schedule_pool_config(u32 capacity);
+void wlan_mac_schedule_pool_get_stats(wlan_sched_pool_stats* stats);
+void wlan_mac_schedule_display_pool_info();
+
+int  wlan_mac_schedule_set_tickless(u8 scheduler_sel, u8 tickless);
+int  wlan_mac_schedule_set_deferred(u8 scheduler_sel, u8 deferred);
+int  wlan_mac_schedule_get_timer_stats(u8 scheduler_sel, wlan_sched_timer_stats* stats);
+
+int  wlan_mac_schedule_get_lateness_stats(u8 scheduler_sel, wlan_sched_lateness_stats* stats);
+int  wlan_mac_schedule_reset_lateness_stats(u8 scheduler_sel);
 void timer_handler(void *CallBackRef, u8 TmrCtrNumber);
 void XTmrCtr_CustomInterruptHandler(void *InstancePtr);
 
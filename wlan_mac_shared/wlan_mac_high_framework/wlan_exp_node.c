@@ -38,6 +38,8 @@
 #include "wlan_mac_ltg.h"
 #include "wlan_mac_schedule.h"
 #include "wlan_mac_bss_info.h"
+#include "wlan_mac_queue.h"
+#include "wlan_mac_run_queue.h"
 
 
 
@@ -49,6 +51,10 @@
 #define SYSMON_BASEADDR		                               XPAR_SYSMON_0_BASEADDR
 #endif
 
+// Size of the wn_buffer header (buffer_id, flags, bytes_remaining, start_byte, size) that
+// precedes the payload bytes of each buffer response packet
+#define NODE_BUFFER_HDR_NBYTES                             (5 * sizeof(u32))
+
 
 /*********************** Global Variable Definitions *************************/
 
@@ -84,6 +90,9 @@ int  node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr
 
 void node_ltg_cleanup(u32 id, void* callback_arg);
 
+void node_sendEarlyRespData(wn_respHdr* respHdr, void* data, u32 data_length, void* pktSrc, unsigned int eth_dev_num);
+u32  node_log_bytes_per_pkt(u32 bytes_per_pkt, u32 max_words);
+
 void create_wn_cmd_log_entry(wn_cmdHdr* cmdHdr, void * cmdArgs, u16 src_id);
 
 int  node_process_tx_power(u32 cmd, u32 aid, int tx_power);
@@ -330,6 +339,75 @@ void node_sendEarlyResp(wn_respHdr* respHdr, void* pktSrc, unsigned int eth_dev_
 
 
 
+/*****************************************************************************/
+/**
+* Node Send Early Response with Data
+*
+* Sends a response, like node_sendEarlyResp(), whose last data_length bytes
+* are not in the response buffer.  Only the response header and arguments are
+* prepared in the response buffer; the transport copies the data in to the
+* send buffer behind them with the central DMA.
+*
+* @param    Response Header        - WARPNet Response Header (the length includes the data)
+*           Data                   - Pointer to the data
+*           Data Length            - Number of bytes of data
+*           Packet Source          - Ethernet Packet Source
+*           Ethernet Device Number - Indicates which Ethernet device packet came from
+*
+* @return	None.
+*
+* @note		Data in the processor's local memory (DLMB) is copied by the processor
+*           rather than the central DMA (see transport_send_w_data()).
+*
+******************************************************************************/
+void node_sendEarlyRespData(wn_respHdr* respHdr, void* data, u32 data_length, void* pktSrc, unsigned int eth_dev_num){
+
+	 wn_host_message nodeResp;
+
+	 nodeResp.payload = (void*) respHdr;
+	 nodeResp.buffer  = (void*) respHdr - ( PAYLOAD_OFFSET + sizeof(wn_transport_header) );
+	 nodeResp.length  = PAYLOAD_PAD_NBYTES + respHdr->length - data_length + sizeof(wn_cmdHdr); //Extra 2 bytes is for alignment
+
+	//Endian swap the response header before before transport sends it
+	respHdr->cmd     = Xil_Ntohl(respHdr->cmd);
+	respHdr->length  = Xil_Ntohs(respHdr->length);
+	respHdr->numArgs = Xil_Ntohs(respHdr->numArgs);
+
+	 transport_send_w_data(sock_unicast, &nodeResp, data, data_length, pktSrc, eth_dev_num);
+
+}
+
+
+
+/*****************************************************************************/
+/**
+* Get the number of event log bytes to send per packet
+*
+* @param    bytes_per_pkt          - Number of bytes per packet requested by the host (0 for the default)
+*           max_words              - Default number of u32 words per packet
+*
+* @return	u32                    - Number of bytes per packet (a multiple of 4)
+*
+* @note		Requests larger than the data that fits in a frame of TRANSPORT_MTU
+*           bytes, after the transport, command and buffer headers, are truncated.
+*           Unless WLAN_EXP_JUMBO_FRAMES is set this is a standard 1500 byte frame.
+*
+******************************************************************************/
+u32 node_log_bytes_per_pkt(u32 bytes_per_pkt, u32 max_words){
+
+	u32 max_bytes = TRANSPORT_MAX_DATA_LENGTH(PAYLOAD_PAD_NBYTES + sizeof(wn_respHdr) + NODE_BUFFER_HDR_NBYTES);
+
+	bytes_per_pkt = min(bytes_per_pkt, max_bytes) & ~0x3;
+
+	if ( bytes_per_pkt == 0 ) {
+		bytes_per_pkt = max_words * 4;
+	}
+
+	return bytes_per_pkt;
+}
+
+
+
 /*****************************************************************************/
 /**
 * Node Commands
@@ -388,10 +466,13 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 	u32            transfer_size;
 	u32            bytes_per_pkt;
 	u32            num_bytes;
+	u32            log_address;
 	u32            num_pkts;
 	u64            time;
 	u64            new_time;
 	u64            abs_time;
+	u64            start_time;
+	u64            end_time;
 	int            power;
 	u32            rate;
 	u32            ant_mode;
@@ -406,6 +487,15 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 	u8             mac_addr[6];
 
 	u8			   entry_mask;
+	u8             entry_policy_mask[6];
+	entry_policy   policy;
+
+	u32                       num_records;
+	ltg_trace_record          trace_record;
+	ltg_rx_flow_stats         rx_flow_stats;
+	wlan_sched_timer_stats    sched_timer_stats;
+	wlan_sched_lateness_stats sched_lateness_stats;
+	tx_queue_stats            queue_stats;
 
     wlan_ipc_msg        ipc_msg_to_low;
     interrupt_state_t   prev_interrupt_state;
@@ -674,6 +764,7 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 			//                     [ 1] - Wrap = 1; No Wrap = 0;
 			//                     [ 2] - Full Payloads Enabled = 1; Full Payloads Disabled = 0;
 			//                     [ 3] - Log WN Cmds Enabled = 1; Log WN Cmds Disabled = 0;
+			//                     [ 6] - Compact TX / RX Entries = 1; Full TX / RX Entries = 0;
 			//   - cmdArgs32[1]  - mask for flags
 			//
             //   - respArgs32[0] - CMD_PARAM_SUCCESS
@@ -739,6 +830,14 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 				}
 			}
 
+			if ( ( temp2 & CMD_PARAM_LOG_CONFIG_FLAG_COMPACT ) == CMD_PARAM_LOG_CONFIG_FLAG_COMPACT ) {
+				if ( ( temp & CMD_PARAM_LOG_CONFIG_FLAG_COMPACT ) == CMD_PARAM_LOG_CONFIG_FLAG_COMPACT ) {
+					wlan_exp_log_set_compact( 1 );
+				} else {
+					wlan_exp_log_set_compact( 0 );
+				}
+			}
+
 			wlan_exp_log_set_entry_en_mask(entry_mask);
 
 			// Send response of status
@@ -756,6 +855,7 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
             //   - respArgs32[1] - Oldest empty entry index
             //   - respArgs32[2] - Number of wraps
             //   - respArgs32[3] - Flags
+            //   - respArgs32[4] - Number of entries that could not be allocated
 			//
 			temp = event_log_get_next_entry_index();
             respArgs32[respIndex++] = Xil_Htonl( temp );
@@ -769,6 +869,9 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 			temp = event_log_get_flags();
             respArgs32[respIndex++] = Xil_Htonl( temp );
 
+			temp = event_log_get_num_failures();
+            respArgs32[respIndex++] = Xil_Htonl( temp );
+
 			// Send response of current info
 			respHdr->length += (respIndex * sizeof(respArgs32));
 			respHdr->numArgs = respIndex;
@@ -804,6 +907,11 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 			//   - cmdArgs32[3] - size of transfer (in bytes)
 			//                      0xFFFF_FFFF  -> Get everything in the event log
 			//   - cmdArgs32[4] - bytes_per_pkt
+			//                      0            -> Use the default (~1400 bytes)
+			//                      Otherwise the number of payload bytes per packet, up to the data that
+			//                        fits in the Xilnet send buffer (see TRANSPORT_MAX_UDP_PAYLOAD); jumbo
+			//                        frames need WLAN_EXP_JUMBO_FRAMES (wlan_exp.h).  The host should use the payload
+			//                        size its network supports (see TRANS_PAYLOADSIZETEST_CMDID).
 			//
 			//   Return Value:
 			//     - wn_buffer
@@ -829,6 +937,7 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 			flags             = Xil_Ntohl(cmdArgs32[1]);
 			start_index       = Xil_Ntohl(cmdArgs32[2]);
             size              = Xil_Ntohl(cmdArgs32[3]);
+            bytes_per_pkt     = node_log_bytes_per_pkt(((cmdHdr->numArgs > 4) ? Xil_Ntohl(cmdArgs32[4]) : 0), max_words);
 
             // Get the size of the log to the "end"
             evt_log_size      = event_log_get_size(start_index);
@@ -838,7 +947,6 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
                 size = evt_log_size;
             }
 
-            bytes_per_pkt     = max_words * 4;
             num_pkts          = (size / bytes_per_pkt) + 1;
             if ( (size % bytes_per_pkt) == 0 ){ num_pkts--; }    // Subtract the extra pkt if the division had no remainder
             curr_index        = start_index;
@@ -879,16 +987,17 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
                 // Unfortunately, due to the byte swapping that occurs in node_sendEarlyResp, we need to set all
                 //   three command parameters for each packet that is sent.
 	            respHdr->cmd     = cmdHdr->cmd;
-	            respHdr->length  = 20 + transfer_size;
+	            respHdr->length  = NODE_BUFFER_HDR_NBYTES + transfer_size;
 				respHdr->numArgs = 5;
 
 				// Transfer data
-				num_bytes = event_log_get_data( curr_index, transfer_size, (char *) &respArgs32[5] );
+				//   NOTE:  The data is sent from the event log; it is not copied in to the response buffer
+				num_bytes = event_log_get_data_address( curr_index, transfer_size, &log_address );
 
-				// Check that we copied everything
+				// Check that we can send everything
 				if ( num_bytes == transfer_size ) {
 					// Send the packet
-					node_sendEarlyResp(respHdr, pktSrc, eth_dev_num);
+					node_sendEarlyRespData(respHdr, (void *) log_address, transfer_size, pktSrc, eth_dev_num);
 				} else {
 					wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log,
 							        "Tried to get %d bytes, but only received %d @ 0x%x \n", transfer_size, num_bytes, curr_index );
@@ -944,6 +1053,8 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 				} else {
 					memcpy( (void *)(&exp_info->info_payload[0]), (void *)(&cmdArgs32[2]), size );
 				}
+
+				event_log_commit_entry( exp_info );
 			}
 	    break;
 
@@ -966,8 +1077,60 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 
 		//---------------------------------------------------------------------
 		case CMDID_LOG_ENABLE_ENTRY:
-			wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log, "Enable Event not supported\n");
-			// TODO:  THIS FUNCTION IS NOT COMPLETE
+			// Set the policy of an entry type
+			//
+			// Message format:
+			//     cmdArgs32[0]   Entry type
+			//     cmdArgs32[1]   Policy (ENTRY_POLICY_*)
+			//     cmdArgs32[2]   Create one of every N entries (ENTRY_POLICY_SAMPLE)
+			//     cmdArgs32[3:4] Address (ENTRY_POLICY_ADDR)
+			//     cmdArgs32[5:6] Address mask (optional; ENTRY_POLICY_ADDR)
+			//
+			// Response format:
+			//     respArgs32[0]  Status
+			//     respArgs32[1]  Number of entries filtered by the previous policy
+			//
+			status = CMD_PARAM_SUCCESS;
+			size   = 0;
+
+			if ( cmdHdr->numArgs < 3 ) {
+				wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log, "Entry policy needs at least 3 arguments (%d given)\n", cmdHdr->numArgs);
+				status = CMD_PARAM_ERROR;
+			} else {
+				id     = Xil_Ntohl(cmdArgs32[0]);
+				temp   = Xil_Ntohl(cmdArgs32[1]);
+				temp2  = Xil_Ntohl(cmdArgs32[2]);
+
+				// Only read the address and mask that were sent; without an address an
+				// ENTRY_POLICY_ADDR policy is rejected, and without a mask every bit is matched
+				if ( cmdHdr->numArgs >= 5 ) {
+					wlan_exp_get_mac_addr(&cmdArgs32[3], &mac_addr[0]);
+				}
+
+				if ( cmdHdr->numArgs >= 7 ) {
+					wlan_exp_get_mac_addr(&cmdArgs32[5], &entry_policy_mask[0]);
+				}
+
+				if ( wlan_exp_log_get_entry_policy(id, &policy) == 0 ) {
+					size = policy.num_filtered;
+				}
+
+				if ( wlan_exp_log_set_entry_policy(id, temp, temp2,
+						                           ((cmdHdr->numArgs >= 5) ? mac_addr : NULL),
+						                           ((cmdHdr->numArgs >= 7) ? entry_policy_mask : NULL)) != 0 ) {
+					wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log, "Invalid policy %d for entry type %d\n", temp, id);
+					status = CMD_PARAM_ERROR;
+				} else {
+					wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_event_log, "Entry type %d policy = %d\n", id, temp);
+				}
+			}
+
+			// Send response
+            respArgs32[respIndex++] = Xil_Htonl( status );
+            respArgs32[respIndex++] = Xil_Htonl( size );
+
+			respHdr->length += (respIndex * sizeof(respArgs32));
+			respHdr->numArgs = respIndex;
 	    break;
 
 
@@ -1022,6 +1185,111 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
         break;
 
 
+	    //---------------------------------------------------------------------
+		case CMDID_LOG_GET_ENTRIES_BY_TIME:
+            // NODE_LOG_GET_ENTRIES_BY_TIME Packet Format:
+            //   - Note:  All u32 parameters in cmdArgs32 are byte swapped so use Xil_Ntohl()
+            //
+			//   - cmdArgs32[0] - buffer id
+			//   - cmdArgs32[1] - flags
+			//   - cmdArgs32[2] - start time (lower 32 bits)
+			//   - cmdArgs32[3] - start time (upper 32 bits)
+			//   - cmdArgs32[4] - end time (lower 32 bits)
+			//   - cmdArgs32[5] - end time (upper 32 bits)
+			//   - cmdArgs32[6] - bytes_per_pkt (same as CMDID_LOG_GET_ENTRIES)
+			//
+			//   Return Value:
+			//     - wn_buffer (same format as CMDID_LOG_GET_ENTRIES)
+			//
+			// NOTE:  The data is entry aligned and contains every entry allocated between the
+			//   start time and the end time (see event_log_get_time_range()).  The data is sent
+			//   in log order:  if the log has wrapped, start_byte will jump back to the first
+			//   entry after the node info entry, so the host should concatenate the payloads
+			//   in the order they are received.  If no data is found, a single packet with no
+			//   payload is sent.  If the command has fewer than 6 arguments, a single response
+			//   with status CMD_PARAM_ERROR is sent instead of a wn_buffer.
+            //
+
+			if ( cmdHdr->numArgs < 6 ) {
+				wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log, "Get entries by time needs at least 6 arguments (%d given)\n", cmdHdr->numArgs);
+
+				respArgs32[respIndex++] = Xil_Htonl( CMD_PARAM_ERROR );
+
+				respHdr->length += (respIndex * sizeof(respArgs32));
+				respHdr->numArgs = respIndex;
+				break;
+			}
+
+			id                = Xil_Ntohl(cmdArgs32[0]);
+			flags             = Xil_Ntohl(cmdArgs32[1]);
+			temp              = Xil_Ntohl(cmdArgs32[2]);
+			temp2             = Xil_Ntohl(cmdArgs32[3]);
+			start_time        = (((u64)temp2)<<32) + ((u64)temp);
+			temp              = Xil_Ntohl(cmdArgs32[4]);
+			temp2             = Xil_Ntohl(cmdArgs32[5]);
+			end_time          = (((u64)temp2)<<32) + ((u64)temp);
+
+			if ( event_log_get_time_range( start_time, end_time, &start_index, &size ) != 0 ) {
+				start_index = 0;
+				size        = 0;
+			}
+
+            bytes_per_pkt     = node_log_bytes_per_pkt(((cmdHdr->numArgs > 6) ? Xil_Ntohl(cmdArgs32[6]) : 0), max_words);
+            curr_index        = start_index;
+            bytes_remaining   = size;
+
+            // Initialize constant parameters
+            respArgs32[0] = Xil_Htonl( id );
+            respArgs32[1] = Xil_Htonl( flags );
+
+            // Iterate through all the packets
+            do {
+				// Get the number of bytes to the "end" of the log
+				evt_log_size = event_log_get_size( curr_index );
+
+				if ( ( evt_log_size == 0 ) && ( bytes_remaining != 0 ) ) {
+					// Continue from the beginning of the log (skipping the node info entry)
+					curr_index   = EVENT_LOG_WRAP_INDEX;
+					evt_log_size = event_log_get_size( curr_index );
+
+					if ( evt_log_size == 0 ) { break; }
+				}
+
+				// Compute the transfer size (packets do not cross the end of the log)
+				transfer_size = min( min( bytes_per_pkt, bytes_remaining ), evt_log_size );
+
+				// Set response args that change per packet
+				respArgs32[2]   = Xil_Htonl( bytes_remaining );
+	            respArgs32[3]   = Xil_Htonl( curr_index );
+                respArgs32[4]   = Xil_Htonl( transfer_size );
+
+	            respHdr->cmd     = cmdHdr->cmd;
+	            respHdr->length  = NODE_BUFFER_HDR_NBYTES + transfer_size;
+				respHdr->numArgs = 5;
+
+				// Transfer data
+				num_bytes = event_log_get_data_address( curr_index, transfer_size, &log_address );
+
+				// Check that we can send everything
+				if ( num_bytes == transfer_size ) {
+					// Send the packet
+					node_sendEarlyRespData(respHdr, (void *) log_address, transfer_size, pktSrc, eth_dev_num);
+				} else {
+					wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log,
+							        "Tried to get %d bytes, but only received %d @ 0x%x \n", transfer_size, num_bytes, curr_index );
+					break;
+				}
+
+				// Update our current address and bytes remaining
+				curr_index      += transfer_size;
+				bytes_remaining -= transfer_size;
+
+            } while ( bytes_remaining != 0 );
+
+			respSent = RESP_SENT;
+		break;
+
+
 //-----------------------------------------------------------------------------
 // Statistics Commands
 //-----------------------------------------------------------------------------
@@ -1324,6 +1592,121 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 		break;
 
 
+	    //---------------------------------------------------------------------
+		case CMDID_LTG_TRACE_WRITE:
+            // NODE_LTG_TRACE_WRITE Packet Format:
+			//   - cmdArgs32[0]      - Index of the first record in the trace buffer
+			//   - cmdArgs32[1]      - Number of records (N)
+			//   - cmdArgs32[2 - 4N+1] - Records (4 words each)
+			//                         [0] - Time since the previous event (usec)
+			//                         [1] - [15:0] Length
+			//                         [3:2] - Destination MAC address
+			//
+            //   - respArgs32[0]     - CMD_PARAM_SUCCESS
+			//                       - CMD_PARAM_ERROR + CMD_PARAM_LTG_ERROR;
+			//   - respArgs32[1]     - Maximum number of records the trace buffer holds (LTG_TRACE_MAX_NUM_RECORDS)
+			//
+			status      = CMD_PARAM_SUCCESS;
+			temp        = 0;
+			temp2       = 0;
+			num_records = 0;
+
+			if (cmdHdr->numArgs >= 2) {
+				temp        = Xil_Ntohl(cmdArgs32[0]);
+				temp2       = Xil_Ntohl(cmdArgs32[1]);
+				num_records = (cmdHdr->numArgs - 2) / 4;      // Number of records in the command
+			}
+
+			// The records must be in the command and fit in the trace buffer
+			if ((cmdHdr->numArgs < 2) || (temp2 > num_records) ||
+				(temp >= LTG_TRACE_MAX_NUM_RECORDS) || (temp2 > (LTG_TRACE_MAX_NUM_RECORDS - temp))) {
+	        	status = CMD_PARAM_ERROR + CMD_PARAM_LTG_ERROR;
+			}
+
+			if (status == CMD_PARAM_SUCCESS) {
+				for (i = 0; i < temp2; i++) {
+					trace_record.delta_usec = Xil_Ntohl(cmdArgs32[2 + (4 * i)]);
+					trace_record.length     = Xil_Ntohl(cmdArgs32[3 + (4 * i)]) & 0xFFFF;
+					wlan_exp_get_mac_addr(&cmdArgs32[4 + (4 * i)], &(trace_record.addr_da[0]));
+
+					ltg_trace_write(temp + i, 1, &trace_record);
+				}
+
+				wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_ltg, "Wrote %d trace records at %d\n", temp2, temp);
+			} else {
+				wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_ltg, "Failed to write %d trace records at %d\n", temp2, temp);
+			}
+
+			// Send response of status
+            respArgs32[respIndex++] = Xil_Htonl( status );
+            respArgs32[respIndex++] = Xil_Htonl( LTG_TRACE_MAX_NUM_RECORDS );
+
+			respHdr->length += (respIndex * sizeof(respArgs32));
+			respHdr->numArgs = respIndex;
+		break;
+
+
+	    //---------------------------------------------------------------------
+		case CMDID_LTG_RX_STATS:
+			// Get the receive statistics of LTG flows
+			//
+			// Message format:
+			//     cmdArgs32[0]   Flags
+			//                      CMD_PARAM_LTG_RX_STATS_FLAG_RESET - Remove all flows after reading them
+			//     cmdArgs32[1]   Index of first flow to return
+			// Response format:
+			//     respArgs32[0]  Status
+			//     respArgs32[1]  Total number of flows
+			//     respArgs32[2]  Number of flow records in this response
+			//     respArgs32[3:] Flow records; each record is the source MAC address (2 words), the LTG ID
+			//                    and an ltg_rx_flow_stats struct
+			//
+			// As many records as fit in the response are returned. The host should repeat the command
+			// starting at the first flow index not yet received, and only set the reset flag on the last.
+			//
+			size        = 3 + (sizeof(ltg_rx_flow_stats) / 4);     // Number of words per flow record
+			status      = CMD_PARAM_SUCCESS;
+			num_records = 0;
+			respIndex   = 3;
+
+			if (cmdHdr->numArgs < 2) {
+				wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_ltg, "LTG Rx stats needs 2 arguments (%d given)\n", cmdHdr->numArgs);
+				status = CMD_PARAM_ERROR + CMD_PARAM_LTG_ERROR;
+			} else {
+				temp        = Xil_Ntohl(cmdArgs32[0]);
+				start_index = Xil_Ntohl(cmdArgs32[1]);
+
+				for (curr_index = start_index; curr_index < ltg_rx_stats_num_flows(); curr_index++) {
+					if ((respIndex + size) > max_words) { break; }
+
+					if (ltg_rx_stats_get(curr_index, &mac_addr[0], &id, &rx_flow_stats) != 0) { break; }
+
+					wlan_exp_put_mac_addr(&mac_addr[0], &respArgs32[respIndex]);
+					respIndex += 2;
+
+					respArgs32[respIndex++] = Xil_Htonl( id );
+					for (i = 0; i < (sizeof(ltg_rx_flow_stats) / 4); i++) {
+						respArgs32[respIndex++] = Xil_Htonl( ((u32*)&rx_flow_stats)[i] );
+					}
+					num_records++;
+				}
+			}
+
+			temp2 = ltg_rx_stats_num_flows();
+
+			if ((status == CMD_PARAM_SUCCESS) && (temp & CMD_PARAM_LTG_RX_STATS_FLAG_RESET)) {
+				ltg_rx_stats_reset();
+			}
+
+			respArgs32[0] = Xil_Htonl( status );
+			respArgs32[1] = Xil_Htonl( temp2 );
+			respArgs32[2] = Xil_Htonl( num_records );
+
+			respHdr->length += (respIndex * sizeof(respArgs32));
+			respHdr->numArgs = respIndex;
+		break;
+
+
 //-----------------------------------------------------------------------------
 // Node Commands
 //-----------------------------------------------------------------------------
@@ -1364,6 +1747,8 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 				} else {
 					wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_ltg, "Removing All LTGs\n");
 				}
+
+				ltg_rx_stats_reset();
 			}
 
 			if ( ( temp & CMD_PARAM_NODE_RESET_FLAG_TX_DATA_QUEUE ) == CMD_PARAM_NODE_RESET_FLAG_TX_DATA_QUEUE ) {
@@ -1548,6 +1933,8 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 						}
 						time_entry->new_time   = new_time;
 						time_entry->abs_time   = abs_time;
+
+						event_log_commit_entry( time_entry );
 					}
 
 					// If this was a write, then update the time value so we can return it to the host
@@ -1754,6 +2141,58 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 		break;
 
 
+		//---------------------------------------------------------------------
+		case CMDID_NODE_SCHEDULE_STATS:
+			// Get the timer and lateness statistics of a scheduler
+			//
+			// Message format:
+			//     cmdArgs32[0]   Scheduler (SCHEDULE_FINE or SCHEDULE_COARSE)
+			//     cmdArgs32[1]   Flags
+			//                      CMD_PARAM_NODE_SCHEDULE_STATS_FLAG_RESET - Clear the lateness statistics after reading them
+			// Response format:
+			//     respArgs32[0]  Status
+			//     respArgs32[1]  Tickless mode enabled
+			//     respArgs32[2]  Number of timer interrupts
+			//     respArgs32[3:] wlan_sched_lateness_stats struct
+			//
+			// The lateness statistics cover events scheduled with microsecond deadlines. Rising lateness
+			// or missed deadlines indicate that the timer interrupt is overloaded.
+			//
+			status  = CMD_PARAM_SUCCESS;
+
+			bzero(&sched_timer_stats, sizeof(wlan_sched_timer_stats));
+			bzero(&sched_lateness_stats, sizeof(wlan_sched_lateness_stats));
+
+			if (cmdHdr->numArgs < 2) {
+				wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_node, "Schedule stats needs 2 arguments (%d given)\n", cmdHdr->numArgs);
+				status = CMD_PARAM_ERROR;
+			} else {
+				temp  = Xil_Ntohl(cmdArgs32[0]);
+				temp2 = Xil_Ntohl(cmdArgs32[1]);
+
+				if ((wlan_mac_schedule_get_timer_stats(temp, &sched_timer_stats) != 0) ||
+				    (wlan_mac_schedule_get_lateness_stats(temp, &sched_lateness_stats) != 0)) {
+					wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_node, "Unknown scheduler: %d\n", temp);
+					status = CMD_PARAM_ERROR;
+				} else if (temp2 & CMD_PARAM_NODE_SCHEDULE_STATS_FLAG_RESET) {
+					wlan_mac_schedule_reset_lateness_stats(temp);
+				}
+			}
+
+			// Send response
+			respArgs32[respIndex++] = Xil_Htonl( status );
+			respArgs32[respIndex++] = Xil_Htonl( sched_timer_stats.tickless );
+			respArgs32[respIndex++] = Xil_Htonl( sched_timer_stats.num_interrupts );
+
+			for (i = 0; i < (sizeof(wlan_sched_lateness_stats) / 4); i++) {
+				respArgs32[respIndex++] = Xil_Htonl( ((u32*)&sched_lateness_stats)[i] );
+			}
+
+			respHdr->length += (respIndex * sizeof(respArgs32));
+			respHdr->numArgs = respIndex;
+		break;
+
+
 	    //---------------------------------------------------------------------
 		case CMDID_NODE_TX_POWER:
             // CMDID_NODE_TX_POWER Packet Format:
@@ -2306,6 +2745,216 @@ int node_processCmd(const wn_cmdHdr* cmdHdr, void* cmdArgs, wn_respHdr* respHdr,
 		break;
 
 
+		//---------------------------------------------------------------------
+		case CMDID_QUEUE_AQM_CONFIG:
+			// Configure active queue management for all Tx queues
+			//
+			// Message format:
+			//     cmdArgs32[0]   Mode (QUEUE_AQM_MODE_DISABLED / _DROP / _MARK, or CMD_PARAM_RSVD for no change)
+			//     cmdArgs32[1]   Target delay in usec (or CMD_PARAM_RSVD for no change)
+			//     cmdArgs32[2]   Interval in usec (or CMD_PARAM_RSVD for no change)
+			//     cmdArgs32[3]   Flags
+			//                      [0] - Reset per-queue counters
+			// Response format:
+			//     respArgs32[0]  Status
+			//     respArgs32[1]  Mode
+			//     respArgs32[2]  Target delay in usec
+			//     respArgs32[3]  Interval in usec
+			//
+			status  = CMD_PARAM_SUCCESS;
+
+			if (cmdHdr->numArgs < 4) {
+				wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "AQM config needs 4 arguments (%d given)\n", cmdHdr->numArgs);
+				status = CMD_PARAM_ERROR + CMD_PARAM_QUEUE_ERROR;
+			} else {
+				msg_cmd = Xil_Ntohl(cmdArgs32[0]);
+				temp    = Xil_Ntohl(cmdArgs32[1]);
+				temp2   = Xil_Ntohl(cmdArgs32[2]);
+				flags   = Xil_Ntohl(cmdArgs32[3]);
+
+				if (msg_cmd == CMD_PARAM_RSVD) { msg_cmd = queue_aqm_get_mode();     }
+				if (temp    == CMD_PARAM_RSVD) { temp    = queue_aqm_get_target();   }
+				if (temp2   == CMD_PARAM_RSVD) { temp2   = queue_aqm_get_interval(); }
+
+				prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+				if (queue_aqm_config(msg_cmd, temp, temp2) != 0) {
+					wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Invalid AQM config: mode = %d, target = %d, interval = %d\n", msg_cmd, temp, temp2);
+					status = CMD_PARAM_ERROR + CMD_PARAM_QUEUE_ERROR;
+				}
+
+				if (flags & CMD_PARAM_QUEUE_AQM_CONFIG_FLAG_RESET_STATS) {
+					queue_reset_stats();
+				}
+
+				wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+			}
+
+			// Send response
+			respArgs32[respIndex++] = Xil_Htonl( status );
+			respArgs32[respIndex++] = Xil_Htonl( queue_aqm_get_mode() );
+			respArgs32[respIndex++] = Xil_Htonl( queue_aqm_get_target() );
+			respArgs32[respIndex++] = Xil_Htonl( queue_aqm_get_interval() );
+
+			respHdr->length += (respIndex * sizeof(respArgs32));
+			respHdr->numArgs = respIndex;
+		break;
+
+
+		//---------------------------------------------------------------------
+		case CMDID_QUEUE_GET_STATS:
+			// Get per-queue occupancy, sojourn time and AQM counters
+			//
+			// Message format:
+			//     cmdArgs32[0]   ID of first queue to return
+			// Response format:
+			//     respArgs32[0]  Status
+			//     respArgs32[1]  Total number of queues
+			//     respArgs32[2]  Number of queue records in this response
+			//     respArgs32[3:] Queue records; each record is the queue ID followed by a tx_queue_stats struct
+			//
+			// As many records as fit in the response are returned. The host should repeat the command
+			// starting at the first queue ID not yet received.
+			//
+			size        = 1 + (sizeof(tx_queue_stats) / 4);        // Number of words per queue record
+			status      = CMD_PARAM_SUCCESS;
+			num_records = 0;
+			respIndex   = 3;
+
+			if (cmdHdr->numArgs < 1) {
+				wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Queue stats needs 1 argument (%d given)\n", cmdHdr->numArgs);
+				status = CMD_PARAM_ERROR + CMD_PARAM_QUEUE_ERROR;
+			}
+
+			prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+			if (status == CMD_PARAM_SUCCESS) {
+				start_index = Xil_Ntohl(cmdArgs32[0]);
+
+				for (curr_index = start_index; curr_index < queue_num_queues(); curr_index++) {
+					if ((respIndex + size) > max_words) { break; }
+
+					queue_get_stats(curr_index, &queue_stats);
+
+					respArgs32[respIndex++] = Xil_Htonl( curr_index );
+					for (i = 0; i < (sizeof(tx_queue_stats) / 4); i++) {
+						respArgs32[respIndex++] = Xil_Htonl( ((u32*)&queue_stats)[i] );
+					}
+					num_records++;
+				}
+			}
+
+			temp = queue_num_queues();
+
+			wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+			respArgs32[0] = Xil_Htonl( status );
+			respArgs32[1] = Xil_Htonl( temp );
+			respArgs32[2] = Xil_Htonl( num_records );
+
+			respHdr->length += (respIndex * sizeof(respArgs32));
+			respHdr->numArgs = respIndex;
+		break;
+
+
+		//---------------------------------------------------------------------
+		case CMDID_QUEUE_SHARE_CONFIG:
+			// Configure how the Tx queue free pool is shared between queues
+			//
+			// Message format:
+			//     cmdArgs32[0]   Alpha: maximum queue length as a multiple of the number of free entries,
+			//                      in 1/8 units (0 to disable, or CMD_PARAM_RSVD for no change)
+			//     cmdArgs32[1]   Reserve: free entries below which the longest queue is head-dropped
+			//                      (or CMD_PARAM_RSVD for no change)
+			// Response format:
+			//     respArgs32[0]  Status
+			//     respArgs32[1]  Alpha
+			//     respArgs32[2]  Reserve
+			//     respArgs32[3]  Total number of queue entries
+			//     respArgs32[4]  Number of free full size queue entries (see queue_checkout())
+			//     respArgs32[5]  Current per-queue cap (entries)
+			//     respArgs32[6]  Number of free queue entries of every size class; the cap is a
+			//                      multiple of this
+			//
+			// Per-queue occupancy and the number of packets dropped to enforce the cap are
+			// returned by CMDID_QUEUE_GET_STATS.
+			//
+			status  = CMD_PARAM_SUCCESS;
+
+			prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+			if (cmdHdr->numArgs < 2) {
+				wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Queue share config needs 2 arguments (%d given)\n", cmdHdr->numArgs);
+				status = CMD_PARAM_ERROR + CMD_PARAM_QUEUE_ERROR;
+			} else {
+				temp    = Xil_Ntohl(cmdArgs32[0]);
+				temp2   = Xil_Ntohl(cmdArgs32[1]);
+
+				if (temp  == CMD_PARAM_RSVD) { temp  = queue_share_get_alpha();   }
+				if (temp2 == CMD_PARAM_RSVD) { temp2 = queue_share_get_reserve(); }
+
+				if (queue_share_config(temp, temp2) != 0) {
+					wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Invalid queue share config: alpha = %d, reserve = %d\n", temp, temp2);
+					status = CMD_PARAM_ERROR + CMD_PARAM_QUEUE_ERROR;
+				}
+			}
+
+			// Send response
+			respArgs32[respIndex++] = Xil_Htonl( status );
+			respArgs32[respIndex++] = Xil_Htonl( queue_share_get_alpha() );
+			respArgs32[respIndex++] = Xil_Htonl( queue_share_get_reserve() );
+			respArgs32[respIndex++] = Xil_Htonl( queue_total_size() );
+			respArgs32[respIndex++] = Xil_Htonl( queue_num_free() );
+			respArgs32[respIndex++] = Xil_Htonl( queue_share_get_cap() );
+			respArgs32[respIndex++] = Xil_Htonl( queue_num_free_sized(0) );
+
+			wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+			respHdr->length += (respIndex * sizeof(respArgs32));
+			respHdr->numArgs = respIndex;
+		break;
+
+
+		//---------------------------------------------------------------------
+		case CMDID_QUEUE_RETRY_CONFIG:
+			// Configure high-level retry of packets CPU Low failed to deliver
+			//
+			// Message format:
+			//     cmdArgs32[0]   Max number of re-enqueues per packet (0 to disable, or CMD_PARAM_RSVD for no change)
+			//     cmdArgs32[1]   Age limit in usec (or CMD_PARAM_RSVD for no change)
+			// Response format:
+			//     respArgs32[0]  Status
+			//     respArgs32[1]  Max number of re-enqueues per packet
+			//     respArgs32[2]  Age limit in usec
+			//
+			status  = CMD_PARAM_SUCCESS;
+
+			if (cmdHdr->numArgs < 2) {
+				wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Queue retry config needs 2 arguments (%d given)\n", cmdHdr->numArgs);
+				status = CMD_PARAM_ERROR + CMD_PARAM_QUEUE_ERROR;
+			} else {
+				temp    = Xil_Ntohl(cmdArgs32[0]);
+				temp2   = Xil_Ntohl(cmdArgs32[1]);
+
+				if (temp  == CMD_PARAM_RSVD) { temp  = queue_retry_get_max();       }
+				if (temp2 == CMD_PARAM_RSVD) { temp2 = queue_retry_get_age_limit(); }
+
+				if (queue_retry_config(temp, temp2) != 0) {
+					wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Invalid queue retry config: max = %d, age limit = %d\n", temp, temp2);
+					status = CMD_PARAM_ERROR + CMD_PARAM_QUEUE_ERROR;
+				}
+			}
+
+			// Send response
+			respArgs32[respIndex++] = Xil_Htonl( status );
+			respArgs32[respIndex++] = Xil_Htonl( queue_retry_get_max() );
+			respArgs32[respIndex++] = Xil_Htonl( queue_retry_get_age_limit() );
+
+			respHdr->length += (respIndex * sizeof(respArgs32));
+			respHdr->numArgs = respIndex;
+		break;
+
+
 //-----------------------------------------------------------------------------
 // Memory Access Commands - For developer use only
 //-----------------------------------------------------------------------------
@@ -2679,7 +3328,7 @@ u32 node_process_buffer_cmds(const wn_cmdHdr* cmdHdr, u32 * cmdArgs32, wn_respHd
 					// Unfortunately, due to the byte swapping that occurs in node_sendEarlyResp, we need to set all
 					//   three command parameters for each packet that is sent.
 					respHdr->cmd     = cmdHdr->cmd;
-					respHdr->length  = 20 + transfer_size;
+					respHdr->length  = NODE_BUFFER_HDR_NBYTES + transfer_size;
 					respHdr->numArgs = 5;
 
 					// Transfer data
@@ -3015,6 +3664,12 @@ int wlan_exp_node_init(u32 type, u32 serial_number, u32 *fpga_dna, u32 eth_dev_n
 	// IMPORTANT: must be called after transport_init()
 	transport_setReceiveCallback( (void *)node_rxFromTransport );
 
+	// Poll the transport from the main loop (see wlan_mac_high_poll())
+	if(run_queue_task_register(RUN_QUEUE_PRIORITY_NORMAL, WLAN_EXP_TRANSPORT_POLL_BUDGET, (function_ptr_t)transport_poll, eth_dev_num) == RUN_QUEUE_TASK_ID_INVALID) {
+        xil_printf("  Error in run_queue_task_register()! Exiting...\n");
+        return FAILURE;
+	}
+
 	// Call child init function
 	status = wlan_exp_init_callback( type, serial_number, fpga_dna, eth_dev_num, hw_addr );
 
@@ -3534,6 +4189,8 @@ void create_wn_cmd_log_entry(wn_cmdHdr* cmdHdr, void * cmdArgs, u16 src_id) {
 			(entry->args)[i] = 0;
 		}
 
+		event_log_commit_entry( entry );
+
 #ifdef _DEBUG_
 		print_entry( 0, ENTRY_TYPE_WN_CMD, (void *) entry );
 #endif
@@ -35,8 +35,10 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <xparameters.h>
+#include <xil_io.h>
 #include <xilnet_config.h>
 
 #ifdef WARP_HW_VER_v3
@@ -94,6 +96,8 @@ struct sockaddr_in           addr_async;
 void transport_null_callback(void* param){};
 void (*usr_receiveCallback) ();
 
+static void transport_send_frame(int socket, wn_host_message* currMsg, void* data, unsigned int data_length, pktSrcInfo* pktSrc, unsigned int eth_dev_num);
+
 int transport_init_parameters(unsigned int eth_dev_num, u32 *info);
 
 
@@ -676,11 +680,67 @@ void transport_poll(unsigned int eth_dev_num){
 *
 ******************************************************************************/
 void transport_send(int socket, wn_host_message* currMsg, pktSrcInfo* pktSrc, unsigned int eth_dev_num){
+	transport_send_frame(socket, currMsg, NULL, 0, pktSrc, eth_dev_num);
+}
+
+
+
+/*****************************************************************************/
+/**
+* This function is used to send a message with a separate data segment over
+* Ethernet
+*
+* @param	socket      - Socket to send the message on
+* @param	currMsg     - Pointer to the WARPNet Host Message containing the headers
+*                           (currMsg->length does not include the data segment)
+* @param    data        - Pointer to the data segment
+* @param    data_length - Length of the data segment (in bytes)
+* @param	pktSrc      - Pointer to the Ethenet packet source structure
+* @param    eth_dev_num - specifies the Ethernet interface to use
+*
+* @return	None.
+*
+* @note		The data segment is copied in to the send buffer, directly behind the
+*       message, by the central DMA rather than by the processor.  The frame is
+*       still sent from the one send buffer:  Xilnet does not chain a second
+*       Ethernet DMA buffer descriptor for the data.  If the data or the send
+*       buffer is in the processor's local memory (DLMB), which the central DMA
+*       cannot reach, the data is copied with memcpy().
+*
+******************************************************************************/
+void transport_send_w_data(int socket, wn_host_message* currMsg, void* data, unsigned int data_length, pktSrcInfo* pktSrc, unsigned int eth_dev_num){
+	transport_send_frame(socket, currMsg, data, data_length, pktSrc, eth_dev_num);
+}
+
+
+
+/*****************************************************************************/
+/**
+* Send a message, and an optional data segment, over Ethernet
+*
+* @param	socket      - Socket to send the message on
+* @param	currMsg     - Pointer to the WARPNet Host Message
+* @param    data        - Pointer to the data segment (NULL if none)
+* @param    data_length - Length of the data segment (in bytes)
+* @param	pktSrc      - Pointer to the Ethenet packet source structure
+* @param    eth_dev_num - specifies the Ethernet interface to use
+*
+* @return	None.
+*
+* @note		The central DMA transfer of the data segment is started before the
+*       headers are prepared and is finished before the frame is sent.  The
+*       message must leave room for the data in a frame of TRANSPORT_MTU bytes
+*       (see TRANSPORT_MAX_DATA_LENGTH).
+*
+******************************************************************************/
+static void transport_send_frame(int socket, wn_host_message* currMsg, void* data, unsigned int data_length, pktSrcInfo* pktSrc, unsigned int eth_dev_num){
 	wn_transport_header   tmp_hdr;
 	wn_transport_header * wn_header_tx;
 	int                   len_to_send;
 	struct sockaddr_in    sendAddr;
 	interrupt_state_t	  prev_interrupt_state;
+	void                * data_dest;
+	u8                    data_use_cdma       = 0;
 
 #ifdef _DEBUG_
 	xil_printf("BEGIN transport_send() \n");
@@ -696,6 +756,27 @@ void transport_send(int socket, wn_host_message* currMsg, pktSrcInfo* pktSrc, un
 	wn_header_tx = (wn_transport_header *)(currMsg->buffer + PAYLOAD_OFFSET);
 	len_to_send  = currMsg->length + sizeof(wn_transport_header);
 
+	// Copy the data segment in to the send buffer directly after the message
+	if ( data_length != 0 ) {
+		if ( ( currMsg->length > TRANSPORT_MAX_DATA_LENGTH(0) ) || ( data_length > TRANSPORT_MAX_DATA_LENGTH(currMsg->length) ) ) {
+			wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_transport, "Message of %d bytes is too large to send\n", len_to_send + data_length);
+			return;
+		}
+
+		data_dest = currMsg->buffer + PAYLOAD_OFFSET - PAYLOAD_PAD_NBYTES + len_to_send;
+
+		//     The central DMA cannot reach the DLMB; copy those segments here rather than
+		//     have wlan_mac_high_cdma_start_transfer() fall back (and print an error) on every packet
+		if ( wlan_mac_high_cdma_addr_ok(data_dest) && wlan_mac_high_cdma_addr_ok(data) ) {
+			wlan_mac_high_cdma_start_transfer( data_dest, data, data_length );
+			data_use_cdma = 1;
+		} else {
+			memcpy( data_dest, data, data_length );
+		}
+
+		len_to_send += data_length;
+	}
+
 	// Grab a copy of the current header
 	//     The send function will perform a network swap of the header to send
 	//     over the wire and then restore the original version for future
@@ -731,6 +812,11 @@ void transport_send(int socket, wn_host_message* currMsg, pktSrcInfo* pktSrc, un
 //	print_pkt((unsigned char *)eth_device[eth_dev_num].sendbuf, len_to_send);
 #endif
 
+	// Wait for the data segment to be in place
+	if ( data_use_cdma ) {
+		wlan_mac_high_cdma_finish_transfer();
+	}
+
 	// Check the interrupt status; Disable interrupts if enabled
 	prev_interrupt_state = wlan_mac_high_interrupt_stop();
 
@@ -52,6 +52,15 @@
 
 static u8	log_entry_en_mask;
 
+// Per entry type policy (see ENTRY_POLICY_*); zero initialized to ENTRY_POLICY_ALWAYS
+static entry_policy log_entry_policies[ENTRY_POLICY_NUM_TYPES];
+
+// Compact entries (see ENTRY_TYPE_TXRX_COMPACT)
+static u8   log_compact_enable;
+static u8   log_compact_anchor_valid;
+static u32  log_compact_count;                   // Compact entries since the last time anchor
+static u64  log_compact_anchor;                  // Timestamp of the last time anchor
+
 
 //-----------------------------------------------
 // mac_payload_log_len
@@ -78,6 +87,17 @@ u32 mac_payload_log_len = MIN_MAC_PAYLOAD_LOG_LEN;
 
 void wlan_exp_log_get_txrx_entry_sizes( u32 type, u16 packet_payload_size, u32 * min_log_len, u32 * entry_size, u32 * payload_size );
 
+void * wlan_exp_log_create_txrx_entry(u16 entry_type_id, u16 entry_size, u8* addr);
+
+u8 *   wlan_exp_log_create_compact_entry(u16 entry_type_id, u64 timestamp, u8* fields, u32 fields_len, u32 payload_len, u8* addr);
+void   wlan_exp_log_create_compact_rx_entry(rx_frame_info* rx_mpdu, u16 entry_type, u8 pkt_type, u8 channel_num, u16 flags, u32 payload_len, u8* addr);
+void   wlan_exp_log_create_compact_tx_entry(tx_frame_info* tx_mpdu, u16 entry_type, u8 pkt_type, u8 channel_num, u32 payload_len);
+void   wlan_exp_log_create_compact_tx_low_entry(tx_frame_info* tx_mpdu, wlan_mac_low_tx_details* tx_low_details, u64 timestamp_send,
+		                                        u32 tx_low_count, u16 entry_type, u8 pkt_type, u32 payload_len);
+
+static inline u32 log_put_varint(u8* buf, u32 value);
+static inline u32 log_put_varint64(u8* buf, u64 value);
+
 
 
 /******************************** Functions **********************************/
@@ -106,6 +126,37 @@ void wlan_exp_log_set_entry_en_mask(u8 mask){
 	log_entry_en_mask = mask;
 }
 
+
+
+/*****************************************************************************/
+/**
+* Enable / Disable compact TX / RX entries
+*
+* @param    u8 enable
+* 				- 1 to log RX, TX high and TX low MPDU entries as
+* 				  ENTRY_TYPE_TXRX_COMPACT entries; 0 to log full entries
+*
+* @return	None.
+*
+* @note		The create functions do not return compact entries to the caller, so
+*           anything the caller would fill in (e.g. RX entry flags) is passed to them.
+*
+******************************************************************************/
+u8 wlan_exp_log_get_compact(){
+	return log_compact_enable;
+}
+
+void wlan_exp_log_set_compact(u8 enable){
+	log_compact_enable = (enable != 0);
+	wlan_exp_log_reset_compact();
+}
+
+void wlan_exp_log_reset_compact(){
+	// The next compact entry will be preceded by a new time anchor
+	log_compact_anchor_valid = 0;
+	log_compact_count        = 0;
+}
+
 /*****************************************************************************/
 /**
 * Set max_mac_payload_log_len
@@ -147,6 +198,163 @@ void wlan_exp_log_set_mac_payload_len(u32 payload_len){
 
 
 
+/*****************************************************************************/
+/**
+* Set the policy for an entry type
+*
+* @param    u16 entry_type_id
+*               - ID of the entry type (must be less than ENTRY_POLICY_NUM_TYPES)
+*           u8 mode
+*               - ENTRY_POLICY_ALWAYS, ENTRY_POLICY_NEVER, ENTRY_POLICY_SAMPLE or ENTRY_POLICY_ADDR
+*           u32 sample_n
+*               - Create one of every sample_n entries (ENTRY_POLICY_SAMPLE only)
+*           u8 * addr
+*               - Address to match (ENTRY_POLICY_ADDR only)
+*           u8 * addr_mask
+*               - Mask applied to the address before comparison; NULL to match
+*                 the full address (ENTRY_POLICY_ADDR only)
+*
+* @return	int
+*               -  0 - Success
+*               - -1 - Invalid entry type or policy
+*
+* @note		Setting a policy resets the sample count and the number of
+*           filtered entries for the entry type.
+*
+******************************************************************************/
+int wlan_exp_log_set_entry_policy(u16 entry_type_id, u8 mode, u32 sample_n, u8* addr, u8* addr_mask){
+	entry_policy*       policy;
+	interrupt_state_t   prev_interrupt_state;
+
+	if( entry_type_id >= ENTRY_POLICY_NUM_TYPES ){
+		return -1;
+	}
+
+	if( (mode > ENTRY_POLICY_ADDR) ||
+		((mode == ENTRY_POLICY_SAMPLE) && (sample_n == 0)) ||
+		((mode == ENTRY_POLICY_ADDR) && (addr == NULL)) ){
+		return -1;
+	}
+
+	policy = &(log_entry_policies[entry_type_id]);
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	bzero(policy, sizeof(entry_policy));
+
+	policy->mode     = mode;
+	policy->sample_n = sample_n;
+
+	if( mode == ENTRY_POLICY_ADDR ){
+		memcpy(policy->addr, addr, 6);
+
+		if( addr_mask != NULL ){
+			memcpy(policy->addr_mask, addr_mask, 6);
+		} else {
+			memset(policy->addr_mask, 0xFF, 6);
+		}
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	return 0;
+}
+
+int wlan_exp_log_get_entry_policy(u16 entry_type_id, entry_policy* policy){
+
+	if( entry_type_id >= ENTRY_POLICY_NUM_TYPES ){
+		return -1;
+	}
+
+	memcpy(policy, &(log_entry_policies[entry_type_id]), sizeof(entry_policy));
+
+	return 0;
+}
+
+void wlan_exp_log_reset_entry_policies(){
+	bzero(log_entry_policies, sizeof(log_entry_policies));
+}
+
+
+
+/*****************************************************************************/
+/**
+* Check the policy for an entry
+*
+* @param    u16 entry_type_id
+*               - ID of the entry being requested
+*           u8 * addr
+*               - Address of the entry (NULL if the entry does not have an address)
+*
+* @return	u32
+*               - 1 if the entry should be created; 0 otherwise
+*
+* @note		This must be called once per entry that would be created, since
+*           it advances the sample count of the entry type.
+*
+******************************************************************************/
+u32 wlan_exp_log_entry_policy_check(u16 entry_type_id, u8* addr){
+	entry_policy*       policy;
+	u32                 create;
+	u32                 i;
+	interrupt_state_t   prev_interrupt_state;
+
+	if( entry_type_id >= ENTRY_POLICY_NUM_TYPES ){
+		return 1;
+	}
+
+	policy = &(log_entry_policies[entry_type_id]);
+
+	if( policy->mode == ENTRY_POLICY_ALWAYS ){
+		return 1;
+	}
+
+	// Entries are created from both interrupt and non-interrupt contexts, so the
+	// counts of the policy must be updated with interrupts stopped
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	create = 0;
+
+	switch(policy->mode){
+		case ENTRY_POLICY_SAMPLE:
+			if( policy->sample_count == 0 ){
+				policy->sample_count = policy->sample_n - 1;
+				create = 1;
+			} else {
+				policy->sample_count--;
+			}
+		break;
+
+		case ENTRY_POLICY_ADDR:
+			if( addr == NULL ){
+				create = 1;
+				break;
+			}
+
+			for( i = 0; i < 6; i++ ){
+				if( (addr[i] ^ policy->addr[i]) & policy->addr_mask[i] ) break;
+			}
+
+			if( i == 6 ){
+				create = 1;
+			}
+		break;
+
+		default:
+		break;
+	}
+
+	if( create == 0 ){
+		policy->num_filtered++;
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	return create;
+}
+
+
+
 /*****************************************************************************/
 /**
 * Get the next empty log entry
@@ -161,24 +369,315 @@ void wlan_exp_log_set_mac_payload_len(u32 payload_len){
 *               - Pointer to memory that was allocated for the entry in the log
 *               @note This can be NULL if an entry was not allocated
 *
-* @note		None.
+* @note		The entry is only created if allowed by the policy of the entry type
+*           (see wlan_exp_log_set_entry_policy()).  The caller must commit the
+*           entry (see event_log_commit_entry()) once it is filled in.
 *
 ******************************************************************************/
 void * wlan_exp_log_create_entry(u16 entry_type_id, u16 entry_size){
 
-	void *    ret_val   = NULL;
+	return wlan_exp_log_create_txrx_entry( entry_type_id, entry_size, NULL );
+}
 
-	//
-	// NOTE:  This is where filtering on entry_type_id would be in future implementations
-	//
 
-	ret_val = event_log_get_next_empty_entry( entry_type_id, entry_size );
+
+/*****************************************************************************/
+/**
+* Get the next empty log entry for a TX / RX entry
+*
+* @param    u16 entry_type_id
+*               - ID of the entry being requested
+*           u16 entry_size
+* 				- Number of total bytes in the entry.
+*           u8 * addr
+*               - Address used by ENTRY_POLICY_ADDR (NULL if none)
+*
+* @return	void *
+*               - Pointer to memory that was allocated for the entry in the log
+*               @note This can be NULL if an entry was not allocated
+*
+* @note		The policy is checked before any space is requested, so callers
+*           must not copy any part of the packet until this returns.
+*
+******************************************************************************/
+void * wlan_exp_log_create_txrx_entry(u16 entry_type_id, u16 entry_size, u8* addr){
+
+	void *    ret_val   = NULL;
+
+	if( wlan_exp_log_entry_policy_check( entry_type_id, addr ) ){
+		ret_val = event_log_get_next_empty_entry( entry_type_id, entry_size );
+	}
 
 	return ret_val;
 }
 
 
 
+/*****************************************************************************/
+/**
+* Write a varint (little endian base 128)
+*
+* @param    u8 * buf
+*               - Buffer for the varint (5 bytes for u32 values; 10 bytes for u64 values)
+*           u32 / u64 value
+*               - Value to write
+*
+* @return	u32
+*               - Number of bytes written
+*
+* @note		None.
+*
+******************************************************************************/
+static inline u32 log_put_varint(u8* buf, u32 value){
+	u32 len = 0;
+
+	while( value >= 0x80 ){
+		buf[len++] = (value & 0x7F) | 0x80;
+		value    >>= 7;
+	}
+	buf[len++] = value;
+
+	return len;
+}
+
+static inline u32 log_put_varint64(u8* buf, u64 value){
+	u32 len = 0;
+
+	// Most values fit in 32 bits, which avoids 64-bit shifts
+	while( (value >> 32) != 0 ){
+		buf[len++] = ((u32)value & 0x7F) | 0x80;
+		value    >>= 7;
+	}
+
+	return len + log_put_varint(&buf[len], (u32)value);
+}
+
+#define LOG_ZIGZAG(x)                  ((((u32)(x)) << 1) ^ ((u32)((s32)(x) >> 31)))
+
+
+
+/*****************************************************************************/
+/**
+* Create a compact TX / RX entry
+*
+* @param    u16 entry_type_id
+*               - Full entry type that the compact entry replaces
+*           u64 timestamp
+*               - Timestamp of the entry
+*           u8 * fields
+*               - Encoded fields of the entry (see ENTRY_TYPE_TXRX_COMPACT)
+*           u32 fields_len
+*               - Number of bytes in fields
+*           u32 payload_len
+*               - Number of MAC payload bytes to reserve
+*           u8 * addr
+*               - Address used by ENTRY_POLICY_ADDR (NULL if none)
+*
+* @return	u8 *
+*               - Pointer to the entry; the MAC payload starts entry[1] bytes in to it
+*               @note This can be NULL if an entry was not allocated
+*
+* @note		The time anchor decision, the time anchor and the compact entry
+*           are allocated with interrupts stopped so that the delta is always
+*           relative to the time anchor that precedes the entry in the log.
+*
+*           The caller must commit the entry (see event_log_commit_entry())
+*           once the MAC payload is written.
+*
+******************************************************************************/
+u8 * wlan_exp_log_create_compact_entry(u16 entry_type_id, u64 timestamp, u8* fields, u32 fields_len, u32 payload_len, u8* addr){
+
+	u8 *                entry        = NULL;
+	time_anchor_entry * anchor;
+	s64                 delta;
+	u8                  delta_buf[5];
+	u32                 delta_len;
+	u32                 payload_offset;
+	interrupt_state_t   prev_interrupt_state;
+
+	if( !wlan_exp_log_entry_policy_check( entry_type_id, addr ) ){
+		return NULL;
+	}
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	delta = (s64)(timestamp - log_compact_anchor);
+
+	// Add a new time anchor if the delta will not fit in 32 bits or if too many
+	// compact entries depend on the last time anchor
+	if( (log_compact_anchor_valid == 0) || (log_compact_count >= COMPACT_ANCHOR_INTERVAL) ||
+		(delta > 0x7FFFFFFF) || (delta < -0x7FFFFFFF) ){
+
+		anchor = (time_anchor_entry *)event_log_get_next_empty_entry( ENTRY_TYPE_TIME_ANCHOR, sizeof(time_anchor_entry) );
+
+		if( anchor == NULL ){
+			wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+			return NULL;
+		}
+
+		anchor->timestamp        = timestamp;
+
+		event_log_commit_entry( anchor );
+
+		log_compact_anchor       = timestamp;
+		log_compact_anchor_valid = 1;
+		log_compact_count        = 0;
+		delta                    = 0;
+	}
+
+	delta_len      = log_put_varint( delta_buf, LOG_ZIGZAG(delta) );
+
+	// The MAC payload is 4-byte aligned for the CDMA transfer
+	payload_offset = (2 + delta_len + fields_len + 3) & ~0x3;
+
+	entry = (u8 *)event_log_get_next_empty_entry( ENTRY_TYPE_TXRX_COMPACT, payload_offset + payload_len );
+
+	if( entry != NULL ){
+		log_compact_count++;
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	if( entry == NULL ){
+		return NULL;
+	}
+
+	entry[0] = entry_type_id;
+	entry[1] = payload_offset;
+
+	memcpy( &entry[2], delta_buf, delta_len );
+	memcpy( &entry[2 + delta_len], fields, fields_len );
+
+	// Zero the alignment padding
+	bzero( &entry[2 + delta_len + fields_len], payload_offset - (2 + delta_len + fields_len) );
+
+	return entry;
+}
+
+
+
+/*****************************************************************************/
+/**
+* Create compact RX, TX high and TX low entries
+*
+* @param    Same as wlan_exp_log_create_rx_entry(), wlan_exp_log_create_tx_entry()
+*           and wlan_exp_log_create_tx_low_entry(), plus:
+*           u16 entry_type
+*               - Full entry type that the compact entry replaces
+*           u8 pkt_type
+*               - Type of packet
+*           u32 payload_len
+*               - Number of MAC payload bytes to log
+*
+* @return	None.
+*
+* @note		See ENTRY_TYPE_TXRX_COMPACT for the format of the fields.
+*
+******************************************************************************/
+void wlan_exp_log_create_compact_rx_entry(rx_frame_info* rx_mpdu, u16 entry_type, u8 pkt_type, u8 channel_num, u16 flags, u32 payload_len, u8* addr){
+
+	u8    fields[COMPACT_ENTRY_MAX_FIELDS_LEN];
+	u32   len   = 0;
+	u8  * entry;
+
+	fields[len++] = (rx_mpdu->phy_details.mcs & 0x7F) | ((rx_mpdu->state == RX_MPDU_STATE_FCS_GOOD) ? (RX_ENTRY_FCS_GOOD << 7) : (RX_ENTRY_FCS_BAD << 7));
+	fields[len++] = rx_mpdu->ant_mode;
+	fields[len++] = channel_num;
+	fields[len++] = (u8)(rx_mpdu->rx_power);
+	fields[len++] = ((rx_mpdu->rf_gain & 0x3) << 6) | (rx_mpdu->bb_gain & 0x3F);
+	fields[len++] = pkt_type;
+	len          += log_put_varint( &fields[len], flags );
+	len          += log_put_varint( &fields[len], rx_mpdu->phy_details.length );
+	len          += log_put_varint( &fields[len], payload_len );
+
+	entry = wlan_exp_log_create_compact_entry( entry_type, rx_mpdu->timestamp, fields, len, payload_len, addr );
+
+	if( entry != NULL ){
+		wlan_mac_high_cdma_start_transfer( &entry[entry[1]], (u8*)rx_mpdu + PHY_RX_PKT_BUF_MPDU_OFFSET, payload_len );
+		event_log_commit_entry( entry );
+	}
+}
+
+void wlan_exp_log_create_compact_tx_entry(tx_frame_info* tx_mpdu, u16 entry_type, u8 pkt_type, u8 channel_num, u32 payload_len){
+
+	u8                  fields[COMPACT_ENTRY_MAX_FIELDS_LEN];
+	u32                 len             = 0;
+	u8                * entry;
+	mac_header_80211  * tx_80211_header = (mac_header_80211*)((u8*)tx_mpdu + PHY_TX_PKT_BUF_MPDU_OFFSET);
+
+	len          += log_put_varint( &fields[len], tx_mpdu->delay_accept );
+	len          += log_put_varint( &fields[len], tx_mpdu->delay_done );
+	len          += log_put_varint64( &fields[len], tx_mpdu->unique_seq );
+	fields[len++] = tx_mpdu->params.phy.rate;
+	fields[len++] = tx_mpdu->params.phy.antenna_mode;
+	fields[len++] = channel_num;
+	fields[len++] = (u8)(tx_mpdu->params.phy.power);
+	fields[len++] = tx_mpdu->short_retry_count;
+	fields[len++] = tx_mpdu->tx_result;
+	fields[len++] = pkt_type;
+	fields[len++] = tx_mpdu->QID;
+	fields[len++] = tx_mpdu->high_retry_count;
+	fields[len++] = tx_mpdu->high_retry_status;
+	len          += log_put_varint( &fields[len], tx_mpdu->length );
+	len          += log_put_varint( &fields[len], payload_len );
+
+	entry = wlan_exp_log_create_compact_entry( entry_type, tx_mpdu->timestamp_create, fields, len, payload_len, tx_80211_header->address_1 );
+
+	if( entry != NULL ){
+		wlan_mac_high_cdma_start_transfer( &entry[entry[1]], tx_80211_header, payload_len );
+		event_log_commit_entry( entry );
+	}
+}
+
+void wlan_exp_log_create_compact_tx_low_entry(tx_frame_info* tx_mpdu, wlan_mac_low_tx_details* tx_low_details, u64 timestamp_send,
+		                                      u32 tx_low_count, u16 entry_type, u8 pkt_type, u32 payload_len){
+
+	u8                  fields[COMPACT_ENTRY_MAX_FIELDS_LEN];
+	u32                 len             = 0;
+	u8                * entry;
+	mac_header_80211  * tx_80211_header = (mac_header_80211*)((u8*)tx_mpdu + PHY_TX_PKT_BUF_MPDU_OFFSET);
+	u8                  flags           = 0;
+
+	if( ((tx_low_count + 1) == (tx_mpdu->num_tx_attempts)) && (tx_mpdu->tx_result == TX_MPDU_RESULT_SUCCESS) ){
+		flags = TX_LOW_FLAGS_WAS_ACKED;
+	}
+
+	len          += log_put_varint64( &fields[len], tx_mpdu->unique_seq );
+	fields[len++] = tx_low_details->mpdu_phy_params.rate;
+	fields[len++] = tx_low_details->mpdu_phy_params.antenna_mode;
+	fields[len++] = (u8)(tx_low_details->mpdu_phy_params.power);
+	fields[len++] = tx_low_details->mpdu_phy_params.flags;
+	fields[len++] = tx_low_count + 1;
+	fields[len++] = tx_low_details->chan_num;
+	fields[len++] = pkt_type;
+	fields[len++] = flags;
+	len          += log_put_varint( &fields[len], LOG_ZIGZAG(tx_low_details->num_slots) );
+	len          += log_put_varint( &fields[len], tx_low_details->cw );
+	len          += log_put_varint( &fields[len], tx_mpdu->length );
+	len          += log_put_varint( &fields[len], payload_len );
+
+	entry = wlan_exp_log_create_compact_entry( entry_type, timestamp_send, fields, len, payload_len, tx_80211_header->address_1 );
+
+	if( entry != NULL ){
+		wlan_mac_high_cdma_start_transfer( &entry[entry[1]], tx_80211_header, payload_len );
+
+		// Re-create the retry flag of this transmission (see wlan_exp_log_create_tx_low_entry())
+		if( payload_len >= 2 ){
+			wlan_mac_high_cdma_finish_transfer();
+
+			if( tx_low_count == 0 ){
+				((mac_header_80211*)&entry[entry[1]])->frame_control_2 &= ~MAC_FRAME_CTRL2_FLAG_RETRY;
+			} else {
+				((mac_header_80211*)&entry[entry[1]])->frame_control_2 |= MAC_FRAME_CTRL2_FLAG_RETRY;
+			}
+		}
+
+		event_log_commit_entry( entry );
+	}
+}
+
+
+
 /*****************************************************************************/
 /**
 * Create a TX Low Log entry
@@ -211,6 +710,7 @@ tx_low_entry * wlan_exp_log_create_tx_low_entry(tx_frame_info* tx_mpdu, wlan_mac
 	u32               entry_size;
 	u32               entry_payload_size;
 	u32               min_entry_payload_size;
+	u64               timestamp_send;
 
 	mpdu                    = (u8*)tx_mpdu + PHY_TX_PKT_BUF_MPDU_OFFSET;
 	mpdu_ptr_u8             = (u8*)mpdu;
@@ -228,7 +728,7 @@ tx_low_entry * wlan_exp_log_create_tx_low_entry(tx_frame_info* tx_mpdu, wlan_mac
 		wlan_exp_log_get_txrx_entry_sizes( entry_type, packet_payload_size, &entry_size, &entry_payload_size, &min_entry_payload_size );
 
 		// Request space for a TX_LOW log entry
-		tx_low_event_log_entry = (tx_low_entry *)wlan_exp_log_create_entry( entry_type, entry_size );
+		tx_low_event_log_entry = (tx_low_entry *)wlan_exp_log_create_txrx_entry( entry_type, entry_size, tx_80211_header->address_1 );
 
 		if(tx_low_event_log_entry != NULL){
 			// Store the payload size in the log entry
@@ -267,6 +767,7 @@ tx_low_entry * wlan_exp_log_create_tx_low_entry(tx_frame_info* tx_mpdu, wlan_mac
 			tx_low_event_log_entry->length                    = packet_payload_size;
 			tx_low_event_log_entry->pkt_type				  = pkt_type;
 
+			event_log_commit_entry( tx_low_event_log_entry );
 		}
 
 	}
@@ -290,7 +791,20 @@ tx_low_entry * wlan_exp_log_create_tx_low_entry(tx_frame_info* tx_mpdu, wlan_mac
 		wlan_exp_log_get_txrx_entry_sizes( entry_type, packet_payload_size, &entry_size, &entry_payload_size, &min_entry_payload_size );
 
 		// Request space for a TX_LOW log entry
-		tx_low_event_log_entry = (tx_low_entry *)wlan_exp_log_create_entry( entry_type, entry_size );
+		if( log_compact_enable ){
+			// Compact entries are populated here and are not returned to the caller
+			if((tx_low_details->tx_details_type == TX_DETAILS_MPDU)){
+				timestamp_send = (u64)(tx_mpdu->timestamp_create + (u64)(tx_mpdu->delay_accept) + (u64)(tx_low_details->tx_start_delta) + timestamp_offset);
+			} else {
+				timestamp_send = (u64)(tx_mpdu->timestamp_create + (u64)(tx_mpdu->delay_accept) + (u64)(tx_low_details->tx_start_delta) + timestamp_offset + (u64)(tx_low_details->timestamp_offset));
+			}
+
+			wlan_exp_log_create_compact_tx_low_entry( tx_mpdu, tx_low_details, timestamp_send, tx_low_count, entry_type, pkt_type,
+					                                  min(entry_payload_size, packet_payload_size) );
+			tx_low_event_log_entry = NULL;
+		} else {
+			tx_low_event_log_entry = (tx_low_entry *)wlan_exp_log_create_txrx_entry( entry_type, entry_size, tx_80211_header->address_1 );
+		}
 
 		if(tx_low_event_log_entry != NULL){
 
@@ -341,6 +855,8 @@ tx_low_entry * wlan_exp_log_create_tx_low_entry(tx_frame_info* tx_mpdu, wlan_mac
 				((mac_header_80211*)(tx_low_event_log_entry->mac_payload))->frame_control_2 |= MAC_FRAME_CTRL2_FLAG_RETRY;
 			}
 
+			event_log_commit_entry( tx_low_event_log_entry );
+
 	#ifdef _DEBUG_
 			xil_printf("TX LOW  : %8d    %8d    \n", transfer_len, MIN_MAC_PAYLOAD_LOG_LEN);
 			print_buf((u8 *)((u32)tx_low_event_log_entry - 8), sizeof(tx_low_entry) + 12);
@@ -405,8 +921,14 @@ tx_high_entry * wlan_exp_log_create_tx_entry(tx_frame_info* tx_mpdu, u8 channel_
 	// Get all the necessary sizes to log the packet
 	wlan_exp_log_get_txrx_entry_sizes( entry_type, packet_payload_size, &entry_size, &entry_payload_size, &min_entry_payload_size );
 
+	if( log_compact_enable ){
+		// Compact entries are populated here and are not returned to the caller
+		wlan_exp_log_create_compact_tx_entry( tx_mpdu, entry_type, pkt_type, channel_num, min(entry_payload_size, packet_payload_size) );
+		return NULL;
+	}
+
 	// Request space for a TX entry
-	tx_high_event_log_entry = (tx_high_entry *)wlan_exp_log_create_entry( entry_type, entry_size );
+	tx_high_event_log_entry = (tx_high_entry *)wlan_exp_log_create_txrx_entry( entry_type, entry_size, tx_80211_header->address_1 );
 
 	if(tx_high_event_log_entry != NULL){
 
@@ -435,7 +957,6 @@ tx_high_entry * wlan_exp_log_create_tx_entry(tx_frame_info* tx_mpdu, u8 channel_
 		}
 
         // Populate the log entry
-		bzero(tx_high_event_log_entry->padding , sizeof(tx_high_event_log_entry->padding));
 		tx_high_event_log_entry->unique_seq				  = tx_mpdu->unique_seq;
 		tx_high_event_log_entry->queue_id				  = tx_mpdu->QID;
 		tx_high_event_log_entry->result                   = tx_mpdu->tx_result;
@@ -449,7 +970,11 @@ tx_high_entry * wlan_exp_log_create_tx_entry(tx_frame_info* tx_mpdu, u8 channel_
 		tx_high_event_log_entry->delay_accept             = tx_mpdu->delay_accept;
 		tx_high_event_log_entry->delay_done               = tx_mpdu->delay_done;
 		tx_high_event_log_entry->ant_mode				  = tx_mpdu->params.phy.antenna_mode;
+		tx_high_event_log_entry->high_retry_count         = tx_mpdu->high_retry_count;
+		tx_high_event_log_entry->high_retry_status        = tx_mpdu->high_retry_status;
 
+		// The central DMA copy of the payload may still be in progress (see event_log_get_data_address())
+		event_log_commit_entry( tx_high_event_log_entry );
 
 #ifdef _DEBUG_
 		xil_printf("TX HIGH : %8d    %8d    %8d    %8d    %8d\n", transfer_len, MIN_MAC_PAYLOAD_LOG_LEN, total_payload_len, extra_payload, payload_log_len);
@@ -477,10 +1002,38 @@ tx_high_entry * wlan_exp_log_create_tx_entry(tx_frame_info* tx_mpdu, u8 channel_
 *               - Pointer to the rx_common_entry log entry
 *               @note This can be NULL if an entry was not allocated
 *
-* @note		None.
+* @note		The entry is created with no flags.  Flags that must also appear in
+*           compact entries are passed to wlan_exp_log_create_rx_entry_with_flags().
 *
 ******************************************************************************/
 rx_common_entry * wlan_exp_log_create_rx_entry(rx_frame_info* rx_mpdu, u8 channel_num, u8 rate){
+	return wlan_exp_log_create_rx_entry_with_flags(rx_mpdu, channel_num, rate, 0);
+}
+
+
+
+/*****************************************************************************/
+/**
+* Create a RX Log entry with the given flags
+*
+* @param    rx_frame_info * rx_mpdu
+*               - RX MPDU of the associated RX entry
+* 			u8 channel_number
+* 			    - Indicates the channel on which the reception occurred
+* 			u8 rate
+* 			    - Indicates the rate at which the reception occurred
+* 			u16 flags
+* 			    - RX entry flags (RX_ENTRY_FLAGS_*)
+*
+* @return	rx_common_entry *
+*               - Pointer to the rx_common_entry log entry
+*               @note This can be NULL if an entry was not allocated
+*
+* @note		The flags are written to both the full and the compact entry.  A compact
+*           entry is not returned, so its flags cannot be set by the caller.
+*
+******************************************************************************/
+rx_common_entry * wlan_exp_log_create_rx_entry_with_flags(rx_frame_info* rx_mpdu, u8 channel_num, u8 rate, u16 flags){
 
 	rx_common_entry*  rx_event_log_entry      = NULL;
 	tx_low_entry*     tx_low_event_log_entry  = NULL; //This is for any inferred CTRL transmissions
@@ -494,6 +1047,7 @@ rx_common_entry * wlan_exp_log_create_rx_entry(rx_frame_info* rx_mpdu, u8 channe
 	u32               entry_payload_size;
 	u32               min_entry_payload_size;
 	u32               transfer_len;
+	u8*               entry_addr;
 
 	typedef enum {PAYLOAD_FIRST, CHAN_EST_FIRST} copy_order_t;
 	copy_order_t      copy_order;
@@ -520,8 +1074,21 @@ rx_common_entry * wlan_exp_log_create_rx_entry(rx_frame_info* rx_mpdu, u8 channe
 		wlan_exp_log_get_txrx_entry_sizes( entry_type, packet_payload_size, &entry_size, &entry_payload_size, &min_entry_payload_size );
 
 
+		// ACK and CTS frames do not have a transmitter address
+		if( packet_payload_size >= (sizeof(mac_header_80211_RTS) + WLAN_PHY_FCS_NBYTES) ){
+			entry_addr = rx_80211_header->address_2;
+		} else {
+			entry_addr = NULL;
+		}
+
 		// Create the log entry
-		rx_event_log_entry = (rx_common_entry*)wlan_exp_log_create_entry( entry_type, entry_size );
+		if( log_compact_enable ){
+			// Compact entries are populated here and are not returned to the caller
+			wlan_exp_log_create_compact_rx_entry( rx_mpdu, entry_type, pkt_type, channel_num, flags, min(entry_payload_size, packet_payload_size), entry_addr );
+			rx_event_log_entry = NULL;
+		} else {
+			rx_event_log_entry = (rx_common_entry*)wlan_exp_log_create_txrx_entry( entry_type, entry_size, entry_addr );
+		}
 
 		// Populate the log entry
 		if(rx_event_log_entry != NULL){
@@ -600,7 +1167,7 @@ rx_common_entry * wlan_exp_log_create_rx_entry(rx_frame_info* rx_mpdu, u8 channe
 			rx_event_log_entry->pkt_type   = pkt_type;
 			rx_event_log_entry->chan_num   = channel_num;
 			rx_event_log_entry->ant_mode   = rx_mpdu->ant_mode;
-			rx_event_log_entry->flags      = 0;
+			rx_event_log_entry->flags      = flags;
 
 
 			// Start second copy based on the copy order
@@ -632,6 +1199,9 @@ rx_common_entry * wlan_exp_log_create_rx_entry(rx_frame_info* rx_mpdu, u8 channe
 				break;
 			}
 
+			// The central DMA copies may still be in progress (see event_log_get_data_address())
+			event_log_commit_entry( rx_event_log_entry );
+
 	#ifdef _DEBUG_
 			xil_printf("RX      : %8d    %8d    %8d    %8d    %8d\n", transfer_len, MIN_MAC_PAYLOAD_LOG_LEN, length, extra_payload, payload_log_len);
 			print_buf((u8 *)((u32)rx_event_log_entry - 8), sizeof(rx_ofdm_entry) + extra_payload + 12);
@@ -651,7 +1221,7 @@ rx_common_entry * wlan_exp_log_create_rx_entry(rx_frame_info* rx_mpdu, u8 channe
 			wlan_exp_log_get_txrx_entry_sizes( entry_type, packet_payload_size, &entry_size, &entry_payload_size, &min_entry_payload_size );
 
 			// Request space for a TX_LOW log entry
-			tx_low_event_log_entry = (tx_low_entry *)wlan_exp_log_create_entry( entry_type, entry_size );
+			tx_low_event_log_entry = (tx_low_entry *)wlan_exp_log_create_txrx_entry( entry_type, entry_size, rx_80211_header->address_2 );
 
 			if(tx_low_event_log_entry != NULL){
 				// Store the payload size in the log entry
@@ -690,6 +1260,8 @@ rx_common_entry * wlan_exp_log_create_rx_entry(rx_frame_info* rx_mpdu, u8 channe
 				tx_low_event_log_entry->cw						  = rx_mpdu->resp_low_tx_details.cw;
 				tx_low_event_log_entry->length                    = packet_payload_size;
 				tx_low_event_log_entry->pkt_type				  = pkt_type;
+
+				event_log_commit_entry( tx_low_event_log_entry );
 			}
 
 
@@ -704,7 +1276,7 @@ rx_common_entry * wlan_exp_log_create_rx_entry(rx_frame_info* rx_mpdu, u8 channe
 				wlan_exp_log_get_txrx_entry_sizes( entry_type, packet_payload_size, &entry_size, &entry_payload_size, &min_entry_payload_size );
 
 				// Request space for a TX_LOW log entry
-				tx_low_event_log_entry = (tx_low_entry *)wlan_exp_log_create_entry( entry_type, entry_size );
+				tx_low_event_log_entry = (tx_low_entry *)wlan_exp_log_create_txrx_entry( entry_type, entry_size, rx_80211_header->address_2 );
 
 				if(tx_low_event_log_entry != NULL){
 					// Store the payload size in the log entry
@@ -742,6 +1314,8 @@ rx_common_entry * wlan_exp_log_create_rx_entry(rx_frame_info* rx_mpdu, u8 channe
 					tx_low_event_log_entry->cw						  = rx_mpdu->resp_low_tx_details.cw;
 					tx_low_event_log_entry->length                    = packet_payload_size;
 					tx_low_event_log_entry->pkt_type				  = pkt_type;
+
+					event_log_commit_entry( tx_low_event_log_entry );
 				}
 			}
 	}
@@ -843,7 +1417,7 @@ void wlan_exp_log_get_txrx_entry_sizes( u32 entry_type, u16 packet_payload_size,
 	    case ENTRY_TYPE_TX_HIGH:
 	    case ENTRY_TYPE_TX_HIGH_LTG:
 	    	// Determine if we need to log the minimum entry payload size or the 32-bit aligned packet payload, whichever is larger
-	    	pkt_bytes_to_log       = max(tmp_min_entry_payload_size, ((1 + ((packet_payload_size - 1) / 4))*4));
+	    	pkt_bytes_to_log       = max(tmp_min_entry_payload_size, (u32)((1 + ((packet_payload_size - 1) / 4))*4));
 
 	    	// Determine if we need to log the mimimum entry payload size or the mac_payload_log_len, whichever is larger
 	    	log_bytes_to_log       = max(tmp_min_entry_payload_size, mac_payload_log_len);
@@ -988,9 +1562,11 @@ void print_entry( u32 entry_number, u32 entry_type, void * entry ){
 			xil_printf("   # Tx High Data MPDUs:   %d (%d successful)\n", txrx_stats_entry_log_item->stats.data.tx_num_packets_total, txrx_stats_entry_log_item->stats.data.tx_num_packets_success);
 			xil_printf("   # Tx High Data bytes:   %d (%d successful)\n", (u32)(txrx_stats_entry_log_item->stats.data.tx_num_bytes_total), (u32)(txrx_stats_entry_log_item->stats.data.tx_num_bytes_success));
 			xil_printf("   # Tx Low Data MPDUs:    %d\n", txrx_stats_entry_log_item->stats.data.tx_num_packets_low);
+			xil_printf("   # Tx Data Requeued:     %d (%d dropped)\n", txrx_stats_entry_log_item->stats.data.tx_num_packets_requeued, txrx_stats_entry_log_item->stats.data.tx_num_packets_retry_dropped);
 			xil_printf("   # Tx High Mgmt MPDUs:   %d (%d successful)\n", txrx_stats_entry_log_item->stats.mgmt.tx_num_packets_total, txrx_stats_entry_log_item->stats.mgmt.tx_num_packets_success);
 			xil_printf("   # Tx High Mgmt bytes:   %d (%d successful)\n", (u32)(txrx_stats_entry_log_item->stats.mgmt.tx_num_bytes_total), (u32)(txrx_stats_entry_log_item->stats.mgmt.tx_num_bytes_success));
 			xil_printf("   # Tx Low Mgmt MPDUs:    %d\n", txrx_stats_entry_log_item->stats.mgmt.tx_num_packets_low);
+			xil_printf("   # Tx Mgmt Requeued:     %d (%d dropped)\n", txrx_stats_entry_log_item->stats.mgmt.tx_num_packets_requeued, txrx_stats_entry_log_item->stats.mgmt.tx_num_packets_retry_dropped);
 			xil_printf("   # Rx Data MPDUs:        %d\n", txrx_stats_entry_log_item->stats.data.rx_num_packets);
 			xil_printf("   # Rx Data Bytes:        %d\n", txrx_stats_entry_log_item->stats.data.rx_num_bytes);
 			xil_printf("   # Rx Mgmt MPDUs:        %d\n", txrx_stats_entry_log_item->stats.mgmt.rx_num_packets);
@@ -1046,6 +1622,8 @@ void print_entry( u32 entry_number, u32 entry_type, void * entry ){
 			xil_printf("   Result:           %d\n",     tx_high_entry_log_item->result);
 			xil_printf("   Pkt Type:         0x%x\n",   tx_high_entry_log_item->pkt_type);
 			xil_printf("   Num Tx:           %d\n",     tx_high_entry_log_item->num_tx);
+			xil_printf("   High Retries:     %d\n",     tx_high_entry_log_item->high_retry_count);
+			xil_printf("   High Retry Stat:  %d\n",     tx_high_entry_log_item->high_retry_status);
 		break;
 
 		case ENTRY_TYPE_TX_LOW:
@@ -16,6 +16,7 @@
 /***************************** Include Files *********************************/
 
 #include "stdlib.h"
+#include "string.h"
 #include "xaxiethernet.h"
 #include "xaxidma.h"
 #include "xparameters.h"
@@ -65,6 +66,10 @@ static u32 num_tx_bd;
 //is plugged into a switch with more than one device.
 static u8                   eth_sta_mac_addr[6];
 
+//802.1D user priority to 802.11e access category (IEEE 802.11 Table 10-1)
+static const u8             eth_up_to_ac[8] = { QUEUE_AC_BE, QUEUE_AC_BK, QUEUE_AC_BK, QUEUE_AC_BE,
+                                                QUEUE_AC_VI, QUEUE_AC_VI, QUEUE_AC_VO, QUEUE_AC_VO };
+
 
 /*************************** Functions Prototypes ****************************/
 
@@ -279,7 +284,7 @@ int wlan_eth_dma_init() {
 
 	//Initialize the Rx buffer descriptors
 	bd_count = XAxiDma_BdRingGetFreeCnt(ETH_A_RxRing_ptr);
-	if(bd_count != num_rx_bd) {xil_printf("Error in Eth Rx DMA init - not all Rx BDs were free at boot\n");}
+	if(bd_count != (int)num_rx_bd) {xil_printf("Error in Eth Rx DMA init - not all Rx BDs were free at boot\n");}
 
 	status = XAxiDma_BdRingAlloc(ETH_A_RxRing_ptr, bd_count, &first_bd_ptr);
 	if(status != XST_SUCCESS) {xil_printf("Error in XAxiDma_BdRingAlloc()! Err = %d\n", status); return -1;}
@@ -288,7 +293,7 @@ int wlan_eth_dma_init() {
 	cur_bd_ptr = first_bd_ptr;
 	for(i = 0; i < bd_count; i++) {
 
-		curr_tx_queue_element = queue_checkout();
+		curr_tx_queue_element = queue_checkout_sized(ETH_RX_BUF_OFFSET + ETH_RX_MAX_LEN);
 
 		if(curr_tx_queue_element == NULL){
 			xil_printf("Error during wlan_eth_dma_init: unable to check out sufficient tx_queue_element\n");
@@ -297,12 +302,12 @@ int wlan_eth_dma_init() {
 
 		//Set the memory address for this BD's buffer to the corresponding Tx queue entry buffer
 		// The Ethernet payload will be copied to an offset in the queue entry, leaving room for meta data at the front
-		buf_addr = (u32)((void*)((tx_queue_buffer*)(curr_tx_queue_element->data))->frame + sizeof(mac_header_80211) + sizeof(llc_header) - sizeof(ethernet_header));
+		buf_addr = (u32)((void*)queue_element_buffer(curr_tx_queue_element)->frame + ETH_RX_BUF_OFFSET);
 		status = XAxiDma_BdSetBufAddr(cur_bd_ptr, buf_addr);
 		if(status != XST_SUCCESS) {xil_printf("XAxiDma_BdSetBufAddr failed (bd %d, addr 0x08x)! Err = %d\n", i, buf_addr, status); return -1;}
 
 		//Set every Rx BD to max length (this assures 1 BD per Rx pkt)
-		status = XAxiDma_BdSetLength(cur_bd_ptr, ETH_A_PKT_BUF_SIZE, ETH_A_RxRing_ptr->MaxTransferLen);
+		status = XAxiDma_BdSetLength(cur_bd_ptr, queue_frame_capacity(curr_tx_queue_element) - ETH_RX_BUF_OFFSET, ETH_A_RxRing_ptr->MaxTransferLen);
 		if(status != XST_SUCCESS) {xil_printf("XAxiDma_BdSetLength failed (bd %d, addr 0x08x)! Err = %d\n", i, buf_addr, status); return -1;}
 
 		//Rx BD's don't need control flags before use; DMA populates these post-Rx
@@ -442,7 +447,7 @@ int wlan_mpdu_eth_send(void* mpdu, u16 length, u8 pre_llc_offset) {
 													//Look backwards from the MPDU payload to find the wireless Rx pkt metadata (the rx_frame_info struct)
 													frame_info = (rx_frame_info*)((u8*)mpdu  - PHY_RX_PKT_BUF_MPDU_OFFSET);
 
-													if(frame_info->additional_info != NULL) {
+													if(frame_info->additional_info != 0) {
 														//rx_frame_info has pointer to STA entry in association table - fill in that entry's hostname field
 
 														// Zero out the hostname field of the station_info
@@ -691,8 +696,9 @@ inline void wlan_poll_eth_rx() {
 	u32 eth_rx_len, eth_rx_buf;
 	u32 mpdu_tx_len;
 	u32 i;
+	u8  ac;
 
-	int bd_count;
+	u32 bd_count;
 	int status;
 	int packet_is_queued;
 
@@ -732,18 +738,25 @@ inline void wlan_poll_eth_rx() {
 		eth_rx_buf = XAxiDma_BdGetBufAddr(cur_bd_ptr);
 
 		//After encapsulation, byte[0] of the MPDU will be at byte[0] of the queue entry frame buffer
-		mpdu_start_ptr = (void*)((tx_queue_buffer*)(curr_tx_queue_element->data))->frame;
+		mpdu_start_ptr = (void*)queue_element_buffer(curr_tx_queue_element)->frame;
 		eth_start_ptr = (u8*)eth_rx_buf;
 
 		//Encapsulate the Ethernet packet
 		// See the 802.11 Ref Design user guide for details on the encapsulation process
-		mpdu_tx_len = wlan_eth_encap(mpdu_start_ptr, eth_dest, eth_src, eth_start_ptr, eth_rx_len);
+		mpdu_tx_len = wlan_eth_encap(mpdu_start_ptr, eth_dest, eth_src, eth_start_ptr, eth_rx_len, &ac);
 
 		if(mpdu_tx_len == 0) {
 			//Encapsulation failed for some reason (probably unknown ETHERTYPE value)
 			// Don't pass the invalid frame to the MAC - just cleanup and return
 			packet_is_queued = 0;
 		} else {
+			//Record the access category so the packet is enqueued to the matching sub-queue
+			queue_element_buffer(curr_tx_queue_element)->metadata.ac = ac;
+
+			//Rx buffers are sized for the largest Ethernet frame; move small packets (TCP ACKs, ARP, etc.)
+			// into a smaller queue entry so they don't hold a full-size buffer while they wait in the queue
+			curr_tx_queue_element = queue_downsize(curr_tx_queue_element, mpdu_tx_len);
+
 			//Call the MAC's callback to process the packet
 			// MAC will either enqueue the packet for eventual transmission or reject the packet
 			packet_is_queued = eth_rx_callback(curr_tx_queue_element, eth_dest, eth_src, mpdu_tx_len);
@@ -773,6 +786,24 @@ inline void wlan_poll_eth_rx() {
 	return;
 }
 
+/**
+ * @brief Run queue task that services Ethernet receptions
+ *
+ * Receptions are also serviced by eth_rx_interrupt_handler(). Polling from the main loop
+ * picks up receptions that completed while the DMA was still coalescing its Rx interrupt.
+ *
+ * @param    arg          - unused
+ * @return   None.
+ */
+void wlan_eth_rx_task(u32 arg){
+	interrupt_state_t prev_interrupt_state;
+
+	//The Rx BD ring is also walked by the Rx interrupt handler
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+	wlan_poll_eth_rx();
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+}
+
 /**
  * @brief Encapsulates Ethernet packets for wireless transmission
  *
@@ -793,6 +824,10 @@ inline void wlan_poll_eth_rx() {
  *    -Assert DHCP header's BROADCAST flag
  *    -Disable the UDP packet checksum (otherwise it would be invliad after modifying the BROADCAST flag)
  *
+ * In every mode, an 802.1Q tag is removed from the packet and the packet is classified into an 802.11e
+ * access category: IPv4 packets (IP version 4) by the DSCP field, other tagged packets by the 802.1p
+ * priority of the removed tag, and all others as best effort.
+ *
  * Refer to the 802.11 Reference Design user guide for more details:
  *  http://warpproject.org/trac/wiki/802.11/MAC/Upper/MACHighFramework/EthEncap
  *
@@ -806,10 +841,13 @@ inline void wlan_poll_eth_rx() {
  *  - Pointer to first byte of received Ethernet packet's header
  * @param u32 eth_rx_len
  *  - Length (in bytes) of the packet payload
+ * @param u8* ac
+ *  - Overwritten with the packet's access category (QUEUE_AC_*)
  * @return 0 for if packet type is unrecognized (failed encapsulation), otherwise returns length of encapsulated packet (in bytes)
 */
-int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_ptr, u32 eth_rx_len){
+int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_ptr, u32 eth_rx_len, u8* ac){
 	ethernet_header* eth_hdr;
+	ethernet_vlan_header* vlan_hdr;
 	ipv4_header* ip_hdr;
 	arp_packet* arp;
 	udp_header* udp;
@@ -817,14 +855,27 @@ int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_
 
 	llc_header* llc_hdr;
 	u32 mpdu_tx_len;
-
-	//Calculate actual wireless Tx len (eth payload - eth header + wireless header)
-	mpdu_tx_len = eth_rx_len - sizeof(ethernet_header) + sizeof(llc_header) + sizeof(mac_header_80211) + WLAN_PHY_FCS_NBYTES;
+	u8  vlan_pcp;
 
 	//Helper pointers to interpret/fill fields in the new MPDU
 	eth_hdr = (ethernet_header*)eth_start_ptr;
 	llc_hdr = (llc_header*)(mpdu_start_ptr + sizeof(mac_header_80211));
 
+	//Remove an 802.1Q tag, keeping its priority for classification. Moving the inner EtherType and
+	// payload over the tag leaves the payload where the MPDU expects it.
+	vlan_pcp = ETH_VLAN_PCP_NONE;
+
+	if((eth_hdr->type == ETH_TYPE_VLAN) && (eth_rx_len >= sizeof(ethernet_vlan_header))){
+		vlan_hdr   = (ethernet_vlan_header*)eth_start_ptr;
+		vlan_pcp   = ETH_VLAN_PCP(Xil_Ntohs(vlan_hdr->tci));
+
+		memmove(&(vlan_hdr->tpid), &(vlan_hdr->type), eth_rx_len - (sizeof(ethernet_vlan_header) - sizeof(u16)));
+		eth_rx_len -= ETH_VLAN_TAG_LEN;
+	}
+
+	//Calculate actual wireless Tx len (eth payload - eth header + wireless header)
+	mpdu_tx_len = eth_rx_len - sizeof(ethernet_header) + sizeof(llc_header) + sizeof(mac_header_80211) + WLAN_PHY_FCS_NBYTES;
+
 	//Copy the src/dest addresses from the received Eth packet to temp space
 	memcpy(eth_src, eth_hdr->address_source, 6);
 	memcpy(eth_dest, eth_hdr->address_destination, 6);
@@ -910,6 +961,27 @@ int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_
 
 	}//END switch(encap mode)
 
+	//Classify the packet. IPv4 packets use the IP precedence bits of their DSCP as the 802.1D user
+	// priority, except for the EF and VOICE-ADMIT code points which map to voice (RFC 8325). A packet
+	// whose IP version is not 4 has no IPv4 TOS field, so it is classified like a non-IP packet.
+	ip_hdr = (ipv4_header*)((void*)eth_hdr + sizeof(ethernet_header));
+
+	if((llc_hdr->type == LLC_TYPE_IP) && ((ip_hdr->ver_ihl >> 4) == 4)){
+		switch(IPV4_DSCP(ip_hdr->tos)){
+			case IPV4_DSCP_EF:
+			case IPV4_DSCP_VA:
+				*ac = QUEUE_AC_VO;
+			break;
+			default:
+				*ac = eth_up_to_ac[IPV4_DSCP(ip_hdr->tos) >> 3];
+			break;
+		}
+	} else if(vlan_pcp != ETH_VLAN_PCP_NONE){
+		*ac = eth_up_to_ac[vlan_pcp];
+	} else {
+		*ac = QUEUE_AC_BE;
+	}
+
 	//If we got this far, the packet was successfully encapsulated; return the post-encapsulation length
 	return mpdu_tx_len;
 }
@@ -938,18 +1010,18 @@ void wlan_eth_dma_update() {
 	XAxiDma_BdRing *ETH_A_RxRing_ptr;
 	XAxiDma_Bd *first_bd_ptr;
 	XAxiDma_Bd *cur_bd_ptr;
-	dl_list checkout;
-	dl_entry*	tx_queue_entry;
+	tx_queue_list checkout;
+	tx_queue_element* tx_queue_entry;
 	u32 buf_addr;
 
-	dl_list_init(&checkout);
+	queue_list_init(&checkout);
 
 	ETH_A_RxRing_ptr = XAxiDma_GetRxRing(&ETH_A_DMA_Instance);
 	bd_count = XAxiDma_BdRingGetFreeCnt(ETH_A_RxRing_ptr);
 
 	//Calculate number of BD-queue pairs to attempt
 	u32 bd_queue_pairs_to_process = bd_count;
-	queue_checkout_list(&checkout, bd_queue_pairs_to_process);
+	queue_checkout_list_sized(&checkout, bd_queue_pairs_to_process, ETH_RX_BUF_OFFSET + ETH_RX_MAX_LEN);
 
 	//If there weren't bd_queue_pairs_to_process free queues available, the checkout list will be
 	//the number of free queues that were found. We now update bd_queue_pairs_to_process accordingly
@@ -961,7 +1033,7 @@ void wlan_eth_dma_update() {
 		status = XAxiDma_BdRingAlloc(ETH_A_RxRing_ptr, bd_queue_pairs_to_process, &first_bd_ptr);
 		if(status != XST_SUCCESS) {xil_printf("Error in XAxiDma_BdRingAlloc()! Err = %d\n", status); return;}
 
-		tx_queue_entry = checkout.first;
+		tx_queue_entry = queue_list_first(&checkout);
 
 		//Iterate over each Rx buffer descriptor
 		cur_bd_ptr = first_bd_ptr;
@@ -971,13 +1043,13 @@ void wlan_eth_dma_update() {
 			// This pointer is offset by the size of a MAC header and LLC header, which results in the Ethernet
 			//  payload being copied to its post-encapsulated location. This speeds up the encapsulation process by
 			//  skipping any re-copying of Ethernet payloads
-			buf_addr = (u32)((void*)((tx_queue_buffer*)(tx_queue_entry->data))->frame + sizeof(mac_header_80211) + sizeof(llc_header) - sizeof(ethernet_header));
+			buf_addr = (u32)((void*)queue_element_buffer(tx_queue_entry)->frame + ETH_RX_BUF_OFFSET);
 			status = XAxiDma_BdSetBufAddr(cur_bd_ptr, buf_addr);
 			if(status != XST_SUCCESS) {xil_printf("XAxiDma_BdSetBufAddr failed (addr 0x08x)! Err = %d\n", buf_addr, status); return;}
 
 			//Set every Rx BD to max length (this assures 1 BD per Rx pkt)
 			// The ETH DMA hardware will record the actual Rx length in its per-BD meta data
-			status = XAxiDma_BdSetLength(cur_bd_ptr, ETH_A_PKT_BUF_SIZE, ETH_A_RxRing_ptr->MaxTransferLen);
+			status = XAxiDma_BdSetLength(cur_bd_ptr, queue_frame_capacity(tx_queue_entry) - ETH_RX_BUF_OFFSET, ETH_A_RxRing_ptr->MaxTransferLen);
 			if(status != XST_SUCCESS) {xil_printf("XAxiDma_BdSetLength failed (addr 0x08x)! Err = %d\n", buf_addr, status); return;}
 
 			//Rx BD's don't need control flags before use; DMA populates these post-Rx
@@ -988,7 +1060,7 @@ void wlan_eth_dma_update() {
 
 			//Update the BD and queue entry pointers to the next list elements (this loop traverses both lists simultaneously)
 			cur_bd_ptr = XAxiDma_BdRingNext(ETH_A_RxRing_ptr, cur_bd_ptr);
-			tx_queue_entry = dl_entry_next(tx_queue_entry);
+			tx_queue_entry = queue_element_next(tx_queue_entry);
 		}
 
 		//Push the Rx BD ring to hardware and start receiving
@@ -33,6 +33,25 @@
  * oldest entries.
  *   Finally, the log does not keep track of event entries and it is up to
  * calling functions to interpret the bytes within the log correctly.
+ *    Entries may be requested from both the main context and interrupt
+ * contexts.  An entry is reserved and its header written with interrupts
+ * stopped, so a producer that interrupts another one (and may move the oldest
+ * address past other entries) always sees a log of complete entry headers.
+ * Only the entry payload is filled in after the reservation.  Requests that
+ * cannot be satisfied are counted (see event_log_get_num_failures()).
+ *    A reserved entry is not part of the log until the producer has written
+ * its payload and committed it (see event_log_commit_entry()).  The log only
+ * exposes the entries up to the first entry that is not committed, so a
+ * reader never sees a partly written entry, even if a producer in an
+ * interrupt context has reserved and committed entries after it.
+ *    A sparse time index is kept alongside the log.  The first entry allocated
+ * in each index interval is recorded as a checkpoint (log time, log index).
+ * Checkpoints are only used if their entry is still in the log, so the index
+ * remains correct as the log wraps (see event_log_get_time_range()).
+ *    A skip index records the first entry that starts in each small block of
+ * the log, so that when a wrapped log allocates, the oldest address can jump
+ * to the block of the allocation instead of walking every entry in between
+ * (see event_log_move_oldest_address()).
  *
  *
  *  @author Chris Hunter (chunter [at] mangocomm.com)
@@ -60,6 +79,21 @@
 
 /*************************** Constant Definitions ****************************/
 
+// An entry header is valid once the entry is reserved, whether or not it is committed
+#define EVENT_LOG_HEADER_VALID(entry_id)     ( (((entry_id) & 0xFFFF0000) == EVENT_LOG_MAGIC_NUMBER) || \
+                                               (((entry_id) & 0xFFFF0000) == EVENT_LOG_RESERVED_NUMBER) )
+
+
+/*********************** Local Structure Definitions *************************/
+
+// Snapshot of the log bounds used to search the time index
+typedef struct{
+	u32 oldest_address;
+	u32 next_address;
+	u32 soft_end_address;
+	u8  full;
+} event_log_bounds;
+
 
 
 /*********************** Global Variable Definitions *************************/
@@ -85,6 +119,8 @@ volatile static u32   log_size;                 // Size of the log in bytes
 // Log index variables
 volatile static u32   log_oldest_address;       // Pointer to the oldest entry
 volatile static u32   log_next_address;         // Pointer to the next entry
+volatile static u32   log_commit_address;       // Pointer to the first entry that is not committed
+                                                //   (log_next_address if all entries are committed)
 volatile static u32   log_num_wraps;            // Number of times the log has wrapped
 
 // Log config variables
@@ -98,9 +134,19 @@ volatile static u8    log_empty;                // log_empty = (log_oldest_addre
 volatile static u8    log_full;                 // log_full  = (log_tail_address == log_next_address);
 volatile static u16   log_count;                // Monotonic counter for log entry sequence number
                                        //   (wraps every (2^16 - 1) entries)
+volatile static u32   log_num_failures;         // Number of entries that could not be allocated
+
+// Log time index variables
+static event_log_checkpoint * log_index;        // Checkpoints (one per index interval)
+static u32            log_index_num_slots;      // Number of checkpoints
+static u32            log_index_shift;          // Index interval is (1 << log_index_shift) bytes
+static u32            log_index_last_slot;      // Interval of the last allocated entry
 
-// Mutex for critical allocation loop
-volatile static u8    allocation_mutex;
+// Log skip index variables
+static u16          * log_skip_index;           // Offset of the first entry in each block (EVENT_LOG_SKIP_NONE if none)
+static u32            log_skip_num_blocks;      // Number of blocks
+static u32            log_skip_shift;           // Block size is (1 << log_skip_shift) bytes
+static u32            log_skip_last_block;      // Block of the last allocated entry
 
 
 // Variables to use with WLAN Exp framework
@@ -112,9 +158,15 @@ wn_cmdHdr    log_entry_cmd;
 
 // Internal functions;  Should not be called externally
 //
+void            event_log_get_bounds( event_log_bounds * bounds );
+void            event_log_advance_commit_address();
 void            event_log_move_oldest_address( u32 end_address );
 void            event_log_increment_oldest_address( u64 end_address, u32 size );
 int             event_log_get_next_empty_address( u32 size, u32 * address );
+void            event_log_index_reset();
+void            event_log_index_restart();
+void            event_log_index_update( u32 address );
+int             event_log_index_get_position( event_log_bounds * bounds, u32 address, u32 * position );
 
 
 /******************************** Functions **********************************/
@@ -175,6 +227,29 @@ void event_log_init( char * start_address, u32 size ) {
 	// Set the wrap buffer to EVENT_LOG_WRAP_BUFFER
 	wrap_buffer       = EVENT_LOG_WRAPPING_BUFFER;
 
+	// Set the time index interval so that the checkpoints fit in the index memory
+	log_index         = (event_log_checkpoint *) EVENT_LOG_INDEX_BASE;
+	log_index_shift   = EVENT_LOG_INDEX_MIN_SHIFT;
+
+	while ( ((log_size >> log_index_shift) + 1) > (EVENT_LOG_INDEX_SIZE / sizeof(event_log_checkpoint)) ) {
+		log_index_shift++;
+	}
+
+	log_index_num_slots = (log_size >> log_index_shift) + 1;
+
+	// Set the skip index block size so that the offsets fit in the skip index memory
+	log_skip_index    = (u16 *) EVENT_LOG_SKIP_BASE;
+	log_skip_shift    = EVENT_LOG_SKIP_MIN_SHIFT;
+
+	while ( ((log_size >> log_skip_shift) + 1) > (EVENT_LOG_SKIP_SIZE / sizeof(u16)) ) {
+		log_skip_shift++;
+	}
+
+	log_skip_num_blocks = (log_size >> log_skip_shift) + 1;
+
+	// Clear the index memory; resets of the log only restart the indexes
+	event_log_index_reset();
+
 	// Reset all the event log variables
 	event_log_reset();
 
@@ -197,7 +272,7 @@ void event_log_init( char * start_address, u32 size ) {
 	xil_printf("    log_next_address     = 0x%x;\n", log_next_address );
 	xil_printf("    log_empty            = 0x%x;\n", log_empty );
 	xil_printf("    log_full             = 0x%x;\n", log_full );
-	xil_printf("    allocation_mutex     = 0x%x;\n", allocation_mutex );
+	xil_printf("    log_num_failures     = 0x%x;\n", log_num_failures );
 #endif
 }
 
@@ -215,19 +290,31 @@ void event_log_init( char * start_address, u32 size ) {
 *
 ******************************************************************************/
 void event_log_reset(){
+	interrupt_state_t prev_interrupt_state;
+
+	// Entries may be requested from interrupt contexts
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
 	log_soft_end_address = log_max_address;
 
 	log_oldest_address   = log_start_address;
 	log_next_address     = log_start_address;
+	log_commit_address   = log_start_address;
 	log_num_wraps        = 0;
 
 	log_empty            = 1;
 	log_full             = 0;
 	log_count            = 0;
+	log_num_failures     = 0;
 
-	allocation_mutex     = 0;
+	// Compact entries after the reset need a new time anchor
+	wlan_exp_log_reset_compact();
+
+	event_log_index_restart();
 
 	add_node_info_entry(WN_NO_TRANSMIT);
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
 }
 
 
@@ -320,15 +407,61 @@ int event_log_config_logging( u32 enable ) {
 * @return	num_bytes        - The number of bytes filled in to the buffer
 *
 * @note		Any requests for data that is out of bounds will print a warning and
-*           return 0 bytes.  If a request exceeds the size of the array, then
-*           the request will be truncated.
+*           return 0 bytes.  If a request exceeds the size of the array, or
+*           reaches an entry that is not committed, then the request will be
+*           truncated.
 *
 ******************************************************************************/
 u32  event_log_get_data( u32 start_index, u32 size, char * buffer ) {
 
 	u32 start_address;
-	u64 end_address;
-	u32 num_bytes     = 0;
+	u32 num_bytes;
+
+	num_bytes = event_log_get_data_address( start_index, size, &start_address );
+
+	// Copy the data in to the buffer
+	if ( num_bytes != 0 ) {
+		memcpy( (void *) buffer, (void *) start_address, num_bytes );
+	}
+
+    return num_bytes;
+}
+
+
+
+/*****************************************************************************/
+/**
+* Get the address of event log data
+*   Based on the start address and the size, the function will return the
+* memory address of the data and the number of bytes that may be read from it,
+* so that the caller can transfer the data without an intermediate copy.  It
+* is up to the caller to determine if the bytes are "valid".
+*
+* @param    start_index      - Address in the event log to start the transfer
+*                                (ie byte index from 0 to log_size)
+*           size             - Size in bytes of the transfer
+*           address          - Pointer to be filled in with the memory address
+*                                of the data
+*
+* @return	num_bytes        - The number of bytes that may be read from address
+*
+* @note		Any requests for data that is out of bounds will print a warning and
+*           return 0 bytes.  If a request exceeds the size of the array, or
+*           reaches an entry that is not committed, then the request will be
+*           truncated.
+*
+*           A committed entry may still be the destination of a central DMA
+*           copy (see wlan_exp_log_create_rx_entry()), so this waits for the
+*           central DMA to finish before the data is returned.
+*
+******************************************************************************/
+u32  event_log_get_data_address( u32 start_index, u32 size, u32 * address ) {
+
+	u32              start_address;
+	u32              end_limit;
+	u64              end_address;
+	u32              num_bytes     = 0;
+	event_log_bounds bounds;
 
 	// If the log is empty, then return 0
     if ( log_empty == 1 ) { return num_bytes; }
@@ -345,15 +478,27 @@ u32  event_log_get_data( u32 start_index, u32 size, char * buffer ) {
     // Compute the end address for validity checks
     end_address = start_address + size;
 
-    // Check that the end address is less than the end of the buffer
-    if ( end_address > log_soft_end_address ) {
-    	num_bytes = log_soft_end_address - start_address;
+    // Data before the commit address ends there; otherwise it ends at the end of the buffer
+    event_log_get_bounds( &bounds );
+
+    if ( start_address < bounds.next_address ) {
+    	end_limit = bounds.next_address;
+    } else {
+    	end_limit = bounds.soft_end_address;
+    }
+
+    // Check that the end address is less than the end of the data
+    if ( end_address > end_limit ) {
+    	num_bytes = ( start_address < end_limit ) ? ( end_limit - start_address ) : 0;
     } else {
     	num_bytes = size;
     }
 
-	// Copy the data in to the buffer
-	memcpy( (void *) buffer, (void *) start_address, num_bytes );
+    if ( num_bytes != 0 ) {
+    	wlan_mac_high_cdma_finish_transfer();
+    }
+
+    *address = start_address;
 
     return num_bytes;
 }
@@ -365,8 +510,8 @@ u32  event_log_get_data( u32 start_index, u32 size, char * buffer ) {
 * Get the size of the log in bytes from the start_index to the "end" of the log
 *
 * The "end" of the log is:
-*   - log_next_address if start_address < log_next_address
-*   - log_soft_end_address if start_address >= log_next_address
+*   - log_commit_address if start_address < log_commit_address
+*   - log_soft_end_address if start_address >= log_commit_address
 *
 * This function will no longer return the total number of bytes in the log.
 * To get that, you would need to call:  event_log_get_total_size()
@@ -375,19 +520,25 @@ u32  event_log_get_data( u32 start_index, u32 size, char * buffer ) {
 *
 * @return	size    - Size of the log in bytes
 *
-* @note		None.
+* @note		The size ends at the first entry that is not committed (see
+*           event_log_get_bounds()).
 *
 ******************************************************************************/
 u32  event_log_get_size( u32 start_index ) {
-	u32 size;
-	u32 start_address = log_start_address + start_index;
+	u32              size;
+	u32              start_address = log_start_address + start_index;
+	event_log_bounds bounds;
+
+	event_log_get_bounds( &bounds );
 
 	// Implemented this way b/c we are using unsigned integers, so we always need
 	//   to have positive integers at each point in the calculation
-	if ( start_address < log_next_address ) {
-		size = log_next_address - start_address;
+	if ( start_address < bounds.next_address ) {
+		size = bounds.next_address - start_address;
+	} else if ( start_address < bounds.soft_end_address ) {
+		size = bounds.soft_end_address - start_address;
 	} else {
-		size = log_soft_end_address - start_address;
+		size = 0;
 	}
 
 #ifdef _DEBUG_
@@ -460,11 +611,17 @@ u32  event_log_get_capacity( void ) {
 *
 * @return	u32    - Index of the event log of the write pointer
 *
-* @note		None.
+* @note		The index is that of the first entry that is not committed, so
+*           it only differs from the write pointer while a producer is
+*           filling in an entry.
 *
 ******************************************************************************/
 u32  event_log_get_next_entry_index( void ) {
-    return ( log_next_address - log_start_address );
+	event_log_bounds bounds;
+
+	event_log_get_bounds( &bounds );
+
+    return ( bounds.next_address - log_start_address );
 }
 
 
@@ -503,6 +660,24 @@ u32  event_log_get_num_wraps( void ) {
 
 
 
+/*****************************************************************************/
+/**
+* Get the number of entries that could not be allocated
+*
+* @param    None.
+*
+* @return	u32    - Number of entries that could not be allocated since the
+*                    log was reset (ie because the log was full)
+*
+* @note		None.
+*
+******************************************************************************/
+u32  event_log_get_num_failures( void ) {
+    return log_num_failures;
+}
+
+
+
 /*****************************************************************************/
 /**
 * Get the flags associated with the log
@@ -522,6 +697,96 @@ u32  event_log_get_flags( void ) {
 
 
 
+/*****************************************************************************/
+/**
+* Get the log data for a window of log time
+*
+* @param    start_time  - Start of the window (usec)
+*           end_time    - End of the window (usec)
+*           start_index * - Index of the first entry of the data
+*           size        * - Number of bytes of data
+*
+* @return	int         -  0 - Success
+*                         -1 - Failure (log is empty)
+*
+* @note		The data starts at the last checkpoint allocated at or before
+*           start_time and ends at the first checkpoint allocated after
+*           end_time (or at the next entry index).  The data is therefore entry
+*           aligned and contains every entry allocated in the window, plus at
+*           most one index interval of entries on either side.
+*
+*           The data is in log order.  If the log has wrapped, the data may
+*           continue from the end of the log to the first entry after the
+*           node info entry at the beginning of the log.
+*
+*           Checkpoints are searched in log order, so a change of the
+*           timebase (ie WN_SET_TIME) only widens the data returned.  As with
+*           event_log_get_size(), the data reflects the log at the time of the
+*           call; entries added afterwards, and entries that are not yet
+*           committed, are not included.
+*
+******************************************************************************/
+int event_log_get_time_range( u64 start_time, u64 end_time, u32 * start_index, u32 * size ) {
+
+	u32                    i;
+	u32                    position;
+	u32                    start_position;
+	u32                    end_position;
+	event_log_bounds       bounds;
+	event_log_checkpoint * checkpoint;
+
+	if ( log_empty ) { return -1; }
+
+	// Take a snapshot of the log so that the checkpoints can be searched with interrupts enabled
+	event_log_get_bounds( &bounds );
+
+	// Positions are byte offsets from the oldest entry in log order
+	start_position = 0;
+
+	if ( bounds.full ) {
+		end_position = bounds.soft_end_address - log_start_address;
+	} else {
+		event_log_index_get_position( &bounds, bounds.next_address, &end_position );
+	}
+
+	// Find the last checkpoint at or before the start time
+	for ( i = 0; i < log_index_num_slots; i++ ) {
+		checkpoint = &(log_index[i]);
+
+		if ( ( checkpoint->index != EVENT_LOG_INDEX_INVALID ) && ( checkpoint->timestamp <= start_time ) &&
+			 ( event_log_index_get_position( &bounds, log_start_address + checkpoint->index, &position ) == 0 ) ) {
+
+			// A checkpoint at the next entry index is stale:  no entry has been allocated there
+			if ( ( position > start_position ) && ( position < end_position ) ) { start_position = position; }
+		}
+	}
+
+	// Find the first checkpoint after the end time that follows the start position
+	for ( i = 0; i < log_index_num_slots; i++ ) {
+		checkpoint = &(log_index[i]);
+
+		if ( ( checkpoint->index != EVENT_LOG_INDEX_INVALID ) && ( checkpoint->timestamp > end_time ) &&
+			 ( event_log_index_get_position( &bounds, log_start_address + checkpoint->index, &position ) == 0 ) ) {
+
+			if ( ( position > start_position ) && ( position < end_position ) ) { end_position = position; }
+		}
+	}
+
+	// Translate the start position back to a log index
+	if ( !bounds.full && ( bounds.next_address <= bounds.oldest_address ) &&
+		 ( start_position >= ( bounds.soft_end_address - bounds.oldest_address ) ) ) {
+		*start_index = EVENT_LOG_WRAP_INDEX + ( start_position - ( bounds.soft_end_address - bounds.oldest_address ) );
+	} else {
+		*start_index = ( bounds.oldest_address - log_start_address ) + start_position;
+	}
+
+	*size = end_position - start_position;
+
+	return 0;
+}
+
+
+
 /*****************************************************************************/
 /**
 * Update the entry type
@@ -545,7 +810,7 @@ int       event_log_update_type( void * entry_ptr, u16 entry_type ) {
     	entry_hdr = (entry_header *) ( ((u32) entry_ptr) - sizeof( entry_header ) );
 
     	// Check to see if the entry has a valid magic number
-    	if ( ( entry_hdr->entry_id & 0xFFFF0000 ) == EVENT_LOG_MAGIC_NUMBER ) {
+    	if ( EVENT_LOG_HEADER_VALID( entry_hdr->entry_id ) ) {
 
         	entry_hdr->entry_type = entry_type;
 
@@ -576,10 +841,40 @@ int       event_log_update_type( void * entry_ptr, u16 entry_type ) {
 *           end_address.  It does not check for the end of the log and that
 *           is the responsibilty of the calling function.
 *
+*           The skip index is used to jump to the first entry that starts in
+*           the block of end_address (or in one of the following blocks, if
+*           the block is covered by a single entry).  Only the entries in that
+*           block are then walked.  Offsets of entries that do not start after
+*           the oldest address were recorded on the current pass through the
+*           log and are not used.
+*
 ******************************************************************************/
 void event_log_move_oldest_address( u32 end_address ) {
 
     entry_header * entry;
+    u32            block;
+    u32            last_block;
+    u32            address;
+
+    // Find the first entry that starts in the block of end_address or in one of the following
+    //   blocks.  An entry is at most (0xFFFF + sizeof(entry_header)) bytes, so one will start
+    //   within that many blocks unless the end of the log is reached.
+    block      = ( end_address - log_start_address ) >> log_skip_shift;
+    last_block = min( block + ( ( 0xFFFF + sizeof(entry_header) ) >> log_skip_shift ) + 1, log_skip_num_blocks - 1 );
+
+    for ( ; block <= last_block; block++ ) {
+    	if ( log_skip_index[block] != EVENT_LOG_SKIP_NONE ) {
+    		address = log_start_address + ( block << log_skip_shift ) + log_skip_index[block];
+    		entry   = (entry_header *) address;
+
+    		// Entries at or past the soft end are stale data from the previous pass through the log
+    		if ( ( address > log_oldest_address ) && ( address < log_soft_end_address ) &&
+    			 EVENT_LOG_HEADER_VALID( entry->entry_id ) ) {
+    			log_oldest_address = address;
+    		}
+    		break;
+    	}
+    }
 
 	// Move the oldest address an integer number of entries until it points to the
 	//   first entry after the allocation
@@ -590,7 +885,7 @@ void event_log_move_oldest_address( u32 end_address ) {
 
 		// Check that the entry is still valid.  Otherwise, print a warning and
 		//   issue a log reset.
-		if ( (entry->entry_id & 0xFFFF0000) != EVENT_LOG_MAGIC_NUMBER ) {
+		if ( !EVENT_LOG_HEADER_VALID( entry->entry_id ) ) {
 			xil_printf("EVENT LOG: ERROR: Oldest entry corrupted. Resetting event log\n");
 			xil_printf("    Please verify that no other code / data is using the event log memory space\n");
 
@@ -601,6 +896,14 @@ void event_log_move_oldest_address( u32 end_address ) {
 		// Increment the address and get the next entry
 		log_oldest_address += ( entry->entry_length + sizeof( entry_header ) );
 		entry               = (entry_header *) log_oldest_address;
+
+		// If that was the last entry before the soft end, then the oldest entry is the
+		//   first entry at the beginning of the array
+		if ( log_oldest_address >= log_soft_end_address ) {
+			log_soft_end_address = log_max_address;
+			log_oldest_address   = log_start_address + EVENT_LOG_WRAP_INDEX;
+			return;
+		}
 	}
 }
 
@@ -651,6 +954,166 @@ void event_log_increment_oldest_address( u64 end_address, u32 size ) {
 
 
 
+/*****************************************************************************/
+/**
+* Clear the time index and the skip index
+*
+* @param    None.
+*
+* @return	None.
+*
+* @note		This walks every checkpoint and block, so it is only done by
+*           event_log_init() before the log is in use.
+*
+******************************************************************************/
+void event_log_index_reset() {
+	u32 i;
+
+	for ( i = 0; i < log_index_num_slots; i++ ) {
+		log_index[i].index = EVENT_LOG_INDEX_INVALID;
+	}
+
+	for ( i = 0; i < log_skip_num_blocks; i++ ) {
+		log_skip_index[i] = EVENT_LOG_SKIP_NONE;
+	}
+
+	log_index_last_slot = EVENT_LOG_INDEX_INVALID;
+	log_skip_last_block = EVENT_LOG_INDEX_INVALID;
+}
+
+
+
+/*****************************************************************************/
+/**
+* Restart the time index and the skip index at the beginning of the log
+*
+* @param    None.
+*
+* @return	None.
+*
+* @note		The checkpoints and block offsets are not cleared.  The next entry
+*           (at the beginning of the log) is treated as following the last
+*           block and interval, so event_log_index_update() records it in
+*           block 0 and, as the log grows, overwrites or invalidates each block
+*           and interval before the log reaches it.  Stale values past the next
+*           entry are outside the log bounds and are not used.
+*
+*           Interrupts must be stopped by the caller.
+*
+******************************************************************************/
+void event_log_index_restart() {
+	log_index_last_slot = log_index_num_slots - 1;
+	log_skip_last_block = log_skip_num_blocks - 1;
+}
+
+
+
+/*****************************************************************************/
+/**
+* Update the time index and the skip index for a newly allocated entry
+*
+* @param    address     - Address of the entry header
+*
+* @return	None.
+*
+* @note		If the entry is the first entry allocated in its skip index block
+*           (or time index interval), then its offset (or checkpoint) is
+*           recorded.  Blocks and intervals that were skipped (by the wrap or
+*           by a long entry) no longer hold an entry header at their recorded
+*           offset, so they are invalidated.
+*
+*           Interrupts must be stopped by the caller.
+*
+******************************************************************************/
+void event_log_index_update( u32 address ) {
+	u32 i;
+	u32 offset = address - log_start_address;
+	u32 block  = offset >> log_skip_shift;
+	u32 slot;
+
+	// Time index intervals are never smaller than skip index blocks, so the
+	//   interval can only change when the block changes
+	if ( block == log_skip_last_block ) { return; }
+
+	if ( log_skip_last_block != EVENT_LOG_INDEX_INVALID ) {
+		if ( block > log_skip_last_block ) {
+			for ( i = ( log_skip_last_block + 1 ); i < block; i++ ) { log_skip_index[i] = EVENT_LOG_SKIP_NONE; }
+		} else {
+			for ( i = ( log_skip_last_block + 1 ); i < log_skip_num_blocks; i++ ) { log_skip_index[i] = EVENT_LOG_SKIP_NONE; }
+			for ( i = 0; i < block; i++ ) { log_skip_index[i] = EVENT_LOG_SKIP_NONE; }
+		}
+	}
+
+	log_skip_index[block] = offset & ( ( 1 << log_skip_shift ) - 1 );
+	log_skip_last_block   = block;
+
+	slot = offset >> log_index_shift;
+
+	if ( slot == log_index_last_slot ) { return; }
+
+	if ( log_index_last_slot != EVENT_LOG_INDEX_INVALID ) {
+		if ( slot > log_index_last_slot ) {
+			for ( i = ( log_index_last_slot + 1 ); i < slot; i++ ) { log_index[i].index = EVENT_LOG_INDEX_INVALID; }
+		} else {
+			for ( i = ( log_index_last_slot + 1 ); i < log_index_num_slots; i++ ) { log_index[i].index = EVENT_LOG_INDEX_INVALID; }
+			for ( i = 0; i < slot; i++ ) { log_index[i].index = EVENT_LOG_INDEX_INVALID; }
+		}
+	}
+
+	log_index[slot].timestamp = get_usec_timestamp();
+	log_index[slot].index     = offset;
+
+	log_index_last_slot       = slot;
+}
+
+
+
+/*****************************************************************************/
+/**
+* Get the position of an entry in log order
+*
+* @param    bounds *    - Snapshot of the log bounds
+*           address     - Address of the entry header
+*           position *  - Number of bytes between the oldest entry and the entry
+*                         in log order
+*
+* @return	int         -  0 - Success
+*                         -1 - Address is not a valid entry in the log
+*
+* @note		The node info entry at the beginning of the log is skipped once
+*           the log has wrapped, as it is not part of the log order.
+*
+******************************************************************************/
+int event_log_index_get_position( event_log_bounds * bounds, u32 address, u32 * position ) {
+
+	if ( bounds->full ) {
+		// Log stopped without wrapping:  [log_start_address, soft_end_address)
+		if ( address >= bounds->soft_end_address ) { return -1; }
+
+		*position = address - log_start_address;
+
+	} else if ( bounds->next_address > bounds->oldest_address ) {
+		// Log has not wrapped:  [oldest_address, next_address)
+		if ( ( address < bounds->oldest_address ) || ( address > bounds->next_address ) ) { return -1; }
+
+		*position = address - bounds->oldest_address;
+
+	} else {
+		// Log has wrapped:  [oldest_address, soft_end_address) then [log_start_address + EVENT_LOG_WRAP_INDEX, next_address)
+		if ( ( address >= bounds->oldest_address ) && ( address < bounds->soft_end_address ) ) {
+			*position = address - bounds->oldest_address;
+		} else if ( ( address >= ( log_start_address + EVENT_LOG_WRAP_INDEX ) ) && ( address <= bounds->next_address ) ) {
+			*position = ( bounds->soft_end_address - bounds->oldest_address ) + ( address - ( log_start_address + EVENT_LOG_WRAP_INDEX ) );
+		} else {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+
 /*****************************************************************************/
 /**
 * Get the address of the next empty entry in the log and allocate size bytes
@@ -667,6 +1130,9 @@ void event_log_increment_oldest_address( u64 end_address, u32 size ) {
 *           a warning message.  If this function is called while the event log
 *           is full, then it will always return max_entry_index
 *
+*           Interrupts must be stopped by the caller so that the allocation
+*           cannot be interrupted by another allocation.
+*
 ******************************************************************************/
 int  event_log_get_next_empty_address( u32 size, u32 * address ) {
 
@@ -681,11 +1147,7 @@ int  event_log_get_next_empty_address( u32 size, u32 * address ) {
 	if ( log_empty ) { log_empty = 0; }
 
 	// If the log is not full, then find the next address
-	if ( !log_full && !allocation_mutex ) {
-
-		// Set the mutex to '1' so that if an interrupt occurs, the event log allocation
-		//   will not be ruined
-		allocation_mutex = 1;
+	if ( !log_full ) {
 
 		// Compute the end address of the newly allocated entry
 	    end_address = (u64)(log_next_address) + (u64)(size);
@@ -824,9 +1286,6 @@ int  event_log_get_next_empty_address( u32 size, u32 * address ) {
 	    		status           = 0;
 		    }
 	    }
-
-		// Set the mutex to '0' to allow for future allocations
-		allocation_mutex = 0;
 	}
 
 	// Set return parameter
@@ -846,7 +1305,10 @@ int  event_log_get_next_empty_address( u32 size, u32 * address ) {
 *
 * @return	void *      - Pointer to the next entry payload
 *
-* @note		None.
+* @note		The entry is reserved but not committed.  Once the payload is
+*           written, the caller must commit the entry with
+*           event_log_commit_entry(); until then, it and every entry
+*           allocated after it are hidden from readers of the log.
 *
 ******************************************************************************/
 void * event_log_get_next_empty_entry( u16 entry_type, u16 entry_size ) {
@@ -856,6 +1318,7 @@ void * event_log_get_next_empty_entry( u16 entry_type, u16 entry_size ) {
 	entry_header * header       = NULL;
 	u32            header_size  = sizeof( entry_header );
 	void *         return_entry = NULL;
+	interrupt_state_t prev_interrupt_state;
 
     // If Event Logging is enabled, then allocate entry
 	if( event_logging_enabled ){
@@ -869,6 +1332,9 @@ void * event_log_get_next_empty_entry( u16 entry_type, u16 entry_size ) {
 
 		total_size = entry_size + header_size;
 
+		// Reserve the entry and write its header without being interrupted by another producer
+		prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
 		// Try to allocate the next entry
 	    if ( !event_log_get_next_empty_address( total_size, &log_address ) ) {
 
@@ -885,24 +1351,142 @@ void * event_log_get_next_empty_entry( u16 entry_type, u16 entry_size ) {
 			// bzero( (void *) header, total_size );
 
 			// Set header parameters
-			//   - Use the upper 16 bits of the timestamp to place a magic number
-            header->entry_id     = EVENT_LOG_MAGIC_NUMBER + ( 0x0000FFFF & log_count++ );
+			//   - Use the upper 16 bits of the timestamp to mark the entry reserved; the
+			//     magic number is placed there when the entry is committed
+            header->entry_id     = EVENT_LOG_RESERVED_NUMBER + ( 0x0000FFFF & log_count++ );
 			header->entry_type   = entry_type;
 			header->entry_length = entry_size;
 
             // Get a pointer to the entry payload
             return_entry         = (void *) ( log_address + header_size );
 
+            event_log_index_update( log_address );
+
 #ifdef _DEBUG_
 			xil_printf("Entry (%6d bytes) = 0x%8x    0x%8x    0x%6x\n", entry_size, return_entry, header, total_size );
 #endif
+	    } else {
+	    	log_num_failures++;
 	    }
+
+		wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
 	}
 
 	return return_entry;
 }
 
 
+
+/*****************************************************************************/
+/**
+* Commit an entry
+*
+* @param    entry_ptr   - Pointer to the entry payload (as returned by
+*                         event_log_get_next_empty_entry())
+*
+* @return	None.
+*
+* @note		The payload must be written (or its central DMA copy started)
+*           before the entry is committed.  Committing an entry moves the
+*           commit address past it and past any entries after it that were
+*           committed while it was being filled in.
+*
+*           An entry that is no longer reserved was removed from the log by
+*           event_log_reset() while it was being filled in and is ignored.
+*
+******************************************************************************/
+void event_log_commit_entry( void * entry_ptr ) {
+
+	entry_header *    entry_hdr = (entry_header *) ( ((u32) entry_ptr) - sizeof( entry_header ) );
+	interrupt_state_t prev_interrupt_state;
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	if ( ( entry_hdr->entry_id & 0xFFFF0000 ) == EVENT_LOG_RESERVED_NUMBER ) {
+		entry_hdr->entry_id = EVENT_LOG_MAGIC_NUMBER + ( entry_hdr->entry_id & 0x0000FFFF );
+
+		event_log_advance_commit_address();
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+}
+
+
+
+/*****************************************************************************/
+/**
+* Move the commit address past the committed entries that follow it
+*
+* @param    None.
+*
+* @return	None.
+*
+* @note		The commit address follows the log order:  at the soft end of a
+*           wrapped log it continues at the first entry after the node info
+*           entry.  If the log is full, it stops at the soft end.
+*
+*           Interrupts must be stopped by the caller.
+*
+******************************************************************************/
+void event_log_advance_commit_address() {
+
+	entry_header * entry;
+
+	while ( log_commit_address != log_next_address ) {
+
+		if ( log_commit_address >= log_soft_end_address ) {
+			if ( log_full ) { break; }
+
+			log_commit_address = log_start_address + EVENT_LOG_WRAP_INDEX;
+			continue;
+		}
+
+		entry = (entry_header *) log_commit_address;
+
+		if ( ( entry->entry_id & 0xFFFF0000 ) != EVENT_LOG_MAGIC_NUMBER ) { break; }
+
+		log_commit_address += ( entry->entry_length + sizeof( entry_header ) );
+	}
+}
+
+
+
+/*****************************************************************************/
+/**
+* Get a snapshot of the committed part of the log
+*
+* @param    bounds *    - Snapshot of the log bounds
+*
+* @return	None.
+*
+* @note		The snapshot ends at the first entry that is not committed:  its
+*           next address is the commit address or, if the log is full, its
+*           soft end is.  While the first entry that is not committed is
+*           before the soft end of a wrapped log, the snapshot is of a log
+*           that has not wrapped, from the oldest entry to the commit address.
+*
+******************************************************************************/
+void event_log_get_bounds( event_log_bounds * bounds ) {
+
+	interrupt_state_t prev_interrupt_state;
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	bounds->oldest_address = log_oldest_address;
+	bounds->full           = log_full;
+
+	if ( log_full ) {
+		bounds->next_address     = log_next_address;
+		bounds->soft_end_address = log_commit_address;
+	} else {
+		bounds->next_address     = log_commit_address;
+		bounds->soft_end_address = log_soft_end_address;
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+}
+
+
 #ifdef _DEBUG_
 
 /*****************************************************************************/
@@ -1028,6 +1612,10 @@ void print_event_log_size(){
 	timestamp = get_usec_timestamp();
 
 	wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_event_log, "(%10d us) %10d of %10d bytes used\n", (u32)timestamp, size, log_size );
+
+	if ( log_num_failures != 0 ) {
+		wlan_exp_printf(WLAN_EXP_PRINT_WARNING, print_type_event_log, "%d entries could not be allocated\n", log_num_failures );
+	}
 }
 
 
@@ -1045,7 +1633,8 @@ void print_event_log_size(){
 *
 * @return	None.
 *
-* @note		None.
+* @note		The entry must be committed (see event_log_commit_entry());
+*           an entry that is not committed is not sent.
 *
 ******************************************************************************/
 void wn_transmit_log_entry(void * entry){
@@ -1074,6 +1663,15 @@ void wn_transmit_log_entry(void * entry){
 		// We have an entry, so we need to jump back to find the entry header
 		entry_hdr = (entry_header*)((u32)(entry) - entry_hdr_size);
 
+		// Only complete entries are streamed
+		if ( ( entry_hdr->entry_id & 0xFFFF0000 ) != EVENT_LOG_MAGIC_NUMBER ) {
+			wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+			return;
+		}
+
+		// Wait for any central DMA copy in to the entry
+		wlan_mac_high_cdma_finish_transfer();
+
 #ifdef _DEBUG_
         xil_printf(" Entry - addr = 0x%8x;  size = 0x%4x  hdr size = 0x%4x \n", entry_hdr, entry_hdr->entry_length, entry_hdr_size );
 	    print_entry( (0x0000FFFF & entry_hdr->entry_id), entry_hdr->entry_type, entry );
@@ -1152,6 +1750,8 @@ void add_node_info_entry(u8 transmit){
 		print_entry(0, ENTRY_TYPE_NODE_INFO, entry);
 #endif
 
+		event_log_commit_entry((void *)(entry));
+
 		// Transmit the entry if requested
 		if (transmit == WN_TRANSMIT) {
 			wn_transmit_log_entry((void *)(entry));
@@ -1202,6 +1802,8 @@ u32 add_txrx_statistics_to_log(statistics_txrx * stats, u8 transmit){
 		//          equivalent to the statistics structure in wlan_mac_high.h (without the dl_node)
 		memcpy( (void *)(&entry->stats), (void *)(stats), stats_size );
 
+		event_log_commit_entry((void *)(entry));
+
 #ifdef USE_WARPNET_WLAN_EXP
 		// Transmit the entry if requested
 		if (transmit == WN_TRANSMIT) {
@@ -1305,6 +1907,8 @@ u32 add_station_info_to_log(station_info * info, u8 zero_aid, u8 transmit){
 		    entry->info.AID = 0;
 		}
 
+		event_log_commit_entry((void *)(entry));
+
 #ifdef USE_WARPNET_WLAN_EXP
 		// Transmit the entry if requested
 		if (transmit == WN_TRANSMIT) {
@@ -1421,6 +2025,8 @@ u32 add_temperature_to_log(u8 transmit){
 															 entry->curr_temp, entry->min_temp, entry->max_temp);
 #endif
 
+		event_log_commit_entry((void *)(entry));
+
 		// Transmit the entry if requested
 		if (transmit == WN_TRANSMIT) {
 			wn_transmit_log_entry((void *)(entry));
@@ -37,6 +37,7 @@
 #include "wlan_mac_ltg.h"
 #include "wlan_mac_event_log.h"
 #include "wlan_mac_schedule.h"
+#include "wlan_mac_run_queue.h"
 #include "wlan_mac_addr_filter.h"
 #include "wlan_mac_bss_info.h"
 #include "wlan_exp_common.h"
@@ -239,7 +240,7 @@ void wlan_mac_high_init(){
 	}
 
 	//DRAM Check
-	Status = (DRAM_BASE <= TX_QUEUE_BUFFER_BASE) && (TX_QUEUE_BUFFER_HIGH < BSS_INFO_BUFFER_BASE) && (BSS_INFO_BUFFER_HIGH < USER_SCRATCH_BASE) && (USER_SCRATCH_HIGH < EVENT_LOG_BASE) && (EVENT_LOG_HIGH <= DRAM_HIGH);
+	Status = (DRAM_BASE <= TX_QUEUE_BUFFER_BASE) && (TX_QUEUE_BUFFER_HIGH < BSS_INFO_BUFFER_BASE) && (BSS_INFO_BUFFER_HIGH < USER_SCRATCH_BASE) && (USER_SCRATCH_HIGH < LTG_TRACE_BUFFER_BASE) && (LTG_TRACE_BUFFER_HIGH < EVENT_LOG_INDEX_BASE) && (EVENT_LOG_INDEX_HIGH < EVENT_LOG_SKIP_BASE) && (EVENT_LOG_SKIP_HIGH < EVENT_LOG_BASE) && (EVENT_LOG_HIGH <= DRAM_HIGH);
 	if(Status != 1){
 		xil_printf("Error: Overlap detected in DRAM. Check address assignments\n");
 	}
@@ -369,6 +370,8 @@ void wlan_mac_high_init(){
 
 	bss_info_init(dram_present);
 	wlan_eth_init();
+	run_queue_init();
+	run_queue_task_register(RUN_QUEUE_PRIORITY_HIGH, ETH_RX_TASK_BUDGET, (function_ptr_t)wlan_eth_rx_task, 0);
 	wlan_mac_schedule_init();
 	wlan_mac_ltg_sched_init();
 	wlan_mac_addr_filter_init();
@@ -379,6 +382,45 @@ void wlan_mac_high_init(){
 
 
 
+/**
+ * @brief Run the MAC High Framework's main loop work
+ *
+ * This function is called on every pass of wlan_mac_high_main_loop(); an
+ * upper-level MAC that keeps its own main loop must call it on every pass. It
+ * runs the run queue, so that work deferred from interrupt context (scheduler
+ * callbacks, scheduler event pool growth) and registered tasks are serviced.
+ * The framework registers the Ethernet Rx task (wlan_eth_rx_task()) here and,
+ * if WLAN Exp is used, the transport poll task in wlan_exp_node_init(), so the
+ * main loop does not need to call transport_poll() itself.
+ *
+ * @param None
+ * @return None
+ */
+void wlan_mac_high_poll(){
+	run_queue_poll();
+}
+
+
+
+/**
+ * @brief MAC High Framework Main Loop
+ *
+ * The upper-level MAC calls this function at the end of its main(), once it
+ * has finished its initialization and enabled interrupts. It does not return.
+ * Main loop work of the upper-level MAC is registered as run queue tasks
+ * (see run_queue_task_register()).
+ *
+ * @param None
+ * @return None
+ */
+void wlan_mac_high_main_loop(){
+	while(1){
+		wlan_mac_high_poll();
+	}
+}
+
+
+
 /**
  * @brief Initialize MAC High Framework's Interrupts
  *
@@ -931,6 +973,8 @@ void wlan_mac_high_display_mallinfo(){
 	xil_printf("   fordblks:                %d\n", mi.fordblks);
 	xil_printf("   keepcost:                %d\n", mi.keepcost);
 #endif
+
+	wlan_mac_schedule_display_pool_info();
 }
 
 
@@ -1395,6 +1439,31 @@ int wlan_mac_high_right_shift_test(){
 
 
 
+/**
+ * @brief Check Central DMA Address
+ *
+ * The central DMA cannot reach the MicroBlaze DLMB.  Callers that may be given
+ * such addresses use this to memcpy() those transfers themselves rather than
+ * relying on the fallback (and error print) in wlan_mac_high_cdma_start_transfer().
+ *
+ * @param void* addr
+ *  - Address to check
+ * @return int
+ *  - 1 if the central DMA can access addr
+ *  - 0 if addr is in the DLMB
+ */
+int wlan_mac_high_cdma_addr_ok(void* addr){
+	if(((u32)addr - XPAR_MB_HIGH_DLMB_BRAM_CNTLR_0_BASEADDR) <= (XPAR_MB_HIGH_DLMB_BRAM_CNTLR_0_HIGHADDR - XPAR_MB_HIGH_DLMB_BRAM_CNTLR_0_BASEADDR)){
+		return 0;
+	} else if(((u32)addr - XPAR_MB_HIGH_DLMB_BRAM_CNTLR_1_BASEADDR) <= (XPAR_MB_HIGH_DLMB_BRAM_CNTLR_1_HIGHADDR - XPAR_MB_HIGH_DLMB_BRAM_CNTLR_1_BASEADDR)){
+		return 0;
+	}
+
+	return 1;
+}
+
+
+
 /**
  * @brief Start Central DMA Transfer
  *
@@ -1422,21 +1491,9 @@ int wlan_mac_high_cdma_start_transfer(void* dest, void* src, u32 size){
 	//This is a wrapper function around the central DMA simple transfer call. It's arguments
 	//are intended to be similar to memcpy. Note: This function does not block on the transfer.
 	int return_value = XST_SUCCESS;
-	u8 out_of_range  = 0;
 
 
-	if((u32)src > XPAR_MB_HIGH_DLMB_BRAM_CNTLR_0_BASEADDR && (u32)src < XPAR_MB_HIGH_DLMB_BRAM_CNTLR_0_HIGHADDR){
-		out_of_range = 1;
-	} else if((u32)src > XPAR_MB_HIGH_DLMB_BRAM_CNTLR_1_BASEADDR && (u32)src < XPAR_MB_HIGH_DLMB_BRAM_CNTLR_1_HIGHADDR){
-		out_of_range = 1;
-	} else if((u32)dest > XPAR_MB_HIGH_DLMB_BRAM_CNTLR_0_BASEADDR && (u32)dest < XPAR_MB_HIGH_DLMB_BRAM_CNTLR_0_HIGHADDR){
-		out_of_range = 1;
-	} else if((u32)dest > XPAR_MB_HIGH_DLMB_BRAM_CNTLR_1_BASEADDR && (u32)dest < XPAR_MB_HIGH_DLMB_BRAM_CNTLR_1_HIGHADDR){
-		out_of_range = 1;
-	}
-
-
-	if(out_of_range == 0){
+	if(wlan_mac_high_cdma_addr_ok(src) && wlan_mac_high_cdma_addr_ok(dest)){
 		wlan_mac_high_cdma_finish_transfer();
 		return_value = XAxiCdma_SimpleTransfer(&cdma_inst, (u32)src, (u32)dest, size, NULL, NULL);
 
@@ -1492,7 +1549,7 @@ void wlan_mac_high_mpdu_transmit(tx_queue_element* packet, int tx_pkt_buf) {
 
 	tx_mpdu = (tx_frame_info*) TX_PKT_BUF_TO_ADDR(tx_pkt_buf);
 
-	header 	  = (mac_header_80211*)((((tx_queue_buffer*)(packet->data))->frame));
+	header 	  = (mac_header_80211*)((queue_element_buffer(packet)->frame));
 
 	// Insert sequence number here
 	header->sequence_control = ((header->sequence_control) & 0xF) | ( (unique_seq&0xFFF)<<4 );
@@ -1503,8 +1560,8 @@ void wlan_mac_high_mpdu_transmit(tx_queue_element* packet, int tx_pkt_buf) {
 
 
 	dest_addr = (void*)TX_PKT_BUF_TO_ADDR(tx_pkt_buf);
-	src_addr  = (void*) (&(((tx_queue_buffer*)(packet->data))->frame_info));
-	xfer_len  = ((tx_queue_buffer*)(packet->data))->frame_info.length + sizeof(tx_frame_info) + PHY_TX_PKT_BUF_PHY_HDR_SIZE - WLAN_PHY_FCS_NBYTES;
+	src_addr  = (void*) (&(queue_element_buffer(packet)->frame_info));
+	xfer_len  = queue_element_buffer(packet)->frame_info.length + sizeof(tx_frame_info) + PHY_TX_PKT_BUF_PHY_HDR_SIZE - WLAN_PHY_FCS_NBYTES;
 
 	// Transfer the frame info
 	wlan_mac_high_cdma_start_transfer( dest_addr, src_addr, xfer_len);
@@ -1517,12 +1574,12 @@ void wlan_mac_high_mpdu_transmit(tx_queue_element* packet, int tx_pkt_buf) {
 	tx_mpdu->unique_seq = unique_seq;
 	unique_seq++;
 
-	switch(((tx_queue_buffer*)(packet->data))->metadata.metadata_type){
+	switch(queue_element_buffer(packet)->metadata.metadata_type){
 	    case QUEUE_METADATA_TYPE_IGNORE:
 		break;
 
 		case QUEUE_METADATA_TYPE_STATION_INFO:
-			station = (station_info*)(((tx_queue_buffer*)(packet->data))->metadata.metadata_ptr);
+			station = (station_info*)(queue_element_buffer(packet)->metadata.metadata_ptr);
 
 			//
 			// NOTE: this would be a good place to add code to handle the automatic adjustment of transmission properties like rate
@@ -1532,7 +1589,7 @@ void wlan_mac_high_mpdu_transmit(tx_queue_element* packet, int tx_pkt_buf) {
 		break;
 
 		case QUEUE_METADATA_TYPE_TX_PARAMS:
-			memcpy(&(tx_mpdu->params), (void*)(((tx_queue_buffer*)(packet->data))->metadata.metadata_ptr), sizeof(tx_params));
+			memcpy(&(tx_mpdu->params), (void*)(queue_element_buffer(packet)->metadata.metadata_ptr), sizeof(tx_params));
 		break;
 	}
 
@@ -1693,7 +1750,7 @@ void wlan_mac_high_setup_tx_header( mac_header_80211_common * header, u8 * addr_
  */
 void wlan_mac_high_setup_tx_frame_info( mac_header_80211_common * header, tx_queue_element * curr_tx_queue_element, u32 tx_length, u8 flags, u8 QID ) {
 
-	tx_queue_buffer* curr_tx_queue_buffer = ((tx_queue_buffer*)(curr_tx_queue_element->data));
+	tx_queue_buffer* curr_tx_queue_buffer = queue_element_buffer(curr_tx_queue_element);
 
 	bzero(&(curr_tx_queue_buffer->frame_info), sizeof(tx_frame_info));
 
@@ -1772,6 +1829,9 @@ void wlan_mac_high_process_ipc_msg( wlan_ipc_msg* msg ) {
 				//Before calling the user's callback, we'll pass this reception off to the BSS info subsystem so it can scrape for
 				bss_info_rx_process((void*)(RX_PKT_BUF_TO_ADDR(rx_pkt_buf)));
 
+				// Update the receive statistics of LTG flows, so that they do not depend on logging LTG receptions
+				ltg_rx_process((void*)(RX_PKT_BUF_TO_ADDR(rx_pkt_buf)));
+
 				// Call the RX callback function to process the received packet
 				mpdu_rx_callback((void*)(RX_PKT_BUF_TO_ADDR(rx_pkt_buf)));
 
@@ -1798,6 +1858,10 @@ void wlan_mac_high_process_ipc_msg( wlan_ipc_msg* msg ) {
 
 			tx_mpdu = (tx_frame_info*)TX_PKT_BUF_TO_ADDR(msg->arg0);
 			temp_1  = (4*(msg->num_payload_words)) / sizeof(wlan_mac_low_tx_details);
+
+			// Release or re-enqueue the packet's queue entry if it was held for high-level retry
+			queue_tx_done(msg->arg0, tx_mpdu);
+
 			mpdu_tx_done_callback(tx_mpdu, (wlan_mac_low_tx_details*)(msg->payload_ptr), temp_1);
 
 			wlan_mac_high_release_tx_packet_buffer(msg->arg0);
@@ -3032,6 +3096,18 @@ void wlan_mac_high_update_tx_statistics(tx_frame_info* tx_mpdu, station_info* st
 				(frame_stats->tx_num_packets_success)++;
 				(frame_stats->tx_num_bytes_success) += tx_mpdu->length;
 			}
+
+			switch(tx_mpdu->high_retry_status){
+				case TX_HIGH_RETRY_REQUEUED:
+					(frame_stats->tx_num_packets_requeued)++;
+				break;
+
+				case TX_HIGH_RETRY_EXHAUSTED:
+				case TX_HIGH_RETRY_EXPIRED:
+				case TX_HIGH_RETRY_DROPPED:
+					(frame_stats->tx_num_packets_retry_dropped)++;
+				break;
+			}
 		}
 	}
 }
@@ -34,13 +34,33 @@
 
 /*************************** Constant Definitions ****************************/
 
+// Return value of ltg_sched_advance() when a trace has been replayed the requested number of times
+#define LTG_SCHED_ADVANCE_DONE       1
+
+// ln(2) in Q16
+#define LTG_LN2_Q16                  45426
+
 /*********************** Global Variable Definitions *************************/
 
 /*************************** Variable Definitions ****************************/
 
 static dl_list               tg_list;
+static dl_list               tg_wheel[LTG_WHEEL_NUM_SLOTS];
 
 static function_ptr_t        ltg_callback;
+static tg_schedule*          ltg_callback_tg;                  // LTG whose callback is running, if any
+
+static dl_list               ltg_rx_flow_list;
+static dl_list               ltg_rx_flow_table[LTG_RX_FLOW_TABLE_SIZE];
+static u8                    ltg_rx_stats_enabled;
+
+static ltg_trace_record*     ltg_trace_records = (ltg_trace_record*)LTG_TRACE_BUFFER_BASE;
+
+// 2^(2^-(i+1)) in Q30, used by ltg_rand_pareto() to raise 2 to a fractional power
+static const u32             ltg_exp2_frac_q30[16] = { 1518500250, 1276901417, 1170923762, 1121280436,
+                                                       1097253708, 1085434106, 1079572136, 1076653033,
+                                                       1075196443, 1074468888, 1074105294, 1073923544,
+                                                       1073832680, 1073787251, 1073764537, 1073753181 };
 
 volatile static u64          num_ltg_checks;
 volatile static u32          schedule_id;
@@ -49,7 +69,21 @@ volatile static u8           schedule_running;
 
 /*************************** Functions Prototypes ****************************/
 
+static void ltg_wheel_insert(tg_schedule* tg);
+static void ltg_wheel_remove(tg_schedule* tg);
+static int  ltg_sched_advance(tg_schedule* tg);
+static u32  ltg_rand_neg_log2();
+static u32  ltg_rand_exponential(u32 mean);
+static u32  ltg_rand_pareto(u32 mean, u32 shape);
+
+static tg_schedule* ltg_find_tg(u32 ltg_id);
+static void ltg_frame_stamp(void* pkt_buf, tg_schedule* tg);
 
+static ltg_rx_flow* ltg_rx_flow_find(u8* addr_src, u32 ltg_id);
+static u32  ltg_rx_delay_bin(u32 delay);
+static u32  ltg_rx_delay_percentile(ltg_rx_flow* flow, u32 num_delays, u32 permille);
+
+#define ltg_usec_to_checks(x)        (((x) + LTG_POLL_INTERVAL - 1) / LTG_POLL_INTERVAL)
 
 
 /******************************** Functions **********************************/
@@ -57,13 +91,26 @@ volatile static u8           schedule_running;
 int  wlan_mac_ltg_sched_init(){
 
 	int return_value = 0;
+	u32 i;
 
 	schedule_running = 0;
 	schedule_id      = SCHEDULE_FAILURE;
 	num_ltg_checks   = 0;
 	ltg_sched_remove(LTG_REMOVE_ALL);
 	dl_list_init(&tg_list);
-	ltg_callback = (function_ptr_t)nullCallback;
+
+	for(i = 0; i < LTG_WHEEL_NUM_SLOTS; i++){
+		dl_list_init(&(tg_wheel[i]));
+	}
+
+	dl_list_init(&ltg_rx_flow_list);
+
+	for(i = 0; i < LTG_RX_FLOW_TABLE_SIZE; i++){
+		dl_list_init(&(ltg_rx_flow_table[i]));
+	}
+	ltg_rx_stats_enabled = LTG_RX_STATS_ENABLE_DEFAULT;
+	ltg_callback    = (function_ptr_t)nullCallback;
+	ltg_callback_tg = NULL;
 
 	return return_value;
 }
@@ -78,6 +125,8 @@ u32 ltg_sched_create(u32 type, void* params, void* callback_arg, void(*cleanup_c
 
 	static u32 id = 0;
 	u32 return_value;
+	u32 params_size;
+	u32 state_size;
 
 	tg_schedule* curr_tg;
 	dl_entry*	 curr_tg_dl_entry;
@@ -101,36 +150,37 @@ u32 ltg_sched_create(u32 type, void* params, void* callback_arg, void(*cleanup_c
 
 	curr_tg->type = type;
 	curr_tg->cleanup_callback = (function_ptr_t)cleanup_callback;
+	curr_tg->in_wheel = 0;
+	curr_tg->wheel_entry.data = (void*)curr_tg;
+	curr_tg->tx_seq = 0;
+
+	curr_tg->params = NULL;
+	curr_tg->state  = NULL;
 
 	switch(type){
 		case LTG_SCHED_TYPE_PERIODIC:
-			curr_tg->params = wlan_mac_high_malloc(sizeof(ltg_sched_periodic_params));
-			curr_tg->state  = wlan_mac_high_malloc(sizeof(ltg_sched_periodic_state));
-
-			if(curr_tg->params != NULL && curr_tg->state != NULL){
-                bzero(curr_tg->state, sizeof(ltg_sched_periodic_state));
-				memcpy(curr_tg->params, params, sizeof(ltg_sched_periodic_params));
-				curr_tg->callback_arg = callback_arg;
-			} else {
-				xil_printf("LTG: ERROR: Failed to initialize LTG structs\n");
-				ltg_sched_destroy_l(curr_tg_dl_entry);
-				return LTG_ID_INVALID;
-			}
+			params_size = sizeof(ltg_sched_periodic_params);
+			state_size  = sizeof(ltg_sched_periodic_state);
 		break;
 
 		case LTG_SCHED_TYPE_UNIFORM_RAND:
-			curr_tg->params = wlan_mac_high_malloc(sizeof(ltg_sched_uniform_rand_params));
-			curr_tg->state  = wlan_mac_high_malloc(sizeof(ltg_sched_uniform_rand_state));
+			params_size = sizeof(ltg_sched_uniform_rand_params);
+			state_size  = sizeof(ltg_sched_uniform_rand_state);
+		break;
 
-			if(curr_tg->params != NULL && curr_tg->state != NULL){
-                bzero(curr_tg->state, sizeof(ltg_sched_uniform_rand_state));
-				memcpy(curr_tg->params, params, sizeof(ltg_sched_uniform_rand_params));
-				curr_tg->callback_arg = callback_arg;
-			} else {
-				xil_printf("LTG: ERROR: Failed to initialize LTG structs\n");
-				ltg_sched_destroy_l(curr_tg_dl_entry);
-				return LTG_ID_INVALID;
-			}
+		case LTG_SCHED_TYPE_POISSON:
+			params_size = sizeof(ltg_sched_poisson_params);
+			state_size  = sizeof(ltg_sched_poisson_state);
+		break;
+
+		case LTG_SCHED_TYPE_PARETO_ON_OFF:
+			params_size = sizeof(ltg_sched_pareto_on_off_params);
+			state_size  = sizeof(ltg_sched_pareto_on_off_state);
+		break;
+
+		case LTG_SCHED_TYPE_TRACE:
+			params_size = sizeof(ltg_sched_trace_params);
+			state_size  = sizeof(ltg_sched_trace_state);
 		break;
 
 		default:
@@ -140,6 +190,19 @@ u32 ltg_sched_create(u32 type, void* params, void* callback_arg, void(*cleanup_c
 		break;
 	}
 
+	curr_tg->params = wlan_mac_high_malloc(params_size);
+	curr_tg->state  = wlan_mac_high_malloc(state_size);
+
+	if(curr_tg->params != NULL && curr_tg->state != NULL){
+		bzero(curr_tg->state, state_size);
+		memcpy(curr_tg->params, params, params_size);
+		curr_tg->callback_arg = callback_arg;
+	} else {
+		xil_printf("LTG: ERROR: Failed to initialize LTG structs\n");
+		ltg_sched_destroy_l(curr_tg_dl_entry);
+		return LTG_ID_INVALID;
+	}
+
 	dl_entry_insertEnd(&tg_list,curr_tg_dl_entry);
 
 	return return_value;
@@ -221,35 +284,38 @@ int ltg_sched_start_all(){
 int ltg_sched_start_l(dl_entry* curr_tg_dl_entry){
 	tg_schedule* curr_tg = (tg_schedule*)(curr_tg_dl_entry->data);
 	u64 timestamp        = get_usec_timestamp();
-	u64 random_timestamp;
+	u64 duration;
+	ltg_sched_pareto_on_off_params* pareto_params;
+	ltg_sched_trace_params*         trace_params = NULL;
+	interrupt_state_t prev_interrupt_state;
 
 	switch(curr_tg->type){
 		case LTG_SCHED_TYPE_PERIODIC:
+			duration = ((ltg_sched_periodic_params*)(curr_tg->params))->duration_usec;
+		break;
 
-			curr_tg->target = num_ltg_checks + (((ltg_sched_periodic_params*)(curr_tg->params))->interval_count);
+		case LTG_SCHED_TYPE_UNIFORM_RAND:
+			duration = ((ltg_sched_uniform_rand_params*)(curr_tg->params))->duration_usec;
+		break;
 
-			if(((ltg_sched_periodic_params*)(curr_tg->params))->duration_count != LTG_DURATION_FOREVER){
-				curr_tg->stop_target = num_ltg_checks + ((ltg_sched_periodic_params*)(curr_tg->params))->duration_count;
-			} else {
-				curr_tg->stop_target = LTG_DURATION_FOREVER;
-			}
+		case LTG_SCHED_TYPE_POISSON:
+			duration = ((ltg_sched_poisson_params*)(curr_tg->params))->duration_usec;
+		break;
 
-			((ltg_sched_state_hdr*)(curr_tg->state))->start_timestamp = timestamp;
-			((ltg_sched_state_hdr*)(curr_tg->state))->enabled = 1;
+		case LTG_SCHED_TYPE_PARETO_ON_OFF:
+			duration = ((ltg_sched_pareto_on_off_params*)(curr_tg->params))->duration_usec;
 		break;
 
-		case LTG_SCHED_TYPE_UNIFORM_RAND:
-			random_timestamp = (rand()%(((ltg_sched_uniform_rand_params*)(curr_tg->params))->max_interval_count - ((ltg_sched_uniform_rand_params*)(curr_tg->params))->min_interval_count))+((ltg_sched_uniform_rand_params*)(curr_tg->params))->min_interval_count;
-			curr_tg->target = num_ltg_checks + (random_timestamp/FAST_TIMER_DUR_US);
+		case LTG_SCHED_TYPE_TRACE:
+			trace_params = (ltg_sched_trace_params*)(curr_tg->params);
+			duration     = trace_params->duration_usec;
 
-			if(((ltg_sched_uniform_rand_params*)(curr_tg->params))->duration_count != LTG_DURATION_FOREVER){
-				curr_tg->stop_target = num_ltg_checks + ((ltg_sched_periodic_params*)(curr_tg->params))->duration_count;
-			} else {
-				curr_tg->stop_target = LTG_DURATION_FOREVER;
+			if((trace_params->num_records == 0) || (trace_params->start_index >= LTG_TRACE_MAX_NUM_RECORDS) ||
+			   (trace_params->num_records > (LTG_TRACE_MAX_NUM_RECORDS - trace_params->start_index))){
+				xil_printf("LTG: ERROR: Trace records [%d, %d) are outside of the trace buffer\n",
+				           trace_params->start_index, trace_params->start_index + trace_params->num_records);
+				return -1;
 			}
-
-			((ltg_sched_state_hdr*)(curr_tg->state))->start_timestamp = timestamp;
-			((ltg_sched_state_hdr*)(curr_tg->state))->enabled = 1;
 		break;
 
 		default:
@@ -260,12 +326,57 @@ int ltg_sched_start_l(dl_entry* curr_tg_dl_entry){
 		break;
 	}
 
+	// The wheel is also modified by ltg_sched_check() in the fine scheduler
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	ltg_wheel_remove(curr_tg);
+
+	curr_tg->target_usec = num_ltg_checks * LTG_POLL_INTERVAL;
+
+	switch(curr_tg->type){
+		case LTG_SCHED_TYPE_TRACE:
+			// The first event is the first record; ltg_sched_advance() moves past it when it fires
+			((ltg_sched_trace_state*)(curr_tg->state))->index     = 0;
+			((ltg_sched_trace_state*)(curr_tg->state))->num_loops = 0;
+
+			curr_tg->target_usec += max(ltg_trace_records[trace_params->start_index].delta_usec, 1);
+			curr_tg->target       = ltg_usec_to_checks(curr_tg->target_usec);
+		break;
+
+		case LTG_SCHED_TYPE_PARETO_ON_OFF:
+			// Start in an on period
+			pareto_params = (ltg_sched_pareto_on_off_params*)(curr_tg->params);
+
+			((ltg_sched_pareto_on_off_state*)(curr_tg->state))->on_end_usec =
+					curr_tg->target_usec + ltg_rand_pareto(pareto_params->mean_on_usec, pareto_params->shape);
+
+			ltg_sched_advance(curr_tg);
+		break;
+
+		default:
+			ltg_sched_advance(curr_tg);
+		break;
+	}
+
+	if(duration != LTG_DURATION_FOREVER){
+		curr_tg->stop_target = num_ltg_checks + ltg_usec_to_checks(duration);
+	} else {
+		curr_tg->stop_target = LTG_DURATION_FOREVER;
+	}
+
+	((ltg_sched_state_hdr*)(curr_tg->state))->start_timestamp = timestamp;
+	((ltg_sched_state_hdr*)(curr_tg->state))->enabled = 1;
+
+	ltg_wheel_insert(curr_tg);
+
 	if(schedule_running == 0){
 		schedule_running = 1;
 
 		schedule_id = wlan_mac_schedule_event_repeated(SCHEDULE_FINE, 0, SCHEDULE_REPEAT_FOREVER, (void*)ltg_sched_check);
 	}
 
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
 	//u64 start_time = ((ltg_sched_state_hdr*)(curr_tg->state))->start_timestamp;
 	//xil_printf("LTG Start @ 0x%08x 0x%08x\n", (u32)(start_time >> 32), (u32)start_time );
 
@@ -276,47 +387,326 @@ int ltg_sched_start_l(dl_entry* curr_tg_dl_entry){
 void ltg_sched_check(){
 	tg_schedule* curr_tg;
 	dl_entry*	 curr_tg_dl_entry;
-	u64 		 random_timestamp;
+	dl_entry*	 next_tg_dl_entry;
+	dl_list*     slot;
+	u64          check_usec;
+	u32          num_events;
+	int          status;
 
 	num_ltg_checks++;
-	if(tg_list.length > 0){
+	check_usec = num_ltg_checks * LTG_POLL_INTERVAL;
 
-		curr_tg_dl_entry = tg_list.first;
+	slot = &(tg_wheel[num_ltg_checks & (LTG_WHEEL_NUM_SLOTS - 1)]);
 
-		while(curr_tg_dl_entry != NULL){
-			curr_tg = (tg_schedule*)(curr_tg_dl_entry->data);
+	// LTGs are moved to other slots or stopped as they are visited
+	next_tg_dl_entry = slot->first;
 
-			if(((ltg_sched_state_hdr*)(curr_tg->state))->enabled){
-
-				if( num_ltg_checks >= ( curr_tg->target ) ){
-					switch(curr_tg->type){
-						case LTG_SCHED_TYPE_PERIODIC:
-							curr_tg->target = num_ltg_checks + (((ltg_sched_periodic_params*)(curr_tg->params))->interval_count);
-						break;
-						case LTG_SCHED_TYPE_UNIFORM_RAND:
-							random_timestamp = (rand()%(((ltg_sched_uniform_rand_params*)(curr_tg->params))->max_interval_count - ((ltg_sched_uniform_rand_params*)(curr_tg->params))->min_interval_count))+((ltg_sched_uniform_rand_params*)(curr_tg->params))->min_interval_count;
-							curr_tg->target = num_ltg_checks + (random_timestamp/FAST_TIMER_DUR_US);
-						break;
-						default:
-							ltg_sched_stop_l(curr_tg_dl_entry);
-							return;
-						break;
-					}
-					ltg_callback(curr_tg->id, curr_tg->callback_arg);
-				}
+	while(next_tg_dl_entry != NULL){
+		curr_tg_dl_entry = next_tg_dl_entry;
+		next_tg_dl_entry = dl_entry_next(curr_tg_dl_entry);
 
-				if( curr_tg->stop_target != LTG_DURATION_FOREVER && num_ltg_checks >= ( curr_tg->stop_target )){
-					ltg_sched_stop_l(curr_tg_dl_entry);
-				}
+		curr_tg = (tg_schedule*)(curr_tg_dl_entry->data);
+
+		if(((ltg_sched_state_hdr*)(curr_tg->state))->enabled == 0){
+			// Stopped LTGs are never fired
+			ltg_wheel_remove(curr_tg);
+			continue;
+		}
+
+		if(num_ltg_checks < curr_tg->wheel_target){
+			// Due in a later revolution of the wheel
+			continue;
+		}
+
+		ltg_wheel_remove(curr_tg);
+
+		num_events = 0;
+
+		while((curr_tg->target_usec <= check_usec) && (num_events < LTG_MAX_EVENTS_PER_CHECK)){
+			if(((ltg_sched_state_hdr*)(curr_tg->state))->enabled == 0){
+				// Stopped by an earlier callback
+				break;
+			}
+
+			status = ltg_sched_advance(curr_tg);
 
+			if(status == -1){
+				ltg_sched_stop_l(&(curr_tg->wheel_entry));
+				break;
 			}
 
-			curr_tg_dl_entry = dl_entry_next(curr_tg_dl_entry);
+			ltg_callback_tg = curr_tg;
+			ltg_callback(curr_tg->id, curr_tg->callback_arg);
+			ltg_callback_tg = NULL;
+			num_events++;
+
+			if(status == LTG_SCHED_ADVANCE_DONE){
+				ltg_sched_stop_l(&(curr_tg->wheel_entry));
+				break;
+			}
+		}
+
+		if(num_events != 0){
+			// The callbacks may have started or stopped other LTGs in this slot, so the
+			// saved next entry can no longer be trusted. Entries already visited have
+			// left the slot or are due in a later revolution, so the slot is rescanned
+			// from its head.
+			next_tg_dl_entry = slot->first;
+		}
+
+		if(((ltg_sched_state_hdr*)(curr_tg->state))->enabled == 0){
+			continue;
+		}
+
+		if( curr_tg->stop_target != LTG_DURATION_FOREVER && num_ltg_checks >= ( curr_tg->stop_target )){
+			ltg_sched_stop_l(&(curr_tg->wheel_entry));
+		} else {
+			ltg_wheel_insert(curr_tg);
 		}
 	}
 }
 
 
+/*****************************************************************************/
+/**
+* Advances an LTG to its next event
+*
+* The next event time is kept in microseconds so that intervals which are not a
+* multiple of LTG_POLL_INTERVAL keep their long-run rate.
+*
+* For trace schedules, the record of the event being fired is copied into the
+* LTG state so that the LTG callback can use its length and destination.
+*
+* @param    tg               - LTG schedule
+* @return   int              - 0 on success
+*                            - LTG_SCHED_ADVANCE_DONE if this is the last event of a trace
+*                            - -1 if the LTG type is unknown
+*/
+static int ltg_sched_advance(tg_schedule* tg){
+	u64 interval;
+	u32 min_interval;
+	u32 max_interval;
+	ltg_sched_pareto_on_off_params* pareto_params;
+	ltg_sched_pareto_on_off_state*  pareto_state;
+	ltg_sched_trace_params*         trace_params;
+	ltg_sched_trace_state*          trace_state;
+	ltg_trace_record*               record;
+
+	switch(tg->type){
+		case LTG_SCHED_TYPE_PERIODIC:
+			interval = ((ltg_sched_periodic_params*)(tg->params))->interval_usec;
+		break;
+
+		case LTG_SCHED_TYPE_UNIFORM_RAND:
+			min_interval = ((ltg_sched_uniform_rand_params*)(tg->params))->min_interval_usec;
+			max_interval = ((ltg_sched_uniform_rand_params*)(tg->params))->max_interval_usec;
+
+			if(max_interval > min_interval){
+				interval = (rand() % (max_interval - min_interval)) + min_interval;
+			} else {
+				interval = min_interval;
+			}
+		break;
+
+		case LTG_SCHED_TYPE_POISSON:
+			interval = ltg_rand_exponential(((ltg_sched_poisson_params*)(tg->params))->mean_interval_usec);
+		break;
+
+		case LTG_SCHED_TYPE_PARETO_ON_OFF:
+			pareto_params = (ltg_sched_pareto_on_off_params*)(tg->params);
+			pareto_state  = (ltg_sched_pareto_on_off_state*)(tg->state);
+
+			interval = max(pareto_params->interval_usec, 1);
+
+			if((tg->target_usec + interval) >= pareto_state->on_end_usec){
+				// The on period has ended; the next event starts the next on period
+				interval = (pareto_state->on_end_usec - min(tg->target_usec, pareto_state->on_end_usec)) +
+				           ltg_rand_pareto(pareto_params->mean_off_usec, pareto_params->shape);
+
+				pareto_state->on_end_usec = tg->target_usec + interval +
+				                            ltg_rand_pareto(pareto_params->mean_on_usec, pareto_params->shape);
+				pareto_state->num_bursts++;
+			}
+		break;
+
+		case LTG_SCHED_TYPE_TRACE:
+			trace_params = (ltg_sched_trace_params*)(tg->params);
+			trace_state  = (ltg_sched_trace_state*)(tg->state);
+
+			record = &(ltg_trace_records[trace_params->start_index + trace_state->index]);
+
+			trace_state->length = record->length;
+			memcpy(trace_state->addr_da, record->addr_da, 6);
+
+			trace_state->index++;
+
+			if(trace_state->index >= trace_params->num_records){
+				trace_state->index = 0;
+				trace_state->num_loops++;
+
+				if((trace_params->num_loops != LTG_TRACE_LOOP_FOREVER) && (trace_state->num_loops >= trace_params->num_loops)){
+					return LTG_SCHED_ADVANCE_DONE;
+				}
+			}
+
+			interval = ltg_trace_records[trace_params->start_index + trace_state->index].delta_usec;
+		break;
+
+		default:
+			return -1;
+		break;
+	}
+
+	// A zero interval would never let the LTG catch up with the current check
+	tg->target_usec += max(interval, 1);
+	tg->target       = ltg_usec_to_checks(tg->target_usec);
+
+	return 0;
+}
+
+
+/*****************************************************************************/
+/**
+* Returns -log2(U) in Q16 for U uniformly distributed in (0, 1]
+*
+* The logarithm is computed one fractional bit at a time by repeated squaring
+* of the mantissa, so the LTG does not need floating point.
+*
+* @param    None
+* @return   u32              - -log2(U) in Q16, between 0 and 31.0
+*/
+static u32 ltg_rand_neg_log2(){
+	u32 x;
+	u32 n;
+	u32 frac;
+	u32 i;
+	u64 y;
+
+	// x / 2^31 is uniform in (0, 1]
+	x = (rand() & 0x7FFFFFFF) + 1;
+
+	// Integer part of log2(x)
+	n = 0;
+	while((x >> n) > 1){
+		n++;
+	}
+
+	// Mantissa x / 2^n in Q30, between 1.0 and 2.0
+	y    = (((u64)x) << 30) >> n;
+	frac = 0;
+
+	for(i = 0; i < 16; i++){
+		y = (y * y) >> 30;
+
+		if(y >= (2ULL << 30)){
+			y     >>= 1;
+			frac   |= (1 << (15 - i));
+		}
+	}
+
+	return (31 << 16) - ((n << 16) | frac);
+}
+
+
+/*****************************************************************************/
+/**
+* Returns an exponentially distributed interval
+*
+* @param    mean             - Mean of the distribution
+* @return   u32              - Random interval (saturates at 0xFFFFFFFF)
+*/
+static u32 ltg_rand_exponential(u32 mean){
+	u64 neg_ln_q16 = (((u64)ltg_rand_neg_log2()) * LTG_LN2_Q16) >> 16;
+
+	return (u32)min(((u64)mean * neg_ln_q16) >> 16, 0xFFFFFFFFULL);
+}
+
+
+/*****************************************************************************/
+/**
+* Returns a Pareto distributed interval
+*
+* The interval is x_m * U^(-1/a) = x_m * 2^(-log2(U) / a), where the scale x_m is
+* chosen to give the requested mean: mean * (a - 1) / a.
+*
+* @param    mean             - Mean of the distribution
+* @param    shape            - Shape (a) of the distribution in 1/100 units, greater than 100
+* @return   u32              - Random interval (saturates at 0xFFFFFFFF)
+*/
+static u32 ltg_rand_pareto(u32 mean, u32 shape){
+	u64 scale;
+	u64 value;
+	u32 exponent;
+	u32 fraction;
+	u32 i;
+
+	if(shape <= 100){
+		return mean;
+	}
+
+	scale    = ((u64)mean * (shape - 100)) / shape;
+	exponent = (u32)((((u64)ltg_rand_neg_log2()) * 100) / shape);
+
+	// Fractional part of the power of 2
+	fraction = exponent & 0xFFFF;
+	value    = 1 << 30;
+
+	for(i = 0; i < 16; i++){
+		if(fraction & (1 << (15 - i))){
+			value = (value * ltg_exp2_frac_q30[i]) >> 30;
+		}
+	}
+
+	value = (scale * value) >> 30;
+
+	// Integer part of the power of 2
+	exponent >>= 16;
+
+	if((exponent >= 32) || ((value >> (32 - exponent)) != 0)){
+		return 0xFFFFFFFF;
+	}
+
+	return (u32)(value << exponent);
+}
+
+
+/*****************************************************************************/
+/**
+* Adds a running LTG to the slot of the next check at which it must be visited
+*
+* @param    tg               - LTG schedule
+* @return   None
+*/
+static void ltg_wheel_insert(tg_schedule* tg){
+	u64 wheel_target = tg->target;
+
+	if((tg->stop_target != LTG_DURATION_FOREVER) && (tg->stop_target < wheel_target)){
+		wheel_target = tg->stop_target;
+	}
+
+	// Never insert into the slot being (or already) checked
+	tg->wheel_target = max(wheel_target, num_ltg_checks + 1);
+
+	dl_entry_insertEnd(&(tg_wheel[tg->wheel_target & (LTG_WHEEL_NUM_SLOTS - 1)]), &(tg->wheel_entry));
+	tg->in_wheel = 1;
+}
+
+
+/*****************************************************************************/
+/**
+* Removes an LTG from the timing wheel
+*
+* @param    tg               - LTG schedule
+* @return   None
+*/
+static void ltg_wheel_remove(tg_schedule* tg){
+	if(tg->in_wheel){
+		dl_entry_remove(&(tg_wheel[tg->wheel_target & (LTG_WHEEL_NUM_SLOTS - 1)]), &(tg->wheel_entry));
+		tg->in_wheel = 0;
+	}
+}
+
+
 int ltg_sched_stop(u32 id){
 	dl_entry*	 curr_tg_dl_entry;
 
@@ -359,20 +749,27 @@ int ltg_sched_stop_all(){
 
 int ltg_sched_stop_l(dl_entry* curr_tg_dl_entry){
 	tg_schedule* curr_tg = (tg_schedule*)(curr_tg_dl_entry->data);
+	interrupt_state_t prev_interrupt_state;
 
 	u64 timestamp = get_usec_timestamp();
 
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
 	if ( ((ltg_sched_state_hdr*)(curr_tg->state))->enabled == 1 ) {
 		((ltg_sched_state_hdr*)(curr_tg->state))->enabled = 0;
 		((ltg_sched_state_hdr*)(curr_tg->state))->stop_timestamp = timestamp;
 		//xil_printf("LTG Stop  @ 0x%08x 0x%08x\n", (u32)(timestamp >> 32), (u32)timestamp );
 	}
 
+	ltg_wheel_remove(curr_tg);
+
 	if(tg_list.length == 0 && schedule_running == 1){
 		wlan_mac_remove_schedule(SCHEDULE_FINE, schedule_id);
 		schedule_running = 0;
 	}
 
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
 	return 0;
 }
 
@@ -411,6 +808,30 @@ int ltg_sched_get_state(u32 id, u32* type, void** state){
 			}
 		break;
 
+		case LTG_SCHED_TYPE_POISSON:
+			if(num_ltg_checks < (curr_tg->target) ){
+				((ltg_sched_poisson_state*)(curr_tg->state))->time_to_next_count = (u32)(curr_tg->target - num_ltg_checks);
+			} else {
+				((ltg_sched_poisson_state*)(curr_tg->state))->time_to_next_count = 0;
+			}
+		break;
+
+		case LTG_SCHED_TYPE_PARETO_ON_OFF:
+			if(num_ltg_checks < (curr_tg->target) ){
+				((ltg_sched_pareto_on_off_state*)(curr_tg->state))->time_to_next_count = (u32)(curr_tg->target - num_ltg_checks);
+			} else {
+				((ltg_sched_pareto_on_off_state*)(curr_tg->state))->time_to_next_count = 0;
+			}
+		break;
+
+		case LTG_SCHED_TYPE_TRACE:
+			if(num_ltg_checks < (curr_tg->target) ){
+				((ltg_sched_trace_state*)(curr_tg->state))->time_to_next_count = (u32)(curr_tg->target - num_ltg_checks);
+			} else {
+				((ltg_sched_trace_state*)(curr_tg->state))->time_to_next_count = 0;
+			}
+		break;
+
 		default:
 			xil_printf("LTG: ERROR: Unknown type %d\n", curr_tg->type);
 			return -1;
@@ -522,8 +943,11 @@ void ltg_sched_destroy_params(tg_schedule *tg){
 	switch(tg->type){
 		case LTG_SCHED_TYPE_PERIODIC:
 		case LTG_SCHED_TYPE_UNIFORM_RAND:
-			wlan_mac_high_free(tg->params);
-			wlan_mac_high_free(tg->state);
+		case LTG_SCHED_TYPE_POISSON:
+		case LTG_SCHED_TYPE_PARETO_ON_OFF:
+		case LTG_SCHED_TYPE_TRACE:
+			if(tg->params != NULL){ wlan_mac_high_free(tg->params); }
+			if(tg->state != NULL){ wlan_mac_high_free(tg->state); }
 		break;
 	}
 }
@@ -579,6 +1003,10 @@ int wlan_create_ltg_frame(void* pkt_buf, mac_header_80211_common* common, u8 tx_
 
 	pkt_id->unique_seq     = 0; //make sure this is filled in via the dequeue callback
 	pkt_id->ltg_id         = ltg_id;
+	pkt_id->magic          = LTG_PACKET_ID_MAGIC;
+	pkt_id->ltg_seq        = 0;
+
+	ltg_frame_stamp(pkt_buf, ltg_find_tg(ltg_id));
 
 	// LTG packets always have LLC header, LTG payload id, plus any extra payload requested by user
 	tx_length += ((sizeof(ltg_packet_id)));
@@ -587,10 +1015,406 @@ int wlan_create_ltg_frame(void* pkt_buf, mac_header_80211_common* common, u8 tx_
 }
 
 
+/*****************************************************************************/
+/**
+* Finds the LTG with the given ID
+*
+* @param    ltg_id           - LTG ID
+* @return   tg_schedule*     - LTG schedule, or NULL if the LTG does not exist
+*/
+static tg_schedule* ltg_find_tg(u32 ltg_id){
+	dl_entry* tg_dl_entry;
+
+	// Frames are normally created from the LTG callback, so do not search tg_list for its LTG
+	if((ltg_callback_tg != NULL) && (ltg_callback_tg->id == ltg_id)){
+		return ltg_callback_tg;
+	}
+
+	tg_dl_entry = ltg_sched_find_tg_schedule(ltg_id);
+
+	if(tg_dl_entry == NULL){
+		return NULL;
+	}
+
+	return (tg_schedule*)(tg_dl_entry->data);
+}
+
+
+/*****************************************************************************/
+/**
+* Fills in the fields of an LTG frame that change with every frame
+*
+* @param    pkt_buf          - Frame
+* @param    tg               - LTG schedule of the frame, or NULL if the LTG does not exist
+* @return   None
+*/
+static void ltg_frame_stamp(void* pkt_buf, tg_schedule* tg){
+	ltg_packet_id*    pkt_id = (ltg_packet_id*)((u8*)pkt_buf + sizeof(mac_header_80211));
+
+	if(tg != NULL){
+		pkt_id->ltg_seq = tg->tx_seq;
+		tg->tx_seq++;
+	}
+
+	pkt_id->timestamp = get_usec_timestamp();
+}
+
+
+/*****************************************************************************/
+/**
+* Writes records into the LTG trace buffer
+*
+* @param    index            - Index of the first record to write
+* @param    num_records      - Number of records to write
+* @param    records          - Records to write
+* @return   int              - 0 on success, -1 if the records do not fit in the trace buffer
+*
+* @note     Records used by a running trace are replayed as they are overwritten
+*/
+int ltg_trace_write(u32 index, u32 num_records, ltg_trace_record* records){
+
+	if((index >= LTG_TRACE_MAX_NUM_RECORDS) || (num_records > (LTG_TRACE_MAX_NUM_RECORDS - index))){
+		return -1;
+	}
+
+	memcpy(&(ltg_trace_records[index]), records, num_records * sizeof(ltg_trace_record));
+
+	return 0;
+}
+
+
+/*****************************************************************************/
+/**
+* Updates the receive statistics of the flow of a received LTG frame
+*
+* Receptions that are not LTG frames, or are LTG frames without ltg_seq and
+* timestamp (see LTG_PACKET_ID_MAGIC), are ignored.
+*
+* @param    pkt_buf_addr     - Rx packet buffer (rx_frame_info followed by the MPDU)
+* @return   None
+*
+* @note     Frames are timed when this is called, so the one-way delay includes
+*           the time taken to pass the frame from CPU Low.
+*/
+void ltg_rx_process(void* pkt_buf_addr){
+	rx_frame_info*      mpdu_info       = (rx_frame_info*)pkt_buf_addr;
+	u8*                 mpdu_ptr_u8     = (u8*)pkt_buf_addr + PHY_RX_PKT_BUF_MPDU_OFFSET;
+	mac_header_80211*   rx_80211_header = (mac_header_80211*)((void *)mpdu_ptr_u8);
+	u16                 length          = mpdu_info->phy_details.length;
+	ltg_packet_id*      pkt_id;
+	ltg_rx_flow*        flow;
+	u64                 timestamp;
+	s64                 transit;
+	u32                 delay;
+	u32                 seq_diff;
+	u32                 transit_diff;
+
+	if((ltg_rx_stats_enabled == 0) || (mpdu_info->state != RX_MPDU_STATE_FCS_GOOD)){
+		return;
+	}
+
+	// Frames from LTGs without ltg_seq and timestamp are too short
+	if((length < (sizeof(mac_header_80211) + sizeof(ltg_packet_id) + WLAN_PHY_FCS_NBYTES)) ||
+	   (wlan_mac_high_pkt_type(mpdu_ptr_u8, length) != PKT_TYPE_DATA_ENCAP_LTG)){
+		return;
+	}
+
+	timestamp = get_usec_timestamp();
+	pkt_id    = (ltg_packet_id*)(mpdu_ptr_u8 + sizeof(mac_header_80211));
+
+	// Frames from older nodes carry user payload where ltg_seq and timestamp would be
+	if(pkt_id->magic != LTG_PACKET_ID_MAGIC){
+		return;
+	}
+
+	flow = ltg_rx_flow_find(rx_80211_header->address_2, pkt_id->ltg_id);
+
+	if(flow == NULL){
+		return;
+	}
+
+	flow->stats.num_rx++;
+
+	// Sequence
+	if(flow->stats.num_rx == 1){
+		flow->seq_max    = pkt_id->ltg_seq;
+		flow->seq_window = 1;
+
+	} else if(pkt_id->ltg_seq > flow->seq_max){
+		seq_diff = pkt_id->ltg_seq - flow->seq_max;
+
+		flow->stats.num_lost += seq_diff - 1;
+		flow->seq_window      = (seq_diff < LTG_RX_SEQ_WINDOW) ? ((flow->seq_window << seq_diff) | 1) : 1;
+		flow->seq_max         = pkt_id->ltg_seq;
+
+	} else {
+		seq_diff = flow->seq_max - pkt_id->ltg_seq;
+
+		if(seq_diff >= LTG_RX_SEQ_WINDOW){
+			// Too old to tell whether it is a duplicate
+			flow->stats.num_reorder++;
+
+		} else if(flow->seq_window & (1ULL << seq_diff)){
+			// Duplicates are retransmissions, so they are not used for delay or jitter
+			flow->stats.num_dup++;
+			return;
+
+		} else {
+			flow->seq_window |= (1ULL << seq_diff);
+			flow->stats.num_reorder++;
+			if(flow->stats.num_lost > 0){
+				flow->stats.num_lost--;
+			}
+		}
+	}
+
+	// One-way delay
+	transit = (s64)timestamp - (s64)(pkt_id->timestamp);
+
+	if(transit < 0){
+		flow->stats.num_delay_negative++;
+		delay = 0;
+	} else {
+		delay = (u32)min(transit, 0xFFFFFFFFLL);
+	}
+
+	if((flow->stats.num_rx - flow->stats.num_dup) == 1){
+		flow->stats.delay_min = delay;
+	} else {
+		// Interarrival jitter: J += (|D| - J) / 16
+		transit_diff = (u32)min((transit > flow->transit_last) ? (transit - flow->transit_last) : (flow->transit_last - transit), 0x0FFFFFFFLL);
+
+		flow->jitter_q4 = flow->jitter_q4 + transit_diff - ((flow->jitter_q4 + 8) >> 4);
+	}
+
+	flow->transit_last     = transit;
+	flow->delay_total     += delay;
+	flow->stats.delay_min  = min(flow->stats.delay_min, delay);
+	flow->stats.delay_max  = max(flow->stats.delay_max, delay);
+
+	flow->delay_hist[ltg_rx_delay_bin(delay)]++;
+}
+
+
+/*****************************************************************************/
+/**
+* Finds the flow of an LTG frame, creating it if it does not exist
+*
+* @param    addr_src         - Address of the source of the frame
+* @param    ltg_id           - LTG ID of the frame
+* @return   ltg_rx_flow*     - Flow, or NULL if there is no room for a new flow
+*/
+static ltg_rx_flow* ltg_rx_flow_find(u8* addr_src, u32 ltg_id){
+	dl_list*     bucket;
+	dl_entry*    curr_dl_entry;
+	ltg_rx_flow* flow;
+
+	bucket = &(ltg_rx_flow_table[(((addr_src[4] << 8) | addr_src[5]) + (ltg_id * 31)) & (LTG_RX_FLOW_TABLE_SIZE - 1)]);
+
+	curr_dl_entry = bucket->first;
+
+	while(curr_dl_entry != NULL){
+		flow = (ltg_rx_flow*)(curr_dl_entry->data);
+
+		if((flow->ltg_id == ltg_id) && wlan_addr_eq(flow->addr_src, addr_src)){
+			return flow;
+		}
+		curr_dl_entry = dl_entry_next(curr_dl_entry);
+	}
+
+	if(ltg_rx_flow_list.length >= LTG_RX_MAX_NUM_FLOWS){
+		return NULL;
+	}
+
+	flow = (ltg_rx_flow*)wlan_mac_high_malloc(sizeof(ltg_rx_flow));
+
+	if(flow == NULL){
+		return NULL;
+	}
+
+	bzero(flow, sizeof(ltg_rx_flow));
+
+	memcpy(flow->addr_src, addr_src, 6);
+	flow->ltg_id            = ltg_id;
+	flow->entry.data        = (void*)flow;
+	flow->bucket_entry.data = (void*)flow;
+
+	dl_entry_insertEnd(&ltg_rx_flow_list, &(flow->entry));
+	dl_entry_insertEnd(bucket, &(flow->bucket_entry));
+
+	return flow;
+}
+
+
+/*****************************************************************************/
+/**
+* Returns the delay histogram bin of a one-way delay
+*
+* Delays below 2^LTG_RX_DELAY_SUB_BINS_LOG2 usec have a bin each. Above that,
+* each power of 2 is split into 2^LTG_RX_DELAY_SUB_BINS_LOG2 bins.
+*
+* @param    delay            - One-way delay (usec)
+* @return   u32              - Bin
+*/
+static u32 ltg_rx_delay_bin(u32 delay){
+	u32 exponent;
+	u32 bin;
+
+	if(delay < (1 << LTG_RX_DELAY_SUB_BINS_LOG2)){
+		return delay;
+	}
+
+	exponent = LTG_RX_DELAY_SUB_BINS_LOG2;
+	while((delay >> (exponent + 1)) != 0){
+		exponent++;
+	}
+
+	bin = ((exponent - LTG_RX_DELAY_SUB_BINS_LOG2 + 1) << LTG_RX_DELAY_SUB_BINS_LOG2) +
+	      ((delay >> (exponent - LTG_RX_DELAY_SUB_BINS_LOG2)) & ((1 << LTG_RX_DELAY_SUB_BINS_LOG2) - 1));
+
+	return min(bin, LTG_RX_DELAY_NUM_BINS - 1);
+}
+
+
+/*****************************************************************************/
+/**
+* Returns a percentile of the one-way delays of a flow
+*
+* @param    flow             - Flow
+* @param    num_delays       - Number of delays in the histogram of the flow
+* @param    permille         - Percentile in 1/1000 units
+* @return   u32              - Middle of the histogram bin holding the percentile (usec)
+*/
+static u32 ltg_rx_delay_percentile(ltg_rx_flow* flow, u32 num_delays, u32 permille){
+	u32 target;
+	u32 count;
+	u32 bin;
+	u32 exponent;
+	u32 width;
+
+	if(num_delays == 0){
+		return 0;
+	}
+
+	target = (u32)((((u64)num_delays * permille) + 999) / 1000);
+	count  = 0;
+
+	for(bin = 0; bin < (LTG_RX_DELAY_NUM_BINS - 1); bin++){
+		count += flow->delay_hist[bin];
+		if(count >= target){
+			break;
+		}
+	}
+
+	if(bin < (1 << LTG_RX_DELAY_SUB_BINS_LOG2)){
+		return bin;
+	}
+
+	exponent = (bin >> LTG_RX_DELAY_SUB_BINS_LOG2) + LTG_RX_DELAY_SUB_BINS_LOG2 - 1;
+	width    = 1 << (exponent - LTG_RX_DELAY_SUB_BINS_LOG2);
+
+	return (((1 << LTG_RX_DELAY_SUB_BINS_LOG2) + (bin & ((1 << LTG_RX_DELAY_SUB_BINS_LOG2) - 1))) * width) + (width >> 1);
+}
+
+
+void ltg_rx_stats_set_enable(u8 enable){
+	ltg_rx_stats_enabled = enable;
+}
+
+
+u32 ltg_rx_stats_num_flows(){
+	return ltg_rx_flow_list.length;
+}
+
+
+/*****************************************************************************/
+/**
+* Gets the receive statistics of a flow
+*
+* @param    index            - Index of the flow, in the order the flows were created
+* @param    addr_src         - Filled in with the source address of the flow
+* @param    ltg_id           - Filled in with the LTG ID of the flow
+* @param    stats            - Filled in with the statistics of the flow
+* @return   int              - 0 on success, -1 if there is no flow with the index
+*/
+int ltg_rx_stats_get(u32 index, u8* addr_src, u32* ltg_id, ltg_rx_flow_stats* stats){
+	dl_entry*         curr_dl_entry;
+	ltg_rx_flow*      flow;
+	u32               num_delays;
+	interrupt_state_t prev_interrupt_state;
+
+	// Flows are updated in the Rx interrupt
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	curr_dl_entry = ltg_rx_flow_list.first;
+
+	while((curr_dl_entry != NULL) && (index > 0)){
+		curr_dl_entry = dl_entry_next(curr_dl_entry);
+		index--;
+	}
+
+	if(curr_dl_entry == NULL){
+		wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+		return -1;
+	}
+
+	flow       = (ltg_rx_flow*)(curr_dl_entry->data);
+	num_delays = flow->stats.num_rx - flow->stats.num_dup;
+
+	if(num_delays > 0){
+		flow->stats.delay_avg = (u32)(flow->delay_total / num_delays);
+	}
+	flow->stats.jitter    = flow->jitter_q4 >> 4;
+	flow->stats.delay_p50 = ltg_rx_delay_percentile(flow, num_delays, 500);
+	flow->stats.delay_p90 = ltg_rx_delay_percentile(flow, num_delays, 900);
+	flow->stats.delay_p99 = ltg_rx_delay_percentile(flow, num_delays, 990);
+
+	memcpy(addr_src, flow->addr_src, 6);
+	*ltg_id = flow->ltg_id;
+	memcpy(stats, &(flow->stats), sizeof(ltg_rx_flow_stats));
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	return 0;
+}
+
+
+/*****************************************************************************/
+/**
+* Removes all flows and their receive statistics
+*
+* @param    None
+* @return   None
+*/
+void ltg_rx_stats_reset(){
+	dl_entry*         curr_dl_entry;
+	ltg_rx_flow*      flow;
+	u32               i;
+	interrupt_state_t prev_interrupt_state;
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	while(ltg_rx_flow_list.first != NULL){
+		curr_dl_entry = ltg_rx_flow_list.first;
+		flow          = (ltg_rx_flow*)(curr_dl_entry->data);
+
+		dl_entry_remove(&ltg_rx_flow_list, curr_dl_entry);
+		wlan_mac_high_free(flow);
+	}
+
+	for(i = 0; i < LTG_RX_FLOW_TABLE_SIZE; i++){
+		dl_list_init(&(ltg_rx_flow_table[i]));
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+}
+
+
 #ifdef USE_WARPNET_WLAN_EXP
 
 
 // NOTE:  The src information is from the network and must be byte swapped
+
 void * ltg_sched_deserialize(u32 * src, u32 * ret_type, u32 * ret_size) {
 	u32    temp, temp2;
     u16    type;
@@ -607,15 +1431,15 @@ void * ltg_sched_deserialize(u32 * src, u32 * ret_type, u32 * ret_size) {
         	if (size == 3){
         		ret_val = (void *) wlan_mac_high_malloc(sizeof(ltg_sched_periodic_params));
         	    if (ret_val != NULL){
-        	    	((ltg_sched_periodic_params *)ret_val)->interval_count = (Xil_Ntohl(src[1]))/LTG_POLL_INTERVAL;
+        	    	((ltg_sched_periodic_params *)ret_val)->interval_usec = Xil_Ntohl(src[1]);
 
         	    	temp     = Xil_Ntohl(src[2]);
         	    	temp2    = Xil_Ntohl(src[3]);
-        	    	((ltg_sched_periodic_params *)ret_val)->duration_count = ((((u64)temp)<<32) + ((u64)temp2))/LTG_POLL_INTERVAL;
+        	    	((ltg_sched_periodic_params *)ret_val)->duration_usec = (((u64)temp)<<32) + ((u64)temp2);
 
         	    	wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_ltg, "Sched Periodic: %d usec for %d usec\n",
-        	    			        LTG_POLL_INTERVAL * ((ltg_sched_periodic_params *)ret_val)->interval_count,
-        	    			        (u32)(LTG_POLL_INTERVAL * (((ltg_sched_periodic_params *)ret_val)->duration_count)));
+        	    			        ((ltg_sched_periodic_params *)ret_val)->interval_usec,
+        	    			        (u32)(((ltg_sched_periodic_params *)ret_val)->duration_usec));
         	    }
         	}
     	break;
@@ -624,17 +1448,78 @@ void * ltg_sched_deserialize(u32 * src, u32 * ret_type, u32 * ret_size) {
         	if (size == 4){
         		ret_val = (void *) wlan_mac_high_malloc(sizeof(ltg_sched_uniform_rand_params));
         	    if (ret_val != NULL){
-        	    	((ltg_sched_uniform_rand_params *)ret_val)->min_interval_count = Xil_Ntohl(src[1])/LTG_POLL_INTERVAL;
-        	    	((ltg_sched_uniform_rand_params *)ret_val)->max_interval_count = Xil_Ntohl(src[2])/LTG_POLL_INTERVAL;
+        	    	((ltg_sched_uniform_rand_params *)ret_val)->min_interval_usec = Xil_Ntohl(src[1]);
+        	    	((ltg_sched_uniform_rand_params *)ret_val)->max_interval_usec = Xil_Ntohl(src[2]);
 
         	    	temp     = Xil_Ntohl(src[3]);
         	    	temp2    = Xil_Ntohl(src[4]);
-        	    	((ltg_sched_uniform_rand_params *)ret_val)->duration_count = ((((u64)temp)<<32) + ((u64)temp2))/LTG_POLL_INTERVAL;
+        	    	((ltg_sched_uniform_rand_params *)ret_val)->duration_usec = (((u64)temp)<<32) + ((u64)temp2);
 
         	    	wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_ltg, "Sched Uniform Rand: [%d %d] usec for %d usec\n",
-                                    LTG_POLL_INTERVAL * ((ltg_sched_uniform_rand_params *)ret_val)->min_interval_count,
-                                    LTG_POLL_INTERVAL * ((ltg_sched_uniform_rand_params *)ret_val)->max_interval_count,
-                                    (u32)(LTG_POLL_INTERVAL * (((ltg_sched_uniform_rand_params *)ret_val)->duration_count)));
+                                    ((ltg_sched_uniform_rand_params *)ret_val)->min_interval_usec,
+                                    ((ltg_sched_uniform_rand_params *)ret_val)->max_interval_usec,
+                                    (u32)(((ltg_sched_uniform_rand_params *)ret_val)->duration_usec));
+        	    }
+        	}
+        break;
+
+        case LTG_SCHED_TYPE_POISSON:
+        	if ((size == 3) && (Xil_Ntohl(src[1]) != 0)){
+        		ret_val = (void *) wlan_mac_high_malloc(sizeof(ltg_sched_poisson_params));
+        	    if (ret_val != NULL){
+        	    	((ltg_sched_poisson_params *)ret_val)->mean_interval_usec = Xil_Ntohl(src[1]);
+
+        	    	temp     = Xil_Ntohl(src[2]);
+        	    	temp2    = Xil_Ntohl(src[3]);
+        	    	((ltg_sched_poisson_params *)ret_val)->duration_usec = (((u64)temp)<<32) + ((u64)temp2);
+
+        	    	wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_ltg, "Sched Poisson: %d usec mean for %d usec\n",
+        	    			        ((ltg_sched_poisson_params *)ret_val)->mean_interval_usec,
+        	    			        (u32)(((ltg_sched_poisson_params *)ret_val)->duration_usec));
+        	    }
+        	}
+        break;
+
+        case LTG_SCHED_TYPE_PARETO_ON_OFF:
+        	if ((size == 6) && (Xil_Ntohl(src[4]) > 100)){
+        		ret_val = (void *) wlan_mac_high_malloc(sizeof(ltg_sched_pareto_on_off_params));
+        	    if (ret_val != NULL){
+        	    	((ltg_sched_pareto_on_off_params *)ret_val)->interval_usec = Xil_Ntohl(src[1]);
+        	    	((ltg_sched_pareto_on_off_params *)ret_val)->mean_on_usec  = Xil_Ntohl(src[2]);
+        	    	((ltg_sched_pareto_on_off_params *)ret_val)->mean_off_usec = Xil_Ntohl(src[3]);
+        	    	((ltg_sched_pareto_on_off_params *)ret_val)->shape         = Xil_Ntohl(src[4]);
+
+        	    	temp     = Xil_Ntohl(src[5]);
+        	    	temp2    = Xil_Ntohl(src[6]);
+        	    	((ltg_sched_pareto_on_off_params *)ret_val)->duration_usec = (((u64)temp)<<32) + ((u64)temp2);
+
+        	    	wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_ltg, "Sched Pareto On/Off: %d usec, on %d usec, off %d usec, shape %d for %d usec\n",
+        	    			        ((ltg_sched_pareto_on_off_params *)ret_val)->interval_usec,
+        	    			        ((ltg_sched_pareto_on_off_params *)ret_val)->mean_on_usec,
+        	    			        ((ltg_sched_pareto_on_off_params *)ret_val)->mean_off_usec,
+        	    			        ((ltg_sched_pareto_on_off_params *)ret_val)->shape,
+        	    			        (u32)(((ltg_sched_pareto_on_off_params *)ret_val)->duration_usec));
+        	    }
+        	}
+        break;
+
+        case LTG_SCHED_TYPE_TRACE:
+        	if (size == 5){
+        		ret_val = (void *) wlan_mac_high_malloc(sizeof(ltg_sched_trace_params));
+        	    if (ret_val != NULL){
+        	    	((ltg_sched_trace_params *)ret_val)->start_index = Xil_Ntohl(src[1]);
+        	    	((ltg_sched_trace_params *)ret_val)->num_records = Xil_Ntohl(src[2]);
+        	    	((ltg_sched_trace_params *)ret_val)->num_loops   = Xil_Ntohl(src[3]);
+
+        	    	temp     = Xil_Ntohl(src[4]);
+        	    	temp2    = Xil_Ntohl(src[5]);
+        	    	((ltg_sched_trace_params *)ret_val)->duration_usec = (((u64)temp)<<32) + ((u64)temp2);
+
+        	    	wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_ltg, "Sched Trace: %d records from %d, %d loops for %d usec\n",
+        	    			        ((ltg_sched_trace_params *)ret_val)->num_records,
+        	    			        ((ltg_sched_trace_params *)ret_val)->start_index,
+        	    			        ((ltg_sched_trace_params *)ret_val)->num_loops,
+        	    			        (u32)(((ltg_sched_trace_params *)ret_val)->duration_usec));
         	    }
         	}
         break;
@@ -703,6 +1588,17 @@ void * ltg_payload_deserialize(u32 * src, u32 * ret_type, u32 * ret_size) {
         	}
         break;
 
+        case LTG_PYLD_TYPE_TRACE:
+        	if (size == 0){
+        		ret_val = (void *) wlan_mac_high_malloc(sizeof(ltg_pyld_trace));
+        	    if (ret_val != NULL){
+					((ltg_pyld_trace *)ret_val)->hdr.type = LTG_PYLD_TYPE_TRACE;
+
+        	    	wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_ltg, "Payload Trace\n");
+        	    }
+        	}
+        break;
+
         default:
         	wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_ltg, "Unknown payload type %d\n", type);
 		break;
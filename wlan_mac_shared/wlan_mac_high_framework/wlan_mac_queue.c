@@ -21,18 +21,51 @@
 #include "string.h"
 
 #include "wlan_mac_ipc_util.h"
+#include "wlan_mac_802_11_defs.h"
 #include "wlan_mac_high.h"
 #include "wlan_mac_queue.h"
-#include "wlan_mac_dl_list.h"
 #include "wlan_mac_eth_util.h"
 
 #include "wlan_exp_common.h"
 
 
-//This list holds all of the empty, free elements
-static dl_list               queue_free;
+//Queue elements are compact descriptors in TX_QUEUE_DL_ENTRY_MEM_BASE linked by 16-bit indices
+#define queue_element_base                ((tx_queue_element*)(TX_QUEUE_DL_ENTRY_MEM_BASE))
+#define queue_element_index(tqe)          ((u16)((tqe) - queue_element_base))
+#define queue_element_at(index)           (&(queue_element_base[(index)]))
 
-//This queue_tx vector will get filled in with elements from the queue_free list
+//Each size class holds a list of its empty, free elements. The elements of a size class occupy
+//one contiguous range of indices and their buffers one contiguous range of TX_QUEUE_BUFFER_BASE,
+//so both the class and the buffer address of any element are computed from its index.
+typedef struct{
+	tx_queue_list    free;
+	u32              buffer_size;
+	u32              num_total;
+	u32              first_index;
+	u32              base;
+} queue_size_class;
+
+static queue_size_class      size_class[QUEUE_NUM_SIZE_CLASSES];
+
+static const u32             size_class_buffer_size[QUEUE_NUM_SIZE_CLASSES] = { QUEUE_BUFFER_SIZE_SMALL,
+                                                                                QUEUE_BUFFER_SIZE_MEDIUM,
+                                                                                QUEUE_BUFFER_SIZE_LARGE };
+
+static const u32             size_class_share[QUEUE_NUM_SIZE_CLASSES]       = { QUEUE_BUFFER_SHARE_SMALL,
+                                                                                QUEUE_BUFFER_SHARE_MEDIUM,
+                                                                                QUEUE_BUFFER_SHARE_LARGE };
+
+//Each queue is a set of per-access category lists. The queue is served from the list chosen by
+//queue_select_ac(), so a frame only waits behind frames of the same or higher priority.
+typedef struct{
+	tx_queue_list    ac[QUEUE_NUM_AC];
+	u32              length;                                   ///< Entries across all access categories
+} queue_ac_lists;
+
+//Access categories from highest to lowest priority
+static const u8              ac_priority[QUEUE_NUM_AC] = { QUEUE_AC_VO, QUEUE_AC_VI, QUEUE_AC_BE, QUEUE_AC_BK };
+
+//This queue_tx vector will get filled in with elements from the size class free lists
 //Note: this implementation sparsely packs the queue_tx array to allow fast
 //indexing at the cost of some wasted memory. The queue_tx array will be
 //reallocated whenever the upper-level MAC asks to enqueue at an index
@@ -41,20 +74,108 @@ static dl_list               queue_free;
 //this array will continue to grow and eventually be unable to be reallocated.
 //Practically speaking, this means an AP needs to re-use the AIDs it issues
 //stations if it wants to use the AIDs as an index into the tx queue.
-static dl_list*              queue_tx;
+static queue_ac_lists*       queue_tx;
 static u16                   num_queue_tx;
 
+//Per-queue scheduling state, allocated in parallel with queue_tx
+static tx_queue_info*        queue_info;
+
+//Bitmap of non-empty queues. Bit (queue_sel & 0x1F) of word (queue_sel >> 5) is
+//set when queue_tx[queue_sel] holds at least one entry. The bitmap is kept in sync
+//by enqueue_after_tail() and dequeue_from_head(), so selecting the next queue to
+//service never has to walk every queue to find the occupied ones.
+static u32*                  queue_active_bitmap;
+static u16                   num_queue_active;
+
+//Deficit round robin cursor; the queue currently holding the DRR "turn"
+static u32                   drr_cursor;
+
+//Active queue management (AQM) configuration, shared by all queues
+static u32                   aqm_mode;
+static u32                   aqm_target;                   ///< Acceptable standing queue delay (usec)
+static u32                   aqm_interval;                 ///< Window over which the delay must stay above aqm_target before dropping (usec)
+
+//Access category scheduling configuration, shared by all queues
+static u32                   ac_sched_mode;
+static u8                    ac_weight[QUEUE_NUM_AC];
+
+//Free pool sharing configuration, shared by all queues
+static u32                   share_alpha;                  ///< Queue length cap as a multiple of the free entries (1/8 units)
+static u32                   share_reserve;                ///< Free entries below which the longest queue is head-dropped
+
+//While the free pool is below share_reserve, the longest queue is kept by queue_share_grow() as queues
+//grow, so that the active queues are not scanned on every arrival. share_others_max bounds the length of
+//every other queue; once head drops cut share_longest below it, queue_share_longest() scans again.
+static u32                   share_longest;                ///< Longest queue, QUEUE_SEL_NONE outside a drop episode
+static u32                   share_others_max;             ///< Upper bound on the length of the other queues
+
+//High-level retry configuration, shared by all queues
+static u32                   retry_max;                    ///< Re-enqueues allowed per packet; QUEUE_RETRY_MAX_DISABLED to check entries in at transmission
+static u32                   retry_age_limit;              ///< Age beyond which a failed packet is dropped rather than re-enqueued (usec)
+
+//Queue entries whose packets are with CPU Low, indexed by Tx packet buffer. Only used when high-level
+//retry is enabled. purge_queue() releases the entries of the purged queue so they are not re-enqueued.
+typedef struct{
+	tx_queue_element*        tqe;
+	u16                      queue_sel;
+	u8                       purged;                       ///< tqe was released by purge_queue()
+} queue_tx_pending;
+
+static queue_tx_pending      tx_pending[NUM_TX_PKT_BUFS];
+
+static void queue_list_insert_end(tx_queue_list* list, tx_queue_element* tqe);
+static void queue_list_remove(tx_queue_list* list, tx_queue_element* tqe);
+static void queue_list_insert_beginning(tx_queue_list* list, tx_queue_element* tqe);
+static void queue_list_concat(tx_queue_list* list, tx_queue_list* list_src);
+static u32 queue_list_move_first(tx_queue_list* list, tx_queue_list* list_src, u32 num_tqe);
+static u32 queue_size_class_of(tx_queue_element* tqe);
+static tx_queue_element* queue_aqm_dequeue(u16 queue_sel);
+
 extern function_ptr_t        tx_poll_callback;             ///< User callback when higher-level framework is ready to send a packet to low
 
 volatile static u32          num_tx_queue;
 
 
 void queue_init(u8 dram_present){
-	u32 i;
+	u32 i, j, k;
+	u32 num_elements;
+	u32 num_requested;
+	u32 num_large;
+	u32 shared_size;
+	u32 buffer_addr;
+	queue_size_class* sc;
+	tx_queue_element* tqe;
+
 	//The number of Tx Queue elements we can initialize is limited by the smaller of two values:
-	//	(1) The number of dl_entry structs we can squeeze into TX_QUEUE_DL_ENTRY_MEM_SIZE
-	//  (2) The number of QUEUE_BUFFER_SIZE MPDU buffers we can squeeze into TX_QUEUE_BUFFER_SIZE
-	num_tx_queue =  min(TX_QUEUE_DL_ENTRY_MEM_SIZE/sizeof(dl_entry), TX_QUEUE_BUFFER_SIZE/QUEUE_BUFFER_SIZE );
+	//	(1) The number of tx_queue_element descriptors we can squeeze into TX_QUEUE_DL_ENTRY_MEM_SIZE
+	//      (and address with a 16-bit index)
+	//  (2) The number of buffers each size class can squeeze into its share of TX_QUEUE_BUFFER_SIZE
+	//The large class is sized first (see QUEUE_BUFFER_NUM_LARGE); the other classes share the rest.
+	num_elements  = min(TX_QUEUE_DL_ENTRY_MEM_SIZE/sizeof(tx_queue_element), QUEUE_INDEX_NONE);
+	num_large     = min(QUEUE_BUFFER_NUM_LARGE, min(num_elements, TX_QUEUE_BUFFER_SIZE / QUEUE_BUFFER_SIZE_LARGE));
+	shared_size   = TX_QUEUE_BUFFER_SIZE - (num_large * QUEUE_BUFFER_SIZE_LARGE);
+	num_requested = 0;
+
+	for(i = 0; i < QUEUE_NUM_SIZE_CLASSES; i++){
+		size_class[i].buffer_size = size_class_buffer_size[i];
+
+		if(i == QUEUE_SIZE_CLASS_LARGE){
+			size_class[i].num_total = num_large;
+		} else {
+			size_class[i].num_total = ((shared_size / 100) * size_class_share[i]) / size_class_buffer_size[i];
+			num_requested          += size_class[i].num_total;
+		}
+	}
+
+	//If there are not enough descriptors left to describe every small and medium buffer, scale those
+	//size classes down evenly
+	if(num_requested > (num_elements - num_large)){
+		for(i = 0; i < QUEUE_NUM_SIZE_CLASSES; i++){
+			if(i != QUEUE_SIZE_CLASS_LARGE){
+				size_class[i].num_total = (size_class[i].num_total * (num_elements - num_large)) / num_requested;
+			}
+		}
+	}
 
 	if(dram_present != 1){
 		xil_printf("A working DRAM SODIMM has not been detected on this board.\n");
@@ -64,274 +185,1890 @@ void queue_init(u8 dram_present){
 		wlan_mac_high_blink_hex_display(0, 250000);
 	}
 
-
-	dl_list_init(&queue_free);
 	bzero((void*)TX_QUEUE_BUFFER_BASE, TX_QUEUE_BUFFER_SIZE);
 
-	//At boot, every dl_entry buffer descriptor is free
+	//At boot, every queue element is free
 	//To set up the doubly linked list, we exploit the fact that we know the starting state is sequential.
 	//This matrix addressing is not safe once the queue is used. The insert/remove helper functions should be used
-	dl_entry* dl_entry_base;
-	dl_entry_base = (dl_entry*)(TX_QUEUE_DL_ENTRY_MEM_BASE);
+	j           = 0;
+	buffer_addr = TX_QUEUE_BUFFER_BASE;
+
+	for(i = 0; i < QUEUE_NUM_SIZE_CLASSES; i++){
+		sc = &(size_class[i]);
+
+		queue_list_init(&(sc->free));
+		sc->first_index = j;
+		sc->base        = buffer_addr;
+
+		for(k = 0; k < sc->num_total; k++){
+			tqe       = queue_element_at(j);
+			tqe->prev = (k == 0)                   ? QUEUE_INDEX_NONE : (j - 1);
+			tqe->next = (k == (sc->num_total - 1)) ? QUEUE_INDEX_NONE : (j + 1);
+			j++;
+		}
+
+		if(sc->num_total > 0){
+			sc->free.first  = sc->first_index;
+			sc->free.last   = j - 1;
+			sc->free.length = sc->num_total;
+		}
+
+		buffer_addr += sc->num_total * sc->buffer_size;
 
-	for(i=0;i<num_tx_queue;i++){
-		dl_entry_base[i].data = (void*)(TX_QUEUE_BUFFER_BASE + (i*QUEUE_BUFFER_SIZE));
-		dl_entry_insertEnd(&queue_free,&(dl_entry_base[i]));
+#ifdef QUEUE_ELEMENT_DATA_FIELD
+		for(k = 0; k < sc->num_total; k++){
+			tqe       = queue_element_at(sc->first_index + k);
+			tqe->data = (void*)(sc->base + (k * sc->buffer_size));
+		}
+#endif
+
+		xil_printf("Tx Queue of %d x %d B placed in DRAM: using %d kB\n", sc->num_total, sc->buffer_size, (sc->num_total*sc->buffer_size)/1024);
 	}
 
-	xil_printf("Tx Queue of %d placed in DRAM: using %d kB\n", num_tx_queue, (num_tx_queue*QUEUE_BUFFER_SIZE)/1024);
+	num_tx_queue = j;
+
+	xil_printf("Tx Queue descriptors placed in BRAM: using %d kB\n", (num_tx_queue*sizeof(tx_queue_element))/1024);
+
+	num_queue_tx        = 0;
+	queue_tx            = NULL;
+	queue_info          = NULL;
+	queue_active_bitmap = NULL;
+	num_queue_active    = 0;
+	drr_cursor          = 0;
 
-	num_queue_tx = 0;
-	queue_tx     = NULL;
+	aqm_mode            = QUEUE_AQM_MODE_DISABLED;
+	aqm_target          = QUEUE_AQM_TARGET_DEFAULT;
+	aqm_interval        = QUEUE_AQM_INTERVAL_DEFAULT;
+
+	ac_sched_mode       = QUEUE_AC_SCHED_STRICT;
+	ac_weight[QUEUE_AC_BE] = QUEUE_AC_WEIGHT_BE_DEFAULT;
+	ac_weight[QUEUE_AC_BK] = QUEUE_AC_WEIGHT_BK_DEFAULT;
+	ac_weight[QUEUE_AC_VI] = QUEUE_AC_WEIGHT_VI_DEFAULT;
+	ac_weight[QUEUE_AC_VO] = QUEUE_AC_WEIGHT_VO_DEFAULT;
+
+	share_alpha         = QUEUE_SHARE_ALPHA_DEFAULT;
+	share_reserve       = QUEUE_SHARE_RESERVE_DEFAULT;
+	share_longest       = QUEUE_SEL_NONE;
+	share_others_max    = 0;
+
+	retry_max           = QUEUE_RETRY_MAX_DISABLED;
+	retry_age_limit     = QUEUE_RETRY_AGE_LIMIT_DEFAULT;
+
+	for(i = 0; i < NUM_TX_PKT_BUFS; i++){
+		tx_pending[i].tqe    = NULL;
+		tx_pending[i].purged = 0;
+	}
 	return;
 }
 
 /**
- * @return Total number of queue entries; sum of all free and occupied entries
+ * @brief Creates queues up to and including queue_sel
+ *
+ * Queue IDs are low-valued integers, allowing for fast lookup by indexing the queue_tx array. This
+ * function grows queue_tx and the arrays that are kept in parallel with it (per-queue scheduling state
+ * and the active queue bitmap) so that queue_sel is a valid index.
+ *
+ * @param u16 queue_sel
+ *  -ID of the highest queue that must exist
+ * @return int
+ *  -0 on success, -1 if the queue arrays could not be reallocated
  */
-int queue_total_size(){
-	return num_tx_queue;
+static int queue_create(u16 queue_sel){
+	u32 i, j;
+	u32 old_num_words;
+	u32 new_num_words;
+	queue_ac_lists* new_queue_tx;
+	tx_queue_info* new_queue_info;
+	u32*           new_bitmap;
+
+	if((queue_sel+1) <= num_queue_tx){
+		return 0;
+	}
+
+	old_num_words = QUEUE_BITMAP_NUM_WORDS(num_queue_tx);
+	new_num_words = QUEUE_BITMAP_NUM_WORDS(queue_sel+1);
+
+	new_queue_tx = wlan_mac_high_realloc(queue_tx, (queue_sel+1)*sizeof(queue_ac_lists));
+	if(new_queue_tx == NULL){
+		wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Could not reallocate %d bytes for queue %d\n", (queue_sel+1)*sizeof(queue_ac_lists), queue_sel);
+		return -1;
+	}
+	queue_tx = new_queue_tx;
+
+	new_queue_info = wlan_mac_high_realloc(queue_info, (queue_sel+1)*sizeof(tx_queue_info));
+	if(new_queue_info == NULL){
+		wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Could not reallocate %d bytes for queue %d\n", (queue_sel+1)*sizeof(tx_queue_info), queue_sel);
+		return -1;
+	}
+	queue_info = new_queue_info;
+
+	if(new_num_words > old_num_words){
+		new_bitmap = wlan_mac_high_realloc(queue_active_bitmap, new_num_words*sizeof(u32));
+		if(new_bitmap == NULL){
+			wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Could not reallocate %d bytes for queue %d\n", new_num_words*sizeof(u32), queue_sel);
+			return -1;
+		}
+		queue_active_bitmap = new_bitmap;
+
+		for(i = old_num_words; i < new_num_words; i++){
+			queue_active_bitmap[i] = 0;
+		}
+	}
+
+	for(i = num_queue_tx; i <= queue_sel; i++){
+		bzero(&(queue_info[i]), sizeof(tx_queue_info));
+		queue_info[i].quantum = QUEUE_DRR_QUANTUM_DEFAULT;
+
+		for(j = 0; j < QUEUE_NUM_AC; j++){
+			queue_list_init(&(queue_tx[i].ac[j]));
+			queue_info[i].ac_credit[j] = ac_weight[j];
+		}
+		queue_tx[i].length = 0;
+	}
+
+	num_queue_tx = queue_sel+1;
+
+	return 0;
 }
 
 /**
- * @brief Flushes the contents of the selected queue
+ * @brief Finds the next non-empty queue at or after start_sel
  *
- * Purges all entries from the selected queue and returns them to the free pool. Packets contained
- * in the purged entries will be dropped. This function should only be called when enqueued packets
- * should no longer be transmitted wirelessly, such as when a node leaves a BSS.
+ * Searches the active queue bitmap one 32-bit word at a time, wrapping around to queue 0, so the
+ * cost depends on the number of bitmap words rather than the number of queues.
  *
- * @param u16 queue_sel
- *  -ID of the queue to purge
+ * @param u32 start_sel
+ *  -ID of the first queue to consider
+ * @return u32
+ *  -ID of the next non-empty queue, QUEUE_SEL_NONE if all queues are empty
  */
-void purge_queue(u16 queue_sel){
-	u32             num_queued;
-	u32			    i;
-	tx_queue_element* curr_tx_queue_element;
-	interrupt_state_t prev_interrupt_state;
+static u32 queue_find_next_active(u32 start_sel){
+	u32 i;
+	u32 num_words;
+	u32 word_idx;
+	u32 word;
 
-	// The queue purge is not interrupt safe
-	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+	if(num_queue_active == 0){
+		return QUEUE_SEL_NONE;
+	}
+
+	if(start_sel >= num_queue_tx){
+		start_sel = 0;
+	}
 
-	num_queued = queue_num_queued(queue_sel);
+	num_words = QUEUE_BITMAP_NUM_WORDS(num_queue_tx);
+	word_idx  = start_sel >> 5;
+	word      = queue_active_bitmap[word_idx] & (0xFFFFFFFF << (start_sel & 0x1F));
 
-	if( num_queued > 0 ){
-		wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_queue, "Purging %d packets from queue %d\n", num_queued, queue_sel);
+	// Visit num_words+1 words so the bits below start_sel in the first word are checked after wrapping
+	for(i = 0; i <= num_words; i++){
+		if(word != 0){
+			return (word_idx << 5) + __builtin_ctz(word);
+		}
 
-		for(i = 0; i < num_queued; i++){
-			curr_tx_queue_element = dequeue_from_head(queue_sel);
-			queue_checkin(curr_tx_queue_element);
+		word_idx++;
+		if(word_idx == num_words){
+			word_idx = 0;
 		}
+		word = queue_active_bitmap[word_idx];
 	}
 
-	// Re-enable interrupts now that we are done
-	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+	return QUEUE_SEL_NONE;
 }
 
 /**
- * @brief Adds a queue entry to a specified queue
+ * @brief Selects the access category a non-empty queue will be served from next
  *
- * Adds the queue entry pointed to by tqe to the queue with ID queue_sel. The calling context must ensure
- * tqe points to a queue entry containing a packet ready for wireless transmission. If a queue with ID quele_sel
- * does not already exist this function will create it, then add tqe to the new queue.
+ * In QUEUE_AC_SCHED_STRICT mode this is the highest priority AC holding an entry. In
+ * QUEUE_AC_SCHED_WEIGHTED mode it is the highest priority AC holding an entry that has credit left in
+ * the current round; if every backlogged AC has used its credit, the highest priority one is chosen
+ * and dequeue_from_head() starts a new round. This function does not modify any state, so the
+ * result always names the AC of the entry the next dequeue_from_head() will return.
  *
  * @param u16 queue_sel
- *  -ID of the queue to which tqe is added. A new queue with ID queue_sel will be created if it does not already exist.
- * @param tx_queue_element* tqe
- *  -Queue entry containing packet for transmission
+ *  -ID of a non-empty queue
+ * @return u32
+ *  -Access category (QUEUE_AC_*)
  */
-void enqueue_after_tail(u16 queue_sel, tx_queue_element* tqe){
+static u32 queue_select_ac(u16 queue_sel){
 	u32 i;
+	u32 ac;
+	u32 first_backlogged = QUEUE_NUM_AC;
 
-	//Create queues up to and including queue_sel if they don't already exist
-	// Queue IDs are low-valued integers, allowing for fast lookup by indexing the queue_tx array
-	if((queue_sel+1) > num_queue_tx){
-    	queue_tx = wlan_mac_high_realloc(queue_tx, (queue_sel+1)*sizeof(dl_list));
-
-    	if(queue_tx == NULL){
-    		wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Could not reallocate %d bytes for queue %d\n", (queue_sel+1)*sizeof(dl_list), queue_sel);
-    	}
+	for(i = 0; i < QUEUE_NUM_AC; i++){
+		ac = ac_priority[i];
 
-    	for(i = num_queue_tx; i <= queue_sel; i++){
-    		dl_list_init(&(queue_tx[i]));
-    	}
-
-    	num_queue_tx = queue_sel+1;
-    }
+		if(queue_tx[queue_sel].ac[ac].length == 0){
+			continue;
+		}
 
-	//Insert the queue entry into the dl_list representing the selected queue
-	dl_entry_insertEnd(&(queue_tx[queue_sel]), (dl_entry*)tqe);
+		if((ac_sched_mode == QUEUE_AC_SCHED_STRICT) || (queue_info[queue_sel].ac_credit[ac] > 0)){
+			return ac;
+		}
 
-	tx_poll_callback();
+		if(first_backlogged == QUEUE_NUM_AC){
+			first_backlogged = ac;
+		}
+	}
 
-	return;
+	return first_backlogged;
 }
 
 /**
- * @brief Removes the head entry from the specified queue
- *
- * If queue_sel is not empty this function returns a tx_queue_element pointer for the head
- * entry in the queue. If the specified queue is empty this function returns NULL.
- *
  * @param u16 queue_sel
- *  -ID of the queue from which to dequeue an entry
+ *  -ID of a non-empty queue
  * @return
- *  -Pointer to queue entry if available, NULL if queue is empty
+ *  -Queue entry the next dequeue_from_head() on queue_sel will return
  */
-tx_queue_element* dequeue_from_head(u16 queue_sel){
-	tx_queue_element* tqe;
-	dl_entry* curr_dl_entry;
+static inline tx_queue_element* queue_head(u16 queue_sel){
+	return queue_element_at(queue_tx[queue_sel].ac[queue_select_ac(queue_sel)].first);
+}
 
-	if((queue_sel+1) > num_queue_tx){
-		//The specified queue does not exist; this can happen if a node has associated (has a valid AID=queue_sel)
-		// but no packet has ever been enqueued to it, as queues are created upon first insertion - see enqueue_after_tail()
-		return NULL;
-	} else {
-		if(queue_tx[queue_sel].length == 0){
-			//Requested queue exists but is empty
-			return NULL;
+/**
+ * @brief Finds the queue holding the most entries
+ *
+ * @param u32* others_max
+ *  -Set to the length of the longest of the other queues (0 if there are none)
+ * @return u32
+ *  -ID of the longest queue, QUEUE_SEL_NONE if all queues are empty
+ */
+static u32 queue_find_longest(u32* others_max){
+	u32 i;
+	u32 queue_sel;
+	u32 longest = QUEUE_SEL_NONE;
+
+	*others_max = 0;
+	queue_sel   = queue_find_next_active(0);
+
+	for(i = 0; i < num_queue_active; i++){
+		if(longest == QUEUE_SEL_NONE){
+			longest = queue_sel;
+		} else if(queue_tx[queue_sel].length > queue_tx[longest].length){
+			*others_max = queue_tx[longest].length;
+			longest     = queue_sel;
 		} else {
-			curr_dl_entry = (queue_tx[queue_sel].first);
-			dl_entry_remove(&queue_tx[queue_sel],curr_dl_entry);
-			tqe = (tx_queue_element*)curr_dl_entry;
-			return tqe;
+			*others_max = max(*others_max, queue_tx[queue_sel].length);
 		}
+		queue_sel = queue_find_next_active(queue_sel + 1);
 	}
+
+	return longest;
 }
 
 /**
- * @return Number of queue entries in the free pool
+ * @brief Returns the longest queue during a free pool drop episode
+ *
+ * The active queues are only scanned when the episode starts, or when head drops may have made
+ * the kept queue shorter than another queue.
+ *
+ * @return u32
+ *  -ID of the longest queue, QUEUE_SEL_NONE if all queues are empty
  */
-u32 queue_num_free(){
-	return queue_free.length;
+static u32 queue_share_longest(){
+	if((share_longest == QUEUE_SEL_NONE) ||
+	   (queue_tx[share_longest].length == 0) ||
+	   (queue_tx[share_longest].length < share_others_max)){
+		share_longest = queue_find_longest(&share_others_max);
+	}
+
+	return share_longest;
 }
 
 /**
- * @param u16 queue_sel ID of queue
- * @return Number of entries in the specified queue
+ * @brief Keeps the longest queue of a drop episode up to date after a queue grows
+ *
+ * @param u16 queue_sel
+ *  -ID of the queue that gained an entry
  */
-u32 queue_num_queued(u16 queue_sel){
-	if((queue_sel+1) > num_queue_tx){
-		return 0;
+static inline void queue_share_grow(u16 queue_sel){
+	if((share_longest == QUEUE_SEL_NONE) || (queue_sel == share_longest)){
+		return;
+	}
+
+	if(queue_tx[queue_sel].length > queue_tx[share_longest].length){
+		share_others_max = queue_tx[share_longest].length;
+		share_longest    = queue_sel;
 	} else {
-		return queue_tx[queue_sel].length;
+		share_others_max = max(share_others_max, queue_tx[queue_sel].length);
 	}
 }
 
 /**
- * @brief Checks out one queue entry from the free pool
+ * @brief Marks a queue that has just become empty as inactive
  *
- * The queue framework maintains a pool of free queue entries. This function removes one entry
- * from the free pool and returns it for use by the MAC application. If the free pool is empty
- * NULL is returned.
+ * An empty queue forfeits any remaining deficit, as in standard DRR, and starts its next AC round afresh.
  *
- * @return New queue entry, NULL if none is available
+ * @param u16 queue_sel
+ *  -ID of the queue
  */
-tx_queue_element* queue_checkout(){
-	tx_queue_element* tqe;
+static void queue_deactivate(u16 queue_sel){
+	u32 i;
+	tx_queue_info* info = &(queue_info[queue_sel]);
 
-	if(queue_free.length > 0){
-		tqe = ((tx_queue_element*)(queue_free.first));
-		dl_entry_remove(&queue_free,queue_free.first);
-		((tx_queue_buffer*)(tqe->data))->metadata.metadata_type = QUEUE_METADATA_TYPE_IGNORE;
-		return tqe;
-	} else {
-		return NULL;
+	queue_active_bitmap[queue_sel >> 5] &= ~(1 << (queue_sel & 0x1F));
+	num_queue_active--;
+	info->deficit = 0;
+
+	for(i = 0; i < QUEUE_NUM_AC; i++){
+		info->ac_credit[i] = ac_weight[i];
 	}
 }
 
 /**
- * @brief Checks out one queue entry from the free pool
- *
- * The queue framework maintains a pool of free queue entries. This function returns one entry
- * to the free pool. tqe must be a valid pointer to a queue entry which the MAC application no
- * longer needs. The application must not use the entry pointed to by tqe after calling this function.
+ * @brief Unlinks the head entry of one access category of a non-empty queue
  *
- * @param tx_queue_element* tqe Pointer to queue entry to be returned to free pool
+ * Keeps the queue's length, byte count and active bitmap bit in sync with the removal. The queue's DRR
+ * deficit is not charged, since the entry is not being sent.
  *
- * @return New queue entry, NULL if none is available
+ * @param u16 queue_sel
+ *  -ID of the queue
+ * @param u32 ac
+ *  -Access category holding at least one entry
+ * @return
+ *  -Pointer to the removed queue entry
  */
-void queue_checkin(tx_queue_element* tqe){
-	dl_entry_insertEnd(&queue_free,(dl_entry*)tqe);
-	return;
-}
+static tx_queue_element* queue_unlink_head(u16 queue_sel, u32 ac){
+	tx_queue_element* tqe;
+
+	tqe = queue_element_at(queue_tx[queue_sel].ac[ac].first);
+
+	queue_list_remove(&(queue_tx[queue_sel].ac[ac]), tqe);
+	queue_tx[queue_sel].length--;
+
+	queue_info[queue_sel].num_bytes -= queue_element_buffer(tqe)->frame_info.length;
 
+	if(queue_tx[queue_sel].length == 0){
+		queue_deactivate(queue_sel);
+	}
+
+	return tqe;
+}
 
 /**
- * @brief Checks out multiple queue entries from the free pool
+ * @brief Removes the head entry of one access category of a non-empty queue
  *
- * The queue framework maintains a pool of free queue entries. This function attempts to check out
- * num_tqe queue entries from the free pool. The number of queue entries successfully checked out
- * is returned. This may be less than requested if the free pool had fewer than num_tqe entries
- * available.
+ * Charges the entry's bytes against the queue's DRR deficit, then unlinks it with queue_unlink_head().
  *
- * @param dl_list* new_list Pointer to doubly linked list to which new queue entries are appended.
- * @param u16 num_tqe Number of queue entries requested
- *
- * @return Number of queue entries successfully checked out and appended to new_list
+ * @param u16 queue_sel
+ *  -ID of the queue
+ * @param u32 ac
+ *  -Access category holding at least one entry
+ * @return
+ *  -Pointer to the removed queue entry
  */
-int queue_checkout_list(dl_list* new_list, u16 num_tqe){
-	//Checks out up to num_packet_bd number of packet_bds from the free list. If num_packet_bd are not free,
-	//then this function will return the number that are free and only check out that many.
+static tx_queue_element* queue_remove_head(u16 queue_sel, u32 ac){
+	tx_queue_info* info;
+	u16 length;
 
-	u32 i,num_checkout;
-	dl_entry* curr_dl_entry;
+	info   = &(queue_info[queue_sel]);
+	length = queue_element_buffer(queue_element_at(queue_tx[queue_sel].ac[ac].first))->frame_info.length;
 
-	if(num_tqe <= queue_free.length){
-		num_checkout = num_tqe;
+	//Charge the dequeued bytes against the queue's DRR deficit
+	if(info->deficit > length){
+		info->deficit -= length;
 	} else {
-		num_checkout = queue_free.length;
+		info->deficit = 0;
+	}
+
+	return queue_unlink_head(queue_sel, ac);
+}
+
+/**
+ * @brief Applies the free pool sharing policy to a packet arriving at a queue
+ *
+ * A queue may hold at most share_alpha/8 times the number of free queue entries (and never fewer than
+ * QUEUE_SHARE_MIN_ENTRIES). As the pool drains the cap falls, so the queues that are growing are
+ * stopped while the rest of the pool stays available to other queues. If the pool still falls below
+ * share_reserve free entries, the longest queue gives up an entry: its lowest priority head entry is
+ * dropped, or, if queue_sel is itself the longest queue, the arriving packet is refused.
+ *
+ * @param u16 queue_sel
+ *  -ID of the queue the packet is being added to
+ * @return int
+ *  -1 if the packet may be enqueued, 0 if it must be refused
+ */
+static int queue_share_admit(u16 queue_sel){
+	u32 i;
+	u32 num_free;
+	u32 longest;
+	tx_queue_element* tqe;
+
+	if(share_alpha == QUEUE_SHARE_ALPHA_DISABLED){
+		return 1;
 	}
 
-	//Traverse the queue_free and update the pointers
-	for (i=0;i<num_checkout;i++){
-		curr_dl_entry = (queue_free.first);
+	//The cap and reserve apply to the whole free pool, including the small and medium size classes
+	num_free = queue_num_free_sized(0);
 
-		//Remove from free list
-		dl_entry_remove(&queue_free,curr_dl_entry);
-		//Add to new checkout list
-		dl_entry_insertEnd(new_list,curr_dl_entry);
+	if(queue_tx[queue_sel].length >= max((share_alpha * num_free) >> 3, QUEUE_SHARE_MIN_ENTRIES)){
+		return 0;
 	}
-	return num_checkout;
-}
 
+	if(num_free >= share_reserve){
+		//End of the drop episode; queues no longer need to be tracked as they grow
+		share_longest = QUEUE_SEL_NONE;
+	} else {
+		longest = queue_share_longest();
+
+		if(longest == QUEUE_SEL_NONE){
+			return 1;
+		}
+
+		if(queue_tx[longest].length <= queue_tx[queue_sel].length){
+			return 0;
+		}
+
+		for(i = QUEUE_NUM_AC; i > 0; i--){
+			if(queue_tx[longest].ac[ac_priority[i-1]].length > 0){
+				tqe = queue_unlink_head(longest, ac_priority[i-1]);
+				queue_info[longest].num_share_drops++;
+				queue_checkin(tqe);
+				break;
+			}
+		}
+	}
 
+	return 1;
+}
 
 /**
- * @brief Dequeues one packet and submits it the lower MAC for wireless transmission
- *
- * This function is the link between the Tx queue framework and the lower-level MAC. The calling
- * function has determined the next wireless transmission should come from the queue with ID queue_sel.
- * This function attempts to checkout 1 packet from that queue. If a packet is available it is
- * passed to wlan_mac_high_mpdu_transmit(), which handles the actual copy-to-pkt-buf and Tx process.
- *
- * When a packet is successfully de-queued and submitted for transmission the corresponding queue entry
- * (tx_queue_element) is returned to the free pool.
+ * @return Total number of queue entries; sum of all free and occupied entries
+ */
+int queue_total_size(){
+	return num_tx_queue;
+}
+
+/**
+ * @brief Flushes the contents of the selected queue
  *
- * This function returns 0 if no packets are available in the requested queue or if the MAC state machine
- * is not ready to submit a new packet to the lower MAC for transmission.
+ * Purges all entries from the selected queue and returns them to the free pool. Packets contained
+ * in the purged entries will be dropped. This function should only be called when enqueued packets
+ * should no longer be transmitted wirelessly, such as when a node leaves a BSS.
  *
- * @param u16 queue_sel Queue ID from which to dequeue packet
+ * Interrupts are only disabled while the queue's lists are detached and while the purged entries are
+ * spliced onto the free lists, both of which take constant time. The purged entries are sorted by size
+ * class in between, when they are no longer reachable from any queue.
  *
- * @return Number of successfully transmitted packets (0 or 1)
+ * @param u16 queue_sel
+ *  -ID of the queue to purge
  */
-inline int dequeue_transmit_checkin(u16 queue_sel){
-	int return_value = 0;
-	int tx_pkt_buf = -1;
+void purge_queue(u16 queue_sel){
+	u32               i;
+	u16               next;
+	tx_queue_list     purged;
+	tx_queue_list     purged_class[QUEUE_NUM_SIZE_CLASSES];
 	tx_queue_element* curr_tx_queue_element;
+	tx_queue_info*    info;
+	interrupt_state_t prev_interrupt_state;
 
-	tx_pkt_buf = wlan_mac_high_lock_new_tx_packet_buffer();
+	queue_list_init(&purged);
 
-	if(tx_pkt_buf != -1){
-		curr_tx_queue_element = dequeue_from_head(queue_sel);
+	// Detaching the queue is not interrupt safe
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
 
-		if(curr_tx_queue_element != NULL){
-			return_value = 1;
-			wlan_mac_high_mpdu_transmit(curr_tx_queue_element, tx_pkt_buf);
-			queue_checkin(curr_tx_queue_element);
-			wlan_eth_dma_update();
-		} else {
-			wlan_mac_high_release_tx_packet_buffer(tx_pkt_buf);
+	if(queue_num_queued(queue_sel) > 0){
+		for(i = 0; i < QUEUE_NUM_AC; i++){
+			queue_list_concat(&purged, &(queue_tx[queue_sel].ac[i]));
 		}
+		queue_tx[queue_sel].length = 0;
+
+		info                       = &(queue_info[queue_sel]);
+		info->num_bytes            = 0;
+		info->aqm_dropping         = 0;
+		info->aqm_first_above_time = 0;
+
+		queue_deactivate(queue_sel);
 	}
-	return return_value;
+
+	// Packets from this queue that are still with CPU Low must not be re-enqueued
+	for(i = 0; i < NUM_TX_PKT_BUFS; i++){
+		if((tx_pending[i].tqe != NULL) && (tx_pending[i].queue_sel == queue_sel)){
+			queue_list_insert_end(&purged, tx_pending[i].tqe);
+			tx_pending[i].tqe    = NULL;
+			tx_pending[i].purged = 1;
+		}
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	if(purged.length == 0){
+		return;
+	}
+
+	wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_queue, "Purging %d packets from queue %d\n", purged.length, queue_sel);
+
+	for(i = 0; i < QUEUE_NUM_SIZE_CLASSES; i++){
+		queue_list_init(&(purged_class[i]));
+	}
+
+	next = purged.first;
+
+	while(next != QUEUE_INDEX_NONE){
+		curr_tx_queue_element = queue_element_at(next);
+		next                  = curr_tx_queue_element->next;
+
+		queue_list_insert_end(&(purged_class[queue_size_class_of(curr_tx_queue_element)]), curr_tx_queue_element);
+	}
+
+	// Returning the entries to the free pool is not interrupt safe
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	for(i = 0; i < QUEUE_NUM_SIZE_CLASSES; i++){
+		queue_list_concat(&(size_class[i].free), &(purged_class[i]));
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+}
+
+/**
+ * @brief Adds a queue entry to a specified queue
+ *
+ * Adds the queue entry pointed to by tqe to the queue with ID queue_sel. The calling context must ensure
+ * tqe points to a queue entry containing a packet ready for wireless transmission. If a queue with ID quele_sel
+ * does not already exist this function will create it, then add tqe to the new queue.
+ *
+ * The entry is added to the sub-queue of the access category recorded in its metadata (see
+ * tx_queue_metadata.ac). Entries that have not been classified are treated as best effort.
+ *
+ * The packet is refused if the queue already holds its share of the free pool (see
+ * queue_share_config()). A refused entry is returned to the free pool, so the caller must not use
+ * tqe after this function returns, whatever the result.
+ *
+ * @param u16 queue_sel
+ *  -ID of the queue to which tqe is added. A new queue with ID queue_sel will be created if it does not already exist.
+ * @param tx_queue_element* tqe
+ *  -Queue entry containing packet for transmission
+ * @return int
+ *  -0 if the packet was enqueued, -1 if it was refused
+ */
+int enqueue_after_tail(u16 queue_sel, tx_queue_element* tqe){
+	tx_queue_buffer* buffer;
+
+	//Create queues up to and including queue_sel if they don't already exist
+	if(queue_create(queue_sel) != 0){
+		queue_checkin(tqe);
+		return -1;
+	}
+
+	if(queue_share_admit(queue_sel) == 0){
+		queue_info[queue_sel].num_share_drops++;
+		queue_checkin(tqe);
+		return -1;
+	}
+
+	buffer = queue_element_buffer(tqe);
+
+	if(buffer->metadata.ac >= QUEUE_NUM_AC){
+		buffer->metadata.ac = QUEUE_AC_BE;
+	}
+
+	//Insert the queue entry into the list representing the selected queue and access category
+	queue_list_insert_end(&(queue_tx[queue_sel].ac[buffer->metadata.ac]), tqe);
+	queue_tx[queue_sel].length++;
+	queue_info[queue_sel].num_bytes += buffer->frame_info.length;
+	queue_share_grow(queue_sel);
+
+	//Mark the queue as active on its empty -> non-empty transition
+	if(queue_tx[queue_sel].length == 1){
+		queue_active_bitmap[queue_sel >> 5] |= (1 << (queue_sel & 0x1F));
+		num_queue_active++;
+	}
+
+	tx_poll_callback();
+
+	return 0;
+}
+
+/**
+ * @brief Adds a queue entry to the head of a specified queue
+ *
+ * Used to return a packet that could not be delivered to the front of its queue so that it is the next
+ * packet of its access category to be transmitted. Unlike enqueue_after_tail(), the packet is not
+ * subject to the free pool share, as it was already admitted when first enqueued, and the tx poll
+ * callback is not called.
+ *
+ * @param u16 queue_sel
+ *  -ID of the queue to which tqe is added. A new queue with ID queue_sel will be created if it does not already exist.
+ * @param tx_queue_element* tqe
+ *  -Queue entry containing packet for transmission
+ * @return int
+ *  -0 if the packet was enqueued, -1 if it was refused
+ */
+int enqueue_before_head(u16 queue_sel, tx_queue_element* tqe){
+	tx_queue_buffer* buffer;
+
+	if(queue_create(queue_sel) != 0){
+		queue_checkin(tqe);
+		return -1;
+	}
+
+	buffer = queue_element_buffer(tqe);
+
+	if(buffer->metadata.ac >= QUEUE_NUM_AC){
+		buffer->metadata.ac = QUEUE_AC_BE;
+	}
+
+	queue_list_insert_beginning(&(queue_tx[queue_sel].ac[buffer->metadata.ac]), tqe);
+	queue_tx[queue_sel].length++;
+	queue_info[queue_sel].num_bytes += buffer->frame_info.length;
+	queue_share_grow(queue_sel);
+
+	if(queue_tx[queue_sel].length == 1){
+		queue_active_bitmap[queue_sel >> 5] |= (1 << (queue_sel & 0x1F));
+		num_queue_active++;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Removes the head entry from the specified queue
+ *
+ * If queue_sel is not empty this function returns a tx_queue_element pointer for the head
+ * entry in the queue. If the specified queue is empty this function returns NULL.
+ *
+ * The entry is taken from the access category chosen by queue_select_ac(), according to the
+ * mode set with queue_ac_sched_config().
+ *
+ * @param u16 queue_sel
+ *  -ID of the queue from which to dequeue an entry
+ * @return
+ *  -Pointer to queue entry if available, NULL if queue is empty
+ */
+tx_queue_element* dequeue_from_head(u16 queue_sel){
+	tx_queue_info* info;
+	u32 ac;
+	u32 i;
+
+	if((queue_sel+1) > num_queue_tx){
+		//The specified queue does not exist; this can happen if a node has associated (has a valid AID=queue_sel)
+		// but no packet has ever been enqueued to it, as queues are created upon first insertion - see enqueue_after_tail()
+		return NULL;
+	} else {
+		if(queue_tx[queue_sel].length == 0){
+			//Requested queue exists but is empty
+			return NULL;
+		} else {
+			info = &(queue_info[queue_sel]);
+			ac   = queue_select_ac(queue_sel);
+
+			if(ac_sched_mode == QUEUE_AC_SCHED_WEIGHTED){
+				//Every backlogged AC has used its credit; start a new round
+				if(info->ac_credit[ac] == 0){
+					for(i = 0; i < QUEUE_NUM_AC; i++){
+						info->ac_credit[i] = ac_weight[i];
+					}
+				}
+				info->ac_credit[ac]--;
+			}
+
+			return queue_remove_head(queue_sel, ac);
+		}
+	}
+}
+
+/**
+ * @return Number of queue entries in the free pool that queue_checkout() can return (entries with a full
+ *         QUEUE_BUFFER_SIZE buffer). Use queue_num_free_sized() to count entries of smaller size classes.
+ */
+u32 queue_num_free(){
+	return queue_num_free_sized(QUEUE_BUFFER_FRAME_SIZE(QUEUE_BUFFER_SIZE));
+}
+
+/**
+ * @param u32 length Number of frame bytes the queue entries must be able to hold
+ * @return Number of queue entries in the free pool whose buffers can hold length bytes; a length of 0
+ *         counts the entries of every size class
+ */
+u32 queue_num_free_sized(u32 length){
+	u32 i;
+	u32 num_free = 0;
+
+	for(i = 0; i < QUEUE_NUM_SIZE_CLASSES; i++){
+		if(QUEUE_BUFFER_FRAME_SIZE(size_class[i].buffer_size) >= length){
+			num_free += size_class[i].free.length;
+		}
+	}
+	return num_free;
+}
+
+/**
+ * @param u16 queue_sel ID of queue
+ * @return Number of entries in the specified queue
+ */
+u32 queue_num_queued(u16 queue_sel){
+	if((queue_sel+1) > num_queue_tx){
+		return 0;
+	} else {
+		return queue_tx[queue_sel].length;
+	}
+}
+
+/**
+ * @param u16 queue_sel ID of queue
+ * @param u8 ac Access category (QUEUE_AC_*)
+ * @return Number of entries in the specified queue's sub-queue for ac
+ */
+u32 queue_num_queued_ac(u16 queue_sel, u8 ac){
+	if(((queue_sel+1) > num_queue_tx) || (ac >= QUEUE_NUM_AC)){
+		return 0;
+	} else {
+		return queue_tx[queue_sel].ac[ac].length;
+	}
+}
+
+/**
+ * @return Number of non-empty queues
+ */
+u32 queue_num_active(){
+	return num_queue_active;
+}
+
+/**
+ * @brief Sets the deficit round robin quantum of a queue
+ *
+ * The quantum is the number of bytes credited to a queue each time the DRR scheduler visits it.
+ * Queues with a larger quantum receive a proportionally larger share of the transmitted bytes when
+ * several queues are backlogged. For the selection in queue_drr_select() to complete in a single
+ * round, the quantum should be at least as large as the largest MPDU. The queue is created if it
+ * does not already exist.
+ *
+ * @param u16 queue_sel
+ *  -ID of the queue
+ * @param u32 quantum
+ *  -Number of bytes credited per DRR round (values below QUEUE_DRR_QUANTUM_MIN are raised to it)
+ */
+void queue_set_drr_quantum(u16 queue_sel, u32 quantum){
+	if(queue_create(queue_sel) != 0){
+		return;
+	}
+
+	queue_info[queue_sel].quantum = max(quantum, QUEUE_DRR_QUANTUM_MIN);
+}
+
+/**
+ * @brief Selects the next queue to service using byte-weighted deficit round robin
+ *
+ * The queue holding the DRR turn keeps it for as long as its deficit covers the length of its head
+ * packet. Otherwise the turn moves to the next non-empty queue (found via the active queue bitmap),
+ * which is credited with its quantum. Deficits are charged when a packet is removed by
+ * dequeue_from_head(), so the caller should dequeue from the returned queue before selecting again.
+ *
+ * @return u32
+ *  -ID of the queue to service, QUEUE_SEL_NONE if all queues are empty
+ */
+u32 queue_drr_select(){
+	u32 queue_sel;
+	u16 length;
+
+	if(num_queue_active == 0){
+		return QUEUE_SEL_NONE;
+	}
+
+	queue_sel = drr_cursor;
+
+	//If the queue holding the turn has emptied, pass the turn on
+	if((queue_sel >= num_queue_tx) || (queue_tx[queue_sel].length == 0)){
+		queue_sel = queue_find_next_active(queue_sel + 1);
+		queue_info[queue_sel].deficit += queue_info[queue_sel].quantum;
+	}
+
+	while(1){
+		length = queue_element_buffer(queue_head(queue_sel))->frame_info.length;
+
+		if(queue_info[queue_sel].deficit >= length){
+			break;
+		}
+
+		queue_sel = queue_find_next_active(queue_sel + 1);
+		queue_info[queue_sel].deficit += queue_info[queue_sel].quantum;
+	}
+
+	drr_cursor = queue_sel;
+
+	return queue_sel;
+}
+
+/**
+ * @brief Configures how each queue divides its service between access categories
+ *
+ * @param u32 mode
+ *  -QUEUE_AC_SCHED_STRICT or QUEUE_AC_SCHED_WEIGHTED
+ * @param u8* weights
+ *  -Array of QUEUE_NUM_AC weights indexed by access category, used in QUEUE_AC_SCHED_WEIGHTED mode.
+ *   A weight is the number of packets the AC may send per round while other ACs are backlogged.
+ *   NULL keeps the current weights.
+ * @return int
+ *  -0 on success, -1 if a parameter is invalid
+ */
+int queue_ac_sched_config(u32 mode, u8* weights){
+	u32 i, j;
+
+	if(mode > QUEUE_AC_SCHED_WEIGHTED){
+		return -1;
+	}
+
+	if(weights != NULL){
+		for(i = 0; i < QUEUE_NUM_AC; i++){
+			if(weights[i] == 0){
+				return -1;
+			}
+		}
+		memcpy(ac_weight, weights, QUEUE_NUM_AC);
+	}
+
+	ac_sched_mode = mode;
+
+	for(i = 0; i < num_queue_tx; i++){
+		for(j = 0; j < QUEUE_NUM_AC; j++){
+			queue_info[i].ac_credit[j] = ac_weight[j];
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @return Current access category scheduling mode
+ */
+u32 queue_ac_sched_get_mode(){
+	return ac_sched_mode;
+}
+
+/**
+ * @brief Configures how the free pool is shared between queues
+ *
+ * @param u32 alpha
+ *  -Maximum queue length as a multiple of the number of free entries, in 1/8 units;
+ *   QUEUE_SHARE_ALPHA_DISABLED lets any queue use the whole pool
+ * @param u32 reserve
+ *  -Number of free entries below which the longest queue is head-dropped
+ * @return int
+ *  -0 on success, -1 if a parameter is invalid
+ */
+int queue_share_config(u32 alpha, u32 reserve){
+	if((alpha > (0xFFFFFFFF / num_tx_queue)) || (reserve > num_tx_queue)){
+		return -1;
+	}
+
+	share_alpha   = alpha;
+	share_reserve = reserve;
+	share_longest = QUEUE_SEL_NONE;
+
+	return 0;
+}
+
+/**
+ * @return Current free pool sharing alpha (1/8 units)
+ */
+u32 queue_share_get_alpha(){
+	return share_alpha;
+}
+
+/**
+ * @return Current free pool reserve (entries)
+ */
+u32 queue_share_get_reserve(){
+	return share_reserve;
+}
+
+/**
+ * @return Number of entries a queue may currently hold, given the number of free entries
+ */
+u32 queue_share_get_cap(){
+	if(share_alpha == QUEUE_SHARE_ALPHA_DISABLED){
+		return num_tx_queue;
+	}
+	return max((share_alpha * queue_num_free_sized(0)) >> 3, QUEUE_SHARE_MIN_ENTRIES);
+}
+
+/**
+ * @brief Configures high-level retry of failed transmissions
+ *
+ * @param u32 max_retries
+ *  -Number of times a packet may be re-enqueued after CPU Low reports a failed transmission;
+ *   QUEUE_RETRY_MAX_DISABLED returns queue entries to the free pool as soon as they are transmitted
+ * @param u32 age_limit
+ *  -Packets created more than this many usec ago are dropped instead of re-enqueued
+ * @return int
+ *  -0 on success, -1 if a parameter is invalid
+ */
+int queue_retry_config(u32 max_retries, u32 age_limit){
+	if(max_retries > 0xFF){
+		return -1;
+	}
+
+	retry_max       = max_retries;
+	retry_age_limit = age_limit;
+
+	return 0;
+}
+
+/**
+ * @return Current number of re-enqueues allowed per packet
+ */
+u32 queue_retry_get_max(){
+	return retry_max;
+}
+
+/**
+ * @return Current retry age limit (usec)
+ */
+u32 queue_retry_get_age_limit(){
+	return retry_age_limit;
+}
+
+/**
+ * @brief Handles the result of a transmission submitted by dequeue_transmit_checkin()
+ *
+ * Must be called when CPU Low reports that the packet in tx_pkt_buf is done, before the MAC
+ * application's tx done callback. If the transmission failed and the packet still has retry budget
+ * and is younger than the age limit, its queue entry is re-enqueued at the head of its queue.
+ * Otherwise, or if its queue was purged, no longer exists or cannot take the entry back, the
+ * packet is dropped and its entry returned to the free pool. The outcome is written to
+ * tx_mpdu->high_retry_status so it can be recorded in statistics and the event log.
+ *
+ * @param int tx_pkt_buf
+ *  -Tx packet buffer reported done by CPU Low
+ * @param tx_frame_info* tx_mpdu
+ *  -Frame info in the Tx packet buffer
+ */
+void queue_tx_done(int tx_pkt_buf, tx_frame_info* tx_mpdu){
+	tx_queue_element* tqe;
+	tx_queue_buffer*  buffer;
+	u16               queue_sel;
+
+	tx_mpdu->high_retry_status = TX_HIGH_RETRY_NONE;
+
+	tqe       = tx_pending[tx_pkt_buf].tqe;
+	queue_sel = tx_pending[tx_pkt_buf].queue_sel;
+
+	if(tqe == NULL){
+		//purge_queue() has already freed the entry of a packet from a purged queue
+		if(tx_pending[tx_pkt_buf].purged && (tx_mpdu->tx_result == TX_MPDU_RESULT_FAILURE)){
+			tx_mpdu->high_retry_status = TX_HIGH_RETRY_DROPPED;
+		}
+		tx_pending[tx_pkt_buf].purged = 0;
+		return;
+	}
+
+	tx_pending[tx_pkt_buf].tqe = NULL;
+
+	if(tx_mpdu->tx_result == TX_MPDU_RESULT_FAILURE){
+		buffer = queue_element_buffer(tqe);
+
+		if(buffer->frame_info.high_retry_count >= retry_max){
+			tx_mpdu->high_retry_status = TX_HIGH_RETRY_EXHAUSTED;
+		} else if((get_usec_timestamp() - buffer->frame_info.timestamp_create) > retry_age_limit){
+			tx_mpdu->high_retry_status = TX_HIGH_RETRY_EXPIRED;
+		} else if(queue_sel >= num_queue_tx){
+			//Never re-create a queue for a packet that was in flight when its queue went away
+			tx_mpdu->high_retry_status = TX_HIGH_RETRY_DROPPED;
+		} else {
+			buffer->frame_info.high_retry_count++;
+
+			if(enqueue_before_head(queue_sel, tqe) == 0){
+				tx_mpdu->high_retry_status = TX_HIGH_RETRY_REQUEUED;
+				return;
+			}
+
+			//enqueue_before_head() has already returned the entry to the free pool
+			tx_mpdu->high_retry_status = TX_HIGH_RETRY_DROPPED;
+			wlan_eth_dma_update();
+			return;
+		}
+	}
+
+	queue_checkin(tqe);
+	wlan_eth_dma_update();
+}
+
+/**
+ * @brief Returns the size class of a queue entry
+ *
+ * @param tx_queue_element* tqe Pointer to queue entry
+ * @return Index into size_class of the class owning the entry
+ */
+static u32 queue_size_class_of(tx_queue_element* tqe){
+	u32 i;
+	u32 index = queue_element_index(tqe);
+
+	for(i = 0; i < (QUEUE_NUM_SIZE_CLASSES - 1); i++){
+		if(index < (size_class[i].first_index + size_class[i].num_total)){
+			break;
+		}
+	}
+	return i;
+}
+
+/**
+ * @brief Returns the buffer described by a queue entry
+ *
+ * Queue entries do not store a pointer to their buffer; the buffer address is computed from the
+ * entry's index within its size class.
+ *
+ * @param tx_queue_element* tqe Pointer to queue entry
+ * @return Pointer to the entry's tx_queue_buffer in DRAM
+ */
+tx_queue_buffer* queue_element_buffer(tx_queue_element* tqe){
+	queue_size_class* sc = &(size_class[queue_size_class_of(tqe)]);
+
+	return (tx_queue_buffer*)(sc->base + ((queue_element_index(tqe) - sc->first_index) * sc->buffer_size));
+}
+
+/**
+ * @param tx_queue_element* tqe Pointer to queue entry
+ * @return Next entry in the list holding tqe, NULL if tqe is the last entry
+ */
+tx_queue_element* queue_element_next(tx_queue_element* tqe){
+	if(tqe->next == QUEUE_INDEX_NONE){
+		return NULL;
+	}
+	return queue_element_at(tqe->next);
+}
+
+/**
+ * @param tx_queue_list* list Pointer to list
+ * @return First entry in the list, NULL if the list is empty
+ */
+tx_queue_element* queue_list_first(tx_queue_list* list){
+	if(list->length == 0){
+		return NULL;
+	}
+	return queue_element_at(list->first);
+}
+
+/**
+ * @brief Initializes an empty list of queue entries
+ *
+ * @param tx_queue_list* list Pointer to list
+ */
+void queue_list_init(tx_queue_list* list){
+	list->first  = QUEUE_INDEX_NONE;
+	list->last   = QUEUE_INDEX_NONE;
+	list->length = 0;
+}
+
+/**
+ * @brief Appends a queue entry to the end of a list
+ *
+ * @param tx_queue_list* list Pointer to list
+ * @param tx_queue_element* tqe Pointer to queue entry, which must not be a member of any list
+ */
+static void queue_list_insert_end(tx_queue_list* list, tx_queue_element* tqe){
+	u16 index = queue_element_index(tqe);
+
+	tqe->next = QUEUE_INDEX_NONE;
+	tqe->prev = list->last;
+
+	if(list->length == 0){
+		list->first = index;
+	} else {
+		queue_element_at(list->last)->next = index;
+	}
+
+	list->last = index;
+	list->length++;
+}
+
+/**
+ * @brief Prepends a queue entry to the beginning of a list
+ *
+ * @param tx_queue_list* list Pointer to list
+ * @param tx_queue_element* tqe Pointer to queue entry, which must not be a member of any list
+ */
+static void queue_list_insert_beginning(tx_queue_list* list, tx_queue_element* tqe){
+	u16 index = queue_element_index(tqe);
+
+	tqe->prev = QUEUE_INDEX_NONE;
+	tqe->next = list->first;
+
+	if(list->length == 0){
+		list->last = index;
+	} else {
+		queue_element_at(list->first)->prev = index;
+	}
+
+	list->first = index;
+	list->length++;
+}
+
+/**
+ * @brief Removes a queue entry from a list
+ *
+ * @param tx_queue_list* list Pointer to list
+ * @param tx_queue_element* tqe Pointer to queue entry, which must be a member of list
+ */
+static void queue_list_remove(tx_queue_list* list, tx_queue_element* tqe){
+	if(tqe->prev == QUEUE_INDEX_NONE){
+		list->first = tqe->next;
+	} else {
+		queue_element_at(tqe->prev)->next = tqe->next;
+	}
+
+	if(tqe->next == QUEUE_INDEX_NONE){
+		list->last = tqe->prev;
+	} else {
+		queue_element_at(tqe->next)->prev = tqe->prev;
+	}
+
+	list->length--;
+}
+
+/**
+ * @brief Moves every entry of a list to the end of another list
+ *
+ * Takes constant time. list_src is left empty.
+ *
+ * @param tx_queue_list* list Pointer to destination list
+ * @param tx_queue_list* list_src Pointer to source list
+ */
+static void queue_list_concat(tx_queue_list* list, tx_queue_list* list_src){
+	if(list_src->length == 0){
+		return;
+	}
+
+	if(list->length == 0){
+		list->first = list_src->first;
+	} else {
+		queue_element_at(list->last)->next     = list_src->first;
+		queue_element_at(list_src->first)->prev = list->last;
+	}
+	list->last    = list_src->last;
+	list->length += list_src->length;
+
+	queue_list_init(list_src);
+}
+
+/**
+ * @brief Moves the first entries of a list to the end of another list
+ *
+ * Only the entries at either side of the cut are relinked. Finding the cut walks from whichever end
+ * of list_src is closer to it.
+ *
+ * @param tx_queue_list* list Pointer to destination list
+ * @param tx_queue_list* list_src Pointer to source list
+ * @param u32 num_tqe Number of entries to move
+ * @return Number of entries moved; less than num_tqe if list_src is shorter
+ */
+static u32 queue_list_move_first(tx_queue_list* list, tx_queue_list* list_src, u32 num_tqe){
+	u32 i;
+	u16 last_moved;
+	u16 first_kept;
+
+	if(num_tqe >= list_src->length){
+		num_tqe = list_src->length;
+		queue_list_concat(list, list_src);
+		return num_tqe;
+	}
+
+	if(num_tqe == 0){
+		return 0;
+	}
+
+	if(num_tqe <= (list_src->length / 2)){
+		last_moved = list_src->first;
+		for(i = 1; i < num_tqe; i++){
+			last_moved = queue_element_at(last_moved)->next;
+		}
+		first_kept = queue_element_at(last_moved)->next;
+	} else {
+		first_kept = list_src->last;
+		for(i = 1; i < (list_src->length - num_tqe); i++){
+			first_kept = queue_element_at(first_kept)->prev;
+		}
+		last_moved = queue_element_at(first_kept)->prev;
+	}
+
+	if(list->length == 0){
+		list->first = list_src->first;
+	} else {
+		queue_element_at(list->last)->next      = list_src->first;
+		queue_element_at(list_src->first)->prev = list->last;
+	}
+	list->last                          = last_moved;
+	queue_element_at(last_moved)->next  = QUEUE_INDEX_NONE;
+	list->length                       += num_tqe;
+
+	list_src->first                     = first_kept;
+	queue_element_at(first_kept)->prev  = QUEUE_INDEX_NONE;
+	list_src->length                   -= num_tqe;
+
+	return num_tqe;
+}
+
+/**
+ * @brief Checks out one queue entry from the free pool
+ *
+ * The queue framework maintains a pool of free queue entries. This function removes one entry
+ * from the free pool and returns it for use by the MAC application. If the free pool is empty
+ * NULL is returned.
+ *
+ * The returned entry always has a full QUEUE_BUFFER_SIZE buffer. Callers that know the length of
+ * the frame they are about to build should use queue_checkout_sized() instead.
+ *
+ * @return New queue entry, NULL if none is available
+ */
+tx_queue_element* queue_checkout(){
+	return queue_checkout_sized(QUEUE_BUFFER_FRAME_SIZE(QUEUE_BUFFER_SIZE));
+}
+
+/**
+ * @brief Checks out one queue entry able to hold a frame of the given length
+ *
+ * The entry is taken from the smallest size class whose buffers can hold length frame bytes. If
+ * that class has no free entries, the next larger class is tried. If no suitable entry is free
+ * NULL is returned.
+ *
+ * @param u32 length Number of bytes that will be written to the entry's frame buffer
+ *
+ * @return New queue entry, NULL if none is available
+ */
+tx_queue_element* queue_checkout_sized(u32 length){
+	u32 i;
+	tx_queue_element* tqe;
+
+	for(i = 0; i < QUEUE_NUM_SIZE_CLASSES; i++){
+		if((QUEUE_BUFFER_FRAME_SIZE(size_class[i].buffer_size) >= length) && (size_class[i].free.length > 0)){
+			tqe = queue_element_at(size_class[i].free.first);
+			queue_list_remove(&(size_class[i].free), tqe);
+			queue_element_buffer(tqe)->metadata.metadata_type = QUEUE_METADATA_TYPE_IGNORE;
+			queue_element_buffer(tqe)->metadata.ac            = QUEUE_AC_BE;
+			return tqe;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Checks out one queue entry from the free pool
+ *
+ * The queue framework maintains a pool of free queue entries. This function returns one entry
+ * to the free pool. tqe must be a valid pointer to a queue entry which the MAC application no
+ * longer needs. The application must not use the entry pointed to by tqe after calling this function.
+ *
+ * @param tx_queue_element* tqe Pointer to queue entry to be returned to free pool
+ *
+ * @return New queue entry, NULL if none is available
+ */
+void queue_checkin(tx_queue_element* tqe){
+	queue_list_insert_end(&(size_class[queue_size_class_of(tqe)].free), tqe);
+	return;
+}
+
+/**
+ * @param tx_queue_element* tqe Pointer to queue entry
+ * @return Number of bytes available in the entry's frame buffer
+ */
+u32 queue_frame_capacity(tx_queue_element* tqe){
+	return QUEUE_BUFFER_FRAME_SIZE(size_class[queue_size_class_of(tqe)].buffer_size);
+}
+
+/**
+ * @brief Moves a packet into the smallest queue entry that can hold it
+ *
+ * Packets whose final length is only known after they have been written to a queue entry (such as
+ * Ethernet receptions, whose DMA buffers must be sized for the largest frame) can be moved into a
+ * smaller size class with this function. If a smaller, free entry is available the queue metadata,
+ * frame info and the first length frame bytes are copied into it and tqe is returned to the free
+ * pool. Otherwise tqe is returned unchanged.
+ *
+ * @param tx_queue_element* tqe Pointer to queue entry holding the packet
+ * @param u32 length Number of valid bytes in the entry's frame buffer
+ *
+ * @return Queue entry now holding the packet
+ */
+tx_queue_element* queue_downsize(tx_queue_element* tqe, u32 length){
+	u32 i;
+	u32 curr_class;
+	tx_queue_element* new_tqe;
+
+	curr_class = queue_size_class_of(tqe);
+
+	for(i = 0; i < curr_class; i++){
+		if((QUEUE_BUFFER_FRAME_SIZE(size_class[i].buffer_size) >= length) && (size_class[i].free.length > 0)){
+			new_tqe = queue_element_at(size_class[i].free.first);
+			queue_list_remove(&(size_class[i].free), new_tqe);
+
+			memcpy(queue_element_buffer(new_tqe), queue_element_buffer(tqe), QUEUE_BUFFER_HDR_SIZE + length);
+
+			queue_list_insert_end(&(size_class[curr_class].free), tqe);
+			return new_tqe;
+		}
+	}
+	return tqe;
+}
+
+
+/**
+ * @brief Checks out multiple queue entries from the free pool
+ *
+ * The queue framework maintains a pool of free queue entries. This function attempts to check out
+ * num_tqe queue entries from the free pool. The number of queue entries successfully checked out
+ * is returned. This may be less than requested if the free pool had fewer than num_tqe entries
+ * available.
+ *
+ * The returned entries always have full QUEUE_BUFFER_SIZE buffers. See queue_checkout_list_sized().
+ *
+ * @param tx_queue_list* new_list Pointer to list to which new queue entries are appended.
+ * @param u16 num_tqe Number of queue entries requested
+ *
+ * @return Number of queue entries successfully checked out and appended to new_list
+ */
+int queue_checkout_list(tx_queue_list* new_list, u16 num_tqe){
+	return queue_checkout_list_sized(new_list, num_tqe, QUEUE_BUFFER_FRAME_SIZE(QUEUE_BUFFER_SIZE));
+}
+
+/**
+ * @brief Checks out multiple queue entries able to hold frames of the given length
+ *
+ * Entries are taken from the smallest size class whose buffers can hold length frame bytes,
+ * falling back to larger classes if it runs out. The number of queue entries successfully checked
+ * out is returned. This may be less than requested if fewer than num_tqe suitable entries were free.
+ *
+ * @param tx_queue_list* new_list Pointer to list to which new queue entries are appended.
+ * @param u16 num_tqe Number of queue entries requested
+ * @param u32 length Number of bytes that will be written to each entry's frame buffer
+ *
+ * @return Number of queue entries successfully checked out and appended to new_list
+ */
+int queue_checkout_list_sized(tx_queue_list* new_list, u16 num_tqe, u32 length){
+	//Checks out up to num_packet_bd number of packet_bds from the free list. If num_packet_bd are not free,
+	//then this function will return the number that are free and only check out that many.
+
+	u32 i;
+	u32 num_checkout;
+
+	num_checkout = 0;
+
+	for(i = 0; (i < QUEUE_NUM_SIZE_CLASSES) && (num_checkout < num_tqe); i++){
+		if(QUEUE_BUFFER_FRAME_SIZE(size_class[i].buffer_size) < length){
+			continue;
+		}
+
+		//Move the entries from the front of the free list to the checkout list in one splice
+		num_checkout += queue_list_move_first(new_list, &(size_class[i].free), num_tqe - num_checkout);
+	}
+	return num_checkout;
+}
+
+
+
+/**
+ * @brief Configures active queue management
+ *
+ * @param u32 mode
+ *  -QUEUE_AQM_MODE_DISABLED, QUEUE_AQM_MODE_DROP or QUEUE_AQM_MODE_MARK
+ * @param u32 target
+ *  -Acceptable standing queue delay (usec)
+ * @param u32 interval
+ *  -Time the queue delay must stay above target before the first drop (usec); should be on the
+ *   order of a worst-case round trip time
+ * @return int
+ *  -0 on success, -1 if a parameter is invalid
+ */
+int queue_aqm_config(u32 mode, u32 target, u32 interval){
+	u32 i;
+
+	if((mode > QUEUE_AQM_MODE_MARK) || (target == 0) || (interval == 0)){
+		return -1;
+	}
+
+	// Leaving the dropping state is only evaluated at dequeue, so reset it here to avoid
+	//   carrying a drop schedule computed with the previous parameters
+	for(i = 0; i < num_queue_tx; i++){
+		queue_info[i].aqm_dropping         = 0;
+		queue_info[i].aqm_first_above_time = 0;
+	}
+
+	aqm_mode     = mode;
+	aqm_target   = target;
+	aqm_interval = interval;
+
+	return 0;
+}
+
+/**
+ * @return Current AQM mode
+ */
+u32 queue_aqm_get_mode(){
+	return aqm_mode;
+}
+
+/**
+ * @return Current AQM target delay (usec)
+ */
+u32 queue_aqm_get_target(){
+	return aqm_target;
+}
+
+/**
+ * @return Current AQM interval (usec)
+ */
+u32 queue_aqm_get_interval(){
+	return aqm_interval;
+}
+
+/**
+ * @return Number of queues that have been created; valid queue IDs are 0 to one less than this value
+ */
+u32 queue_num_queues(){
+	return num_queue_tx;
+}
+
+/**
+ * @brief Gets the occupancy and AQM counters of a queue
+ *
+ * @param u16 queue_sel
+ *  -ID of the queue
+ * @param tx_queue_stats* stats
+ *  -Pointer to stats struct to fill in
+ * @return int
+ *  -0 on success, -1 if the queue does not exist
+ */
+int queue_get_stats(u16 queue_sel, tx_queue_stats* stats){
+	tx_queue_info* info;
+
+	if((queue_sel+1) > num_queue_tx){
+		return -1;
+	}
+
+	info = &(queue_info[queue_sel]);
+
+	stats->num_queued      = queue_tx[queue_sel].length;
+	stats->num_bytes       = info->num_bytes;
+	stats->num_dequeued    = info->num_dequeued;
+	stats->num_aqm_drops   = info->num_aqm_drops;
+	stats->num_aqm_marks   = info->num_aqm_marks;
+	stats->num_share_drops = info->num_share_drops;
+	stats->sojourn_last    = info->sojourn_last;
+	stats->sojourn_avg     = info->sojourn_avg;
+	stats->sojourn_max     = info->sojourn_max;
+
+	return 0;
+}
+
+/**
+ * @brief Resets the counters of every queue
+ */
+void queue_reset_stats(){
+	u32 i;
+
+	for(i = 0; i < num_queue_tx; i++){
+		queue_info[i].num_dequeued    = 0;
+		queue_info[i].num_aqm_drops   = 0;
+		queue_info[i].num_aqm_marks   = 0;
+		queue_info[i].num_share_drops = 0;
+		queue_info[i].sojourn_last    = 0;
+		queue_info[i].sojourn_avg     = 0;
+		queue_info[i].sojourn_max     = 0;
+	}
+}
+
+/**
+ * @brief Integer square root
+ *
+ * @param u32 x
+ * @return floor(sqrt(x))
+ */
+static u32 queue_aqm_isqrt(u32 x){
+	u32 result = 0;
+	u32 bit    = (1 << 30);
+
+	while(bit > x){
+		bit >>= 2;
+	}
+
+	while(bit != 0){
+		if(x >= (result + bit)){
+			x      -= (result + bit);
+			result  = (result >> 1) + bit;
+		} else {
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+	return result;
+}
+
+/**
+ * @brief CoDel control law
+ *
+ * Drops are scheduled at intervals that shrink with the square root of the number of drops
+ * in the current dropping state, which gives a linear change in TCP throughput.
+ *
+ * @param u64 t
+ *  -Time of the previous drop (usec)
+ * @param u32 count
+ *  -Number of drops since entering the dropping state
+ * @return Time of the next drop (usec)
+ */
+static inline u64 queue_aqm_control_law(u64 t, u32 count){
+	return t + (aqm_interval / queue_aqm_isqrt(max(count, 1)));
+}
+
+/**
+ * @brief Returns the length of the MAC header of a data frame
+ *
+ * QoS data frames add a QoS Control field (and an HT Control field if the Order flag is set),
+ * and frames with both To DS and From DS set add a fourth address.
+ *
+ * @param mac_header_80211* hdr
+ *  -MAC header of the frame
+ * @return u32
+ *  -Length (in bytes) of the MAC header
+ */
+static u32 queue_aqm_data_header_length(mac_header_80211* hdr){
+	u32 length = sizeof(mac_header_80211);
+
+	if((hdr->frame_control_2 & (MAC_FRAME_CTRL2_FLAG_TO_DS | MAC_FRAME_CTRL2_FLAG_FROM_DS)) ==
+	   (MAC_FRAME_CTRL2_FLAG_TO_DS | MAC_FRAME_CTRL2_FLAG_FROM_DS)){
+		length += 6;
+	}
+
+	//QoS data sub-types have the QoS bit of the sub-type set
+	if(hdr->frame_control_1 & (MAC_FRAME_CTRL1_SUBTYPE_QOSDATA & MAC_FRAME_CTRL1_MASK_SUBTYPE)){
+		length += 2;
+
+		if(hdr->frame_control_2 & MAC_FRAME_CTRL2_FLAG_ORDER){
+			length += 4;
+		}
+	}
+
+	return length;
+}
+
+/**
+ * @brief Sets the ECN Congestion Experienced codepoint of an IPv4 data frame
+ *
+ * @param tx_queue_element* tqe
+ *  -Queue entry holding the frame
+ * @return int
+ *  -1 if the frame is ECN capable and is now marked, 0 if it cannot be marked
+ */
+static int queue_aqm_ecn_mark(tx_queue_element* tqe){
+	tx_queue_buffer*  buffer;
+	mac_header_80211* mac_hdr;
+	u32               mac_hdr_length;
+	llc_header*       llc_hdr;
+	ipv4_header*      ip_hdr;
+	u8*               checksum;
+	u16               old_word;
+	u16               new_word;
+	u32               sum;
+
+	buffer  = queue_element_buffer(tqe);
+	mac_hdr = (mac_header_80211*)(buffer->frame);
+
+	//Frame type is bits [3:2] of the first frame control byte. The body of a protected frame is encrypted.
+	if(((mac_hdr->frame_control_1 & 0x0C) != MAC_FRAME_CTRL1_TYPE_DATA) ||
+	   (mac_hdr->frame_control_2 & MAC_FRAME_CTRL2_FLAG_PROTECTED)){
+		return 0;
+	}
+
+	mac_hdr_length = queue_aqm_data_header_length(mac_hdr);
+
+	if(buffer->frame_info.length < (mac_hdr_length + sizeof(llc_header) + sizeof(ipv4_header) + WLAN_PHY_FCS_NBYTES)){
+		return 0;
+	}
+
+	llc_hdr = (llc_header*)(buffer->frame + mac_hdr_length);
+	ip_hdr  = (ipv4_header*)(buffer->frame + mac_hdr_length + sizeof(llc_header));
+
+	if((llc_hdr->type != LLC_TYPE_IP) || ((ip_hdr->ver_ihl >> 4) != 4)){
+		return 0;
+	}
+
+	switch(ip_hdr->tos & IPV4_ECN_MASK){
+		case IPV4_ECN_NOT_ECT:
+			return 0;
+		break;
+
+		case IPV4_ECN_CE:
+			return 1;
+		break;
+	}
+
+	//Incrementally update the header checksum (RFC 1624) for the change in the ver_ihl/tos word
+	old_word       = (ip_hdr->ver_ihl << 8) | ip_hdr->tos;
+	ip_hdr->tos   |= IPV4_ECN_CE;
+	new_word       = (ip_hdr->ver_ihl << 8) | ip_hdr->tos;
+
+	checksum       = (u8*)&(ip_hdr->checksum);
+	sum            = (~((checksum[0] << 8) | checksum[1]) & 0xFFFF) + (~old_word & 0xFFFF) + new_word;
+	sum            = (sum & 0xFFFF) + (sum >> 16);
+	sum            = (sum & 0xFFFF) + (sum >> 16);
+	sum            = ~sum & 0xFFFF;
+
+	checksum[0]    = (sum >> 8) & 0xFF;
+	checksum[1]    = sum & 0xFF;
+
+	return 1;
+}
+
+/**
+ * @brief Signals congestion on a packet chosen by the AQM control law
+ *
+ * In QUEUE_AQM_MODE_MARK, ECN capable packets are marked and left for transmission. All other
+ * packets are dropped and their queue entries returned to the free pool.
+ *
+ * @param u16 queue_sel
+ *  -ID of the queue the packet was taken from
+ * @param tx_queue_element* tqe
+ *  -Queue entry holding the packet
+ * @return int
+ *  -1 if the packet was marked (tqe is still valid), 0 if it was dropped
+ */
+static int queue_aqm_signal(u16 queue_sel, tx_queue_element* tqe){
+	if((aqm_mode == QUEUE_AQM_MODE_MARK) && queue_aqm_ecn_mark(tqe)){
+		queue_info[queue_sel].num_aqm_marks++;
+		return 1;
+	}
+
+	queue_info[queue_sel].num_aqm_drops++;
+	queue_checkin(tqe);
+	return 0;
+}
+
+/**
+ * @brief Returns the time a packet has spent in its queue
+ *
+ * @param tx_queue_element* tqe
+ *  -Queue entry holding the packet
+ * @param u64 now
+ *  -Current time (usec)
+ * @return u32
+ *  -Time since tx_frame_info.timestamp_create (usec)
+ */
+static inline u32 queue_aqm_sojourn(tx_queue_element* tqe, u64 now){
+	u64 timestamp_create = queue_element_buffer(tqe)->frame_info.timestamp_create;
+
+	return (now > timestamp_create) ? (u32)(now - timestamp_create) : 0;
+}
+
+/**
+ * @brief Records the sojourn time of a packet dequeued for transmission
+ *
+ * Packets dropped by AQM are counted in num_aqm_drops instead.
+ *
+ * @param u16 queue_sel
+ *  -ID of the queue the packet was taken from
+ * @param tx_queue_element* tqe
+ *  -Queue entry holding the packet
+ * @param u64 now
+ *  -Current time (usec)
+ * @return tx_queue_element*
+ *  -tqe
+ */
+static tx_queue_element* queue_aqm_transmit(u16 queue_sel, tx_queue_element* tqe, u64 now){
+	tx_queue_info* info = &(queue_info[queue_sel]);
+	u32            sojourn;
+
+	if(tqe != NULL){
+		sojourn = queue_aqm_sojourn(tqe, now);
+
+		info->num_dequeued++;
+		info->sojourn_last = sojourn;
+		info->sojourn_avg  = info->sojourn_avg - (info->sojourn_avg >> 3) + (sojourn >> 3);
+		info->sojourn_max  = max(info->sojourn_max, sojourn);
+	}
+
+	return tqe;
+}
+
+/**
+ * @brief Removes the head entry of a queue and measures its sojourn time
+ *
+ * @param u16 queue_sel
+ *  -ID of the queue
+ * @param u64 now
+ *  -Current time (usec)
+ * @param u8* ok_to_drop
+ *  -Set to 1 if the queue delay has been above aqm_target for at least aqm_interval
+ * @return
+ *  -Pointer to queue entry if available, NULL if queue is empty
+ */
+static tx_queue_element* queue_aqm_dodequeue(u16 queue_sel, u64 now, u8* ok_to_drop){
+	tx_queue_element* tqe;
+	tx_queue_info*    info;
+	u32               sojourn;
+
+	*ok_to_drop = 0;
+
+	tqe = dequeue_from_head(queue_sel);
+
+	if(tqe == NULL){
+		if((queue_sel+1) <= num_queue_tx){
+			queue_info[queue_sel].aqm_first_above_time = 0;
+		}
+		return NULL;
+	}
+
+	info    = &(queue_info[queue_sel]);
+	sojourn = queue_aqm_sojourn(tqe, now);
+
+	if((sojourn < aqm_target) || (info->num_bytes <= QUEUE_AQM_MTU)){
+		//Delay is acceptable, or there is not enough left in the queue to build a standing queue
+		info->aqm_first_above_time = 0;
+	} else if(info->aqm_first_above_time == 0){
+		//Delay just went above target; only act if it stays there for a full interval
+		info->aqm_first_above_time = now + aqm_interval;
+	} else if(now >= info->aqm_first_above_time){
+		*ok_to_drop = 1;
+	}
+
+	return tqe;
+}
+
+/**
+ * @brief Removes the head entry of a queue, applying active queue management
+ *
+ * Implements the CoDel algorithm (K. Nichols and V. Jacobson, "Controlling Queue Delay") using the
+ * time each packet has spent in the queue, measured from tx_frame_info.timestamp_create. Once the
+ * sojourn time has stayed above aqm_target for aqm_interval, packets are dropped (or marked) from the
+ * head of the queue at a rate that increases with the square root of the number of drops until the
+ * delay falls back below target.
+ *
+ * Sojourn statistics are recorded only for the packet returned for transmission. If AQM is disabled this
+ * function only records those statistics.
+ *
+ * @param u16 queue_sel
+ *  -ID of the queue from which to dequeue an entry
+ * @return
+ *  -Pointer to queue entry to transmit, NULL if queue is empty
+ */
+static tx_queue_element* queue_aqm_dequeue(u16 queue_sel){
+	tx_queue_element* tqe;
+	tx_queue_info*    info;
+	u64               now;
+	u8                ok_to_drop;
+	u32               delta;
+
+	now = get_usec_timestamp();
+	tqe = queue_aqm_dodequeue(queue_sel, now, &ok_to_drop);
+
+	if((tqe == NULL) || (aqm_mode == QUEUE_AQM_MODE_DISABLED)){
+		return queue_aqm_transmit(queue_sel, tqe, now);
+	}
+
+	info = &(queue_info[queue_sel]);
+
+	if(info->aqm_dropping){
+		if(ok_to_drop == 0){
+			//Delay has gone below target; leave the dropping state
+			info->aqm_dropping = 0;
+		}
+
+		while(info->aqm_dropping && (now >= info->aqm_drop_next)){
+			info->aqm_count++;
+
+			if(queue_aqm_signal(queue_sel, tqe)){
+				//Marked packets are still transmitted
+				info->aqm_drop_next = queue_aqm_control_law(info->aqm_drop_next, info->aqm_count);
+				return queue_aqm_transmit(queue_sel, tqe, now);
+			}
+
+			tqe = queue_aqm_dodequeue(queue_sel, now, &ok_to_drop);
+
+			if((tqe == NULL) || (ok_to_drop == 0)){
+				info->aqm_dropping = 0;
+			} else {
+				info->aqm_drop_next = queue_aqm_control_law(info->aqm_drop_next, info->aqm_count);
+			}
+		}
+	} else if(ok_to_drop){
+		//Enter the dropping state, signalling the packet at the head
+		if(queue_aqm_signal(queue_sel, tqe) == 0){
+			tqe = queue_aqm_dodequeue(queue_sel, now, &ok_to_drop);
+		}
+
+		info->aqm_dropping = 1;
+
+		//If the dropping state was entered recently, resume at the drop rate it reached
+		delta = info->aqm_count - info->aqm_lastcount;
+
+		if((delta > 1) && (now < (info->aqm_drop_next + (16 * (u64)aqm_interval)))){
+			info->aqm_count = delta;
+		} else {
+			info->aqm_count = 1;
+		}
+
+		info->aqm_drop_next = queue_aqm_control_law(now, info->aqm_count);
+		info->aqm_lastcount = info->aqm_count;
+	}
+
+	return queue_aqm_transmit(queue_sel, tqe, now);
+}
+
+
+/**
+ * @brief Dequeues one packet and submits it the lower MAC for wireless transmission
+ *
+ * This function is the link between the Tx queue framework and the lower-level MAC. The calling
+ * function has determined the next wireless transmission should come from the queue with ID queue_sel.
+ * This function attempts to checkout 1 packet from that queue. If a packet is available it is
+ * passed to wlan_mac_high_mpdu_transmit(), which handles the actual copy-to-pkt-buf and Tx process.
+ *
+ * When a packet is successfully de-queued and submitted for transmission the corresponding queue entry
+ * (tx_queue_element) is returned to the free pool. If high-level retry is enabled (see queue_retry_config())
+ * the entry is instead held until queue_tx_done() is called for the packet.
+ *
+ * This function returns 0 if no packets are available in the requested queue or if the MAC state machine
+ * is not ready to submit a new packet to the lower MAC for transmission. When active queue management is
+ * enabled, packets may be dropped from the head of the queue before one is submitted (see queue_aqm_dequeue()).
+ *
+ * @param u16 queue_sel Queue ID from which to dequeue packet
+ *
+ * @return Number of successfully transmitted packets (0 or 1)
+ */
+inline int dequeue_transmit_checkin(u16 queue_sel){
+	int return_value = 0;
+	int tx_pkt_buf = -1;
+	tx_queue_element* curr_tx_queue_element;
+
+	tx_pkt_buf = wlan_mac_high_lock_new_tx_packet_buffer();
+
+	if(tx_pkt_buf != -1){
+		curr_tx_queue_element = queue_aqm_dequeue(queue_sel);
+
+		if(curr_tx_queue_element != NULL){
+			return_value = 1;
+
+			if(retry_max != QUEUE_RETRY_MAX_DISABLED){
+				//Record the entry before CPU Low can report the transmission done
+				tx_pending[tx_pkt_buf].tqe       = curr_tx_queue_element;
+				tx_pending[tx_pkt_buf].queue_sel = queue_sel;
+				tx_pending[tx_pkt_buf].purged    = 0;
+
+				wlan_mac_high_mpdu_transmit(curr_tx_queue_element, tx_pkt_buf);
+			} else {
+				wlan_mac_high_mpdu_transmit(curr_tx_queue_element, tx_pkt_buf);
+				queue_checkin(curr_tx_queue_element);
+				wlan_eth_dma_update();
+			}
+		} else {
+			wlan_mac_high_release_tx_packet_buffer(tx_pkt_buf);
+		}
+	}
+	return return_value;
+}
+
+/**
+ * @brief Dequeues one packet from the next DRR queue and submits it to the lower MAC
+ *
+ * Combines queue_drr_select() and dequeue_transmit_checkin() so that a MAC application which does
+ * not need its own queue ordering can service all queues fairly without scanning them.
+ *
+ * @return Number of successfully transmitted packets (0 or 1)
+ */
+int dequeue_transmit_checkin_drr(){
+	u32 queue_sel;
+
+	queue_sel = queue_drr_select();
+
+	if(queue_sel == QUEUE_SEL_NONE){
+		return 0;
+	}
+
+	return dequeue_transmit_checkin(queue_sel);
 }
@@ -0,0 +1,446 @@
+/** @file wlan_mac_run_queue.c
+ *  @brief Run Queue
+ *
+ *  This contains code for deferring work from interrupt context to the
+ *  main loop of CPU High.
+ *
+ *  Interrupt handlers (for example, the scheduler's timer handler) queue
+ *  work items with run_queue_enqueue(). Long running polling functions
+ *  (for example, wlan_eth_rx_task() and transport_poll()) are registered
+ *  as tasks with run_queue_task_register(). The main loop of the upper-level
+ *  MAC calls wlan_mac_high_poll(), which calls run_queue_poll() to run both,
+ *  in priority order, within per-priority time budgets.
+ *
+ *  @copyright Copyright 2014-2015, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *				See LICENSE.txt included in the design archive or
+ *				at http://mangocomm.com/802.11/license
+ *
+ *  @author Chris Hunter (chunter [at] mangocomm.com)
+ *  @author Patrick Murphy (murphpo [at] mangocomm.com)
+ *  @author Erik Welsh (welsh [at] mangocomm.com)
+ */
+
+/***************************** Include Files *********************************/
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "xil_types.h"
+#include "wlan_mac_dl_list.h"
+#include "wlan_mac_high.h"
+#include "wlan_mac_run_queue.h"
+
+
+/*************************** Constant Definitions ****************************/
+
+
+/*********************** Global Variable Definitions *************************/
+
+
+/*************************** Variable Definitions ****************************/
+
+typedef struct {
+	function_ptr_t   function;
+	u32              arg;
+} run_queue_work;
+
+typedef struct {
+	run_queue_work   work[RUN_QUEUE_WORK_SIZE];
+	u32              head;                   ///< Number of work items dequeued
+	u32              tail;                   ///< Number of work items enqueued
+	u32              budget;                 ///< Time (in microseconds) work items may use per pass
+	u32              num_full;               ///< Number of work items refused because the queue was full
+	run_queue_stats  stats;                  ///< Run time of the work items; each pass counts as one run
+} run_queue_work_list;
+
+static run_queue_work_list    run_queue_work_lists[RUN_QUEUE_NUM_PRIORITIES];
+
+static dl_list                run_queue_tasks;
+static u32                    run_queue_task_count;
+static u8                     run_queue_tasks_walking;
+
+
+/*************************** Functions Prototypes ****************************/
+
+static void run_queue_stats_update(run_queue_stats* stats, u32 run_time, u32 budget);
+static dl_entry* run_queue_find_task(u32 id);
+static void run_queue_task_free(dl_entry* entry);
+
+
+/******************************** Functions **********************************/
+
+/**
+ * @brief Initialize the Run Queue
+ *
+ * @param    None.
+ * @return   None.
+ */
+void run_queue_init(){
+	bzero(run_queue_work_lists, sizeof(run_queue_work_lists));
+
+	run_queue_work_lists[RUN_QUEUE_PRIORITY_HIGH].budget   = RUN_QUEUE_BUDGET_HIGH_DEFAULT;
+	run_queue_work_lists[RUN_QUEUE_PRIORITY_NORMAL].budget = RUN_QUEUE_BUDGET_NORMAL_DEFAULT;
+	run_queue_work_lists[RUN_QUEUE_PRIORITY_LOW].budget    = RUN_QUEUE_BUDGET_LOW_DEFAULT;
+
+	dl_list_init(&run_queue_tasks);
+	run_queue_task_count    = 0;
+	run_queue_tasks_walking = 0;
+}
+
+
+/**
+ * @brief Queue a work item
+ *
+ * The work item is run by the next call to run_queue_poll() that reaches its
+ * priority. This function may be called from interrupt context.
+ *
+ * @param    priority     - RUN_QUEUE_PRIORITY_*
+ * @param    function     - Function to call; it is passed arg
+ * @param    arg          - Argument for the function
+ * @return   int          - 0 on success, -1 if the priority is invalid or the queue is full
+ */
+int run_queue_enqueue(u8 priority, function_ptr_t function, u32 arg){
+	run_queue_work_list* list;
+	interrupt_state_t    prev_interrupt_state;
+	int                  status = -1;
+
+	if(priority >= RUN_QUEUE_NUM_PRIORITIES){
+		return -1;
+	}
+
+	list = &(run_queue_work_lists[priority]);
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	if((list->tail - list->head) < RUN_QUEUE_WORK_SIZE){
+		list->work[list->tail & (RUN_QUEUE_WORK_SIZE - 1)].function = function;
+		list->work[list->tail & (RUN_QUEUE_WORK_SIZE - 1)].arg      = arg;
+		list->tail++;
+		status = 0;
+	} else {
+		list->num_full++;
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	return status;
+}
+
+
+/**
+ * @brief Run queued work items and registered tasks
+ *
+ * This function is called from the main loop of the upper-level MAC by
+ * wlan_mac_high_poll(). For each priority, from highest to lowest, queued work
+ * items are run until none are left or the priority's budget is used, then each
+ * registered task of the priority is called once. Work items left in the queue
+ * are run in the next pass.
+ *
+ * @param    None.
+ * @return   None.
+ */
+void run_queue_poll(){
+	u32                  priority;
+	u32                  num_work;
+	run_queue_work_list* list;
+	run_queue_work       work;
+	run_queue_task*      task;
+	dl_entry*            curr_entry;
+	dl_entry*            next_entry;
+	u64                  start_timestamp;
+	u64                  task_timestamp;
+	interrupt_state_t    prev_interrupt_state;
+
+	for(priority = 0; priority < RUN_QUEUE_NUM_PRIORITIES; priority++){
+		list            = &(run_queue_work_lists[priority]);
+		num_work        = 0;
+		start_timestamp = get_usec_timestamp();
+
+		while(1){
+			prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+			if(list->head == list->tail){
+				wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+				break;
+			}
+
+			work = list->work[list->head & (RUN_QUEUE_WORK_SIZE - 1)];
+			list->head++;
+
+			wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+			work.function(work.arg);
+			num_work++;
+
+			if((get_usec_timestamp() - start_timestamp) >= list->budget){
+				break;
+			}
+		}
+
+		if(num_work){
+			run_queue_stats_update(&(list->stats), (u32)(get_usec_timestamp() - start_timestamp), list->budget);
+		}
+
+		// Tasks may remove any task, including themselves.  Removals are only marked while
+		// the tasks are walked (see run_queue_task_remove()) and are freed once the walk ends.
+		run_queue_tasks_walking = 1;
+		curr_entry              = run_queue_tasks.first;
+
+		while(curr_entry != NULL){
+			task = (run_queue_task*)(curr_entry->data);
+
+			if((task->priority == priority) && (task->removed == 0)){
+				task_timestamp = get_usec_timestamp();
+				task->function(task->arg);
+				run_queue_stats_update(&(task->stats), (u32)(get_usec_timestamp() - task_timestamp), task->budget);
+			}
+
+			curr_entry = dl_entry_next(curr_entry);
+		}
+
+		run_queue_tasks_walking = 0;
+
+		curr_entry = run_queue_tasks.first;
+
+		while(curr_entry != NULL){
+			next_entry = dl_entry_next(curr_entry);
+
+			if(((run_queue_task*)(curr_entry->data))->removed){
+				run_queue_task_free(curr_entry);
+			}
+
+			curr_entry = next_entry;
+		}
+	}
+}
+
+
+/**
+ * @brief Register a task
+ *
+ * The task's function is called, with arg, once per pass of run_queue_poll().
+ *
+ * @param    priority     - RUN_QUEUE_PRIORITY_*
+ * @param    budget       - Time (in microseconds) the task should use per call; calls
+ *                          that take longer are counted as overruns
+ * @param    function     - Function to call
+ * @param    arg          - Argument for the function
+ * @return   u32          - ID of the task, RUN_QUEUE_TASK_ID_INVALID on failure
+ */
+u32 run_queue_task_register(u8 priority, u32 budget, function_ptr_t function, u32 arg){
+	dl_entry*       entry;
+	run_queue_task* task;
+
+	if(priority >= RUN_QUEUE_NUM_PRIORITIES){
+		return RUN_QUEUE_TASK_ID_INVALID;
+	}
+
+	entry = wlan_mac_high_malloc(sizeof(dl_entry));
+
+	if(entry == NULL){
+		return RUN_QUEUE_TASK_ID_INVALID;
+	}
+
+	task = wlan_mac_high_malloc(sizeof(run_queue_task));
+
+	if(task == NULL){
+		wlan_mac_high_free(entry);
+		return RUN_QUEUE_TASK_ID_INVALID;
+	}
+
+	bzero(task, sizeof(run_queue_task));
+
+	task->id       = run_queue_task_count++;
+	task->priority = priority;
+	task->budget   = budget;
+	task->function = function;
+	task->arg      = arg;
+
+	entry->data = task;
+	dl_entry_insertEnd(&run_queue_tasks, entry);
+
+	return task->id;
+}
+
+
+/**
+ * @brief Remove a task
+ *
+ * If called from a task (i.e. while run_queue_poll() walks the tasks), the task is
+ * only marked as removed.  It is no longer called and is freed when the walk ends.
+ *
+ * @param    id           - ID of the task
+ * @return   None.
+ */
+void run_queue_task_remove(u32 id){
+	dl_entry* entry = run_queue_find_task(id);
+
+	if(entry != NULL){
+		if(run_queue_tasks_walking){
+			((run_queue_task*)(entry->data))->removed = 1;
+		} else {
+			run_queue_task_free(entry);
+		}
+	}
+}
+
+
+/**
+ * @brief Set the time queued work items of a priority may use per pass
+ *
+ * @param    priority     - RUN_QUEUE_PRIORITY_*
+ * @param    budget       - Time (in microseconds); at least one work item is run per pass
+ * @return   int          - 0 on success, -1 if the priority is invalid
+ */
+int run_queue_set_budget(u8 priority, u32 budget){
+	if(priority >= RUN_QUEUE_NUM_PRIORITIES){
+		return -1;
+	}
+
+	run_queue_work_lists[priority].budget = budget;
+
+	return 0;
+}
+
+
+/**
+ * @brief Get the run time statistics of a task
+ *
+ * @param    id           - ID of the task
+ * @param    stats        - Filled in with the task's statistics
+ * @return   int          - 0 on success, -1 if there is no task with the ID
+ */
+int run_queue_get_task_stats(u32 id, run_queue_stats* stats){
+	dl_entry* entry = run_queue_find_task(id);
+
+	if(entry == NULL){
+		return -1;
+	}
+
+	memcpy(stats, &(((run_queue_task*)(entry->data))->stats), sizeof(run_queue_stats));
+
+	return 0;
+}
+
+
+/**
+ * @brief Get the run time statistics of the queued work items of a priority
+ *
+ * Each pass of run_queue_poll() that runs work items of the priority counts as one run.
+ *
+ * @param    priority     - RUN_QUEUE_PRIORITY_*
+ * @param    stats        - Filled in with the priority's statistics
+ * @return   int          - 0 on success, -1 if the priority is invalid
+ */
+int run_queue_get_work_stats(u8 priority, run_queue_stats* stats){
+	if(priority >= RUN_QUEUE_NUM_PRIORITIES){
+		return -1;
+	}
+
+	memcpy(stats, &(run_queue_work_lists[priority].stats), sizeof(run_queue_stats));
+
+	return 0;
+}
+
+
+/**
+ * @brief Print the run time statistics of the run queue
+ *
+ * @param    None.
+ * @return   None.
+ */
+void run_queue_print_stats(){
+	u32                  i;
+	dl_entry*            curr_entry;
+	run_queue_task*      task;
+	run_queue_work_list* list;
+
+	xil_printf("\n");
+	xil_printf("--- Run Queue ---\n");
+
+	for(i = 0; i < RUN_QUEUE_NUM_PRIORITIES; i++){
+		list = &(run_queue_work_lists[i]);
+
+		xil_printf("Work (priority %d):\n", i);
+		xil_printf("   queued:                  %d\n", list->tail - list->head);
+		xil_printf("   num_full:                %d\n", list->num_full);
+		xil_printf("   num_runs:                %d\n", list->stats.num_runs);
+		xil_printf("   num_overruns:            %d\n", list->stats.num_overruns);
+		xil_printf("   run_time_max:            %d usec\n", list->stats.run_time_max);
+	}
+
+	curr_entry = run_queue_tasks.first;
+
+	while(curr_entry != NULL){
+		task = (run_queue_task*)(curr_entry->data);
+
+		xil_printf("Task %d (priority %d, budget %d usec):\n", task->id, task->priority, task->budget);
+		xil_printf("   num_runs:                %d\n", task->stats.num_runs);
+		xil_printf("   num_overruns:            %d\n", task->stats.num_overruns);
+		xil_printf("   run_time_last:           %d usec\n", task->stats.run_time_last);
+		xil_printf("   run_time_max:            %d usec\n", task->stats.run_time_max);
+
+		curr_entry = dl_entry_next(curr_entry);
+	}
+}
+
+
+/**
+ * @brief Record the run time of a task or of a pass of work items
+ *
+ * @param    stats        - Statistics to update
+ * @param    run_time     - Run time (usec)
+ * @param    budget       - Budget (usec)
+ * @return   None.
+ */
+static void run_queue_stats_update(run_queue_stats* stats, u32 run_time, u32 budget){
+	stats->num_runs++;
+	stats->run_time_last   = run_time;
+	stats->run_time_total += run_time;
+
+	if(run_time > stats->run_time_max){
+		stats->run_time_max = run_time;
+	}
+
+	if(run_time > budget){
+		stats->num_overruns++;
+	}
+}
+
+
+/**
+ * @brief Find a task
+ *
+ * @param    id           - ID of the task
+ * @return   dl_entry*    - Entry of the task, NULL if there is no task with the ID
+ */
+static dl_entry* run_queue_find_task(u32 id){
+	dl_entry*       curr_entry = run_queue_tasks.first;
+	run_queue_task* task;
+
+	while(curr_entry != NULL){
+		task = (run_queue_task*)(curr_entry->data);
+
+		if((task->id == id) && (task->removed == 0)){
+			return curr_entry;
+		}
+		curr_entry = dl_entry_next(curr_entry);
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief Unlink a task from the list of tasks and free it
+ *
+ * @param    entry        - Entry of the task
+ * @return   None.
+ */
+static void run_queue_task_free(dl_entry* entry){
+	dl_entry_remove(&run_queue_tasks, entry);
+
+	wlan_mac_high_free(entry->data);
+	wlan_mac_high_free(entry);
+}
@@ -19,8 +19,10 @@
 #include "xparameters.h"
 //#include "stdlib.h"
 #include "xil_types.h"
+#include "string.h"
 #include "wlan_mac_high.h"
 #include "wlan_mac_schedule.h"
+#include "wlan_mac_run_queue.h"
 #include "xtmrctr.h"
 #include "xil_exception.h"
 #include "xintc.h"
@@ -31,11 +33,91 @@ static XIntc*                InterruptController_ptr;
 
 volatile static u32          schedule_count;
 
-volatile static u64          num_coarse_checks;
-volatile static u64          num_fine_checks;
-
-static dl_list               wlan_sched_coarse;
-static dl_list               wlan_sched_fine;
+// Each scheduler keeps its events in a binary min-heap ordered on target, so the timer handler
+// only visits events that have expired. Events are also hashed by ID into id_table so that they
+// can be found and removed without searching the heap.
+//
+// In periodic mode the scheduler's timer interrupts every tick while any event is scheduled. In
+// tickless mode the timer is programmed as a one-shot for the earliest target and num_checks is
+// advanced by the number of ticks that were programmed. The time into the current tick at which
+// the one-shot was programmed is kept in timer_partial so that reprogramming does not lose time.
+//
+// In deferred mode the timer handler only queues the calls of expired events in deferred_calls.
+// Each queued call is tagged with the event's ID and generation, and is made from the main loop by
+// wlan_sched_deferred_run() only if the event has not been removed since.
+typedef struct {
+	dl_entry*     entry;                                   ///< Event
+	u32           id;                                      ///< ID of the event when the call was queued
+	u32           generation;                              ///< Generation of the event when the call was queued
+} wlan_sched_deferred_call;
+
+typedef struct {
+	dl_entry**    heap;                                    ///< Min-heap of events ordered on wlan_sched target
+	u32           length;                                  ///< Number of scheduled events
+	dl_list       id_table[SCHEDULE_ID_TABLE_SIZE];        ///< Events hashed by ID
+
+	volatile u64  num_checks;                              ///< Number of ticks counted by the scheduler
+	u8            timer_cntr;                              ///< TIMER_CNTR_FAST or TIMER_CNTR_SLOW
+	u8            tickless;                                ///< Program the timer for the earliest target instead of every tick
+	u8            timer_running;
+	u8            in_handler;                              ///< Events are being processed by the timer handler
+	u8            deferred;                                ///< Callbacks are queued to the run queue instead of called by the timer handler
+	u8            run_queue_priority;                      ///< Run queue priority of deferred callbacks
+	u32           tick_cycles;                             ///< Timer cycles per tick
+	u32           timer_partial;                           ///< Timer cycles into the tick at which the one-shot was programmed
+	u32           timer_armed;                             ///< Timer cycles programmed for the one-shot
+	u32           num_interrupts;                          ///< Number of timer interrupts taken
+
+	wlan_sched_deferred_call deferred_calls[SCHEDULE_DEFERRED_QUEUE_SIZE];
+	u32           deferred_head;                           ///< Number of deferred calls dequeued
+	u32           deferred_tail;                           ///< Number of deferred calls queued
+	u8            deferred_run_pending;                    ///< A wlan_sched_deferred_run() work item is in the run queue
+	u32           num_deferred_overflows;                  ///< Number of calls dropped because deferred_calls was full
+	u32           num_deferred_dropped;                    ///< Number of queued calls dropped because their event was removed
+
+	wlan_sched_lateness_stats lateness;                    ///< Lateness of events with microsecond deadlines
+} wlan_sched_list;
+
+static wlan_sched_list       wlan_sched_coarse;
+static wlan_sched_list       wlan_sched_fine;
+
+// Events are allocated from a pool of wlan_sched_event records so that scheduling an event and
+// expiring it in the timer interrupt handler never use the heap. The pool is only grown from the
+// main loop, by a run queue work item. Each scheduler's heap array can hold every event in the pool.
+static dl_list               wlan_sched_pool_free;
+static u32                   wlan_sched_pool_capacity;
+static u32                   wlan_sched_pool_high_water;
+static u32                   wlan_sched_pool_num_failures;
+static u8                    wlan_sched_pool_grow_pending;
+
+// heap_index of an event that is no longer scheduled
+#define WLAN_SCHED_HEAP_INDEX_NONE  0xFFFFFFFF
+
+#define wlan_sched_of(x)            ((wlan_sched*)(((dl_entry*)(x))->data))
+#define wlan_sched_id_bucket(l,id)  (&((l)->id_table[(id) & (SCHEDULE_ID_TABLE_SIZE - 1)]))
+
+/*************************** Functions Prototypes ****************************/
+
+static void wlan_sched_list_init(wlan_sched_list* list, u8 timer_cntr, u32 tick_us);
+static wlan_sched_list* wlan_sched_get_list(u8 scheduler_sel);
+static dl_entry* wlan_sched_pool_alloc();
+static void wlan_sched_pool_free_entry(dl_entry* entry);
+static void wlan_sched_pool_request_grow();
+static void wlan_sched_pool_grow(u32 arg);
+static void wlan_sched_heap_insert(wlan_sched_list* list, dl_entry* entry);
+static void wlan_sched_heap_remove(wlan_sched_list* list, u32 index);
+static void wlan_sched_heap_sift_up(wlan_sched_list* list, u32 index);
+static void wlan_sched_heap_sift_down(wlan_sched_list* list, u32 index);
+static void wlan_sched_remove_entry(wlan_sched_list* list, dl_entry* entry);
+static void wlan_sched_process(wlan_sched_list* list);
+static void wlan_sched_defer_call(wlan_sched_list* list, dl_entry* entry);
+static void wlan_sched_deferred_run(u32 arg);
+static u64  wlan_sched_now(wlan_sched_list* list);
+static u64  wlan_sched_earliest_target(wlan_sched_list* list, u64 target);
+static void wlan_sched_timer_update(wlan_sched_list* list);
+static void wlan_sched_timer_set_options(wlan_sched_list* list);
+static u64  wlan_sched_deadline_target(wlan_sched_list* list, u64 deadline, u64 timestamp);
+static void wlan_sched_lateness_update(wlan_sched_list* list, u32 lateness, u32 num_missed);
 
 /******************************** Functions **********************************/
 
@@ -55,10 +137,20 @@ int wlan_mac_schedule_init(){
 
 	//Initialize internal variables
 	schedule_count    = 0;
-	num_coarse_checks = 0;
-	num_fine_checks   = 0;
-	dl_list_init(&wlan_sched_coarse);
-	dl_list_init(&wlan_sched_fine);
+	wlan_sched_list_init(&wlan_sched_coarse, TIMER_CNTR_SLOW, SLOW_TIMER_DUR_US);
+	wlan_sched_list_init(&wlan_sched_fine, TIMER_CNTR_FAST, FAST_TIMER_DUR_US);
+
+	//Create the event pool
+	dl_list_init(&wlan_sched_pool_free);
+	wlan_sched_pool_capacity     = 0;
+	wlan_sched_pool_high_water   = 0;
+	wlan_sched_pool_num_failures = 0;
+	wlan_sched_pool_grow_pending = 0;
+
+	if (wlan_mac_schedule_pool_config(SCHEDULE_POOL_SIZE_DEFAULT) != 0) {
+		xil_printf("Scheduler event pool failed to initialize\n");
+		return -1;
+	}
 
 
 	//Set up the timer
@@ -72,9 +164,9 @@ int wlan_mac_schedule_init(){
 	//Set the handler for Timer
 	XTmrCtr_SetHandler(&TimerCounterInst, timer_handler, &TimerCounterInst);
 
-	//Enable interrupt of timer and auto-reload so it continues repeatedly
-	XTmrCtr_SetOptions(&TimerCounterInst, TIMER_CNTR_FAST, XTC_DOWN_COUNT_OPTION | XTC_INT_MODE_OPTION | XTC_AUTO_RELOAD_OPTION);
-	XTmrCtr_SetOptions(&TimerCounterInst, TIMER_CNTR_SLOW, XTC_DOWN_COUNT_OPTION | XTC_INT_MODE_OPTION | XTC_AUTO_RELOAD_OPTION);
+	//Enable interrupt of timer and, in periodic mode, auto-reload so it continues repeatedly
+	wlan_sched_timer_set_options(&wlan_sched_fine);
+	wlan_sched_timer_set_options(&wlan_sched_coarse);
 
 
 	return 0;
@@ -116,25 +208,29 @@ int wlan_mac_schedule_setup_interrupt(XIntc* intc){
 *
 ******************************************************************************/
 u32 wlan_mac_schedule_event_repeated(u8 scheduler_sel, u32 delay, u32 num_calls, void(*callback)()){
-	u32 id;
+	u32               id;
+	wlan_sched_list*  list;
+	interrupt_state_t prev_interrupt_state;
 
-	dl_entry*	entry_ptr = wlan_mac_high_malloc(sizeof(dl_entry));
+	list = wlan_sched_get_list(scheduler_sel);
 
-	if(entry_ptr == NULL){
-		//malloc has failed. Return failure condition
+	if(list == NULL){
+		xil_printf("Unknown scheduler selection.  No event scheduled.\n");
 		return SCHEDULE_FAILURE;
 	}
 
-	wlan_sched* sched_ptr = wlan_mac_high_malloc(sizeof(wlan_sched));
+	// The pool, heap and ID table are also modified by the timer interrupt handler
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
 
-	if(sched_ptr == NULL){
-		//malloc has failed. Return failure condition
-		wlan_mac_high_free(entry_ptr);
+	dl_entry* entry_ptr = wlan_sched_pool_alloc();
+
+	if(entry_ptr == NULL){
+		//The event pool is exhausted. Return failure condition
+		wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
 		return SCHEDULE_FAILURE;
 	}
 
-	//Attach the schedule struct to this dl_entry
-	entry_ptr->data = sched_ptr;
+	wlan_sched* sched_ptr = wlan_sched_of(entry_ptr);
 
 	id = (schedule_count++);
 
@@ -144,33 +240,102 @@ u32 wlan_mac_schedule_event_repeated(u8 scheduler_sel, u32 delay, u32 num_calls,
 	sched_ptr->id        = id;
 	sched_ptr->num_calls = num_calls;
 	sched_ptr->callback  = (function_ptr_t)callback;
+	sched_ptr->period    = 0;
+	sched_ptr->deadline  = 0;
 
 	switch(scheduler_sel){
 		case SCHEDULE_COARSE:
 			sched_ptr->delay = delay/SLOW_TIMER_DUR_US;
-			sched_ptr->target = num_coarse_checks + (u64)(sched_ptr->delay);
-
-			if(wlan_sched_coarse.length == 0){
-				XTmrCtr_SetResetValue(&TimerCounterInst, TIMER_CNTR_SLOW, SLOW_TIMER_DUR_US*(TIMER_FREQ/1000000));
-				XTmrCtr_Start(&TimerCounterInst, TIMER_CNTR_SLOW);
-			}
-			dl_entry_insertEnd(&wlan_sched_coarse, entry_ptr);
 		break;
 		case SCHEDULE_FINE:
 			sched_ptr->delay = delay/FAST_TIMER_DUR_US;
-			sched_ptr->target = num_fine_checks + (u64)(sched_ptr->delay);
-
-			if(wlan_sched_fine.length == 0){
-				XTmrCtr_SetResetValue(&TimerCounterInst, TIMER_CNTR_FAST, FAST_TIMER_DUR_US*(TIMER_FREQ/1000000));
-				XTmrCtr_Start(&TimerCounterInst, TIMER_CNTR_FAST);
-			}
-			dl_entry_insertEnd(&wlan_sched_fine, entry_ptr);
-		break;
-		default:
-			xil_printf("Unknown scheduler selection.  No event scheduled.\n");
-			return SCHEDULE_FAILURE;
 		break;
 	}
+	sched_ptr->target = wlan_sched_earliest_target(list, wlan_sched_now(list) + (u64)(sched_ptr->delay));
+
+	wlan_sched_heap_insert(list, entry_ptr);
+	dl_entry_insertEnd(wlan_sched_id_bucket(list, id), entry_ptr);
+
+	//Start the timer if this is the first event, or reprogram it if this is the earliest event in tickless mode
+	if((list->length == 1) || (list->tickless && (sched_ptr->heap_index == 0))){
+		wlan_sched_timer_update(list);
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	return id;
+}
+
+/*****************************************************************************/
+/**
+* Schedules the periodic execution of a callback at absolute microsecond deadlines
+*
+* @param    scheduler_sel    - SCHEDULE_COARSE or SCHEDULE_FINE
+* 			first_deadline   - time (in microseconds, see get_usec_timestamp()) of the first call
+* 			period           - interval (in microseconds) between deadlines; must be non-zero
+* 			num_calls        - number of calls or SCHEDULE_REPEAT_FOREVER for permanent periodic
+* 			callback         - function pointer to callback
+*
+* @return	id  			 - ID of scheduled event or SCHEDULE_FAILURE if error
+*
+* @note		Each deadline is the previous deadline plus the period, so the
+* 			schedule does not drift with the scheduler's tick or with late calls.
+* 			The callback is never called before its deadline; it is called at the
+* 			first scheduler tick at or after it. If a deadline is missed by more
+* 			than a period, the missed deadlines are skipped and counted in the
+* 			scheduler's lateness statistics. The event is removed with
+* 			wlan_mac_remove_schedule().
+*
+******************************************************************************/
+u32 wlan_mac_schedule_event_periodic(u8 scheduler_sel, u64 first_deadline, u32 period, u32 num_calls, void(*callback)()){
+	u32               id;
+	wlan_sched_list*  list;
+	interrupt_state_t prev_interrupt_state;
+
+	list = wlan_sched_get_list(scheduler_sel);
+
+	if(list == NULL){
+		xil_printf("Unknown scheduler selection.  No event scheduled.\n");
+		return SCHEDULE_FAILURE;
+	}
+
+	if((period == 0) || (num_calls == 0)){
+		return SCHEDULE_FAILURE;
+	}
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	dl_entry* entry_ptr = wlan_sched_pool_alloc();
+
+	if(entry_ptr == NULL){
+		//The event pool is exhausted. Return failure condition
+		wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+		return SCHEDULE_FAILURE;
+	}
+
+	wlan_sched* sched_ptr = wlan_sched_of(entry_ptr);
+
+	id = (schedule_count++);
+
+	// Check if we hit the section of reserved IDs; Wrap back to 0 and start again
+	if ((id >= SCHEDULE_ID_RESERVED_MIN) && (id <= SCHEDULE_ID_RESERVED_MAX)) { id = 0; }
+
+	sched_ptr->id        = id;
+	sched_ptr->num_calls = num_calls;
+	sched_ptr->callback  = (function_ptr_t)callback;
+	sched_ptr->delay     = 0;
+	sched_ptr->period    = period;
+	sched_ptr->deadline  = first_deadline;
+	sched_ptr->target    = wlan_sched_earliest_target(list, wlan_sched_deadline_target(list, first_deadline, get_usec_timestamp()));
+
+	wlan_sched_heap_insert(list, entry_ptr);
+	dl_entry_insertEnd(wlan_sched_id_bucket(list, id), entry_ptr);
+
+	if((list->length == 1) || (list->tickless && (sched_ptr->heap_index == 0))){
+		wlan_sched_timer_update(list);
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
 
 	return id;
 }
@@ -189,48 +354,36 @@ u32 wlan_mac_schedule_event_repeated(u8 scheduler_sel, u32 delay, u32 num_calls,
 *
 ******************************************************************************/
 void wlan_mac_remove_schedule(u8 scheduler_sel, u32 id){
-	dl_entry*	curr_entry_ptr;
-	wlan_sched* curr_sched_ptr;
-
-    curr_entry_ptr = find_schedule(scheduler_sel, id);
-
-    if (curr_entry_ptr != NULL) {
-		curr_sched_ptr = (wlan_sched*)(curr_entry_ptr->data);
-
-		switch(scheduler_sel){
-			case SCHEDULE_COARSE:
-				if(curr_sched_ptr != NULL){
-					dl_entry_remove(&wlan_sched_coarse,curr_entry_ptr);
-					wlan_mac_high_free(curr_entry_ptr);
-					wlan_mac_high_free(curr_sched_ptr);
-				}
-
-				if(wlan_sched_coarse.length == 0){
-					//We just removed the last schedule, but the timer is still running. We should stop it.
-					//When a future schedule is added, it will restart the timer at that time.
-					XTmrCtr_Stop(&TimerCounterInst, TIMER_CNTR_SLOW);
-				}
-			break;
+	dl_entry*	      curr_entry_ptr;
+	wlan_sched_list*  list;
+	interrupt_state_t prev_interrupt_state;
 
-			case SCHEDULE_FINE:
-				if(curr_sched_ptr != NULL){
-					dl_entry_remove(&wlan_sched_fine,curr_entry_ptr);
-					wlan_mac_high_free(curr_entry_ptr);
-					wlan_mac_high_free(curr_sched_ptr);
-				}
-
-				if(wlan_sched_fine.length == 0){
-					//We just removed the last schedule, but the timer is still running. We should stop it.
-					//When a future schedule is added, it will restart the timer at that time.
-					XTmrCtr_Stop(&TimerCounterInst, TIMER_CNTR_FAST);
-				}
-			break;
+	list = wlan_sched_get_list(scheduler_sel);
 
-			default:
-				xil_printf("Unknown scheduler selection.  No event removed.\n");
-			break;
+	if(list == NULL){
+		xil_printf("Unknown scheduler selection.  No event removed.\n");
+		return;
+	}
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	curr_entry_ptr = find_schedule(scheduler_sel, id);
+
+	if (curr_entry_ptr != NULL) {
+		//Calls of the event that are still waiting in the run queue are dropped
+		(wlan_sched_of(curr_entry_ptr)->generation)++;
+
+		wlan_sched_remove_entry(list, curr_entry_ptr);
+
+		//If we just removed the last schedule, the timer is still running and should be stopped. When a
+		//future schedule is added, it will restart the timer at that time. In tickless mode the timer
+		//may also be programmed for the event that was removed.
+		if((list->length == 0) || list->tickless){
+			wlan_sched_timer_update(list);
 		}
-    }
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
 }
 
 /*****************************************************************************/
@@ -247,108 +400,234 @@ void wlan_mac_remove_schedule(u8 scheduler_sel, u32 id){
 *
 ******************************************************************************/
 void timer_handler(void *CallBackRef, u8 TmrCtrNumber){
+	wlan_sched_list* list;
+
+	switch(TmrCtrNumber){
+		case TIMER_CNTR_FAST:
+			list = &wlan_sched_fine;
+		break;
 
-	dl_entry*	next_entry_ptr;
-	dl_entry*	curr_entry_ptr;
-	wlan_sched* curr_sched_ptr;
+		case TIMER_CNTR_SLOW:
+			list = &wlan_sched_coarse;
+		break;
 
-	u32            coarse_id;
-	function_ptr_t coarse_callback;
+		default:
+			return;
+	}
 
-	u32            fine_id;
-	function_ptr_t fine_callback;
+	list->num_interrupts++;
 
+	if(list->tickless){
+		//The one-shot expired at the tick boundary it was programmed for
+		list->num_checks    += (list->timer_partial + list->timer_armed) / list->tick_cycles;
+		list->timer_partial  = 0;
+		list->timer_running  = 0;
+	} else {
+		list->num_checks++;
+	}
 
-	switch(TmrCtrNumber){
-		case TIMER_CNTR_FAST:
-			num_fine_checks++;
-			next_entry_ptr = wlan_sched_fine.first;
-
-			//for(i=0; i<(wlan_sched_fine.length); i++){
-			while(next_entry_ptr != NULL){
-				curr_entry_ptr = next_entry_ptr;
-				next_entry_ptr = dl_entry_next(next_entry_ptr);
-
-				curr_sched_ptr = (wlan_sched*)(curr_entry_ptr->data);
-
-				if(num_fine_checks >= (curr_sched_ptr->target)){
-				//	xil_printf("%d: FINE:   %d > %d\n", curr_sched_ptr->id, (u32)num_fine_checks, (u32)(curr_sched_ptr->target));
-					// curr_sched_ptr->callback(curr_sched_ptr->id);
-					fine_id       = curr_sched_ptr->id;
-					fine_callback = curr_sched_ptr->callback;
-
-					if(curr_sched_ptr->num_calls != SCHEDULE_REPEAT_FOREVER && curr_sched_ptr->num_calls != 0){
-						(curr_sched_ptr->num_calls)--;
-					}
-					if(curr_sched_ptr->num_calls == 0){
-						dl_entry_remove(&wlan_sched_fine,curr_entry_ptr);
-						wlan_mac_high_free(curr_entry_ptr);
-						wlan_mac_high_free(curr_sched_ptr);
-					} else {
-						curr_sched_ptr->target = num_fine_checks + (u64)(curr_sched_ptr->delay);
-					}
-
-					fine_callback(fine_id);
-				}
-			}
-			/*
-			if(wlan_sched_fine.length > 0){
-				//There are still schedules pending. Restart the timer.
-				XTmrCtr_SetResetValue(&TimerCounterInst, TIMER_CNTR_FAST, FAST_TIMER_DUR_US*(TIMER_FREQ/1000000));
-				XTmrCtr_Start(&TimerCounterInst, TIMER_CNTR_FAST);
+	//Callbacks may schedule or remove events. The timer is updated once all expired events have been processed.
+	list->in_handler = 1;
+	wlan_sched_process(list);
+	list->in_handler = 0;
+
+	if((list->length == 0) || list->tickless){
+		wlan_sched_timer_update(list);
+	}
+}
+
+/*****************************************************************************/
+/**
+* Calls the callbacks of all expired events of a scheduler
+*
+* @param    list            - scheduler whose timer has expired
+*
+* @return	None
+*
+* @note     In deferred mode the calls are only queued (see wlan_sched_defer_call())
+* 			and are made from the main loop. A call that does not fit in the queue
+* 			is dropped and counted; it is never made from interrupt context.
+* 			Only expired events are visited. A repeating event is rescheduled
+* 			at least one tick later, so each event is called at most once per
+* 			tick, as when every event was checked on every tick. Events scheduled
+* 			by the callbacks target a later tick (see wlan_sched_earliest_target()),
+* 			so the pass ends once the events that were due when it started are done.
+*
+******************************************************************************/
+static void wlan_sched_process(wlan_sched_list* list){
+	dl_entry*      curr_entry_ptr;
+	wlan_sched*    curr_sched_ptr;
+	u32            id;
+	function_ptr_t callback;
+	u64            num_checks = list->num_checks;
+	u64            timestamp  = 0;
+	u32            lateness;
+	u32            num_missed;
+
+	while(list->length > 0){
+		curr_entry_ptr = list->heap[0];
+		curr_sched_ptr = wlan_sched_of(curr_entry_ptr);
+
+		if(num_checks < (curr_sched_ptr->target)){
+			break;
+		}
+
+		if(curr_sched_ptr->period){
+			timestamp = get_usec_timestamp();
+
+			if(timestamp < curr_sched_ptr->deadline){
+				//The tick came before the deadline; wait for the tick at or after it
+				curr_sched_ptr->target = max(wlan_sched_deadline_target(list, curr_sched_ptr->deadline, timestamp), num_checks + 1);
+				wlan_sched_heap_sift_down(list, 0);
+				continue;
 			}
-			*/
+		}
 
+		id       = curr_sched_ptr->id;
+		callback = curr_sched_ptr->callback;
 
-		break;
+		if(curr_sched_ptr->num_calls != SCHEDULE_REPEAT_FOREVER && curr_sched_ptr->num_calls != 0){
+			(curr_sched_ptr->num_calls)--;
+		}
 
-		case TIMER_CNTR_SLOW:
-			num_coarse_checks++;
-			next_entry_ptr = wlan_sched_coarse.first;
-
-			while(next_entry_ptr != NULL){
-				curr_entry_ptr = next_entry_ptr;
-				next_entry_ptr = dl_entry_next(next_entry_ptr);
-
-				curr_sched_ptr = (wlan_sched*)(curr_entry_ptr->data);
-
-				if(num_coarse_checks >= (curr_sched_ptr->target)){
-					// curr_sched_ptr->callback(curr_sched_ptr->id);
-					coarse_id       = curr_sched_ptr->id;
-					coarse_callback = curr_sched_ptr->callback;
-
-					if(curr_sched_ptr->num_calls != SCHEDULE_REPEAT_FOREVER && curr_sched_ptr->num_calls != 0){
-						(curr_sched_ptr->num_calls)--;
-					}
-					if(curr_sched_ptr->num_calls == 0){
-						dl_entry_remove(&wlan_sched_coarse,curr_entry_ptr);
-						wlan_mac_high_free(curr_entry_ptr);
-						wlan_mac_high_free(curr_sched_ptr);
-					} else {
-						curr_sched_ptr->target = num_coarse_checks + (u64)(curr_sched_ptr->delay);
-					}
-
-					coarse_callback(coarse_id);
-				}
+		if(curr_sched_ptr->period){
+			//Re-arm from the deadline, not from the time of this call
+			lateness   = (u32)(timestamp - curr_sched_ptr->deadline);
+			num_missed = 0;
+			curr_sched_ptr->deadline += curr_sched_ptr->period;
+
+			if(curr_sched_ptr->deadline <= timestamp){
+				num_missed = ((timestamp - curr_sched_ptr->deadline) / curr_sched_ptr->period) + 1;
+				curr_sched_ptr->deadline += (u64)num_missed * curr_sched_ptr->period;
 			}
-			/*
-			if(wlan_sched_coarse.length > 0){
-				//There are still schedules pending. Restart the timer.
-				XTmrCtr_SetResetValue(&TimerCounterInst, TIMER_CNTR_SLOW, SLOW_TIMER_DUR_US*(TIMER_FREQ/1000000));
-				XTmrCtr_Start(&TimerCounterInst, TIMER_CNTR_SLOW);
+
+			wlan_sched_lateness_update(list, lateness, num_missed);
+		}
+
+		//Queue the call before the event can be removed, so that its record is kept until the call is made
+		if(list->deferred){
+			wlan_sched_defer_call(list, curr_entry_ptr);
+		}
+
+		if(curr_sched_ptr->num_calls == 0){
+			wlan_sched_remove_entry(list, curr_entry_ptr);
+		} else {
+			if(curr_sched_ptr->period){
+				curr_sched_ptr->target = max(wlan_sched_deadline_target(list, curr_sched_ptr->deadline, timestamp), num_checks + 1);
+			} else {
+				curr_sched_ptr->target = num_checks + (u64)(max(curr_sched_ptr->delay, 1));
 			}
-			*/
+			wlan_sched_heap_sift_down(list, 0);
+		}
 
-		break;
+		if(list->deferred == 0){
+			callback(id);
+		}
 	}
+}
+
+/*****************************************************************************/
+/**
+* Queues the call of an expired event for the main loop
+*
+* @param    list            - scheduler event list
+* 			entry           - dl_entry of the event
+*
+* @return	None
+*
+* @note     Called from the timer interrupt handler. If the deferred call queue
+* 			is full the call is dropped and counted in num_deferred_overflows. If
+* 			the run queue is full, the queued calls wait until a later call
+* 			manages to queue the wlan_sched_deferred_run() work item.
+*
+******************************************************************************/
+static void wlan_sched_defer_call(wlan_sched_list* list, dl_entry* entry){
+	wlan_sched*               sched_ptr = wlan_sched_of(entry);
+	wlan_sched_deferred_call* call;
 
-	if(wlan_sched_fine.length == 0){
-		XTmrCtr_Stop(&TimerCounterInst, TIMER_CNTR_FAST);
+	if((list->deferred_tail - list->deferred_head) >= SCHEDULE_DEFERRED_QUEUE_SIZE){
+		list->num_deferred_overflows++;
+		return;
 	}
-	if(wlan_sched_coarse.length == 0) {
-		XTmrCtr_Stop(&TimerCounterInst, TIMER_CNTR_SLOW);
+
+	call             = &(list->deferred_calls[list->deferred_tail & (SCHEDULE_DEFERRED_QUEUE_SIZE - 1)]);
+	call->entry      = entry;
+	call->id         = sched_ptr->id;
+	call->generation = sched_ptr->generation;
+
+	list->deferred_tail++;
+	(sched_ptr->num_deferred)++;
+
+	if(list->deferred_run_pending == 0){
+		if(run_queue_enqueue(list->run_queue_priority, (function_ptr_t)wlan_sched_deferred_run, (u32)list) == 0){
+			list->deferred_run_pending = 1;
+		}
 	}
+}
+
+/*****************************************************************************/
+/**
+* Run queue work item that makes the deferred calls of a scheduler
+*
+* @param    arg             - scheduler event list (wlan_sched_list*)
+*
+* @return	None
+*
+* @note     Only the calls queued when the work item starts are made; calls queued
+* 			while it runs are made by the next work item. A call is dropped, and
+* 			counted in num_deferred_dropped, if its event was removed after the
+* 			call was queued or its record has since been re-used. The record of an
+* 			event that is no longer scheduled returns to the pool once its last
+* 			deferred call is done.
+*
+******************************************************************************/
+static void wlan_sched_deferred_run(u32 arg){
+	wlan_sched_list*          list = (wlan_sched_list*)arg;
+	wlan_sched_deferred_call  call;
+	wlan_sched*               sched_ptr;
+	function_ptr_t            callback;
+	u32                       num_calls;
+	u8                        valid;
+	interrupt_state_t         prev_interrupt_state;
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+	list->deferred_run_pending = 0;
+	num_calls = list->deferred_tail - list->deferred_head;
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	while(num_calls > 0){
+		num_calls--;
+
+		prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+		call = list->deferred_calls[list->deferred_head & (SCHEDULE_DEFERRED_QUEUE_SIZE - 1)];
+		list->deferred_head++;
+
+		sched_ptr = wlan_sched_of(call.entry);
+		callback  = sched_ptr->callback;
+		valid     = (sched_ptr->id == call.id) && (sched_ptr->generation == call.generation);
+
+		if(valid == 0){
+			list->num_deferred_dropped++;
+		}
+
+		wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
 
+		if(valid){
+			callback(call.id);
+		}
+
+		// The callback may have removed the event
+		prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+		(sched_ptr->num_deferred)--;
+
+		if((sched_ptr->num_deferred == 0) && (sched_ptr->heap_index == WLAN_SCHED_HEAP_INDEX_NONE)){
+			wlan_sched_pool_free_entry(call.entry);
+		}
+
+		wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+	}
 }
 
 /*****************************************************************************/
@@ -361,47 +640,798 @@ void timer_handler(void *CallBackRef, u8 TmrCtrNumber){
 * @return   dl_entry*       - pointer to the doubly-linked list entry that, in turn,
 * 						      points to the schedule
 *
-* @note     This function is a modified implementation of XTmrCtr_InterruptHandler
-* 			in the xtmrctr_intr.c driver. It has been modified to remove an explicit
-* 			reset of the timer.
+* @note     Only the events that share the ID's hash bucket are searched.
 *
 ******************************************************************************/
 dl_entry* find_schedule(u8 scheduler_sel, u32 id){
-	dl_entry*	curr_dl_entry;
-	dl_entry*   next_dl_entry;
-	wlan_sched* curr_wlan_sched;
+	dl_entry*	     curr_dl_entry;
+	wlan_sched_list* list;
+
+	list = wlan_sched_get_list(scheduler_sel);
+
+	if(list == NULL){
+		return NULL;
+	}
+
+	curr_dl_entry = wlan_sched_id_bucket(list, id)->first;
+
+	while(curr_dl_entry != NULL){
+		if(wlan_sched_of(curr_dl_entry)->id == id){
+			return curr_dl_entry;
+		}
+		curr_dl_entry = dl_entry_next(curr_dl_entry);
+	}
+	return NULL;
+}
+
+/*****************************************************************************/
+/**
+* Initializes an empty scheduler event list
+*
+* @param    list            - scheduler event list
+* 			timer_cntr      - timer counter used by the scheduler
+* 			tick_us         - duration of a scheduler tick (in microseconds)
+*
+* @return	None
+*
+******************************************************************************/
+static void wlan_sched_list_init(wlan_sched_list* list, u8 timer_cntr, u32 tick_us){
+	u32 i;
+
+	list->heap     = NULL;
+	list->length   = 0;
+
+	list->num_checks     = 0;
+	list->timer_cntr     = timer_cntr;
+	list->tickless       = SCHEDULE_TICKLESS_DEFAULT;
+	list->timer_running  = 0;
+	list->in_handler     = 0;
+	list->deferred       = SCHEDULE_DEFERRED_DEFAULT;
+	list->run_queue_priority = (timer_cntr == TIMER_CNTR_FAST) ? RUN_QUEUE_PRIORITY_HIGH : RUN_QUEUE_PRIORITY_NORMAL;
+	list->tick_cycles    = tick_us * (TIMER_FREQ/1000000);
+	list->timer_partial  = 0;
+	list->timer_armed    = 0;
+	list->num_interrupts = 0;
+
+	list->deferred_head          = 0;
+	list->deferred_tail          = 0;
+	list->deferred_run_pending   = 0;
+	list->num_deferred_overflows = 0;
+	list->num_deferred_dropped   = 0;
+
+	bzero(&(list->lateness), sizeof(wlan_sched_lateness_stats));
+
+	for(i = 0; i < SCHEDULE_ID_TABLE_SIZE; i++){
+		dl_list_init(&(list->id_table[i]));
+	}
+}
 
+/*****************************************************************************/
+/**
+* Returns the event list of a scheduler
+*
+* @param    scheduler_sel   - SCHEDULE_COARSE or SCHEDULE_FINE
+*
+* @return	wlan_sched_list* - event list, NULL if scheduler_sel is invalid
+*
+******************************************************************************/
+static wlan_sched_list* wlan_sched_get_list(u8 scheduler_sel){
 	switch(scheduler_sel){
-		case SCHEDULE_COARSE:
-			next_dl_entry = wlan_sched_coarse.first;
+		case SCHEDULE_COARSE: return &wlan_sched_coarse;
+		case SCHEDULE_FINE:   return &wlan_sched_fine;
+	}
+	return NULL;
+}
 
-			while(next_dl_entry != NULL){
-				curr_dl_entry   = next_dl_entry;
-				next_dl_entry   = dl_entry_next(next_dl_entry);
+/*****************************************************************************/
+/**
+* Adds an event to a scheduler's heap
+*
+* @param    list            - scheduler event list
+* 			entry           - dl_entry of the event; its wlan_sched target must be set
+*
+* @return	None
+*
+* @note     The heap array holds as many events as the event pool, so it cannot overflow.
+*
+******************************************************************************/
+static void wlan_sched_heap_insert(wlan_sched_list* list, dl_entry* entry){
+	list->heap[list->length] = entry;
+	(list->length)++;
 
-				curr_wlan_sched = (wlan_sched*)(curr_dl_entry->data);
+	wlan_sched_heap_sift_up(list, list->length - 1);
+}
 
-				if(curr_wlan_sched->id == id){
-					return curr_dl_entry;
-				}
-			}
-		break;
-		case SCHEDULE_FINE:
-			next_dl_entry = wlan_sched_fine.first;
+/*****************************************************************************/
+/**
+* Removes the event at a position in a scheduler's heap
+*
+* @param    list            - scheduler event list
+* 			index           - heap position of the event
+*
+* @return	None
+*
+******************************************************************************/
+static void wlan_sched_heap_remove(wlan_sched_list* list, u32 index){
+	(list->length)--;
+
+	if(index == list->length){
+		return;
+	}
 
-			while(next_dl_entry != NULL){
-				curr_dl_entry   = next_dl_entry;
-				next_dl_entry   = dl_entry_next(next_dl_entry);
+	// Move the last event into the hole and restore the heap property around it
+	list->heap[index] = list->heap[list->length];
+	wlan_sched_of(list->heap[index])->heap_index = index;
 
-				curr_wlan_sched = (wlan_sched*)(curr_dl_entry->data);
+	wlan_sched_heap_sift_down(list, index);
+	wlan_sched_heap_sift_up(list, wlan_sched_of(list->heap[index])->heap_index);
+}
 
-				if(curr_wlan_sched->id == id){
-					return curr_dl_entry;
-				}
-			}
-		break;
+/*****************************************************************************/
+/**
+* Moves an event towards the root of the heap until its parent's target is not later
+*
+******************************************************************************/
+static void wlan_sched_heap_sift_up(wlan_sched_list* list, u32 index){
+	dl_entry* entry  = list->heap[index];
+	u64       target = wlan_sched_of(entry)->target;
+	u32       parent;
+
+	while(index > 0){
+		parent = (index - 1) >> 1;
+
+		if(wlan_sched_of(list->heap[parent])->target <= target){
+			break;
+		}
+
+		list->heap[index] = list->heap[parent];
+		wlan_sched_of(list->heap[index])->heap_index = index;
+		index = parent;
 	}
-	return NULL;
+
+	list->heap[index] = entry;
+	wlan_sched_of(entry)->heap_index = index;
+}
+
+/*****************************************************************************/
+/**
+* Moves an event away from the root of the heap until neither child's target is earlier
+*
+******************************************************************************/
+static void wlan_sched_heap_sift_down(wlan_sched_list* list, u32 index){
+	dl_entry* entry  = list->heap[index];
+	u64       target = wlan_sched_of(entry)->target;
+	u32       child;
+
+	while((child = (2 * index) + 1) < list->length){
+		if(((child + 1) < list->length) && (wlan_sched_of(list->heap[child + 1])->target < wlan_sched_of(list->heap[child])->target)){
+			child++;
+		}
+
+		if(target <= wlan_sched_of(list->heap[child])->target){
+			break;
+		}
+
+		list->heap[index] = list->heap[child];
+		wlan_sched_of(list->heap[index])->heap_index = index;
+		index = child;
+	}
+
+	list->heap[index] = entry;
+	wlan_sched_of(entry)->heap_index = index;
+}
+
+/*****************************************************************************/
+/**
+* Removes an event from a scheduler and frees it
+*
+* @param    list            - scheduler event list
+* 			entry           - dl_entry of the event
+*
+* @return	None
+*
+* @note     An event with deferred calls still queued is returned to the pool by
+* 			wlan_sched_deferred_run() once they are done.
+*
+******************************************************************************/
+static void wlan_sched_remove_entry(wlan_sched_list* list, dl_entry* entry){
+	wlan_sched* sched_ptr = wlan_sched_of(entry);
+
+	wlan_sched_heap_remove(list, sched_ptr->heap_index);
+	dl_entry_remove(wlan_sched_id_bucket(list, sched_ptr->id), entry);
+
+	sched_ptr->heap_index = WLAN_SCHED_HEAP_INDEX_NONE;
+
+	if(sched_ptr->num_deferred == 0){
+		wlan_sched_pool_free_entry(entry);
+	}
+}
+
+/*****************************************************************************/
+/**
+* Limits the target of an event being scheduled
+*
+* @param    list            - scheduler event list
+* 			target          - requested target tick
+*
+* @return	u64             - target tick of the event
+*
+* @note     An event scheduled by a callback called from the timer handler
+* 			targets the next tick at the earliest. Otherwise a callback that
+* 			schedules an event with no delay would be called again in the same
+* 			pass of wlan_sched_process(), without bound.
+*
+******************************************************************************/
+static u64 wlan_sched_earliest_target(wlan_sched_list* list, u64 target){
+	if(list->in_handler){
+		return max(target, list->num_checks + 1);
+	}
+	return target;
+}
+
+/*****************************************************************************/
+/**
+* Returns the current tick of a scheduler
+*
+* @param    list            - scheduler event list
+*
+* @return	u64             - current tick
+*
+* @note     In tickless mode the ticks that have elapsed since the one-shot was
+* 			programmed are read from the timer. Must be called with interrupts stopped.
+*
+******************************************************************************/
+static u64 wlan_sched_now(wlan_sched_list* list){
+	u32 elapsed;
+
+	if((list->tickless == 0) || (list->timer_running == 0) || list->in_handler){
+		return list->num_checks;
+	}
+
+	if(XTmrCtr_IsExpired(&TimerCounterInst, list->timer_cntr)){
+		elapsed = list->timer_partial + list->timer_armed;
+	} else {
+		elapsed = list->timer_partial + list->timer_armed - XTmrCtr_GetValue(&TimerCounterInst, list->timer_cntr);
+	}
+
+	return list->num_checks + (elapsed / list->tick_cycles);
+}
+
+/*****************************************************************************/
+/**
+* Starts, stops or reprograms a scheduler's timer after its events have changed
+*
+* @param    list            - scheduler event list
+*
+* @return	None
+*
+* @note     Must be called with interrupts stopped.
+*
+******************************************************************************/
+static void wlan_sched_timer_update(wlan_sched_list* list){
+	u32 elapsed;
+	u64 num_ticks;
+
+	//The timer handler updates the timer once it has processed all expired events
+	if(list->in_handler){
+		return;
+	}
+
+	if(list->length == 0){
+		XTmrCtr_Stop(&TimerCounterInst, list->timer_cntr);
+		list->timer_running = 0;
+		list->timer_partial = 0;
+		return;
+	}
+
+	if(list->tickless == 0){
+		if(list->timer_running == 0){
+			XTmrCtr_SetResetValue(&TimerCounterInst, list->timer_cntr, list->tick_cycles);
+			XTmrCtr_Start(&TimerCounterInst, list->timer_cntr);
+			list->timer_running = 1;
+		}
+		return;
+	}
+
+	if(list->timer_running){
+		//Check for a pending interrupt before stopping the timer: XTmrCtr_Stop() writes the control
+		//register back with the interrupt bit set, which acknowledges the interrupt
+		if(XTmrCtr_IsExpired(&TimerCounterInst, list->timer_cntr)){
+			//The timer interrupt is pending. The timer handler will advance num_checks and reprogram the timer.
+			return;
+		}
+
+		XTmrCtr_Stop(&TimerCounterInst, list->timer_cntr);
+
+		//Move the whole ticks that have elapsed into num_checks and keep the remainder
+		elapsed              = list->timer_partial + list->timer_armed - XTmrCtr_GetValue(&TimerCounterInst, list->timer_cntr);
+		list->num_checks    += elapsed / list->tick_cycles;
+		list->timer_partial  = elapsed % list->tick_cycles;
+	}
+
+	num_ticks = wlan_sched_of(list->heap[0])->target;
+	num_ticks = (num_ticks > list->num_checks) ? (num_ticks - list->num_checks) : 1;
+
+	//The one-shot must fit in the 32-bit timer
+	num_ticks = min(num_ticks, (u64)(0xFFFFFFFF / list->tick_cycles));
+
+	list->timer_armed = ((u32)num_ticks * list->tick_cycles) - list->timer_partial;
+
+	XTmrCtr_SetResetValue(&TimerCounterInst, list->timer_cntr, list->timer_armed);
+	XTmrCtr_Start(&TimerCounterInst, list->timer_cntr);
+	list->timer_running = 1;
+}
+
+/*****************************************************************************/
+/**
+* Sets the timer options for a scheduler's mode
+*
+* @param    list            - scheduler event list
+*
+* @return	None
+*
+******************************************************************************/
+static void wlan_sched_timer_set_options(wlan_sched_list* list){
+	if(list->tickless){
+		XTmrCtr_SetOptions(&TimerCounterInst, list->timer_cntr, XTC_DOWN_COUNT_OPTION | XTC_INT_MODE_OPTION);
+	} else {
+		XTmrCtr_SetOptions(&TimerCounterInst, list->timer_cntr, XTC_DOWN_COUNT_OPTION | XTC_INT_MODE_OPTION | XTC_AUTO_RELOAD_OPTION);
+	}
+}
+
+/*****************************************************************************/
+/**
+* Selects periodic or tickless operation of a scheduler
+*
+* @param    scheduler_sel   - SCHEDULE_COARSE or SCHEDULE_FINE
+* 			tickless        - 1 to program the timer for the earliest event only, 0 to interrupt every tick
+*
+* @return	int             - 0 on success, -1 if scheduler_sel is invalid
+*
+* @note     In tickless mode the time between the one-shot expiring and the timer
+* 			handler reprogramming it is not counted, so a scheduler that stays
+* 			busy may run slightly behind the periodic mode.
+*
+******************************************************************************/
+int wlan_mac_schedule_set_tickless(u8 scheduler_sel, u8 tickless){
+	wlan_sched_list*  list;
+	interrupt_state_t prev_interrupt_state;
+
+	list = wlan_sched_get_list(scheduler_sel);
+
+	if(list == NULL){
+		return -1;
+	}
+
+	tickless = (tickless != 0);
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	if(tickless != list->tickless){
+		//Stop the timer in the current mode, keeping any elapsed ticks
+		if(list->timer_running){
+			//Read the elapsed ticks and any pending interrupt before stopping the timer, which
+			//acknowledges the interrupt. Any events that were due are processed at the next timer
+			//interrupt in the new mode.
+			list->num_checks = wlan_sched_now(list);
+
+			if(XTmrCtr_IsExpired(&TimerCounterInst, list->timer_cntr) && (list->tickless == 0)){
+				list->num_checks++;
+			}
+
+			XTmrCtr_Stop(&TimerCounterInst, list->timer_cntr);
+			list->timer_running = 0;
+		}
+		list->timer_partial = 0;
+
+		list->tickless = tickless;
+		wlan_sched_timer_set_options(list);
+
+		if(list->length > 0){
+			wlan_sched_timer_update(list);
+		}
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	return 0;
+}
+
+/*****************************************************************************/
+/**
+* Selects whether a scheduler's callbacks are called from interrupt context
+*
+* @param    scheduler_sel   - SCHEDULE_COARSE or SCHEDULE_FINE
+* 			deferred        - 1 to queue callbacks to the run queue, 0 to call them from the timer handler
+*
+* @return	int             - 0 on success, -1 if scheduler_sel is invalid
+*
+* @note     Schedulers start in deferred mode (SCHEDULE_DEFERRED_DEFAULT). Deferred
+* 			callbacks are called from the main loop (see wlan_mac_high_main_loop()).
+* 			Fine scheduler callbacks are run at RUN_QUEUE_PRIORITY_HIGH and coarse
+* 			scheduler callbacks at RUN_QUEUE_PRIORITY_NORMAL. A callback that was
+* 			queued before its event was removed is not called.
+*
+******************************************************************************/
+int wlan_mac_schedule_set_deferred(u8 scheduler_sel, u8 deferred){
+	wlan_sched_list* list;
+
+	list = wlan_sched_get_list(scheduler_sel);
+
+	if(list == NULL){
+		return -1;
+	}
+
+	list->deferred = (deferred != 0);
+
+	return 0;
+}
+
+/*****************************************************************************/
+/**
+* Returns the timer statistics of a scheduler
+*
+* @param    scheduler_sel   - SCHEDULE_COARSE or SCHEDULE_FINE
+* 			stats           - filled in with the mode, tick count, number of timer interrupts and deferred call counts
+*
+* @return	int             - 0 on success, -1 if scheduler_sel is invalid
+*
+******************************************************************************/
+int wlan_mac_schedule_get_timer_stats(u8 scheduler_sel, wlan_sched_timer_stats* stats){
+	wlan_sched_list*  list;
+	interrupt_state_t prev_interrupt_state;
+
+	list = wlan_sched_get_list(scheduler_sel);
+
+	if(list == NULL){
+		return -1;
+	}
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	stats->tickless       = list->tickless;
+	stats->num_checks     = wlan_sched_now(list);
+	stats->num_interrupts = list->num_interrupts;
+
+	stats->num_deferred_overflows = list->num_deferred_overflows;
+	stats->num_deferred_dropped   = list->num_deferred_dropped;
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	return 0;
+}
+
+/*****************************************************************************/
+/**
+* Returns the scheduler tick at which a microsecond deadline is reached
+*
+* @param    list            - scheduler event list
+* 			deadline        - deadline (in microseconds)
+* 			timestamp       - current time (in microseconds)
+*
+* @return	u64             - first tick at or after the deadline
+*
+* @note     The tick boundaries are not aligned to the microsecond timer, so the
+* 			deadline is checked again when the tick is reached.
+*
+******************************************************************************/
+static u64 wlan_sched_deadline_target(wlan_sched_list* list, u64 deadline, u64 timestamp){
+	u64 tick_us = list->tick_cycles / (TIMER_FREQ/1000000);
+
+	if(deadline <= timestamp){
+		return wlan_sched_now(list);
+	}
+
+	return wlan_sched_now(list) + ((deadline - timestamp + tick_us - 1) / tick_us);
+}
+
+/*****************************************************************************/
+/**
+* Records the lateness of a call to an event with a microsecond deadline
+*
+* @param    list            - scheduler event list
+* 			lateness        - time (in microseconds) between the deadline and the call
+* 			num_missed      - number of deadlines skipped because they had already passed
+*
+* @return	None
+*
+******************************************************************************/
+static void wlan_sched_lateness_update(wlan_sched_list* list, u32 lateness, u32 num_missed){
+	wlan_sched_lateness_stats* stats = &(list->lateness);
+	u32                        bin   = 0;
+	u32                        val   = lateness;
+
+	// Bin 0 holds on-time calls; bin N holds lateness in [2^(N-1), 2^N) usec
+	while((val != 0) && (bin < (SCHEDULE_LATENESS_NUM_BINS - 1))){
+		val >>= 1;
+		bin++;
+	}
+
+	stats->num_calls++;
+	stats->num_missed += num_missed;
+	stats->hist[bin]++;
+
+	if(lateness > stats->lateness_max){
+		stats->lateness_max = lateness;
+	}
+
+	if(stats->num_calls == 1){
+		stats->lateness_avg = lateness;
+	} else {
+		stats->lateness_avg = stats->lateness_avg - (stats->lateness_avg >> 3) + (lateness >> 3);
+	}
+}
+
+/*****************************************************************************/
+/**
+* Returns the lateness statistics of a scheduler
+*
+* @param    scheduler_sel   - SCHEDULE_COARSE or SCHEDULE_FINE
+* 			stats           - filled in with the lateness of calls to events with microsecond deadlines
+*
+* @return	int             - 0 on success, -1 if scheduler_sel is invalid
+*
+******************************************************************************/
+int wlan_mac_schedule_get_lateness_stats(u8 scheduler_sel, wlan_sched_lateness_stats* stats){
+	wlan_sched_list*  list;
+	interrupt_state_t prev_interrupt_state;
+
+	list = wlan_sched_get_list(scheduler_sel);
+
+	if(list == NULL){
+		return -1;
+	}
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+	memcpy(stats, &(list->lateness), sizeof(wlan_sched_lateness_stats));
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	return 0;
+}
+
+/*****************************************************************************/
+/**
+* Clears the lateness statistics of a scheduler
+*
+* @param    scheduler_sel   - SCHEDULE_COARSE or SCHEDULE_FINE
+*
+* @return	int             - 0 on success, -1 if scheduler_sel is invalid
+*
+******************************************************************************/
+int wlan_mac_schedule_reset_lateness_stats(u8 scheduler_sel){
+	wlan_sched_list*  list;
+	interrupt_state_t prev_interrupt_state;
+
+	list = wlan_sched_get_list(scheduler_sel);
+
+	if(list == NULL){
+		return -1;
+	}
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+	bzero(&(list->lateness), sizeof(wlan_sched_lateness_stats));
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	return 0;
+}
+
+/*****************************************************************************/
+/**
+* Grows the scheduler event pool
+*
+* @param    capacity        - total number of events that may be scheduled at once
+*
+* @return	int             - 0 on success, -1 if the memory for the new events could not be allocated
+*
+* @note     The pool never shrinks. Requesting a capacity at or below the current
+* 			capacity has no effect. This function allocates from the heap, which is
+* 			not reentrant, so it must not be called from interrupt context. The
+* 			scheduler calls it from the main loop through a run queue work item
+* 			(see wlan_sched_pool_grow()).
+*
+******************************************************************************/
+int wlan_mac_schedule_pool_config(u32 capacity){
+	u32               i;
+	u32               num_new;
+	wlan_sched_event* events;
+	dl_entry**        heap_coarse;
+	dl_entry**        heap_fine;
+	dl_entry**        old_heap_coarse;
+	dl_entry**        old_heap_fine;
+	interrupt_state_t prev_interrupt_state;
+
+	if(capacity <= wlan_sched_pool_capacity){
+		return 0;
+	}
+
+	num_new     = capacity - wlan_sched_pool_capacity;
+	events      = wlan_mac_high_malloc(num_new * sizeof(wlan_sched_event));
+	heap_coarse = wlan_mac_high_malloc(capacity * sizeof(dl_entry*));
+	heap_fine   = wlan_mac_high_malloc(capacity * sizeof(dl_entry*));
+
+	if((events == NULL) || (heap_coarse == NULL) || (heap_fine == NULL)){
+		if(events != NULL)      wlan_mac_high_free(events);
+		if(heap_coarse != NULL) wlan_mac_high_free(heap_coarse);
+		if(heap_fine != NULL)   wlan_mac_high_free(heap_fine);
+		return -1;
+	}
+
+	for(i = 0; i < num_new; i++){
+		events[i].entry.data         = &(events[i].sched);
+		events[i].sched.generation   = 0;
+		events[i].sched.num_deferred = 0;
+	}
+
+	// The timer interrupt handler must not run while the heaps are copied and swapped in
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	if(wlan_sched_coarse.length > 0){
+		memcpy(heap_coarse, wlan_sched_coarse.heap, wlan_sched_coarse.length * sizeof(dl_entry*));
+	}
+	if(wlan_sched_fine.length > 0){
+		memcpy(heap_fine, wlan_sched_fine.heap, wlan_sched_fine.length * sizeof(dl_entry*));
+	}
+
+	// Keep the old arrays so they can be freed once interrupts are restored
+	old_heap_coarse        = wlan_sched_coarse.heap;
+	old_heap_fine          = wlan_sched_fine.heap;
+	wlan_sched_coarse.heap = heap_coarse;
+	wlan_sched_fine.heap   = heap_fine;
+
+	for(i = 0; i < num_new; i++){
+		dl_entry_insertEnd(&wlan_sched_pool_free, &(events[i].entry));
+	}
+
+	wlan_sched_pool_capacity = capacity;
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	if(old_heap_coarse != NULL) wlan_mac_high_free(old_heap_coarse);
+	if(old_heap_fine != NULL)   wlan_mac_high_free(old_heap_fine);
+
+	return 0;
+}
+
+/*****************************************************************************/
+/**
+* Returns the state of the scheduler event pool
+*
+* @param    stats           - filled in with the pool capacity, usage and high water mark
+*
+* @return	None
+*
+******************************************************************************/
+void wlan_mac_schedule_pool_get_stats(wlan_sched_pool_stats* stats){
+	stats->capacity     = wlan_sched_pool_capacity;
+	stats->num_used     = wlan_sched_pool_capacity - wlan_sched_pool_free.length;
+	stats->high_water   = wlan_sched_pool_high_water;
+	stats->num_failures = wlan_sched_pool_num_failures;
+}
+
+/*****************************************************************************/
+/**
+* Prints the state of the scheduler event pool
+*
+* @param    None
+*
+* @return	None
+*
+******************************************************************************/
+void wlan_mac_schedule_display_pool_info(){
+	wlan_sched_pool_stats stats;
+
+	wlan_mac_schedule_pool_get_stats(&stats);
+
+	xil_printf("\n");
+	xil_printf("--- Scheduler Event Pool ---\n");
+	xil_printf("   capacity:                %d\n", stats.capacity);
+	xil_printf("   num_used:                %d\n", stats.num_used);
+	xil_printf("   high_water:              %d\n", stats.high_water);
+	xil_printf("   num_failures:            %d\n", stats.num_failures);
+}
+
+/*****************************************************************************/
+/**
+* Takes an event from the event pool
+*
+* @param    None
+*
+* @return	dl_entry*       - dl_entry of the event, NULL if the pool is exhausted
+*
+* @note     Must be called with interrupts stopped. It may be called from the timer
+* 			interrupt handler, so it never grows the pool itself. If the allocation
+* 			leaves fewer than SCHEDULE_POOL_LOW_WATER free events, or the pool is
+* 			empty, the pool is grown by the next pass of run_queue_poll().
+*
+******************************************************************************/
+static dl_entry* wlan_sched_pool_alloc(){
+	dl_entry* entry;
+	u32       num_used;
+
+	entry = wlan_sched_pool_free.first;
+
+	if(entry == NULL){
+		wlan_sched_pool_num_failures++;
+		wlan_sched_pool_request_grow();
+		return NULL;
+	}
+
+	dl_entry_remove(&wlan_sched_pool_free, entry);
+
+	//Calls queued for an earlier event that used the record are not made for this one
+	(wlan_sched_of(entry)->generation)++;
+
+	num_used = wlan_sched_pool_capacity - wlan_sched_pool_free.length;
+
+	if(num_used > wlan_sched_pool_high_water){
+		wlan_sched_pool_high_water = num_used;
+	}
+
+	if(wlan_sched_pool_free.length < SCHEDULE_POOL_LOW_WATER){
+		wlan_sched_pool_request_grow();
+	}
+
+	return entry;
+}
+
+/*****************************************************************************/
+/**
+* Queues a run queue work item to grow the event pool
+*
+* @param    None
+*
+* @return	None
+*
+* @note     Must be called with interrupts stopped. Only one work item is
+* 			queued at a time.
+*
+******************************************************************************/
+static void wlan_sched_pool_request_grow(){
+	if(wlan_sched_pool_grow_pending){
+		return;
+	}
+
+	if(run_queue_enqueue(RUN_QUEUE_PRIORITY_NORMAL, (function_ptr_t)wlan_sched_pool_grow, 0) == 0){
+		wlan_sched_pool_grow_pending = 1;
+	}
+}
+
+/*****************************************************************************/
+/**
+* Run queue work item that doubles the event pool
+*
+* @param    arg             - unused
+*
+* @return	None
+*
+* @note     The pool is only grown if it is still below SCHEDULE_POOL_LOW_WATER
+* 			free events.
+*
+******************************************************************************/
+static void wlan_sched_pool_grow(u32 arg){
+	wlan_sched_pool_grow_pending = 0;
+
+	if(wlan_sched_pool_free.length >= SCHEDULE_POOL_LOW_WATER){
+		return;
+	}
+
+	// On failure another work item is queued by the next allocation that finds the pool low
+	wlan_mac_schedule_pool_config(2 * wlan_sched_pool_capacity);
+}
+
+/*****************************************************************************/
+/**
+* Returns an event to the event pool
+*
+* @param    entry           - dl_entry of the event
+*
+* @return	None
+*
+* @note     Must be called with interrupts stopped.
+*
+******************************************************************************/
+static void wlan_sched_pool_free_entry(dl_entry* entry){
+	dl_entry_insertEnd(&wlan_sched_pool_free, entry);
 }
 
 /*****************************************************************************/